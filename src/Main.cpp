@@ -3,16 +3,22 @@
 #include <OIS.h>
 
 #include "Main.h"
+#include "core/Benchmark.h"
 #include "core/CameraManager.h"
 #include "core/ConfigCmdManager.h"
 #include "core/ConfigFile.h"
 #include "core/ConfigVarManager.h"
+#include "core/Counters.h"
 #include "core/Console.h"
 #include "core/DebugDraw.h"
 #include "game/EntityManager.h"
+#include "core/FrameBudget.h"
 #include "core/GameFrameListner.h"
 #include "core/InputManager.h"
 #include "core/Logger.h"
+#include "core/MemoryTracker.h"
+#include "core/Profiler.h"
+#include "core/Recorder.h"
 #include "core/ScriptManager.h"
 #include "core/TextManager.h"
 #include "core/Timer.h"
@@ -32,8 +38,10 @@ main(int argc, char *argv[])
     Ogre::SceneManager* scene_manager;
 
     Ogre::LogManager* log_manager = new Ogre::LogManager();
-    log_manager->createLog( "x-gears.log", true, true );
+    // file is written by logger writer thread, ogre messages go there through listener
+    log_manager->createLog( "x-gears.log", true, true, true );
     log_manager->getDefaultLog()->setLogDetail( ( Ogre::LoggingLevel )3 );
+    Logger* logger = new Logger( "x-gears.log" );
 
     // init root early
     root = new Ogre::Root( "", "" );
@@ -75,12 +83,24 @@ main(int argc, char *argv[])
 
 
 
+    // create in main thread, it becomes profiler thread 0
+    Profiler* profiler = new Profiler();
+    Counters* counters = new Counters();
+    // before any tracked memory is allocated
+    MemoryTracker* memory_tracker = new MemoryTracker();
+    // init before managers because they add their scenarios
+    Benchmark* benchmark = new Benchmark();
+
+
+
     DebugDraw* debug_draw = new DebugDraw();
 
 
 
     // init before GameFrameListener, but after ConfigCmdManager
     InputManager* input_manager = new InputManager();
+    Recorder* recorder = new Recorder();
+    FrameBudget* frame_budget = new FrameBudget();
 
 
 
@@ -114,9 +134,68 @@ main(int argc, char *argv[])
 
 
 
+    // session recorded from start can be replayed from start with same state
+    // -record <file>, -replay <file>, -headless replays without drawing and exits at end
+    {
+        bool headless = false;
+        for( int i = 1; i < argc; ++i )
+        {
+            headless = headless || Ogre::String( argv[ i ] ) == "-headless";
+        }
+        for( int i = 1; i < argc - 1; ++i )
+        {
+            if( Ogre::String( argv[ i ] ) == "-record" )
+            {
+                recorder->StartRecord( argv[ i + 1 ] );
+            }
+            else if( Ogre::String( argv[ i ] ) == "-replay" )
+            {
+                recorder->StartReplay( argv[ i + 1 ], headless, headless );
+            }
+        }
+    }
+
+
+
+    // run benchmark instead of game: -benchmark <result file> [-baseline <file>] [-filter <name start>]
+    // exit code is number of scenarios slower than in baseline
+    int exit_code = 0;
+    bool run_game = true;
+    {
+        Ogre::String benchmark_file = "";
+        Ogre::String baseline_file = "";
+        Ogre::String filter = "";
+        for( int i = 1; i < argc - 1; ++i )
+        {
+            if( Ogre::String( argv[ i ] ) == "-benchmark" )
+            {
+                benchmark_file = argv[ i + 1 ];
+            }
+            else if( Ogre::String( argv[ i ] ) == "-baseline" )
+            {
+                baseline_file = argv[ i + 1 ];
+            }
+            else if( Ogre::String( argv[ i ] ) == "-filter" )
+            {
+                filter = argv[ i + 1 ];
+            }
+        }
+
+        if( benchmark_file != "" )
+        {
+            exit_code = benchmark->Run( filter, benchmark_file, baseline_file );
+            run_game = false;
+        }
+    }
+
+
+
     // run application cycle
-    g_ApplicationState = QG_GAME;
-    root->startRendering();
+    if( run_game == true )
+    {
+        g_ApplicationState = QG_GAME;
+        root->startRendering();
+    }
 
 
 
@@ -131,13 +210,20 @@ main(int argc, char *argv[])
     delete script_manager;
     delete console;
     delete camera_manager;
+    delete frame_budget;
+    delete recorder;
     delete input_manager;
     delete debug_draw;
+    delete benchmark;
+    delete memory_tracker;
+    delete counters;
+    delete profiler;
     delete config_cmd_manager;
     delete config_var_manager;
     delete timer;
     delete root;
+    delete logger;
     delete log_manager;
 
-    return 0;
+    return exit_code;
 }
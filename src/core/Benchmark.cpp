@@ -0,0 +1,207 @@
+#include "Benchmark.h"
+#include "BenchmarkCommands.h"
+
+#include <OgreStringConverter.h>
+#include <algorithm>
+#include <fstream>
+
+#include "ConfigVar.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "Utilites.h"
+
+
+
+template<>Benchmark* Ogre::Singleton< Benchmark >::msSingleton = NULL;
+
+ConfigVarFloat cv_benchmark_time( "benchmark_time", "Seconds each benchmark scenario is measured", 1.0f );
+ConfigVarFloat cv_benchmark_regression( "benchmark_regression", "Percent of median time over baseline reported as regression", 10.0f );
+
+// scenario is run at least this number of times even if it is slow
+const unsigned int BENCHMARK_MIN_ITERATIONS = 5;
+const unsigned int BENCHMARK_MAX_ITERATIONS = 100000;
+
+
+
+Benchmark::Benchmark():
+    m_Running( false )
+{
+    InitCmd();
+}
+
+
+
+Benchmark::~Benchmark()
+{
+}
+
+
+
+void
+Benchmark::AddScenario( const Ogre::String& name, BenchmarkFunction setup, BenchmarkFunction run, BenchmarkFunction teardown, const int size )
+{
+    Scenario scenario;
+    scenario.name = name;
+    scenario.setup = setup;
+    scenario.run = run;
+    scenario.teardown = teardown;
+    scenario.size = size;
+    m_Scenarios.push_back( scenario );
+}
+
+
+
+unsigned int
+Benchmark::Run( const Ogre::String& filter, const Ogre::String& file_name, const Ogre::String& baseline_name )
+{
+    std::vector< BenchmarkResult > baseline;
+    if( baseline_name != "" && ReadResults( baseline_name, baseline ) == false )
+    {
+        LOG_ERROR( "Can't read benchmark baseline \"" + baseline_name + "\"." );
+        return 0;
+    }
+
+    std::ofstream file( file_name.c_str() );
+    if( file.is_open() == false )
+    {
+        LOG_ERROR( "Can't open benchmark result file \"" + file_name + "\"." );
+        return 0;
+    }
+    file << "name,size,iterations,min_us,median_us,mean_us\n";
+
+    unsigned int regressions = 0;
+    unsigned int number = 0;
+    for( unsigned int i = 0; i < m_Scenarios.size(); ++i )
+    {
+        if( m_Scenarios[ i ].name.compare( 0, filter.size(), filter ) != 0 )
+        {
+            continue;
+        }
+
+        BenchmarkResult result = RunScenario( i );
+        ++number;
+        file << result.name << "," << result.size << "," << result.iterations << "," << result.min << "," << result.median << "," << result.mean << "\n";
+
+        bool regression = false;
+        Ogre::String text = result.name + ": median " + Ogre::StringConverter::toString( result.median ) + " us, min " + Ogre::StringConverter::toString( result.min ) + " us, " + Ogre::StringConverter::toString( result.iterations ) + " iterations";
+
+        for( unsigned int j = 0; j < baseline.size(); ++j )
+        {
+            if( baseline[ j ].name == result.name && baseline[ j ].median > 0 )
+            {
+                float change = ( result.median - baseline[ j ].median ) * 100.0f / baseline[ j ].median;
+                text += ", baseline " + Ogre::StringConverter::toString( baseline[ j ].median ) + " us (" + ( ( change >= 0 ) ? "+" : "" ) + Ogre::StringConverter::toString( change, 1, 0, ' ', std::ios::fixed ) + "%)";
+                if( change > cv_benchmark_regression.Get() )
+                {
+                    text += " REGRESSION";
+                    regression = true;
+                    ++regressions;
+                }
+                break;
+            }
+        }
+
+        if( regression == true )
+        {
+            LOG_WARNING( text );
+        }
+        else
+        {
+            LOG_TRIVIAL( text );
+        }
+    }
+
+    LOG_TRIVIAL( "Benchmark finished: " + Ogre::StringConverter::toString( number ) + " scenarios, " + Ogre::StringConverter::toString( regressions ) + " regressions, results in \"" + file_name + "\"." );
+
+    return regressions;
+}
+
+
+
+bool
+Benchmark::IsRunning() const
+{
+    return m_Running;
+}
+
+
+
+BenchmarkResult
+Benchmark::RunScenario( const unsigned int scenario )
+{
+    const Scenario& s = m_Scenarios[ scenario ];
+
+    m_Running = true;
+
+    if( s.setup != NULL )
+    {
+        s.setup( s.size );
+    }
+
+    // first run warms caches and lazy initialisations
+    s.run( s.size );
+
+    std::vector< float > times;
+    unsigned long long limit = ( unsigned long long )( cv_benchmark_time.Get() * 1000000.0f );
+    unsigned long long total = 0;
+    while( ( total < limit || times.size() < BENCHMARK_MIN_ITERATIONS ) && times.size() < BENCHMARK_MAX_ITERATIONS )
+    {
+        unsigned long long start = Profiler::GetTime();
+        s.run( s.size );
+        unsigned long long time = Profiler::GetTime() - start;
+        times.push_back( ( float )time );
+        total += time;
+    }
+
+    if( s.teardown != NULL )
+    {
+        s.teardown( s.size );
+    }
+
+    m_Running = false;
+
+    std::sort( times.begin(), times.end() );
+
+    BenchmarkResult result;
+    result.name = s.name;
+    result.size = s.size;
+    result.iterations = times.size();
+    result.min = times[ 0 ];
+    result.median = times[ times.size() / 2 ];
+    result.mean = ( float )total / times.size();
+    return result;
+}
+
+
+
+bool
+Benchmark::ReadResults( const Ogre::String& file_name, std::vector< BenchmarkResult >& results ) const
+{
+    Ogre::String data;
+    if( ReadFileData( file_name, data ) == false )
+    {
+        return false;
+    }
+
+    Ogre::StringVector lines = Ogre::StringUtil::split( data, "\r\n" );
+    // first line is header
+    for( unsigned int i = 1; i < lines.size(); ++i )
+    {
+        Ogre::StringVector values = Ogre::StringUtil::split( lines[ i ], "," );
+        if( values.size() != 6 )
+        {
+            continue;
+        }
+
+        BenchmarkResult result;
+        result.name = values[ 0 ];
+        result.size = Ogre::StringConverter::parseInt( values[ 1 ] );
+        result.iterations = Ogre::StringConverter::parseUnsignedInt( values[ 2 ] );
+        result.min = Ogre::StringConverter::parseReal( values[ 3 ] );
+        result.median = Ogre::StringConverter::parseReal( values[ 4 ] );
+        result.mean = Ogre::StringConverter::parseReal( values[ 5 ] );
+        results.push_back( result );
+    }
+
+    return true;
+}
@@ -0,0 +1,65 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <OgreSingleton.h>
+#include <OgreString.h>
+#include <vector>
+
+
+
+// scenario function gets size of scenario (number of entities, coroutines, letters)
+typedef void ( *BenchmarkFunction )( const int size );
+
+
+
+struct BenchmarkResult
+{
+    Ogre::String name;
+    int size;
+    unsigned int iterations;
+    float min; // microseconds per iteration
+    float median;
+    float mean;
+};
+
+
+
+// Benchmark scenarios are registered by subsystems which own tested code.
+// Setup prepares state, run is measured many times and teardown restores
+// state of game. Results are written as csv, one scenario per line, and
+// compared with same file from other build by median time.
+class Benchmark : public Ogre::Singleton< Benchmark >
+{
+public:
+    Benchmark();
+    virtual ~Benchmark();
+
+    void AddScenario( const Ogre::String& name, BenchmarkFunction setup, BenchmarkFunction run, BenchmarkFunction teardown, const int size );
+
+    // runs scenarios which names start with filter, returns number of regressions against baseline
+    unsigned int Run( const Ogre::String& filter, const Ogre::String& file_name, const Ogre::String& baseline_name );
+
+    // true from setup to teardown of scenario
+    bool IsRunning() const;
+
+private:
+    void InitCmd();
+    BenchmarkResult RunScenario( const unsigned int scenario );
+    bool ReadResults( const Ogre::String& file_name, std::vector< BenchmarkResult >& results ) const;
+
+private:
+    struct Scenario
+    {
+        Ogre::String name;
+        BenchmarkFunction setup;
+        BenchmarkFunction run;
+        BenchmarkFunction teardown;
+        int size;
+    };
+    std::vector< Scenario > m_Scenarios;
+    bool m_Running;
+};
+
+
+
+#endif // BENCHMARK_H
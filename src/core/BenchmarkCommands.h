@@ -0,0 +1,27 @@
+#include "ConfigCmdManager.h"
+#include "Console.h"
+
+
+
+void
+CmdBenchmark( const Ogre::StringVector& params )
+{
+    if( params.size() > 4 )
+    {
+        Console::getSingleton().AddTextToOutput( "Usage: /benchmark [filter] [result file] [baseline file]" );
+        return;
+    }
+
+    Ogre::String filter = ( params.size() > 1 && params[ 1 ] != "all" ) ? params[ 1 ] : "";
+    Ogre::String file_name = ( params.size() > 2 ) ? params[ 2 ] : "benchmark.csv";
+    Ogre::String baseline_name = ( params.size() > 3 ) ? params[ 3 ] : "";
+    Benchmark::getSingleton().Run( filter, file_name, baseline_name );
+}
+
+
+
+void
+Benchmark::InitCmd()
+{
+    ConfigCmdManager::getSingleton().AddCommand( "benchmark", "Run benchmark scenarios which start with filter (all by default) and compare with baseline", "", CmdBenchmark, NULL );
+}
@@ -8,7 +8,7 @@
 
 
 
-class CameraManager : public Ogre::Singleton< CameraManager >
+class CameraManager : public Ogre::Singleton< CameraManager >, public InputListener
 {
 public:
     CameraManager();
@@ -1,6 +1,8 @@
 #include "ConfigCmdManager.h"
 #include "ConfigCmdManagerCommands.h"
 
+#include <algorithm>
+
 #include "Assert.h"
 
 
@@ -9,6 +11,27 @@ template<>ConfigCmdManager *Ogre::Singleton< ConfigCmdManager >::msSingleton = N
 
 
 
+// compares both commands and command with name, so it can be used for sort and lower_bound
+struct ConfigCmdLess
+{
+    bool operator()( const ConfigCmd* a, const ConfigCmd* b ) const
+    {
+        return a->GetName() < b->GetName();
+    }
+
+    bool operator()( const ConfigCmd* a, const Ogre::String& name ) const
+    {
+        return a->GetName() < name;
+    }
+
+    bool operator()( const Ogre::String& name, const ConfigCmd* b ) const
+    {
+        return name < b->GetName();
+    }
+};
+
+
+
 ConfigCmdManager::ConfigCmdManager()
 {
     InitCmd();
@@ -33,12 +56,11 @@ ConfigCmdManager::AddCommand( const Ogre::String& name, const Ogre::String& desc
     QGEARS_ASSERT( handler, "Null command handler." );
 
     // see if command already added
-    for( unsigned int i = 0; i < m_Commands.size(); ++i )
-    {
-        QGEARS_ASSERT( m_Commands[ i ]->GetName() != name, "Command already exist." );
-    }
+    QGEARS_ASSERT( m_CommandIndex.find( name ) == m_CommandIndex.end(), "Command already exist." );
 
-    m_Commands.push_back( new ConfigCmd( name, description, params_description, handler, completion ) );
+    ConfigCmd* cmd = new ConfigCmd( name, description, params_description, handler, completion );
+    m_Commands.insert( std::lower_bound( m_Commands.begin(), m_Commands.end(), name, ConfigCmdLess() ), cmd );
+    m_CommandIndex[ name ] = cmd;
 }
 
 
@@ -46,12 +68,10 @@ ConfigCmdManager::AddCommand( const Ogre::String& name, const Ogre::String& desc
 ConfigCmd*
 ConfigCmdManager::Find( const Ogre::String& name ) const
 {
-    for( unsigned int i = 0; i < m_Commands.size(); ++i )
+    boost::unordered_map< Ogre::String, ConfigCmd* >::const_iterator it = m_CommandIndex.find( name );
+    if( it != m_CommandIndex.end() )
     {
-        if( m_Commands[ i ]->GetName() == name )
-        {
-            return m_Commands[ i ];
-        }
+        return it->second;
     }
 
     return NULL;
@@ -77,3 +97,16 @@ ConfigCmdManager::GetConfigCmd( unsigned int i ) const
 
     return NULL;
 }
+
+
+
+void
+ConfigCmdManager::Complete( const Ogre::String& prefix, Ogre::StringVector& names ) const
+{
+    // all names with prefix follow each other in sorted list
+    std::vector< ConfigCmd* >::const_iterator it = std::lower_bound( m_Commands.begin(), m_Commands.end(), prefix, ConfigCmdLess() );
+    for( ; it != m_Commands.end() && ( *it )->GetName().compare( 0, prefix.size(), prefix ) == 0; ++it )
+    {
+        names.push_back( ( *it )->GetName() );
+    }
+}
@@ -2,6 +2,7 @@
 #define CONFIG_CMD_MANAGER_H
 
 #include <OgreSingleton.h>
+#include <boost/unordered_map.hpp>
 #include <vector>
 
 #include "ConfigCmd.h"
@@ -21,6 +22,9 @@ public:
     int GetConfigCmdNumber();
     ConfigCmd* GetConfigCmd( unsigned int i ) const;
 
+    // names of commands which start with prefix in alphabetical order
+    void Complete( const Ogre::String& prefix, Ogre::StringVector& names ) const;
+
 private:
     // forbid copy
     ConfigCmdManager( const ConfigCmdManager& rhs );
@@ -28,7 +32,8 @@ private:
 
     void InitCmd();
 
-    std::vector< ConfigCmd* > m_Commands;
+    std::vector< ConfigCmd* > m_Commands; // sorted by name
+    boost::unordered_map< Ogre::String, ConfigCmd* > m_CommandIndex;
 };
 
 
@@ -250,7 +250,9 @@ CmdSetLogLevel( const Ogre::StringVector& params )
     int value = Ogre::StringConverter::parseInt( params[ 1 ] );
     if( value > 0 && value < 4 )
     {
+        // ogre filters its own messages, logger filters ours before they are formatted
         Ogre::LogManager::getSingletonPtr()->getDefaultLog()->setLogDetail( ( Ogre::LoggingLevel )value );
+        Logger::getSingleton().SetLevel( value );
 
         switch( value )
         {
@@ -1,8 +1,10 @@
 #include "ConfigVar.h"
 
 #include <OgreStringConverter.h>
+#include <algorithm>
 
 #include "Assert.h"
+#include "Logger.h"
 
 
 
@@ -10,10 +12,12 @@ ConfigVar* ConfigVar::m_StaticConfigVarList = 0;
 
 
 
-ConfigVar::ConfigVar(const Ogre::String& name, const Ogre::String& description, const Ogre::String& default_value):
+ConfigVar::ConfigVar(const Ogre::String& name, const Ogre::String& description, const Ogre::String& default_value, const Type type):
     m_Name(name),
     m_Description(description),
     m_DefaultValue(default_value),
+    m_Type(type),
+    m_WrongTypeReported(false),
     m_ValueS(default_value)
 {
     QGEARS_ASSERT(name != "", "m_Name of ConfigVar can`t be empty!");
@@ -35,43 +39,10 @@ ConfigVar::ConfigVar(const Ogre::String& name, const Ogre::String& description,
 
 
 
-int
-ConfigVar::GetI() const
-{
-    return m_ValueI;
-}
-
-
-
-float
-ConfigVar::GetF() const
-{
-    return m_ValueF;
-}
-
-
-
-bool
-ConfigVar::GetB() const
-{
-    return m_ValueB;
-}
-
-
-
-Ogre::String
-ConfigVar::GetS() const
-{
-    return m_ValueS;
-}
-
-
-
 void
 ConfigVar::SetI(int value)
 {
-    m_ValueS = Ogre::StringConverter::toString(value);
-    UpdateVariables();
+    SetS(Ogre::StringConverter::toString(value));
 }
 
 
@@ -79,8 +50,7 @@ ConfigVar::SetI(int value)
 void
 ConfigVar::SetF(float value)
 {
-    m_ValueS = Ogre::StringConverter::toString(value);
-    UpdateVariables();
+    SetS(Ogre::StringConverter::toString(value));
 }
 
 
@@ -88,8 +58,7 @@ ConfigVar::SetF(float value)
 void
 ConfigVar::SetB(bool value)
 {
-    m_ValueS = Ogre::StringConverter::toString(value);
-    UpdateVariables();
+    SetS(Ogre::StringConverter::toString(value));
 }
 
 
@@ -97,8 +66,21 @@ ConfigVar::SetB(bool value)
 void
 ConfigVar::SetS(const Ogre::String& value)
 {
+    // setting same value doesn't parse it again and doesn't notify anyone
+    if (value == m_ValueS)
+    {
+        return;
+    }
+
     m_ValueS = value;
     UpdateVariables();
+
+    // copy so callback can remove itself
+    std::vector<ConfigVarCallback> callbacks = m_Callbacks;
+    for (size_t i = 0; i < callbacks.size(); ++i)
+    {
+        callbacks[i](*this);
+    }
 }
 
 
@@ -134,3 +116,38 @@ ConfigVar::UpdateVariables()
     m_ValueF = Ogre::StringConverter::parseReal(m_ValueS);
     m_ValueB = Ogre::StringConverter::parseBool(m_ValueS);
 }
+
+
+
+void
+ConfigVar::WrongType(const Type type) const
+{
+    // not assert, console commands like /increment read any cvar
+    if (m_WrongTypeReported == false)
+    {
+        const char* type_name[] = { "string", "int", "float", "bool" };
+        LOG_WARNING("Config variable \"" + m_Name + "\" of type " + type_name[m_Type] + " read as " + type_name[type] + ".");
+        m_WrongTypeReported = true;
+    }
+}
+
+
+
+void
+ConfigVar::AddCallback(ConfigVarCallback callback)
+{
+    QGEARS_ASSERT(callback, "Null cvar callback.");
+
+    if (std::find(m_Callbacks.begin(), m_Callbacks.end(), callback) == m_Callbacks.end())
+    {
+        m_Callbacks.push_back(callback);
+    }
+}
+
+
+
+void
+ConfigVar::RemoveCallback(ConfigVarCallback callback)
+{
+    m_Callbacks.erase(std::remove(m_Callbacks.begin(), m_Callbacks.end(), callback), m_Callbacks.end());
+}
@@ -2,10 +2,16 @@
 #define CONFIG_VAR_H
 
 #include <OgreString.h>
+#include <OgreStringConverter.h>
+#include <vector>
 
 
 
 class ConfigVarManager;
+class ConfigVar;
+
+// called after value of cvar was changed
+typedef void (*ConfigVarCallback)(ConfigVar& cvar);
 
 
 
@@ -14,12 +20,24 @@ class ConfigVar
     friend class ConfigVarManager;
 
 public:
-                        ConfigVar(const Ogre::String& name, const Ogre::String& description, const Ogre::String& default_value);
-
-    int                 GetI() const;
-    float               GetF() const;
-    bool                GetB() const;
-    Ogre::String        GetS() const;
+    // type in which cvar is declared, string cvar can be read as any type
+    enum Type
+    {
+        TYPE_STRING,
+        TYPE_INT,
+        TYPE_FLOAT,
+        TYPE_BOOL
+    };
+
+                        ConfigVar(const Ogre::String& name, const Ogre::String& description, const Ogre::String& default_value, const Type type = TYPE_STRING);
+
+    // values are parsed once when cvar is set, getters only return them.
+    // Typed cvar read as other type is reported, int can be read as float.
+    int                 GetI() const { CheckType(TYPE_INT); return m_ValueI; }
+    float               GetF() const { CheckType(TYPE_FLOAT); return m_ValueF; }
+    bool                GetB() const { CheckType(TYPE_BOOL); return m_ValueB; }
+    const Ogre::String& GetS() const { return m_ValueS; }
+    Type                GetType() const { return m_Type; }
 
     void                SetI(int value);
     void                SetF(float value);
@@ -32,23 +50,78 @@ public:
 
     void                UpdateVariables();
 
+    // subsystems cache value of cvar and update it in callback instead of
+    // reading cvar every frame
+    void                AddCallback(ConfigVarCallback callback);
+    void                RemoveCallback(ConfigVarCallback callback);
+
 private:
     // forbid copy
     ConfigVar(const ConfigVar&);
     ConfigVar&operator=(const ConfigVar&);
 
+    void                CheckType(const Type type) const
+                        {
+                            if (m_Type != TYPE_STRING && m_Type != type && (m_Type != TYPE_INT || type != TYPE_FLOAT))
+                            {
+                                WrongType(type);
+                            }
+                        }
+    void                WrongType(const Type type) const;
+
     Ogre::String    m_Name;
     Ogre::String    m_Description;
     Ogre::String    m_DefaultValue;
+    Type            m_Type;
+    mutable bool    m_WrongTypeReported; // wrong read is logged once
     int             m_ValueI;
     float           m_ValueF;
     bool            m_ValueB;
     Ogre::String    m_ValueS;
 
+    std::vector<ConfigVarCallback> m_Callbacks;
+
     ConfigVar*          m_Previous;
     static ConfigVar*   m_StaticConfigVarList;
 };
 
 
 
+template<typename T> struct ConfigVarTypeOf;
+template<> struct ConfigVarTypeOf<int>   { static const ConfigVar::Type type = ConfigVar::TYPE_INT; };
+template<> struct ConfigVarTypeOf<float> { static const ConfigVar::Type type = ConfigVar::TYPE_FLOAT; };
+template<> struct ConfigVarTypeOf<bool>  { static const ConfigVar::Type type = ConfigVar::TYPE_BOOL; };
+
+
+
+// cvar of one type, declared as ConfigVarTyped<float> cv_name("name", "description", 1.0f)
+template<typename T>
+class ConfigVarTyped : public ConfigVar
+{
+public:
+                        ConfigVarTyped(const Ogre::String& name, const Ogre::String& description, const T default_value):
+                            ConfigVar(name, description, Ogre::StringConverter::toString(default_value), ConfigVarTypeOf<T>::type)
+                        {
+                        }
+
+    T                   Get() const;
+    void                Set(const T value);
+};
+
+
+
+template<> inline int   ConfigVarTyped<int>::Get() const { return GetI(); }
+template<> inline float ConfigVarTyped<float>::Get() const { return GetF(); }
+template<> inline bool  ConfigVarTyped<bool>::Get() const { return GetB(); }
+
+template<> inline void  ConfigVarTyped<int>::Set(const int value) { SetI(value); }
+template<> inline void  ConfigVarTyped<float>::Set(const float value) { SetF(value); }
+template<> inline void  ConfigVarTyped<bool>::Set(const bool value) { SetB(value); }
+
+typedef ConfigVarTyped<int>   ConfigVarInt;
+typedef ConfigVarTyped<float> ConfigVarFloat;
+typedef ConfigVarTyped<bool>  ConfigVarBool;
+
+
+
 #endif // CONFIG_VAR_H
@@ -1,22 +1,51 @@
 #include "ConfigVarManager.h"
 
+#include <algorithm>
+
+#include "Assert.h"
+
 
 
 template<>ConfigVarManager *Ogre::Singleton< ConfigVarManager >::msSingleton = NULL;
 
 
 
+// compares both cvars and cvar with name, so it can be used for sort and lower_bound
+struct ConfigVarLess
+{
+    bool operator()( const ConfigVar* a, const ConfigVar* b ) const
+    {
+        return a->GetName() < b->GetName();
+    }
+
+    bool operator()( const ConfigVar* a, const Ogre::String& name ) const
+    {
+        return a->GetName() < name;
+    }
+
+    bool operator()( const Ogre::String& name, const ConfigVar* b ) const
+    {
+        return name < b->GetName();
+    }
+};
+
+
+
 ConfigVarManager::ConfigVarManager()
 {
     if( ConfigVar::m_StaticConfigVarList != ( ConfigVar* )0xffffffff )
     {
         for( ConfigVar* cvar = ConfigVar::m_StaticConfigVarList; cvar; cvar = cvar->m_Previous )
         {
+            QGEARS_ASSERT( m_ConfigVarIndex.find( cvar->GetName() ) == m_ConfigVarIndex.end(), "ConfigVar already exist." );
             m_ConfigVars.push_back( cvar );
+            m_ConfigVarIndex[ cvar->GetName() ] = cvar;
         }
 
         ConfigVar::m_StaticConfigVarList = ( ConfigVar* )0xffffffff;
     }
+
+    std::sort( m_ConfigVars.begin(), m_ConfigVars.end(), ConfigVarLess() );
 }
 
 
@@ -24,12 +53,10 @@ ConfigVarManager::ConfigVarManager()
 ConfigVar*
 ConfigVarManager::Find( const Ogre::String& name ) const
 {
-    for( size_t i = 0; i < m_ConfigVars.size(); ++i )
+    boost::unordered_map< Ogre::String, ConfigVar* >::const_iterator it = m_ConfigVarIndex.find( name );
+    if( it != m_ConfigVarIndex.end() )
     {
-        if( m_ConfigVars[ i ]->GetName() == name )
-        {
-            return m_ConfigVars[ i ];
-        }
+        return it->second;
     }
 
     return NULL;
@@ -55,3 +82,16 @@ ConfigVarManager::GetConfigVar( const unsigned int i ) const
 
     return NULL;
 }
+
+
+
+void
+ConfigVarManager::Complete( const Ogre::String& prefix, Ogre::StringVector& names ) const
+{
+    // all names with prefix follow each other in sorted list
+    std::vector< ConfigVar* >::const_iterator it = std::lower_bound( m_ConfigVars.begin(), m_ConfigVars.end(), prefix, ConfigVarLess() );
+    for( ; it != m_ConfigVars.end() && ( *it )->GetName().compare( 0, prefix.size(), prefix ) == 0; ++it )
+    {
+        names.push_back( ( *it )->GetName() );
+    }
+}
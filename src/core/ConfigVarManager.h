@@ -2,6 +2,7 @@
 #define CONFIG_VAR_MANAGER_H
 
 #include <OgreSingleton.h>
+#include <boost/unordered_map.hpp>
 #include <vector>
 
 #include "ConfigVar.h"
@@ -17,8 +18,12 @@ public:
     unsigned int GetConfigVarNumber() const;
     ConfigVar*   GetConfigVar( const unsigned int i ) const;
 
+    // names of cvars which start with prefix in alphabetical order
+    void         Complete( const Ogre::String& prefix, Ogre::StringVector& names ) const;
+
 private:
-    std::vector< ConfigVar* > m_ConfigVars;
+    std::vector< ConfigVar* > m_ConfigVars; // sorted by name
+    boost::unordered_map< Ogre::String, ConfigVar* > m_ConfigVarIndex;
 };
 
 
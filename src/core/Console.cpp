@@ -6,6 +6,8 @@
 #include "ConfigVarManager.h"
 #include "DebugDraw.h"
 #include "Logger.h"
+#include "Profiler.h"
+#include "Recorder.h"
 #include "ScriptManager.h"
 #include "Timer.h"
 #include "Utilites.h"
@@ -25,7 +27,10 @@ Console::Console():
     m_Visible( false ),
     m_Height( 0 ),
 
-    m_MaxOutputLine( 128 ),
+    m_OutputTextStart( 0 ),
+    m_OutputTextNumber( 0 ),
+    m_OutputLineStart( 0 ),
+    m_OutputLineNumber( 0 ),
     m_DisplayLine( 0 ),
     m_InputLine( "" ),
     m_CursorPosition( 0 ),
@@ -34,7 +39,9 @@ Console::Console():
     m_HistoryLineCycleIndex( -1 ),
     m_HistoryMaxSize( 32 ),
 
-    m_AutoCompletitionLine( 0 )
+    m_AutoCompletitionLine( 0 ),
+
+    m_ThreadId( boost::this_thread::get_id() )
 {
     Ogre::FontPtr font = Ogre::FontManager::getSingletonPtr()->getByName( "CourierNew" );
     if( font.isNull() == false )
@@ -50,11 +57,12 @@ Console::Console():
     m_ConsoleWidth = Ogre::Root::getSingleton().getRenderTarget( "QGearsWindow" )->getWidth();
     m_ConsoleHeight = Ogre::Root::getSingleton().getRenderTarget( "QGearsWindow" )->getHeight() / 2.5f;
     m_LineWidth = ( m_ConsoleWidth - 20 ) / 8;
+    m_WrapWidth = m_LineWidth;
 
-    LOG_TRIVIAL( "Created console width " + Ogre::StringConverter::toString( m_ConsoleWidth ) + ", height " + Ogre::StringConverter::toString( m_ConsoleHeight ) );
+    m_OutputText.resize( 256 );
+    m_OutputLine.resize( 512 );
 
-    // add as frame and log listener
-    Ogre::LogManager::getSingleton().getDefaultLog()->addListener( this );
+    LOG_TRIVIAL( "Created console width " + Ogre::StringConverter::toString( m_ConsoleWidth ) + ", height " + Ogre::StringConverter::toString( m_ConsoleHeight ) );
 
     LoadHistory();
 }
@@ -63,9 +71,6 @@ Console::Console():
 
 Console::~Console()
 {
-    // remove as listener
-    Ogre::LogManager::getSingleton().getDefaultLog()->removeListener( this );
-
     SaveHistory();
 }
 
@@ -95,6 +100,7 @@ Console::Input( const Event& event )
 
         AddTextToOutput( m_InputLine );
         AddInputToHistory();
+        Recorder::getSingleton().RecordCommand( m_InputLine );
 
         // backslashed text are console commands, otherwise - script commands
         if( '\\' == m_InputLine[ 0 ] || '/' == m_InputLine[ 0 ] )
@@ -154,7 +160,7 @@ Console::Input( const Event& event )
     // scroll display to next row
     else if( event.type == ET_MOUSE_SCROLL && event.param1 < 0 )
     {
-        if( m_DisplayLine < m_OutputLine.size() )
+        if( m_DisplayLine < m_OutputLineNumber )
         {
             m_DisplayLine += 1;
         }
@@ -171,7 +177,7 @@ Console::Input( const Event& event )
     // scroll display to next row
     else if( ( event.type == ET_PRESS || event.type == ET_REPEAT_WAIT ) && event.button == OIS::KC_PGDOWN )
     {
-        if( m_DisplayLine < m_OutputLine.size() )
+        if( m_DisplayLine < m_OutputLineNumber )
         {
             m_DisplayLine += 1;
         }
@@ -287,6 +293,35 @@ Console::Input( const Event& event )
 void
 Console::Update()
 {
+    PROFILE_ZONE( "Console::Update" );
+
+    OutputLines pending;
+    {
+        boost::mutex::scoped_lock lock( m_PendingOutputMutex );
+        pending.swap( m_PendingOutput );
+    }
+    // texts which don't fit in ring would be overwritten anyway
+    unsigned int first = ( pending.size() > m_OutputText.size() ) ? pending.size() - m_OutputText.size() : 0;
+    for( unsigned int i = first; i < pending.size(); ++i )
+    {
+        AddTextToOutput( pending[ i ].text, pending[ i ].colour );
+    }
+
+    // log lines written by logger since last update
+    std::vector< LogLine > log;
+    Logger::getSingleton().GetConsoleLines( log );
+    first = ( log.size() > m_OutputText.size() ) ? log.size() - m_OutputText.size() : 0;
+    for( unsigned int i = first; i < log.size(); ++i )
+    {
+        Ogre::ColourValue colour = Ogre::ColourValue::White;
+        switch( log[ i ].level )
+        {
+            case LOG_LEVEL_WARNING: colour = Ogre::ColourValue( 1, 1, 0, 1 ); break;
+            case LOG_LEVEL_ERROR: colour = Ogre::ColourValue( 1, 0, 0, 1 ); break;
+        }
+        AddTextToOutput( log[ i ].text, colour );
+    }
+
     float delta_time = Timer::getSingleton().GetSystemTimeDelta();
 
     if( m_ToVisible == true && m_Height < m_ConsoleHeight )
@@ -335,35 +370,29 @@ Console::UpdateDraw()
     DEBUG_DRAW.SetZ( -0.6f );
     DEBUG_DRAW.Line( 0, m_Height, m_ConsoleWidth, m_Height );
 
-    int row = 1;
+    UpdateWrap();
+
+    // draw only lines in visible window
     int rows = ( m_ConsoleHeight - 30 ) / 16;
     int y = -m_ConsoleHeight + m_Height;
-    int empty = rows - m_DisplayLine;
-    if( empty > 0 )
+    int first = ( int )m_DisplayLine - rows;
+    if( first < 0 )
     {
-        y += empty * 16;
+        y += -first * 16;
+        first = 0;
     }
 
-    std::list< OutputLine >::iterator i;
-    for( i = m_OutputLine.begin(); i != m_OutputLine.end(); ++i, ++row )
+    for( unsigned int i = first; i < m_DisplayLine; ++i )
     {
-        if( row > ( int )m_DisplayLine - rows && row <= ( int )m_DisplayLine )
-        {
-
-            DEBUG_DRAW.SetColour( ( *i ).colour );
-            DEBUG_DRAW.Text( 5, y, ( *i ).text );
-            y += 16;
-        }
+        const OutputLine& line = GetOutputLine( i );
+        DEBUG_DRAW.SetColour( line.colour );
+        DEBUG_DRAW.Text( 5, y, line.text );
+        y += 16;
     }
-    if( m_DisplayLine != m_OutputLine.size() )
+    if( m_DisplayLine != m_OutputLineNumber )
     {
-        Ogre::String temp = "";
-        for( unsigned int i = 0; i < m_LineWidth; ++i )
-        {
-            temp += "^";
-        }
         DEBUG_DRAW.SetColour( Ogre::ColourValue( 1, 0, 0, 1 ) );
-        DEBUG_DRAW.Text( 5, y, temp );
+        DEBUG_DRAW.Text( 5, y, Ogre::String( m_LineWidth, '^' ) );
     }
 
 
@@ -401,20 +430,22 @@ Console::UpdateNotification()
     DEBUG_DRAW.SetScreenSpace( true );
     DEBUG_DRAW.SetZ( -0.6f );
 
-    std::list< OutputLine >::reverse_iterator i;
-    int y = ( m_OutputLine.size() > 10 ) ? 160 : m_OutputLine.size() * 16;
+    UpdateWrap();
+
+    int y = ( m_OutputLineNumber > 10 ) ? 160 : m_OutputLineNumber * 16;
     int line = 0;
     float max_time = 3.0f;
 
-    for( i = m_OutputLine.rbegin(); i != m_OutputLine.rend() && line < 10; ++i )
+    for( unsigned int i = m_OutputLineNumber; i > 0 && line < 10; --i )
     {
-        float time = Timer::getSingleton().GetSystemTimeTotal() - ( *i ).time;
+        const OutputLine& output = GetOutputLine( i - 1 );
+        float time = Timer::getSingleton().GetSystemTimeTotal() - output.time;
         if( time < max_time )
         {
-            Ogre::ColourValue colour = ( *i ).colour;
+            Ogre::ColourValue colour = output.colour;
             colour.a = ( max_time - time ) / max_time;
             DEBUG_DRAW.SetColour( colour );
-            DEBUG_DRAW.Text( 5, y, ( *i ).text );
+            DEBUG_DRAW.Text( 5, y, output.text );
             y -= 16;
             ++line;
         }
@@ -429,6 +460,7 @@ Console::OnResize()
     // calculate width and height of console depending on size of application
     m_ConsoleWidth = Ogre::Root::getSingleton().getRenderTarget( "QGearsWindow" )->getWidth();
     m_ConsoleHeight = Ogre::Root::getSingleton().getRenderTarget( "QGearsWindow" )->getHeight() / 2.5f;
+    // output is wrapped to new width when it is drawn next time
     m_LineWidth = ( m_ConsoleWidth - 20 ) / 8;
 
     LOG_TRIVIAL( "Resized console width to " + Ogre::StringConverter::toString( m_ConsoleWidth ) + ", height to " + Ogre::StringConverter::toString( m_ConsoleHeight ) );
@@ -466,14 +498,51 @@ Console::IsVisible() const
 
 void
 Console::AddTextToOutput( const Ogre::String& text, const Ogre::ColourValue& colour )
+{
+    if( boost::this_thread::get_id() != m_ThreadId )
+    {
+        boost::mutex::scoped_lock lock( m_PendingOutputMutex );
+        OutputLine line;
+        line.text = text;
+        line.colour = colour;
+        line.time = 0;
+        m_PendingOutput.push_back( line );
+        return;
+    }
+
+    OutputLine& output = m_OutputText[ ( m_OutputTextStart + m_OutputTextNumber ) % m_OutputText.size() ];
+    if( m_OutputTextNumber < m_OutputText.size() )
+    {
+        ++m_OutputTextNumber;
+    }
+    else
+    {
+        m_OutputTextStart = ( m_OutputTextStart + 1 ) % m_OutputText.size();
+    }
+    output.text = text;
+    output.colour = colour;
+    output.time = Timer::getSingleton().GetSystemTimeTotal();
+
+    // if width was changed all texts will be wrapped later
+    if( m_WrapWidth == m_LineWidth )
+    {
+        WrapText( output );
+    }
+}
+
+
+
+void
+Console::WrapText( const OutputLine& text )
 {
     // go through line and add it to output correctly
-    const char* str = text.c_str();
+    const char* str = text.text.c_str();
+    size_t size = text.text.size();
     Ogre::String output_line;
     unsigned int string_size = 0;
     bool indent = false;
     unsigned int c = 0;
-    for( ; c < text.size(); ++c )
+    for( ; c < size; ++c )
     {
         // add space at start of string if we want indent
         if( string_size == 0 && indent == true )
@@ -488,26 +557,12 @@ Console::AddTextToOutput( const Ogre::String& text, const Ogre::ColourValue& col
             ++string_size;
         }
 
-        if( str[ c ] == '\n' || string_size >= m_LineWidth || c >= text.size() - 1 )
+        if( str[ c ] == '\n' || string_size >= m_WrapWidth || c >= size - 1 )
         {
             // if string is larger than output size than add indent
-            indent = ( string_size >= m_LineWidth ) ? true : false;
+            indent = ( string_size >= m_WrapWidth ) ? true : false;
 
-            if( m_OutputLine.size() >= m_MaxOutputLine )
-            {
-                m_OutputLine.pop_front();
-            }
-
-            if( m_OutputLine.size() == m_DisplayLine )
-            {
-                ++m_DisplayLine;
-            }
-
-            OutputLine line;
-            line.text = output_line;
-            line.colour = colour;
-            line.time = Timer::getSingleton().GetSystemTimeTotal();
-            m_OutputLine.push_back( line );
+            AddOutputLine( output_line, text.colour, text.time );
 
             output_line.clear();
             string_size = 0;
@@ -515,23 +570,62 @@ Console::AddTextToOutput( const Ogre::String& text, const Ogre::ColourValue& col
     }
 
     // add one more string if text ended with \n
-    if( text.size() == 0 || str[ text.size() - 1 ] == '\n' )
+    if( size == 0 || str[ size - 1 ] == '\n' )
     {
-        if( m_OutputLine.size() >= m_MaxOutputLine )
-        {
-            m_OutputLine.pop_front();
-        }
+        AddOutputLine( "", text.colour, text.time );
+    }
+}
 
-        if( m_OutputLine.size() == m_DisplayLine )
+
+
+void
+Console::AddOutputLine( const Ogre::String& text, const Ogre::ColourValue& colour, const float time )
+{
+    // when ring is full oldest line is overwritten and display line stays on same position
+    if( m_OutputLineNumber < m_OutputLine.size() )
+    {
+        if( m_OutputLineNumber == m_DisplayLine )
         {
             ++m_DisplayLine;
         }
+        ++m_OutputLineNumber;
+    }
+    else
+    {
+        m_OutputLineStart = ( m_OutputLineStart + 1 ) % m_OutputLine.size();
+    }
 
-        OutputLine line;
-        line.text = "";
-        line.colour = colour;
-        line.time = Timer::getSingleton().GetSystemTimeTotal();
-        m_OutputLine.push_back( line );
+    OutputLine& line = m_OutputLine[ ( m_OutputLineStart + m_OutputLineNumber - 1 ) % m_OutputLine.size() ];
+    line.text = text;
+    line.colour = colour;
+    line.time = time;
+}
+
+
+
+const Console::OutputLine&
+Console::GetOutputLine( const unsigned int line ) const
+{
+    return m_OutputLine[ ( m_OutputLineStart + line ) % m_OutputLine.size() ];
+}
+
+
+
+void
+Console::UpdateWrap()
+{
+    if( m_WrapWidth == m_LineWidth )
+    {
+        return;
+    }
+
+    m_WrapWidth = m_LineWidth;
+    m_OutputLineStart = 0;
+    m_OutputLineNumber = 0;
+    m_DisplayLine = 0;
+    for( unsigned int i = 0; i < m_OutputTextNumber; ++i )
+    {
+        WrapText( m_OutputText[ ( m_OutputTextStart + i ) % m_OutputText.size() ] );
     }
 }
 
@@ -610,19 +704,9 @@ Console::CompleteInput()
 
         if( params.size() == 0 )
         {
-            // add cvars
-            int num_vars = ConfigVarManager::getSingleton().GetConfigVarNumber();
-            for( int i = 0; i < num_vars; ++i )
-            {
-                m_AutoCompletition.push_back( ConfigVarManager::getSingleton().GetConfigVar( i )->GetName() );
-            }
-
-            // add commands
-            int num_cmds = ConfigCmdManager::getSingleton().GetConfigCmdNumber();
-            for( int i = 0; i < num_cmds; ++i )
-            {
-                m_AutoCompletition.push_back( ConfigCmdManager::getSingleton().GetConfigCmd( i )->GetName() );
-            }
+            // add cvars and commands
+            ConfigVarManager::getSingleton().Complete( "", m_AutoCompletition );
+            ConfigCmdManager::getSingleton().Complete( "", m_AutoCompletition );
 
             add_slash = true;
         }
@@ -631,43 +715,38 @@ Console::CompleteInput()
             m_InputLine = params[ 0 ];
 
             // add cvars
-            int num_vars = ConfigVarManager::getSingleton().GetConfigVarNumber();
-            for( int i = 0; i < num_vars; ++i )
+            Ogre::StringVector names;
+            ConfigVarManager::getSingleton().Complete( m_InputLine, names );
+            for( size_t i = 0; i < names.size(); ++i )
             {
-                Ogre::String name = ConfigVarManager::getSingleton().GetConfigVar( i )->GetName();
-                unsigned int pos = name.find( m_InputLine );
-                if( pos == 0 )
-                {
-                    add_slash = true;
+                add_slash = true;
 
-                    if( input_size != name.size() )
-                    {
-                        Ogre::String part = name.substr( input_size, name.size() - input_size );
-                        m_AutoCompletition.push_back( part );
-                    }
+                if( input_size != names[ i ].size() )
+                {
+                    Ogre::String part = names[ i ].substr( input_size, names[ i ].size() - input_size );
+                    m_AutoCompletition.push_back( part );
                 }
             }
 
             // add commands
-            int num_cmds = ConfigCmdManager::getSingleton().GetConfigCmdNumber();
-            for( int i = 0; i < num_cmds; ++i )
+            names.clear();
+            ConfigCmdManager::getSingleton().Complete( m_InputLine, names );
+            for( size_t i = 0; i < names.size(); ++i )
             {
-                Ogre::String name = ConfigCmdManager::getSingleton().GetConfigCmd( i )->GetName();
+                add_slash = true;
 
-                int pos = name.find( m_InputLine );
-                if( pos == 0 )
+                if( names[ i ] != params[ 0 ] )
                 {
-                    add_slash = true;
-
-                    if( name != params[ 0 ] )
-                    {
-                        Ogre::String part = name.substr( input_size, name.size() - input_size );
-                        m_AutoCompletition.push_back( part );
-                    }
-                    else if( ConfigCmdManager::getSingleton().GetConfigCmd( i )->GetCompletion() != NULL )
+                    Ogre::String part = names[ i ].substr( input_size, names[ i ].size() - input_size );
+                    m_AutoCompletition.push_back( part );
+                }
+                else
+                {
+                    ConfigCmd* cmd = ConfigCmdManager::getSingleton().Find( names[ i ] );
+                    if( cmd->GetCompletion() != NULL )
                     {
                         m_InputLine += " ";
-                        ConfigCmdManager::getSingleton().GetConfigCmd( i )->GetCompletion()( m_AutoCompletition );
+                        cmd->GetCompletion()( m_AutoCompletition );
                     }
                 }
             }
@@ -773,7 +852,7 @@ Console::SetInputLineFromHistory()
 {
     ResetAutoCompletion();
 
-    std::list< Ogre::String >::iterator i = m_History.begin();
+    HistoryLines::iterator i = m_History.begin();
     for( int count = 0; i != m_History.end(); ++i, ++count )
     {
         if( count == m_HistoryLineCycleIndex )
@@ -787,20 +866,6 @@ Console::SetInputLineFromHistory()
 
 
 
-void
-Console::messageLogged( const Ogre::String& message, Ogre::LogMessageLevel lml, bool maskDebug, const Ogre::String& logName, bool& skipThisMessage )
-{
-    Ogre::ColourValue colour = Ogre::ColourValue::White;
-    switch( ( int )lml )
-    {
-        case 2: colour = Ogre::ColourValue( 1, 1, 0, 1 ); break;
-        case 3: colour = Ogre::ColourValue( 1, 0, 0, 1 ); break;
-    }
-    AddTextToOutput( message, colour );
-};
-
-
-
 void
 Console::LoadHistory()
 {
@@ -824,7 +889,7 @@ Console::SaveHistory()
         LOG_ERROR( "Failed to open console history file for writing" );
         return;
     }
-    std::list< Ogre::String >::iterator i = m_History.begin();
+    HistoryLines::iterator i = m_History.begin();
     for( ; i != m_History.end(); ++i )
     {
         file << *i << "\r\n";
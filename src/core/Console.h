@@ -2,18 +2,19 @@
 #define CONSOLE_H
 
 #include <OgreColourValue.h>
-#include <OgreLog.h>
 #include <OgreSingleton.h>
 #include <OgreStringVector.h>
 #include <OIS.h>
+#include <boost/thread.hpp>
 #include <list>
 #include <vector>
 
 #include "Event.h"
+#include "MemoryTracker.h"
 
 
 
-class Console : public Ogre::Singleton< Console >, public Ogre::LogListener
+class Console : public Ogre::Singleton< Console >, public InputListener
 {
 public:
     Console();
@@ -37,13 +38,24 @@ public:
     void AddInputToHistory();
     void SetInputLineFromHistory();
 
-    virtual void messageLogged( const Ogre::String& message, Ogre::LogMessageLevel lml, bool maskDebug, const Ogre::String &logName, bool& skipThisMessage );
-
 private:
     void LoadHistory();
     void SaveHistory();
     void AddToHistory( const Ogre::String& history );
 
+    struct OutputLine
+    {
+        Ogre::String text;
+        Ogre::ColourValue colour;
+        float time;
+    };
+    typedef std::vector< OutputLine, TrackedAllocator< OutputLine, MEMORY_CONSOLE > > OutputLines;
+    typedef std::list< Ogre::String, TrackedAllocator< Ogre::String, MEMORY_CONSOLE > > HistoryLines;
+    void WrapText( const OutputLine& text );
+    void AddOutputLine( const Ogre::String& text, const Ogre::ColourValue& colour, const float time );
+    const OutputLine& GetOutputLine( const unsigned int line ) const;
+    void UpdateWrap();
+
 private:
     int                           m_ConsoleWidth;
     int                           m_ConsoleHeight;
@@ -54,25 +66,33 @@ private:
     bool                          m_Visible;
     float                         m_Height;
 
-    struct OutputLine
-    {
-        Ogre::String text;
-        Ogre::ColourValue colour;
-        float time;
-    };
-    std::list< OutputLine >       m_OutputLine;
-    unsigned int                  m_MaxOutputLine; // max number of lines in output list
+    // Output is kept in two fixed rings, so adding text never allocates
+    // new nodes and old text is overwritten. Texts are stored as they were
+    // added and wrapped again when console width changes, lines are already
+    // wrapped to current width and only lines in visible window are drawn.
+    OutputLines                   m_OutputText;
+    unsigned int                  m_OutputTextStart; // oldest text in ring
+    unsigned int                  m_OutputTextNumber;
+    OutputLines                   m_OutputLine;
+    unsigned int                  m_OutputLineStart; // oldest line in ring
+    unsigned int                  m_OutputLineNumber;
+    unsigned int                  m_WrapWidth;     // width lines in ring are wrapped to
     unsigned int                  m_DisplayLine;   // bottom of console displays this line
     Ogre::String                  m_InputLine;
     unsigned int                  m_CursorPosition;
     float                         m_CursorBlinkTime;
 
-    std::list< Ogre::String >     m_History;
+    HistoryLines                  m_History;
     int                           m_HistoryLineCycleIndex;
     unsigned int                  m_HistoryMaxSize;
 
     Ogre::StringVector            m_AutoCompletition;
     unsigned int                  m_AutoCompletitionLine;
+
+    // text added from other threads (script workers) is moved to output in main thread
+    boost::thread::id             m_ThreadId;
+    boost::mutex                  m_PendingOutputMutex;
+    OutputLines                   m_PendingOutput;
 };
 
 
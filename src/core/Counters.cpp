@@ -0,0 +1,423 @@
+#include "Counters.h"
+#include "CountersCommands.h"
+
+#include <OgreStringConverter.h>
+#include <algorithm>
+#include <fstream>
+
+#include "ConfigVar.h"
+#include "DebugDraw.h"
+#include "Logger.h"
+#include "Profiler.h"
+
+
+
+template<>Counters* Ogre::Singleton< Counters >::msSingleton = NULL;
+
+ConfigVar cv_counters_dump( "counters_dump_file", "File where counters are written periodically, csv or json by extension. none - no dump.", "none" );
+ConfigVarFloat cv_counters_dump_interval( "counters_dump_interval", "Seconds between periodic counters dumps", 10.0f );
+
+
+
+void
+counter_thread_cleanup( CounterThread* thread )
+{
+    // threads are owned by counters so their increments stay after thread exit
+}
+
+
+
+Counters::Counters():
+    m_CountersNumber( 0 ),
+    m_Thread( counter_thread_cleanup ),
+    m_StartTime( Profiler::GetTime() ),
+    m_SecondStart( m_StartTime ),
+    m_Seconds( 0 ),
+    m_DumpTime( 0 ),
+    m_DumpFile( "" )
+{
+    InitCmd();
+}
+
+
+
+Counters::~Counters()
+{
+    m_Thread.release();
+    for( unsigned int i = 0; i < m_Threads.size(); ++i )
+    {
+        delete m_Threads[ i ];
+    }
+}
+
+
+
+void
+Counters::Update()
+{
+    {
+        boost::mutex::scoped_lock lock( m_CountersMutex );
+        boost::mutex::scoped_lock threads_lock( m_ThreadsMutex );
+        for( unsigned int i = 0; i < m_CountersNumber; ++i )
+        {
+            if( m_Counters[ i ].type == COUNTER )
+            {
+                long long total = 0;
+                for( unsigned int j = 0; j < m_Threads.size(); ++j )
+                {
+                    total += m_Threads[ j ]->values[ i ].load( boost::memory_order_relaxed );
+                }
+                m_Counters[ i ].total = total;
+            }
+        }
+    }
+
+    unsigned long long time = Profiler::GetTime();
+    if( time - m_SecondStart >= 1000000 )
+    {
+        UpdateSecond( ( time - m_SecondStart ) / 1000000.0f );
+        m_SecondStart = time;
+    }
+
+    if( m_Graphs.size() > 0 )
+    {
+        UpdateDebug();
+    }
+}
+
+
+
+unsigned int
+Counters::Register( const Ogre::String& name, const Type type )
+{
+    boost::mutex::scoped_lock lock( m_CountersMutex );
+
+    int id = Find( name );
+    if( id >= 0 )
+    {
+        return id;
+    }
+
+    if( m_CountersNumber == COUNTERS_MAX )
+    {
+        LOG_ERROR( "Can't add counter \"" + name + "\", there are already " + Ogre::StringConverter::toString( COUNTERS_MAX ) + " counters." );
+        return COUNTERS_MAX;
+    }
+
+    Counter& counter = m_Counters[ m_CountersNumber ];
+    counter.name = name;
+    counter.type = type;
+    counter.total = 0;
+    counter.second_total = 0;
+    counter.rate = 0;
+    counter.value = 0;
+    counter.history.resize( COUNTERS_HISTORY, 0 );
+    m_CounterIndex[ name ] = m_CountersNumber;
+    return m_CountersNumber++;
+}
+
+
+
+void
+Counters::RegisterOnce( const char* name, const Type type, volatile unsigned int* id )
+{
+    *id = Counters::getSingleton().Register( name, type );
+}
+
+
+
+void
+Counters::Add( const unsigned int id, const long long value )
+{
+    // only this thread writes slot, so plain load and store are enough
+    boost::atomic< long long >& slot = GetThread()->values[ id ];
+    slot.store( slot.load( boost::memory_order_relaxed ) + value, boost::memory_order_relaxed );
+}
+
+
+
+void
+Counters::Set( const unsigned int id, const float value )
+{
+    // gauges are set from script workers too
+    boost::mutex::scoped_lock lock( m_CountersMutex );
+    m_Counters[ id ].value = value;
+}
+
+
+
+float
+Counters::Get( const Ogre::String& name ) const
+{
+    boost::mutex::scoped_lock lock( m_CountersMutex );
+    int id = Find( name );
+    if( id < 0 )
+    {
+        return 0;
+    }
+    return ( m_Counters[ id ].type == COUNTER ) ? m_Counters[ id ].rate : m_Counters[ id ].value;
+}
+
+
+
+double
+Counters::GetTotal( const Ogre::String& name ) const
+{
+    boost::mutex::scoped_lock lock( m_CountersMutex );
+    int id = Find( name );
+    if( id < 0 )
+    {
+        return 0;
+    }
+    return ( m_Counters[ id ].type == COUNTER ) ? ( double )m_Counters[ id ].total : m_Counters[ id ].value;
+}
+
+
+
+void
+Counters::GetNames( Ogre::StringVector& names ) const
+{
+    boost::mutex::scoped_lock lock( m_CountersMutex );
+    for( unsigned int i = 0; i < m_CountersNumber; ++i )
+    {
+        names.push_back( m_Counters[ i ].name );
+    }
+    std::sort( names.begin(), names.end() );
+}
+
+
+
+void
+Counters::Print( const Ogre::String& filter ) const
+{
+    Ogre::StringVector names;
+    GetNames( names );
+
+    // console isn't called under lock, it can add counters itself
+    std::vector< Counter > counters;
+    {
+        boost::mutex::scoped_lock lock( m_CountersMutex );
+        for( unsigned int i = 0; i < names.size(); ++i )
+        {
+            if( names[ i ].find( filter ) != Ogre::String::npos )
+            {
+                counters.push_back( m_Counters[ Find( names[ i ] ) ] );
+            }
+        }
+    }
+
+    for( unsigned int i = 0; i < counters.size(); ++i )
+    {
+        const Counter& counter = counters[ i ];
+        if( counter.type == COUNTER )
+        {
+            Console::getSingleton().AddTextToOutput( counter.name + ": " + Ogre::StringConverter::toString( counter.rate, 1, 0, ' ', std::ios::fixed ) + "/s, total " + Ogre::StringConverter::toString( ( unsigned long )counter.total ) );
+        }
+        else
+        {
+            Console::getSingleton().AddTextToOutput( counter.name + ": " + Ogre::StringConverter::toString( counter.value ) );
+        }
+    }
+}
+
+
+
+void
+Counters::ToggleGraph( const Ogre::String& name )
+{
+    int id = -1;
+    {
+        boost::mutex::scoped_lock lock( m_CountersMutex );
+        id = Find( name );
+    }
+    if( id < 0 )
+    {
+        LOG_ERROR( "Counter \"" + name + "\" not found." );
+        return;
+    }
+
+    std::vector< unsigned int >::iterator it = std::find( m_Graphs.begin(), m_Graphs.end(), ( unsigned int )id );
+    if( it != m_Graphs.end() )
+    {
+        m_Graphs.erase( it );
+    }
+    else
+    {
+        m_Graphs.push_back( id );
+    }
+}
+
+
+
+void
+Counters::Dump( const Ogre::String& file_name, const bool append ) const
+{
+    bool json = Ogre::StringUtil::endsWith( file_name, ".json" );
+
+    std::ofstream file( file_name.c_str(), append ? std::ios::app : std::ios::trunc );
+    if( file.is_open() == false )
+    {
+        LOG_ERROR( "Can't open counters file \"" + file_name + "\"." );
+        return;
+    }
+
+    // csv has one line per counter, json has one object per dump on its own line
+    float time = ( Profiler::GetTime() - m_StartTime ) / 1000000.0f;
+    if( json == false && append == false )
+    {
+        file << "time,name,type,total,value\n";
+    }
+    if( json == true )
+    {
+        file << "{\"time\":" << time << ",\"counters\":{";
+    }
+
+    boost::mutex::scoped_lock lock( m_CountersMutex );
+    for( unsigned int i = 0; i < m_CountersNumber; ++i )
+    {
+        const Counter& counter = m_Counters[ i ];
+        float value = ( counter.type == COUNTER ) ? counter.rate : counter.value;
+        if( json == true )
+        {
+            file << ( ( i > 0 ) ? "," : "" ) << "\"" << counter.name << "\":{\"total\":" << ( ( counter.type == COUNTER ) ? ( double )counter.total : value ) << ",\"value\":" << value << "}";
+        }
+        else
+        {
+            file << time << "," << counter.name << "," << ( ( counter.type == COUNTER ) ? "counter" : "gauge" ) << "," << ( ( counter.type == COUNTER ) ? ( double )counter.total : value ) << "," << value << "\n";
+        }
+    }
+
+    if( json == true )
+    {
+        file << "}}\n";
+    }
+}
+
+
+
+CounterThread*
+Counters::GetThread()
+{
+    CounterThread* thread = m_Thread.get();
+    if( thread == NULL )
+    {
+        thread = new CounterThread();
+        m_Thread.reset( thread );
+
+        boost::mutex::scoped_lock lock( m_ThreadsMutex );
+        m_Threads.push_back( thread );
+    }
+    return thread;
+}
+
+
+
+int
+Counters::Find( const Ogre::String& name ) const
+{
+    boost::unordered_map< Ogre::String, unsigned int >::const_iterator it = m_CounterIndex.find( name );
+    return ( it != m_CounterIndex.end() ) ? ( int )it->second : -1;
+}
+
+
+
+void
+Counters::UpdateSecond( const float seconds )
+{
+    {
+        boost::mutex::scoped_lock lock( m_CountersMutex );
+        unsigned int slot = m_Seconds % COUNTERS_HISTORY;
+        for( unsigned int i = 0; i < m_CountersNumber; ++i )
+        {
+            Counter& counter = m_Counters[ i ];
+            if( counter.type == COUNTER )
+            {
+                counter.rate = ( counter.total - counter.second_total ) / seconds;
+                counter.second_total = counter.total;
+                counter.history[ slot ] = counter.rate;
+            }
+            else
+            {
+                counter.history[ slot ] = counter.value;
+            }
+        }
+        ++m_Seconds;
+    }
+
+    const Ogre::String& dump_file = cv_counters_dump.GetS();
+    if( dump_file == "none" || dump_file == "" )
+    {
+        m_DumpFile = "";
+        return;
+    }
+
+    m_DumpTime += seconds;
+    if( m_DumpTime >= cv_counters_dump_interval.Get() || dump_file != m_DumpFile )
+    {
+        // new file is started from beginning
+        Dump( dump_file, dump_file == m_DumpFile );
+        m_DumpFile = dump_file;
+        m_DumpTime = 0;
+    }
+}
+
+
+
+void
+Counters::UpdateDebug()
+{
+    const float width = 240.0f;
+    const float height = 50.0f;
+    const float step = width / ( COUNTERS_HISTORY - 1 );
+
+    DEBUG_DRAW.SetTextAlignment( DEBUG_DRAW.LEFT );
+    DEBUG_DRAW.SetScreenSpace( true );
+
+    float x = 10.0f;
+    float y = 200.0f;
+
+    // debug draw isn't called under lock, it can add counters itself
+    std::vector< Counter > counters;
+    unsigned int total_seconds = 0;
+    {
+        boost::mutex::scoped_lock lock( m_CountersMutex );
+        for( unsigned int i = 0; i < m_Graphs.size(); ++i )
+        {
+            counters.push_back( m_Counters[ m_Graphs[ i ] ] );
+        }
+        total_seconds = m_Seconds;
+    }
+    unsigned int seconds = std::min( total_seconds, COUNTERS_HISTORY );
+
+    for( unsigned int i = 0; i < counters.size(); ++i )
+    {
+        const Counter& counter = counters[ i ];
+
+        // oldest second first
+        float max = 0;
+        for( unsigned int j = 0; j < seconds; ++j )
+        {
+            max = std::max( max, counter.history[ j ] );
+        }
+
+        float value = ( counter.type == COUNTER ) ? counter.rate : counter.value;
+        DEBUG_DRAW.SetColour( Ogre::ColourValue( 1.0f, 1.0f, 1.0f, 1.0f ) );
+        DEBUG_DRAW.Text( x, y, counter.name + ": " + Ogre::StringConverter::toString( value ) + ( ( counter.type == COUNTER ) ? "/s" : "" ) + ", max " + Ogre::StringConverter::toString( max ) );
+
+        float bottom = y + 16.0f + height;
+        DEBUG_DRAW.SetColour( Ogre::ColourValue( 0.5f, 0.5f, 0.5f, 1.0f ) );
+        DEBUG_DRAW.Line( x, bottom, x + width, bottom );
+
+        DEBUG_DRAW.SetColour( Ogre::ColourValue( 0.0f, 0.8f, 0.0f, 1.0f ) );
+        for( unsigned int j = 1; j < seconds; ++j )
+        {
+            float v1 = counter.history[ ( total_seconds - seconds + j - 1 ) % COUNTERS_HISTORY ];
+            float v2 = counter.history[ ( total_seconds - seconds + j ) % COUNTERS_HISTORY ];
+            float y1 = ( max > 0 ) ? bottom - v1 / max * height : bottom;
+            float y2 = ( max > 0 ) ? bottom - v2 / max * height : bottom;
+            DEBUG_DRAW.Line( x + ( j - 1 ) * step, y1, x + j * step, y2 );
+        }
+
+        y += height + 30.0f;
+    }
+}
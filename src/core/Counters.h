@@ -0,0 +1,131 @@
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+#include <OgreSingleton.h>
+#include <OgreString.h>
+#include <OgreStringVector.h>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/unordered_map.hpp>
+#include <vector>
+
+
+
+// Counters of engine work. Counter is increased with COUNTER_ADD from any
+// thread, each thread adds to its own slots so increment needs no lock.
+// Gauge is value set with COUNTER_SET, last set value is kept. At start of
+// every frame main thread sums slots of all threads, once per second rates
+// of counters are calculated and kept with gauges in history of last minute.
+
+
+
+const unsigned int COUNTERS_MAX = 128;
+// id of place of use before its counter is registered
+const unsigned int COUNTERS_UNREGISTERED = ( unsigned int )-1;
+// seconds kept in history
+const unsigned int COUNTERS_HISTORY = 60;
+
+
+
+// written only by its own thread, slot COUNTERS_MAX is for counters that didn't fit.
+// Values are atomic because 64 bit value is written in two halves on 32 bit
+// build and main thread could read it half written.
+struct CounterThread
+{
+    CounterThread()
+    {
+        for( unsigned int i = 0; i <= COUNTERS_MAX; ++i )
+        {
+            values[ i ].store( 0, boost::memory_order_relaxed );
+        }
+    }
+
+    boost::atomic< long long > values[ COUNTERS_MAX + 1 ];
+};
+
+
+
+class Counters : public Ogre::Singleton< Counters >
+{
+public:
+    enum Type
+    {
+        COUNTER,
+        GAUGE
+    };
+
+    Counters();
+    virtual ~Counters();
+
+    // called by main thread at start of frame
+    void Update();
+
+    // returns id of counter, counter is created on first call with its name
+    unsigned int Register( const Ogre::String& name, const Type type );
+    // for COUNTER_ADD and COUNTER_SET, called once for each place of use
+    static void RegisterOnce( const char* name, const Type type, volatile unsigned int* id );
+    void Add( const unsigned int id, const long long value );
+    void Set( const unsigned int id, const float value );
+
+    // per second rate of counter or value of gauge, 0 for unknown name
+    float Get( const Ogre::String& name ) const;
+    // sum of all increments of counter or value of gauge
+    double GetTotal( const Ogre::String& name ) const;
+    void GetNames( Ogre::StringVector& names ) const;
+
+    void Print( const Ogre::String& filter ) const;
+    void ToggleGraph( const Ogre::String& name );
+    // csv or json (by extension) with current values, appended to file
+    void Dump( const Ogre::String& file_name, const bool append ) const;
+
+private:
+    void InitCmd();
+    CounterThread* GetThread();
+    int Find( const Ogre::String& name ) const;
+    void UpdateSecond( const float seconds );
+    void UpdateDebug();
+
+private:
+    struct Counter
+    {
+        Ogre::String name;
+        Type type;
+        long long total;
+        long long second_total; // total at start of current second
+        float rate;
+        float value;
+        std::vector< float > history; // rate or value for each of last seconds
+    };
+    mutable boost::mutex m_CountersMutex;
+    Counter m_Counters[ COUNTERS_MAX + 1 ];
+    unsigned int m_CountersNumber;
+    boost::unordered_map< Ogre::String, unsigned int > m_CounterIndex;
+
+    boost::mutex m_ThreadsMutex;
+    std::vector< CounterThread* > m_Threads;
+    boost::thread_specific_ptr< CounterThread > m_Thread;
+
+    unsigned long long m_StartTime;
+    unsigned long long m_SecondStart;
+    unsigned int m_Seconds; // number of seconds written to history
+    float m_DumpTime; // seconds since last periodic dump
+    Ogre::String m_DumpFile; // file of periodic dump which was already started
+
+    std::vector< unsigned int > m_Graphs;
+};
+
+
+
+// id is looked up once for each place of use, names must be same for same counter.
+// Place can be reached from several threads and function statics aren't
+// initialised thread safe by all compilers, so lookup goes through call_once.
+// Statics are constant initialised and id is word sized, so after first
+// registration place of use only reads cached id and doesn't enter call_once.
+#define COUNTER_REGISTER( name, type ) static boost::once_flag counter_once = BOOST_ONCE_INIT; static volatile unsigned int counter_id = COUNTERS_UNREGISTERED; if( counter_id == COUNTERS_UNREGISTERED ) { boost::call_once( counter_once, boost::bind( &Counters::RegisterOnce, name, type, &counter_id ) ); }
+#define COUNTER_ADD( name, value ) do { COUNTER_REGISTER( name, Counters::COUNTER ); Counters::getSingleton().Add( counter_id, value ); } while( false )
+#define COUNTER_SET( name, value ) do { COUNTER_REGISTER( name, Counters::GAUGE ); Counters::getSingleton().Set( counter_id, value ); } while( false )
+
+
+
+#endif // COUNTERS_H
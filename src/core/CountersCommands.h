@@ -0,0 +1,65 @@
+#include "ConfigCmdManager.h"
+#include "Console.h"
+#include "Logger.h"
+
+
+
+void
+CmdCounters( const Ogre::StringVector& params )
+{
+    if( params.size() > 2 )
+    {
+        Console::getSingleton().AddTextToOutput( "Usage: /counters [part of name]" );
+        return;
+    }
+
+    Counters::getSingleton().Print( ( params.size() == 2 ) ? params[ 1 ] : "" );
+}
+
+
+
+void
+CmdCountersGraph( const Ogre::StringVector& params )
+{
+    if( params.size() != 2 )
+    {
+        Console::getSingleton().AddTextToOutput( "Usage: /counters_graph <counter name>" );
+        return;
+    }
+
+    Counters::getSingleton().ToggleGraph( params[ 1 ] );
+}
+
+
+
+void
+CmdCountersGraphCompletition( Ogre::StringVector& complete_params )
+{
+    Counters::getSingleton().GetNames( complete_params );
+}
+
+
+
+void
+CmdCountersDump( const Ogre::StringVector& params )
+{
+    if( params.size() > 2 )
+    {
+        Console::getSingleton().AddTextToOutput( "Usage: /counters_dump [file name]" );
+        return;
+    }
+
+    Ogre::String file_name = ( params.size() == 2 ) ? params[ 1 ] : "counters.csv";
+    Counters::getSingleton().Dump( file_name, false );
+    LOG_TRIVIAL( "Counters dumped to \"" + file_name + "\"." );
+}
+
+
+
+void
+Counters::InitCmd()
+{
+    ConfigCmdManager::getSingleton().AddCommand( "counters", "List counters (per second) and gauges which names contain given text", "", CmdCounters, NULL );
+    ConfigCmdManager::getSingleton().AddCommand( "counters_graph", "Show or hide graph of counter for last minute", "", CmdCountersGraph, CmdCountersGraphCompletition );
+    ConfigCmdManager::getSingleton().AddCommand( "counters_dump", "Write counters to csv or json file", "", CmdCountersDump, NULL );
+}
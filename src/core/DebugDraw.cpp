@@ -1,11 +1,16 @@
 #include "DebugDraw.h"
+#include "DebugDrawCommands.h"
 
 #include <Overlay/OgreFontManager.h>
 #include <OgreHardwareBufferManager.h>
 #include <OgreMaterialManager.h>
+#include <algorithm>
 
 #include "CameraManager.h"
+#include "Counters.h"
 #include "Logger.h"
+#include "Profiler.h"
+#include "SdfFont.h"
 
 
 
@@ -20,21 +25,15 @@ DebugDraw::DebugDraw():
     m_FadeStartSquare( 999999 ),
     m_FadeEndSquare( 999999 ),
     m_FontHeight( 16 ),
-    m_LineMaxVertexCount( 0 ),
-    m_Line3dMaxVertexCount( 0 ),
-    m_QuadMaxVertexCount( 0 ),
-    m_TextMaxVertexCount( 0 )
+    m_TextAlignment( LEFT )
 {
     m_SceneManager = Ogre::Root::getSingleton().getSceneManager( "Scene" );
     m_RenderSystem = Ogre::Root::getSingletonPtr()->getRenderSystem();
+    m_Window = Ogre::Root::getSingleton().getRenderTarget( "QGearsWindow" );
 
-    CreateLineVertexBuffer();
-    CreateLine3dVertexBuffer();
-    CreateTriangle3dVertexBuffer();
-    CreateCircleVertexBuffer();
-    CreateDiscVertexBuffer();
-    CreateQuadVertexBuffer();
-    CreateTextVertexBuffer();
+    CreateBatch( m_Frame );
+    m_Current = &m_Frame;
+    m_SkipFrame = false;
 
     m_Material = Ogre::MaterialManager::getSingleton().create( "DebugDraw", "General" );
     Ogre::Pass* pass = m_Material->getTechnique( 0 )->getPass( 0 );
@@ -54,27 +53,11 @@ DebugDraw::DebugDraw():
     pass->setLightingEnabled( false );
     pass->setSceneBlending( Ogre::SBT_TRANSPARENT_ALPHA );
 
-    m_Font = Ogre::FontManager::getSingleton().getByName( "CourierNew" );
-    if( m_Font.isNull() )
-    {
-        LOG_ERROR( "Could not find font \"CourierNew\" for debug draw." );
-    }
-    m_Font->load();
-    pass = m_Font->getMaterial()->getTechnique( 0 )->getPass( 0 );
-    pass->setVertexColourTracking( Ogre::TVC_AMBIENT );
-    pass->setCullingMode( Ogre::CULL_NONE );
-    pass->setDepthCheckEnabled( true );
-    pass->setDepthWriteEnabled( true );
-    pass->setLightingEnabled( false );
-    pass->setSceneBlending( Ogre::SBT_TRANSPARENT_ALPHA );
-
-    pass->setAlphaRejectFunction( Ogre::CMPF_GREATER );
-    pass->setAlphaRejectValue( 0 );
-    Ogre::TextureUnitState* tex = pass->getTextureUnitState( 0 );
-    tex->setNumMipmaps( -1 );
-    tex->setTextureFiltering( Ogre::TFO_NONE );
+    SetFont( "CourierNew", false );
 
     m_SceneManager->addRenderQueueListener( this );
+
+    InitCmd();
 }
 
 
@@ -83,13 +66,12 @@ DebugDraw::~DebugDraw()
 {
     m_SceneManager->removeRenderQueueListener( this );
 
-    DestroyLineVertexBuffer();
-    DestroyLine3dVertexBuffer();
-    DestroyTriangle3dVertexBuffer();
-    DestroyCircleVertexBuffer();
-    DestroyDiscVertexBuffer();
-    DestroyQuadVertexBuffer();
-    DestroyTextVertexBuffer();
+    for( std::map< Ogre::String, Group* >::iterator it = m_Groups.begin(); it != m_Groups.end(); ++it )
+    {
+        DestroyBatch( it->second->batch );
+        delete it->second;
+    }
+    DestroyBatch( m_Frame );
 }
 
 
@@ -128,130 +110,103 @@ DebugDraw::SetFadeDistance( const float fade_s, const float fade_e )
 
 
 void
-DebugDraw::SetTextAlignment( TextAlignment alignment )
+DebugDraw::SetSkipFrame( const bool skip )
 {
-    m_TextAlignment = alignment;
+    m_SkipFrame = skip;
 }
 
 
 
 void
-DebugDraw::Line( const float x1, const float y1, const float x2, const float y2 )
+DebugDraw::SetFont( const Ogre::String& name, const bool sdf )
 {
-    if( m_LineRenderOp.vertexData->vertexCount + 2 > m_LineMaxVertexCount )
+    Ogre::FontPtr font = Ogre::FontManager::getSingleton().getByName( name );
+    if( font.isNull() )
     {
-        LOG_ERROR( "Max number of lines reached. Can't create more than " + Ogre::StringConverter::toString( m_LineMaxVertexCount / 2 ) + " lines." );
+        LOG_ERROR( "Could not find font \"" + name + "\" for debug draw." );
         return;
     }
+    font->load();
 
-    float width = Ogre::Root::getSingleton().getRenderTarget( "QGearsWindow" )->getViewport( 0 )->getActualWidth();
-    float height = Ogre::Root::getSingleton().getRenderTarget( "QGearsWindow" )->getViewport( 0 )->getActualHeight();
+    Ogre::Pass* pass = font->getMaterial()->getTechnique( 0 )->getPass( 0 );
+    pass->setVertexColourTracking( Ogre::TVC_AMBIENT );
+    pass->setCullingMode( Ogre::CULL_NONE );
+    pass->setDepthCheckEnabled( true );
+    pass->setDepthWriteEnabled( true );
+    pass->setLightingEnabled( false );
+    pass->setSceneBlending( Ogre::SBT_TRANSPARENT_ALPHA );
 
-    float new_x1 = ( m_ScreenSpace == true ) ? ( ( int ) x1 / width ) * 2 - 1 : x1;
-    float new_y1 = ( m_ScreenSpace == true ) ? -( ( ( int ) y1 / height ) * 2 - 1 ) : y1;
-    float new_x2 = ( m_ScreenSpace == true ) ? ( ( int ) x2 / width ) * 2 - 1 : x2;
-    float new_y2 = ( m_ScreenSpace == true ) ? -( ( ( int ) y2 / height ) * 2 - 1 ) : y2;
+    pass->setAlphaRejectFunction( Ogre::CMPF_GREATER );
+    pass->setAlphaRejectValue( 0 );
+    Ogre::TextureUnitState* tex = pass->getTextureUnitState( 0 );
+    tex->setNumMipmaps( -1 );
+    tex->setTextureFiltering( Ogre::TFO_NONE );
 
-    float* writeIterator = ( float* ) m_LineVertexBuffer->lock( Ogre::HardwareBuffer::HBL_NORMAL );
-    writeIterator += m_LineRenderOp.vertexData->vertexCount * 7;
+    // distance field font scales to any m_FontHeight without blur
+    if( sdf == true )
+    {
+        SetSdfPass( pass );
+    }
 
-    *writeIterator++ = new_x1;
-    *writeIterator++ = new_y1;
-    *writeIterator++ = m_Z;
-    *writeIterator++ = m_Colour.r;
-    *writeIterator++ = m_Colour.g;
-    *writeIterator++ = m_Colour.b;
-    *writeIterator++ = m_Colour.a;
+    m_Font = font;
+}
 
-    *writeIterator++ = new_x2;
-    *writeIterator++ = new_y2;
-    *writeIterator++ = m_Z;
-    *writeIterator++ = m_Colour.r;
-    *writeIterator++ = m_Colour.g;
-    *writeIterator++ = m_Colour.b;
-    *writeIterator++ = m_Colour.a;
 
-    m_LineRenderOp.vertexData->vertexCount += 2;
 
-    m_LineVertexBuffer->unlock();
+void
+DebugDraw::SetTextAlignment( TextAlignment alignment )
+{
+    m_TextAlignment = alignment;
 }
 
 
 
 void
-DebugDraw::Line3d( const Ogre::Vector3& point1, const Ogre::Vector3& point2 )
+DebugDraw::Line( const float x1, const float y1, const float x2, const float y2 )
 {
-    if( m_Line3dRenderOp.vertexData->vertexCount + 2 > m_Line3dMaxVertexCount )
+    if( IsSkipped() == true )
     {
-        LOG_ERROR( "Max number of 3d lines reached. Can't create more than " + Ogre::StringConverter::toString( m_Line3dMaxVertexCount / 2 ) + " 3d lines." );
         return;
     }
 
-    float* writeIterator = ( float* ) m_Line3dVertexBuffer->lock( Ogre::HardwareBuffer::HBL_NORMAL );
-    writeIterator += m_Line3dRenderOp.vertexData->vertexCount * 7;
-
-    *writeIterator++ = point1.x;
-    *writeIterator++ = point1.y;
-    *writeIterator++ = point1.z;
-    *writeIterator++ = m_Colour.r;
-    *writeIterator++ = m_Colour.g;
-    *writeIterator++ = m_Colour.b;
-    *writeIterator++ = m_Colour.a;
-
-    *writeIterator++ = point2.x;
-    *writeIterator++ = point2.y;
-    *writeIterator++ = point2.z;
-    *writeIterator++ = m_Colour.r;
-    *writeIterator++ = m_Colour.g;
-    *writeIterator++ = m_Colour.b;
-    *writeIterator++ = m_Colour.a;
-
-    m_Line3dRenderOp.vertexData->vertexCount += 2;
+    Ogre::Viewport* viewport = m_Window->getViewport( 0 );
+    float width = viewport->getActualWidth();
+    float height = viewport->getActualHeight();
 
-    m_Line3dVertexBuffer->unlock();
+    Buffer& buffer = m_Current->buffers[ DDB_LINE ];
+    AddVertex( buffer, ToScreen( x1, y1, width, height ) );
+    AddVertex( buffer, ToScreen( x2, y2, width, height ) );
 }
 
 
 
 void
-DebugDraw::Triangle3d( const Ogre::Vector3& point1, const Ogre::Vector3& point2, const Ogre::Vector3& point3 )
+DebugDraw::Line3d( const Ogre::Vector3& point1, const Ogre::Vector3& point2 )
 {
-    if( m_Triangle3dRenderOp.vertexData->vertexCount + 3 > m_Triangle3dMaxVertexCount )
+    if( IsSkipped() == true )
     {
-        LOG_ERROR( "Max number of 3d triangles reached. Can't create more than " + Ogre::StringConverter::toString( m_Triangle3dMaxVertexCount / 3 ) + " 3d triangles." );
         return;
     }
 
-    float* writeIterator = ( float* ) m_Triangle3dVertexBuffer->lock( Ogre::HardwareBuffer::HBL_NORMAL );
-    writeIterator += m_Triangle3dRenderOp.vertexData->vertexCount * 7;
-
-    *writeIterator++ = point1.x;
-    *writeIterator++ = point1.y;
-    *writeIterator++ = point1.z;
-    *writeIterator++ = m_Colour.r;
-    *writeIterator++ = m_Colour.g;
-    *writeIterator++ = m_Colour.b;
-    *writeIterator++ = m_Colour.a;
+    Buffer& buffer = m_Current->buffers[ DDB_LINE3D ];
+    AddVertex( buffer, point1 );
+    AddVertex( buffer, point2 );
+}
 
-    *writeIterator++ = point2.x;
-    *writeIterator++ = point2.y;
-    *writeIterator++ = point2.z;
-    *writeIterator++ = m_Colour.r;
-    *writeIterator++ = m_Colour.g;
-    *writeIterator++ = m_Colour.b;
-    *writeIterator++ = m_Colour.a;
 
-    *writeIterator++ = point3.x;
-    *writeIterator++ = point3.y;
-    *writeIterator++ = point3.z;
-    *writeIterator++ = m_Colour.r;
-    *writeIterator++ = m_Colour.g;
-    *writeIterator++ = m_Colour.b;
-    *writeIterator++ = m_Colour.a;
 
-    m_Triangle3dRenderOp.vertexData->vertexCount += 3;
+void
+DebugDraw::Triangle3d( const Ogre::Vector3& point1, const Ogre::Vector3& point2, const Ogre::Vector3& point3 )
+{
+    if( IsSkipped() == true )
+    {
+        return;
+    }
 
-    m_Triangle3dVertexBuffer->unlock();
+    Buffer& buffer = m_Current->buffers[ DDB_TRIANGLE3D ];
+    AddVertex( buffer, point1 );
+    AddVertex( buffer, point2 );
+    AddVertex( buffer, point3 );
 }
 
 
@@ -259,79 +214,34 @@ DebugDraw::Triangle3d( const Ogre::Vector3& point1, const Ogre::Vector3& point2,
 void
 DebugDraw::Circle( const float x, const float y, const float radius )
 {
-    Ogre::RenderTarget* window  = Ogre::Root::getSingleton().getRenderTarget( "QGearsWindow" );
-    if( ( Ogre::RenderWindow* )window->isActive() == false )
-    {
-        return;
-    }
-
-    if( m_CircleRenderOp.vertexData->vertexCount + 16 > m_CircleMaxVertexCount )
+    if( IsSkipped() == true )
     {
-        LOG_ERROR( "Max number of circles reached. Can't create more than " + Ogre::StringConverter::toString( m_CircleMaxVertexCount / 16 ) + " circles." );
         return;
     }
 
-    float width = window->getViewport( 0 )->getActualWidth();
-    float height = window->getViewport( 0 )->getActualHeight();
+    Ogre::Viewport* viewport = m_Window->getViewport( 0 );
+    float width = viewport->getActualWidth();
+    float height = viewport->getActualHeight();
 
     float radius23 = radius * ( 2.2f / 3.0f );
-
-    float x1 = x;
-    float y1 = y - radius;
-    float x2 = x + radius23;
-    float y2 = y - radius23;
-    float x3 = x + radius;
-    float y3 = y;
-    float x4 = x + radius23;
-    float y4 = y + radius23;
-    float x5 = x;
-    float y5 = y + radius;
-    float x6 = x - radius23;
-    float y6 = y + radius23;
-    float x7 = x - radius;
-    float y7 = y;
-    float x8 = x - radius23;
-    float y8 = y - radius23;
-
-    float new_x1 = ( m_ScreenSpace == true ) ? ( ( int ) x1 / width ) * 2 - 1 : x1;
-    float new_y1 = ( m_ScreenSpace == true ) ? -( ( ( int ) y1 / height ) * 2 - 1 ) : y1;
-    float new_x2 = ( m_ScreenSpace == true ) ? ( ( int ) x2 / width ) * 2 - 1 : x2;
-    float new_y2 = ( m_ScreenSpace == true ) ? -( ( ( int ) y2 / height ) * 2 - 1 ) : y2;
-    float new_x3 = ( m_ScreenSpace == true ) ? ( ( int ) x3 / width ) * 2 - 1 : x3;
-    float new_y3 = ( m_ScreenSpace == true ) ? -( ( ( int ) y3 / height ) * 2 - 1 ) : y3;
-    float new_x4 = ( m_ScreenSpace == true ) ? ( ( int ) x4 / width ) * 2 - 1 : x4;
-    float new_y4 = ( m_ScreenSpace == true ) ? -( ( ( int ) y4 / height ) * 2 - 1 ) : y4;
-    float new_x5 = ( m_ScreenSpace == true ) ? ( ( int ) x5 / width ) * 2 - 1 : x5;
-    float new_y5 = ( m_ScreenSpace == true ) ? -( ( ( int ) y5 / height ) * 2 - 1 ) : y5;
-    float new_x6 = ( m_ScreenSpace == true ) ? ( ( int ) x6 / width ) * 2 - 1 : x6;
-    float new_y6 = ( m_ScreenSpace == true ) ? -( ( ( int ) y6 / height ) * 2 - 1 ) : y6;
-    float new_x7 = ( m_ScreenSpace == true ) ? ( ( int ) x7 / width ) * 2 - 1 : x7;
-    float new_y7 = ( m_ScreenSpace == true ) ? -( ( ( int ) y7 / height ) * 2 - 1 ) : y7;
-    float new_x8 = ( m_ScreenSpace == true ) ? ( ( int ) x8 / width ) * 2 - 1 : x8;
-    float new_y8 = ( m_ScreenSpace == true ) ? -( ( ( int ) y8 / height ) * 2 - 1 ) : y8;
-
-    float* writeIterator = ( float* ) m_CircleVertexBuffer->lock( Ogre::HardwareBuffer::HBL_NORMAL );
-    writeIterator += m_CircleRenderOp.vertexData->vertexCount * 7;
-
-    *writeIterator++ = new_x1; *writeIterator++ = new_y1; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x2; *writeIterator++ = new_y2; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x2; *writeIterator++ = new_y2; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x3; *writeIterator++ = new_y3; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x3; *writeIterator++ = new_y3; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x4; *writeIterator++ = new_y4; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x4; *writeIterator++ = new_y4; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x5; *writeIterator++ = new_y5; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x5; *writeIterator++ = new_y5; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x6; *writeIterator++ = new_y6; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x6; *writeIterator++ = new_y6; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x7; *writeIterator++ = new_y7; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x7; *writeIterator++ = new_y7; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x8; *writeIterator++ = new_y8; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x8; *writeIterator++ = new_y8; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x1; *writeIterator++ = new_y1; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-
-    m_CircleRenderOp.vertexData->vertexCount += 16;
-    m_CircleVertexBuffer->unlock();
+    Ogre::Vector2 points[ 8 ] =
+    {
+        ToScreen( x, y - radius, width, height ),
+        ToScreen( x + radius23, y - radius23, width, height ),
+        ToScreen( x + radius, y, width, height ),
+        ToScreen( x + radius23, y + radius23, width, height ),
+        ToScreen( x, y + radius, width, height ),
+        ToScreen( x - radius23, y + radius23, width, height ),
+        ToScreen( x - radius, y, width, height ),
+        ToScreen( x - radius23, y - radius23, width, height )
+    };
+
+    Buffer& buffer = m_Current->buffers[ DDB_CIRCLE ];
+    for( int i = 0; i < 8; ++i )
+    {
+        AddVertex( buffer, points[ i ] );
+        AddVertex( buffer, points[ ( i + 1 ) % 8 ] );
+    }
 }
 
 
@@ -339,87 +249,36 @@ DebugDraw::Circle( const float x, const float y, const float radius )
 void
 DebugDraw::Disc( const float x, const float y, const float radius )
 {
-    Ogre::RenderTarget* window  = Ogre::Root::getSingleton().getRenderTarget( "QGearsWindow" );
-    if( ( Ogre::RenderWindow* )window->isActive() == false )
+    if( IsSkipped() == true )
     {
         return;
     }
 
-    if( m_DiscRenderOp.vertexData->vertexCount + 24 > m_DiscMaxVertexCount )
-    {
-        LOG_ERROR( "Max number of discs reached. Can't create more than " + Ogre::StringConverter::toString( m_DiscMaxVertexCount / 24 ) + " discs." );
-        return;
-    }
-
-    float width = window->getViewport( 0 )->getActualWidth();
-    float height = window->getViewport( 0 )->getActualHeight();
+    Ogre::Viewport* viewport = m_Window->getViewport( 0 );
+    float width = viewport->getActualWidth();
+    float height = viewport->getActualHeight();
 
     float radius23 = radius * ( 2.2f / 3.0f );
-
-    float x1 = x;
-    float y1 = y - radius;
-    float x2 = x + radius23;
-    float y2 = y - radius23;
-    float x3 = x + radius;
-    float y3 = y;
-    float x4 = x + radius23;
-    float y4 = y + radius23;
-    float x5 = x;
-    float y5 = y + radius;
-    float x6 = x - radius23;
-    float y6 = y + radius23;
-    float x7 = x - radius;
-    float y7 = y;
-    float x8 = x - radius23;
-    float y8 = y - radius23;
-
-    float new_x1 = ( m_ScreenSpace == true ) ? ( ( int ) x1 / width ) * 2 - 1 : x1;
-    float new_y1 = ( m_ScreenSpace == true ) ? -( ( ( int ) y1 / height ) * 2 - 1 ) : y1;
-    float new_x2 = ( m_ScreenSpace == true ) ? ( ( int ) x2 / width ) * 2 - 1 : x2;
-    float new_y2 = ( m_ScreenSpace == true ) ? -( ( ( int ) y2 / height ) * 2 - 1 ) : y2;
-    float new_x3 = ( m_ScreenSpace == true ) ? ( ( int ) x3 / width ) * 2 - 1 : x3;
-    float new_y3 = ( m_ScreenSpace == true ) ? -( ( ( int ) y3 / height ) * 2 - 1 ) : y3;
-    float new_x4 = ( m_ScreenSpace == true ) ? ( ( int ) x4 / width ) * 2 - 1 : x4;
-    float new_y4 = ( m_ScreenSpace == true ) ? -( ( ( int ) y4 / height ) * 2 - 1 ) : y4;
-    float new_x5 = ( m_ScreenSpace == true ) ? ( ( int ) x5 / width ) * 2 - 1 : x5;
-    float new_y5 = ( m_ScreenSpace == true ) ? -( ( ( int ) y5 / height ) * 2 - 1 ) : y5;
-    float new_x6 = ( m_ScreenSpace == true ) ? ( ( int ) x6 / width ) * 2 - 1 : x6;
-    float new_y6 = ( m_ScreenSpace == true ) ? -( ( ( int ) y6 / height ) * 2 - 1 ) : y6;
-    float new_x7 = ( m_ScreenSpace == true ) ? ( ( int ) x7 / width ) * 2 - 1 : x7;
-    float new_y7 = ( m_ScreenSpace == true ) ? -( ( ( int ) y7 / height ) * 2 - 1 ) : y7;
-    float new_x8 = ( m_ScreenSpace == true ) ? ( ( int ) x8 / width ) * 2 - 1 : x8;
-    float new_y8 = ( m_ScreenSpace == true ) ? -( ( ( int ) y8 / height ) * 2 - 1 ) : y8;
-
-    float* writeIterator = ( float* ) m_DiscVertexBuffer->lock( Ogre::HardwareBuffer::HBL_NORMAL );
-    writeIterator += m_DiscRenderOp.vertexData->vertexCount * 7;
-
-    *writeIterator++ = new_x1; *writeIterator++ = new_y1; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x2; *writeIterator++ = new_y2; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x1; *writeIterator++ = new_y3; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x2; *writeIterator++ = new_y2; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x3; *writeIterator++ = new_y3; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x1; *writeIterator++ = new_y3; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x3; *writeIterator++ = new_y3; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x4; *writeIterator++ = new_y4; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x1; *writeIterator++ = new_y3; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x4; *writeIterator++ = new_y4; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x5; *writeIterator++ = new_y5; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x1; *writeIterator++ = new_y3; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x5; *writeIterator++ = new_y5; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x6; *writeIterator++ = new_y6; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x1; *writeIterator++ = new_y3; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x6; *writeIterator++ = new_y6; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x7; *writeIterator++ = new_y7; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x1; *writeIterator++ = new_y3; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x7; *writeIterator++ = new_y7; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x8; *writeIterator++ = new_y8; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x1; *writeIterator++ = new_y3; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x8; *writeIterator++ = new_y8; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x1; *writeIterator++ = new_y1; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-    *writeIterator++ = new_x1; *writeIterator++ = new_y3; *writeIterator++ = m_Z; *writeIterator++ = m_Colour.r; *writeIterator++ = m_Colour.g; *writeIterator++ = m_Colour.b; *writeIterator++ = m_Colour.a;
-
-    m_DiscRenderOp.vertexData->vertexCount += 24;
-    m_DiscVertexBuffer->unlock();
+    Ogre::Vector2 center = ToScreen( x, y, width, height );
+    Ogre::Vector2 points[ 8 ] =
+    {
+        ToScreen( x, y - radius, width, height ),
+        ToScreen( x + radius23, y - radius23, width, height ),
+        ToScreen( x + radius, y, width, height ),
+        ToScreen( x + radius23, y + radius23, width, height ),
+        ToScreen( x, y + radius, width, height ),
+        ToScreen( x - radius23, y + radius23, width, height ),
+        ToScreen( x - radius, y, width, height ),
+        ToScreen( x - radius23, y - radius23, width, height )
+    };
+
+    Buffer& buffer = m_Current->buffers[ DDB_DISC ];
+    for( int i = 0; i < 8; ++i )
+    {
+        AddVertex( buffer, points[ i ] );
+        AddVertex( buffer, points[ ( i + 1 ) % 8 ] );
+        AddVertex( buffer, center );
+    }
 }
 
 
@@ -427,78 +286,25 @@ DebugDraw::Disc( const float x, const float y, const float radius )
 void
 DebugDraw::Quad( const float x1, const float y1, const float x2, const float y2, const float x3, const float y3, const float x4, const float y4 )
 {
-    if( m_QuadRenderOp.vertexData->vertexCount + 6 > m_QuadMaxVertexCount )
+    if( IsSkipped() == true )
     {
-        LOG_ERROR( "Max number of quads reached. Can't create more than " + Ogre::StringConverter::toString( m_QuadMaxVertexCount / 6 ) + " quads." );
         return;
     }
 
-    float width = Ogre::Root::getSingleton().getRenderTarget( "QGearsWindow" )->getViewport( 0 )->getActualWidth();
-    float height = Ogre::Root::getSingleton().getRenderTarget( "QGearsWindow" )->getViewport( 0 )->getActualHeight();
-
-    float new_x1 = ( m_ScreenSpace == true ) ? ( ( int ) x1 / width ) * 2 - 1 : x1;
-    float new_y1 = ( m_ScreenSpace == true ) ? -( ( ( int ) y1 / height ) * 2 - 1 ) : y1;
-    float new_x2 = ( m_ScreenSpace == true ) ? ( ( int ) x2 / width ) * 2 - 1 : x2;
-    float new_y2 = ( m_ScreenSpace == true ) ? -( ( y2 / height ) * 2 - 1 ) : y2;
-    float new_x3 = ( m_ScreenSpace == true ) ? ( ( int ) x3 / width ) * 2 - 1 : x3;
-    float new_y3 = ( m_ScreenSpace == true ) ? -( ( ( int ) y3 / height ) * 2 - 1 ) : y3;
-    float new_x4 = ( m_ScreenSpace == true ) ? ( ( int ) x4 / width ) * 2 - 1 : x4;
-    float new_y4 = ( m_ScreenSpace == true ) ? -( ( ( int ) y4 / height ) * 2 - 1 ) : y4;
-
-    float* writeIterator = ( float* ) m_QuadVertexBuffer->lock( Ogre::HardwareBuffer::HBL_NORMAL );
-    writeIterator += m_QuadRenderOp.vertexData->vertexCount * 7;
-
-    *writeIterator++ = new_x1;
-    *writeIterator++ = new_y1;
-    *writeIterator++ = m_Z;
-    *writeIterator++ = m_Colour.r;
-    *writeIterator++ = m_Colour.g;
-    *writeIterator++ = m_Colour.b;
-    *writeIterator++ = m_Colour.a;
-
-    *writeIterator++ = new_x2;
-    *writeIterator++ = new_y2;
-    *writeIterator++ = m_Z;
-    *writeIterator++ = m_Colour.r;
-    *writeIterator++ = m_Colour.g;
-    *writeIterator++ = m_Colour.b;
-    *writeIterator++ = m_Colour.a;
-
-    *writeIterator++ = new_x3;
-    *writeIterator++ = new_y3;
-    *writeIterator++ = m_Z;
-    *writeIterator++ = m_Colour.r;
-    *writeIterator++ = m_Colour.g;
-    *writeIterator++ = m_Colour.b;
-    *writeIterator++ = m_Colour.a;
-
-    *writeIterator++ = new_x1;
-    *writeIterator++ = new_y1;
-    *writeIterator++ = m_Z;
-    *writeIterator++ = m_Colour.r;
-    *writeIterator++ = m_Colour.g;
-    *writeIterator++ = m_Colour.b;
-    *writeIterator++ = m_Colour.a;
-
-    *writeIterator++ = new_x3;
-    *writeIterator++ = new_y3;
-    *writeIterator++ = m_Z;
-    *writeIterator++ = m_Colour.r;
-    *writeIterator++ = m_Colour.g;
-    *writeIterator++ = m_Colour.b;
-    *writeIterator++ = m_Colour.a;
-
-    *writeIterator++ = new_x4;
-    *writeIterator++ = new_y4;
-    *writeIterator++ = m_Z;
-    *writeIterator++ = m_Colour.r;
-    *writeIterator++ = m_Colour.g;
-    *writeIterator++ = m_Colour.b;
-    *writeIterator++ = m_Colour.a;
-
-    m_QuadRenderOp.vertexData->vertexCount += 6;
-
-    m_QuadVertexBuffer->unlock();
+    Ogre::Viewport* viewport = m_Window->getViewport( 0 );
+    float width = viewport->getActualWidth();
+    float height = viewport->getActualHeight();
+
+    Ogre::Vector2 point1 = ToScreen( x1, y1, width, height );
+    Ogre::Vector2 point3 = ToScreen( x3, y3, width, height );
+
+    Buffer& buffer = m_Current->buffers[ DDB_QUAD ];
+    AddVertex( buffer, point1 );
+    AddVertex( buffer, ToScreen( x2, y2, width, height ) );
+    AddVertex( buffer, point3 );
+    AddVertex( buffer, point1 );
+    AddVertex( buffer, point3 );
+    AddVertex( buffer, ToScreen( x4, y4, width, height ) );
 }
 
 
@@ -506,17 +312,14 @@ DebugDraw::Quad( const float x1, const float y1, const float x2, const float y2,
 void
 DebugDraw::Text( const float x, const float y, const Ogre::String& text )
 {
-    if( m_TextRenderOp.vertexData->vertexCount + text.size() * 6 > m_TextMaxVertexCount )
+    if( IsSkipped() == true )
     {
-        LOG_ERROR( "Max number of text reached. Can't add text \"" + text + "\". Max number of letters is " + Ogre::StringConverter::toString( m_TextMaxVertexCount / 6 ) + "." );
         return;
     }
 
-    float* writeIterator = ( float* ) m_TextVertexBuffer->lock( Ogre::HardwareBuffer::HBL_NORMAL );
-    writeIterator += m_TextRenderOp.vertexData->vertexCount * 9;
-
-    float width = Ogre::Root::getSingleton().getRenderTarget( "QGearsWindow" )->getViewport( 0 )->getActualWidth();
-    float height = Ogre::Root::getSingleton().getRenderTarget( "QGearsWindow" )->getViewport( 0 )->getActualHeight();
+    Ogre::Viewport* viewport = m_Window->getViewport( 0 );
+    float width = viewport->getActualWidth();
+    float height = viewport->getActualHeight();
 
     float length = 0;
     if( m_TextAlignment != LEFT )
@@ -532,95 +335,32 @@ DebugDraw::Text( const float x, const float y, const Ogre::String& text )
         }
     }
 
-    float current_x = ( m_ScreenSpace == true ) ? ( ( int ) x / width ) * 2 - 1 : x;
-    current_x -= length;
-    float current_y =  ( m_ScreenSpace == true ) ? -( ( ( int ) y / height ) * 2 - 1 ) : y;
+    Ogre::Vector2 current = ToScreen( x, y, width, height );
+    current.x -= length;
     float char_height = -( m_FontHeight / height ) * 2;
 
+    Buffer& buffer = m_Current->buffers[ DDB_TEXT ];
+    buffer.vertices.reserve( buffer.vertices.size() + text.size() * 6 * buffer.vertex_size );
+
     for( size_t i = 0; i < text.size(); ++i )
     {
         float char_width = ( ( m_Font->getGlyphAspectRatio( text[ i ] ) * m_FontHeight ) / width ) * 2;
+        const Ogre::Font::UVRect& uv = m_Font->getGlyphTexCoords( text[ i ] );
 
-        float new_x1 = current_x;
-        float new_y1 = current_y;
-
-        float new_x2 = current_x + char_width;
-        float new_y2 = current_y;
-
-        float new_x3 = current_x + char_width;
-        float new_y3 = current_y + char_height;
-
-        float new_x4 = current_x;
-        float new_y4 = current_y + char_height;
-
-        current_x += char_width;
+        Ogre::Vector2 point1( current.x, current.y );
+        Ogre::Vector2 point2( current.x + char_width, current.y );
+        Ogre::Vector2 point3( current.x + char_width, current.y + char_height );
+        Ogre::Vector2 point4( current.x, current.y + char_height );
 
-        const Ogre::Font::UVRect& uv = m_Font->getGlyphTexCoords( text[ i ] );
+        AddVertex( buffer, point1, uv.left, uv.top );
+        AddVertex( buffer, point2, uv.right, uv.top );
+        AddVertex( buffer, point3, uv.right, uv.bottom );
+        AddVertex( buffer, point1, uv.left, uv.top );
+        AddVertex( buffer, point3, uv.right, uv.bottom );
+        AddVertex( buffer, point4, uv.left, uv.bottom );
 
-        *writeIterator++ = new_x1;
-        *writeIterator++ = new_y1;
-        *writeIterator++ = m_Z;
-        *writeIterator++ = m_Colour.r;
-        *writeIterator++ = m_Colour.g;
-        *writeIterator++ = m_Colour.b;
-        *writeIterator++ = m_Colour.a;
-        *writeIterator++ = uv.left;
-        *writeIterator++ = uv.top;
-
-        *writeIterator++ = new_x2;
-        *writeIterator++ = new_y2;
-        *writeIterator++ = m_Z;
-        *writeIterator++ = m_Colour.r;
-        *writeIterator++ = m_Colour.g;
-        *writeIterator++ = m_Colour.b;
-        *writeIterator++ = m_Colour.a;
-        *writeIterator++ = uv.right;
-        *writeIterator++ = uv.top;
-
-        *writeIterator++ = new_x3;
-        *writeIterator++ = new_y3;
-        *writeIterator++ = m_Z;
-        *writeIterator++ = m_Colour.r;
-        *writeIterator++ = m_Colour.g;
-        *writeIterator++ = m_Colour.b;
-        *writeIterator++ = m_Colour.a;
-        *writeIterator++ = uv.right;
-        *writeIterator++ = uv.bottom;
-
-        *writeIterator++ = new_x1;
-        *writeIterator++ = new_y1;
-        *writeIterator++ = m_Z;
-        *writeIterator++ = m_Colour.r;
-        *writeIterator++ = m_Colour.g;
-        *writeIterator++ = m_Colour.b;
-        *writeIterator++ = m_Colour.a;
-        *writeIterator++ = uv.left;
-        *writeIterator++ = uv.top;
-
-        *writeIterator++ = new_x3;
-        *writeIterator++ = new_y3;
-        *writeIterator++ = m_Z;
-        *writeIterator++ = m_Colour.r;
-        *writeIterator++ = m_Colour.g;
-        *writeIterator++ = m_Colour.b;
-        *writeIterator++ = m_Colour.a;
-        *writeIterator++ = uv.right;
-        *writeIterator++ = uv.bottom;
-
-        *writeIterator++ = new_x4;
-        *writeIterator++ = new_y4;
-        *writeIterator++ = m_Z;
-        *writeIterator++ = m_Colour.r;
-        *writeIterator++ = m_Colour.g;
-        *writeIterator++ = m_Colour.b;
-        *writeIterator++ = m_Colour.a;
-        *writeIterator++ = uv.left;
-        *writeIterator++ = uv.bottom;
-
-        m_TextRenderOp.vertexData->vertexCount += 6;
+        current.x += char_width;
     }
-
-    m_TextVertexBuffer->unlock();
 }
 
 
@@ -648,308 +388,292 @@ DebugDraw::Text( const Ogre::Vector3& point, const float x, const float y, const
 
 
 void
-DebugDraw::renderQueueEnded( Ogre::uint8 queueGroupId, const Ogre::String& invocation, bool& repeatThisInvocation )
+DebugDraw::BeginGroup( const Ogre::String& name )
 {
-    if( queueGroupId == Ogre::RENDER_QUEUE_OVERLAY )
+    if( m_Current != &m_Frame )
     {
-        m_RenderSystem->clearFrameBuffer( Ogre::FBT_DEPTH );
-        m_RenderSystem->_setWorldMatrix( Ogre::Matrix4::IDENTITY );
-        m_RenderSystem->_setViewMatrix( Ogre::Matrix4::IDENTITY );
-        Ogre::Matrix4 mat;
-        m_RenderSystem->_convertProjectionMatrix( Ogre::Matrix4::IDENTITY, mat );
-        m_RenderSystem->_setProjectionMatrix( mat );
-
-        if( m_LineRenderOp.vertexData->vertexCount != 0 )
-        {
-            m_SceneManager->_setPass( m_Material->getTechnique( 0 )->getPass( 0 ), true, false );
-            m_RenderSystem->_render( m_LineRenderOp );
-            m_LineRenderOp.vertexData->vertexCount = 0;
-        }
-
-        if( m_CircleRenderOp.vertexData->vertexCount != 0 )
-        {
-            m_SceneManager->_setPass( m_Material->getTechnique( 0 )->getPass( 0 ), true, false );
-            m_RenderSystem->_render( m_CircleRenderOp );
-            m_CircleRenderOp.vertexData->vertexCount = 0;
-        }
-
-        if( m_DiscRenderOp.vertexData->vertexCount != 0 )
-        {
-            m_SceneManager->_setPass( m_Material->getTechnique( 0 )->getPass( 0 ), true, false );
-            m_RenderSystem->_render( m_DiscRenderOp );
-            m_DiscRenderOp.vertexData->vertexCount = 0;
-        }
-
-        if( m_QuadRenderOp.vertexData->vertexCount != 0 )
-        {
-            m_SceneManager->_setPass( m_Material->getTechnique( 0 )->getPass( 0 ), true, false );
-            m_RenderSystem->_render( m_QuadRenderOp );
-            m_QuadRenderOp.vertexData->vertexCount = 0;
-        }
+        LOG_ERROR( "Can't begin debug draw group \"" + name + "\" inside other group." );
+        return;
+    }
 
-        if( m_TextRenderOp.vertexData->vertexCount != 0 )
-        {
-            m_SceneManager->_setPass( m_Font->getMaterial()->getTechnique( 0 )->getPass( 0 ), true, false );
-            m_RenderSystem->_render( m_TextRenderOp );
-            m_TextRenderOp.vertexData->vertexCount = 0;
-        }
+    std::map< Ogre::String, Group* >::iterator it = m_Groups.find( name );
+    Group* group = NULL;
+    if( it != m_Groups.end() )
+    {
+        group = it->second;
+        ClearBatch( group->batch, 0, DDB_MAX );
     }
-    else if( queueGroupId == Ogre::RENDER_QUEUE_MAIN )
+    else
     {
-        m_RenderSystem->_setWorldMatrix( Ogre::Matrix4::IDENTITY );
-        m_RenderSystem->_setViewMatrix( CameraManager::getSingleton().GetCurrentCamera()->getViewMatrix( true ) );
-        m_RenderSystem->_setProjectionMatrix( CameraManager::getSingleton().GetCurrentCamera()->getProjectionMatrixRS() );
-
-        if( m_Line3dRenderOp.vertexData->vertexCount != 0 )
-        {
-            m_SceneManager->_setPass( m_Material3d->getTechnique( 0 )->getPass( 0 ), true, false );
-            m_RenderSystem->_render( m_Line3dRenderOp );
-            m_Line3dRenderOp.vertexData->vertexCount = 0;
-        }
-
-        if( m_Triangle3dRenderOp.vertexData->vertexCount != 0 )
-        {
-            m_SceneManager->_setPass( m_Material3d->getTechnique( 0 )->getPass( 0 ), true, false );
-            m_RenderSystem->_render( m_Triangle3dRenderOp );
-            m_Triangle3dRenderOp.vertexData->vertexCount = 0;
-        }
+        group = new Group();
+        group->visible = true;
+        CreateBatch( group->batch );
+        m_Groups[ name ] = group;
     }
+
+    m_Current = &group->batch;
 }
 
 
 
 void
-DebugDraw::CreateLineVertexBuffer()
+DebugDraw::EndGroup()
 {
-    m_LineMaxVertexCount = 1024 * 2;
-    m_LineRenderOp.vertexData = new Ogre::VertexData;
-    m_LineRenderOp.vertexData->vertexStart = 0;
-
-    Ogre::VertexDeclaration* vDecl = m_LineRenderOp.vertexData->vertexDeclaration;
-
-    size_t offset = 0;
-    vDecl->addElement( 0, 0, Ogre::VET_FLOAT3, Ogre::VES_POSITION );
-    offset += Ogre::VertexElement::getTypeSize( Ogre::VET_FLOAT3 );
-    vDecl->addElement( 0, offset, Ogre::VET_FLOAT4, Ogre::VES_DIFFUSE );
-
-    m_LineVertexBuffer = Ogre::HardwareBufferManager::getSingletonPtr()->createVertexBuffer( vDecl->getVertexSize( 0 ), m_LineMaxVertexCount, Ogre::HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY, false );
-
-    m_LineRenderOp.vertexData->vertexBufferBinding->setBinding( 0, m_LineVertexBuffer );
-    m_LineRenderOp.operationType = Ogre::RenderOperation::OT_LINE_LIST;
-    m_LineRenderOp.useIndexes = false;
+    m_Current = &m_Frame;
 }
 
 
 
 void
-DebugDraw::DestroyLineVertexBuffer()
+DebugDraw::ClearGroup( const Ogre::String& name )
 {
-    delete m_LineRenderOp.vertexData;
-    m_LineRenderOp.vertexData = 0;
-    m_LineVertexBuffer.setNull();
-    m_LineMaxVertexCount = 0;
+    std::map< Ogre::String, Group* >::iterator it = m_Groups.find( name );
+    if( it == m_Groups.end() )
+    {
+        return;
+    }
+
+    if( m_Current == &it->second->batch )
+    {
+        m_Current = &m_Frame;
+    }
+    DestroyBatch( it->second->batch );
+    delete it->second;
+    m_Groups.erase( it );
 }
 
 
 
 void
-DebugDraw::CreateLine3dVertexBuffer()
+DebugDraw::SetGroupVisible( const Ogre::String& name, const bool visible )
 {
-    m_Line3dMaxVertexCount = 16384 * 2;
-    m_Line3dRenderOp.vertexData = new Ogre::VertexData;
-    m_Line3dRenderOp.vertexData->vertexStart = 0;
-
-    Ogre::VertexDeclaration* vDecl = m_Line3dRenderOp.vertexData->vertexDeclaration;
-
-    size_t offset = 0;
-    vDecl->addElement( 0, 0, Ogre::VET_FLOAT3, Ogre::VES_POSITION );
-    offset += Ogre::VertexElement::getTypeSize( Ogre::VET_FLOAT3 );
-    vDecl->addElement( 0, offset, Ogre::VET_FLOAT4, Ogre::VES_DIFFUSE );
-
-    m_Line3dVertexBuffer = Ogre::HardwareBufferManager::getSingletonPtr()->createVertexBuffer( vDecl->getVertexSize( 0 ), m_Line3dMaxVertexCount, Ogre::HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY, false );
+    std::map< Ogre::String, Group* >::iterator it = m_Groups.find( name );
+    if( it == m_Groups.end() )
+    {
+        LOG_ERROR( "Debug draw group \"" + name + "\" doesn't exist." );
+        return;
+    }
 
-    m_Line3dRenderOp.vertexData->vertexBufferBinding->setBinding( 0, m_Line3dVertexBuffer );
-    m_Line3dRenderOp.operationType = Ogre::RenderOperation::OT_LINE_LIST;
-    m_Line3dRenderOp.useIndexes = false;
+    it->second->visible = visible;
 }
 
 
-void
-DebugDraw::DestroyLine3dVertexBuffer()
+
+bool
+DebugDraw::IsGroup( const Ogre::String& name ) const
 {
-    delete m_Line3dRenderOp.vertexData;
-    m_Line3dRenderOp.vertexData = 0;
-    m_Line3dVertexBuffer.setNull();
-    m_Line3dMaxVertexCount = 0;
+    return m_Groups.find( name ) != m_Groups.end();
 }
 
 
 
 void
-DebugDraw::CreateTriangle3dVertexBuffer()
+DebugDraw::renderQueueEnded( Ogre::uint8 queueGroupId, const Ogre::String& invocation, bool& repeatThisInvocation )
 {
-    m_Triangle3dMaxVertexCount = 128 * 3;
-    m_Triangle3dRenderOp.vertexData = new Ogre::VertexData;
-    m_Triangle3dRenderOp.vertexData->vertexStart = 0;
+    if( queueGroupId == Ogre::RENDER_QUEUE_OVERLAY )
+    {
+        PROFILE_ZONE( "DebugDraw render" );
 
-    Ogre::VertexDeclaration* vDecl = m_Triangle3dRenderOp.vertexData->vertexDeclaration;
+        m_RenderSystem->clearFrameBuffer( Ogre::FBT_DEPTH );
+        m_RenderSystem->_setWorldMatrix( Ogre::Matrix4::IDENTITY );
+        m_RenderSystem->_setViewMatrix( Ogre::Matrix4::IDENTITY );
+        Ogre::Matrix4 mat;
+        m_RenderSystem->_convertProjectionMatrix( Ogre::Matrix4::IDENTITY, mat );
+        m_RenderSystem->_setProjectionMatrix( mat );
 
-    size_t offset = 0;
-    vDecl->addElement( 0, 0, Ogre::VET_FLOAT3, Ogre::VES_POSITION );
-    offset += Ogre::VertexElement::getTypeSize( Ogre::VET_FLOAT3 );
-    vDecl->addElement( 0, offset, Ogre::VET_FLOAT4, Ogre::VES_DIFFUSE );
+        for( std::map< Ogre::String, Group* >::iterator it = m_Groups.begin(); it != m_Groups.end(); ++it )
+        {
+            if( it->second->visible == true )
+            {
+                RenderBatch( it->second->batch, DDB_LINE, DDB_TEXT, false );
+            }
+        }
+        RenderBatch( m_Frame, DDB_LINE, DDB_TEXT, true );
+        ClearBatch( m_Frame, DDB_LINE, DDB_TEXT );
+    }
+    else if( queueGroupId == Ogre::RENDER_QUEUE_MAIN )
+    {
+        PROFILE_ZONE( "DebugDraw render 3d" );
 
-    m_Triangle3dVertexBuffer = Ogre::HardwareBufferManager::getSingletonPtr()->createVertexBuffer( vDecl->getVertexSize( 0 ), m_Triangle3dMaxVertexCount, Ogre::HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY, false );
+        m_RenderSystem->_setWorldMatrix( Ogre::Matrix4::IDENTITY );
+        m_RenderSystem->_setViewMatrix( CameraManager::getSingleton().GetCurrentCamera()->getViewMatrix( true ) );
+        m_RenderSystem->_setProjectionMatrix( CameraManager::getSingleton().GetCurrentCamera()->getProjectionMatrixRS() );
 
-    m_Triangle3dRenderOp.vertexData->vertexBufferBinding->setBinding( 0, m_Triangle3dVertexBuffer );
-    m_Triangle3dRenderOp.operationType = Ogre::RenderOperation::OT_TRIANGLE_LIST;
-    m_Triangle3dRenderOp.useIndexes = false;
+        for( std::map< Ogre::String, Group* >::iterator it = m_Groups.begin(); it != m_Groups.end(); ++it )
+        {
+            if( it->second->visible == true )
+            {
+                RenderBatch( it->second->batch, DDB_LINE3D, DDB_TRIANGLE3D, false );
+            }
+        }
+        RenderBatch( m_Frame, DDB_LINE3D, DDB_TRIANGLE3D, true );
+        ClearBatch( m_Frame, DDB_LINE3D, DDB_TRIANGLE3D );
+    }
 }
 
 
+
 void
-DebugDraw::DestroyTriangle3dVertexBuffer()
+DebugDraw::CreateBatch( Batch& batch )
 {
-    delete m_Triangle3dRenderOp.vertexData;
-    m_Triangle3dRenderOp.vertexData = 0;
-    m_Triangle3dVertexBuffer.setNull();
-    m_Triangle3dMaxVertexCount = 0;
+    for( int i = 0; i < DDB_MAX; ++i )
+    {
+        Buffer& buffer = batch.buffers[ i ];
+        buffer.render_op.vertexData = new Ogre::VertexData;
+        buffer.render_op.vertexData->vertexStart = 0;
+        buffer.render_op.vertexData->vertexCount = 0;
+
+        Ogre::VertexDeclaration* vDecl = buffer.render_op.vertexData->vertexDeclaration;
+
+        size_t offset = 0;
+        vDecl->addElement( 0, 0, Ogre::VET_FLOAT3, Ogre::VES_POSITION );
+        offset += Ogre::VertexElement::getTypeSize( Ogre::VET_FLOAT3 );
+        vDecl->addElement( 0, offset, Ogre::VET_FLOAT4, Ogre::VES_DIFFUSE );
+        offset += Ogre::VertexElement::getTypeSize( Ogre::VET_FLOAT4 );
+        if( i == DDB_TEXT )
+        {
+            vDecl->addElement( 0, offset, Ogre::VET_FLOAT2, Ogre::VES_TEXTURE_COORDINATES );
+        }
+
+        buffer.vertex_size = vDecl->getVertexSize( 0 ) / sizeof( float );
+        buffer.render_op.operationType = ( i == DDB_LINE || i == DDB_CIRCLE || i == DDB_LINE3D ) ? Ogre::RenderOperation::OT_LINE_LIST : Ogre::RenderOperation::OT_TRIANGLE_LIST;
+        buffer.render_op.useIndexes = false;
+        buffer.capacity = 0;
+        buffer.uploaded = true;
+    }
 }
 
 
 
 void
-DebugDraw::CreateCircleVertexBuffer()
+DebugDraw::DestroyBatch( Batch& batch )
 {
-    m_CircleMaxVertexCount = 16384 * 16;
-    m_CircleRenderOp.vertexData = new Ogre::VertexData;
-    m_CircleRenderOp.vertexData->vertexStart = 0;
-
-    Ogre::VertexDeclaration* vDecl = m_CircleRenderOp.vertexData->vertexDeclaration;
+    for( int i = 0; i < DDB_MAX; ++i )
+    {
+        Buffer& buffer = batch.buffers[ i ];
+        delete buffer.render_op.vertexData;
+        buffer.render_op.vertexData = 0;
+        buffer.hardware.setNull();
+        buffer.capacity = 0;
+        buffer.vertices.clear();
+    }
+}
 
-    size_t offset = 0;
-    vDecl->addElement( 0, 0, Ogre::VET_FLOAT3, Ogre::VES_POSITION );
-    offset += Ogre::VertexElement::getTypeSize( Ogre::VET_FLOAT3 );
-    vDecl->addElement( 0, offset, Ogre::VET_FLOAT4, Ogre::VES_DIFFUSE );
 
-    m_CircleVertexBuffer = Ogre::HardwareBufferManager::getSingletonPtr()->createVertexBuffer( vDecl->getVertexSize( 0 ), m_CircleMaxVertexCount, Ogre::HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY, false );
 
-    m_CircleRenderOp.vertexData->vertexBufferBinding->setBinding( 0, m_CircleVertexBuffer );
-    m_CircleRenderOp.operationType = Ogre::RenderOperation::OT_LINE_LIST;
-    m_CircleRenderOp.useIndexes = false;
+void
+DebugDraw::ClearBatch( Batch& batch, const int first, const int last )
+{
+    for( int i = first; i <= last; ++i )
+    {
+        // memory of vector stays so next frame adds without allocations
+        batch.buffers[ i ].vertices.clear();
+        batch.buffers[ i ].render_op.vertexData->vertexCount = 0;
+        batch.buffers[ i ].uploaded = true;
+    }
 }
 
 
 
 void
-DebugDraw::DestroyCircleVertexBuffer()
+DebugDraw::RenderBatch( Batch& batch, const int first, const int last, const bool dynamic )
 {
-    delete m_CircleRenderOp.vertexData;
-    m_CircleRenderOp.vertexData = 0;
-    m_CircleVertexBuffer.setNull();
-    m_CircleMaxVertexCount = 0;
+    for( int i = first; i <= last; ++i )
+    {
+        Buffer& buffer = batch.buffers[ i ];
+        UploadBuffer( buffer, dynamic );
+
+        if( buffer.render_op.vertexData->vertexCount != 0 )
+        {
+            Ogre::Pass* pass = ( i == DDB_TEXT ) ? m_Font->getMaterial()->getTechnique( 0 )->getPass( 0 ) : ( i >= DDB_LINE3D ) ? m_Material3d->getTechnique( 0 )->getPass( 0 ) : m_Material->getTechnique( 0 )->getPass( 0 );
+            m_SceneManager->_setPass( pass, true, false );
+            m_RenderSystem->_render( buffer.render_op );
+        }
+    }
 }
 
 
 
 void
-DebugDraw::CreateDiscVertexBuffer()
+DebugDraw::UploadBuffer( Buffer& buffer, const bool dynamic )
 {
-    m_DiscMaxVertexCount = 16384 * 24;
-    m_DiscRenderOp.vertexData = new Ogre::VertexData;
-    m_DiscRenderOp.vertexData->vertexStart = 0;
-
-    Ogre::VertexDeclaration* vDecl = m_DiscRenderOp.vertexData->vertexDeclaration;
+    if( buffer.uploaded == true )
+    {
+        return;
+    }
+    buffer.uploaded = true;
 
-    size_t offset = 0;
-    vDecl->addElement( 0, 0, Ogre::VET_FLOAT3, Ogre::VES_POSITION );
-    offset += Ogre::VertexElement::getTypeSize( Ogre::VET_FLOAT3 );
-    vDecl->addElement( 0, offset, Ogre::VET_FLOAT4, Ogre::VES_DIFFUSE );
+    unsigned int count = buffer.vertices.size() / buffer.vertex_size;
+    buffer.render_op.vertexData->vertexCount = count;
+    if( count == 0 )
+    {
+        return;
+    }
 
-    m_DiscVertexBuffer = Ogre::HardwareBufferManager::getSingletonPtr()->createVertexBuffer( vDecl->getVertexSize( 0 ), m_DiscMaxVertexCount, Ogre::HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY, false );
+    size_t vertex_bytes = buffer.vertex_size * sizeof( float );
+    if( count > buffer.capacity )
+    {
+        // grow with reserve so slowly growing number of primitives doesn't recreate buffer every frame
+        buffer.capacity = std::max( count, std::max( buffer.capacity * 2, ( unsigned int )1024 ) );
+        buffer.hardware = Ogre::HardwareBufferManager::getSingletonPtr()->createVertexBuffer( vertex_bytes, buffer.capacity, ( dynamic == true ) ? Ogre::HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY_DISCARDABLE : Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY, false );
+        buffer.render_op.vertexData->vertexBufferBinding->setBinding( 0, buffer.hardware );
+    }
 
-    m_DiscRenderOp.vertexData->vertexBufferBinding->setBinding( 0, m_DiscVertexBuffer );
-    m_DiscRenderOp.operationType = Ogre::RenderOperation::OT_TRIANGLE_LIST;
-    m_DiscRenderOp.useIndexes = false;
+    // one lock with discard for whole buffer
+    COUNTER_ADD( "vertex_buffer_locks", 1 );
+    buffer.hardware->writeData( 0, count * vertex_bytes, &buffer.vertices[ 0 ], true );
 }
 
 
 
-void
-DebugDraw::DestroyDiscVertexBuffer()
+bool
+DebugDraw::IsSkipped() const
 {
-    delete m_DiscRenderOp.vertexData;
-    m_DiscRenderOp.vertexData = 0;
-    m_DiscVertexBuffer.setNull();
-    m_DiscMaxVertexCount = 0;
+    // frame primitives are cleared only when window is drawn, don't collect them while it is not
+    return m_Current == &m_Frame && ( m_SkipFrame == true || m_Window->isActive() == false );
 }
 
 
 
-void
-DebugDraw::CreateQuadVertexBuffer()
+Ogre::Vector2
+DebugDraw::ToScreen( const float x, const float y, const float width, const float height ) const
 {
-    m_QuadMaxVertexCount = 16384 * 6;
-    m_QuadRenderOp.vertexData = new Ogre::VertexData;
-    m_QuadRenderOp.vertexData->vertexStart = 0;
-
-    Ogre::VertexDeclaration* vDecl = m_QuadRenderOp.vertexData->vertexDeclaration;
-
-    size_t offset = 0;
-    vDecl->addElement( 0, 0, Ogre::VET_FLOAT3, Ogre::VES_POSITION );
-    offset += Ogre::VertexElement::getTypeSize( Ogre::VET_FLOAT3 );
-    vDecl->addElement( 0, offset, Ogre::VET_FLOAT4, Ogre::VES_DIFFUSE );
-
-    m_QuadVertexBuffer = Ogre::HardwareBufferManager::getSingletonPtr()->createVertexBuffer( vDecl->getVertexSize( 0 ), m_QuadMaxVertexCount, Ogre::HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY, false );
-
-    m_QuadRenderOp.vertexData->vertexBufferBinding->setBinding( 0, m_QuadVertexBuffer );
-    m_QuadRenderOp.operationType = Ogre::RenderOperation::OT_TRIANGLE_LIST;
-    m_QuadRenderOp.useIndexes = false;
+    if( m_ScreenSpace == true )
+    {
+        return Ogre::Vector2( ( ( int )x / width ) * 2 - 1, -( ( ( int )y / height ) * 2 - 1 ) );
+    }
+    return Ogre::Vector2( x, y );
 }
 
 
 
 void
-DebugDraw::DestroyQuadVertexBuffer()
+DebugDraw::AddVertex( Buffer& buffer, const Ogre::Vector2& position )
 {
-    delete m_QuadRenderOp.vertexData;
-    m_QuadRenderOp.vertexData = 0;
-    m_QuadVertexBuffer.setNull();
-    m_QuadMaxVertexCount = 0;
+    AddVertex( buffer, Ogre::Vector3( position.x, position.y, m_Z ) );
 }
 
 
 
 void
-DebugDraw::CreateTextVertexBuffer()
+DebugDraw::AddVertex( Buffer& buffer, const Ogre::Vector3& position )
 {
-    m_TextMaxVertexCount = 16384 * 6;
-    m_TextRenderOp.vertexData = new Ogre::VertexData;
-    m_TextRenderOp.vertexData->vertexStart = 0;
-
-    Ogre::VertexDeclaration* vDecl = m_TextRenderOp.vertexData->vertexDeclaration;
-
-    size_t offset = 0;
-    vDecl->addElement( 0, 0, Ogre::VET_FLOAT3, Ogre::VES_POSITION );
-    offset += Ogre::VertexElement::getTypeSize( Ogre::VET_FLOAT3 );
-    vDecl->addElement( 0, offset, Ogre::VET_FLOAT4, Ogre::VES_DIFFUSE );
-    offset += Ogre::VertexElement::getTypeSize( Ogre::VET_FLOAT4 );
-    vDecl->addElement( 0, offset, Ogre::VET_FLOAT2, Ogre::VES_TEXTURE_COORDINATES );
-
-    m_TextVertexBuffer = Ogre::HardwareBufferManager::getSingletonPtr()->createVertexBuffer( vDecl->getVertexSize( 0 ), m_TextMaxVertexCount, Ogre::HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY, false );
-
-    m_TextRenderOp.vertexData->vertexBufferBinding->setBinding( 0, m_TextVertexBuffer );
-    m_TextRenderOp.operationType = Ogre::RenderOperation::OT_TRIANGLE_LIST;
-    m_TextRenderOp.useIndexes = false;
+    buffer.vertices.push_back( position.x );
+    buffer.vertices.push_back( position.y );
+    buffer.vertices.push_back( position.z );
+    buffer.vertices.push_back( m_Colour.r );
+    buffer.vertices.push_back( m_Colour.g );
+    buffer.vertices.push_back( m_Colour.b );
+    buffer.vertices.push_back( m_Colour.a );
+    buffer.uploaded = false;
 }
 
 
 
 void
-DebugDraw::DestroyTextVertexBuffer()
+DebugDraw::AddVertex( Buffer& buffer, const Ogre::Vector2& position, const float u, const float v )
 {
-    delete m_TextRenderOp.vertexData;
-    m_TextRenderOp.vertexData = 0;
-    m_TextVertexBuffer.setNull();
-    m_TextMaxVertexCount = 0;
+    AddVertex( buffer, Ogre::Vector3( position.x, position.y, m_Z ) );
+    buffer.vertices.push_back( u );
+    buffer.vertices.push_back( v );
 }
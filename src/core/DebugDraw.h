@@ -6,6 +6,9 @@
 #include <OgreRenderQueueListener.h>
 #include <OgreRoot.h>
 #include <OgreSingleton.h>
+#include <OgreVector2.h>
+#include <map>
+#include <vector>
 
 
 
@@ -19,6 +22,9 @@ public:
     void SetScreenSpace( const bool screen_space );
     void SetZ( const float z );
     void SetFadeDistance( const float fade_s, const float fade_e );
+    // frame primitives are not collected, used when ticks run without drawing
+    void SetSkipFrame( const bool skip );
+    void SetFont( const Ogre::String& name, const bool sdf );
 
     enum TextAlignment
     {
@@ -37,62 +43,78 @@ public:
     void Text( const float x1, const float y1, const Ogre::String& text );
     void Text( const Ogre::Vector3& point, const float x, const float y, const Ogre::String& text );
 
+    // primitives added between BeginGroup and EndGroup are kept in named group
+    // and drawn every frame until group is cleared, so static overlays are
+    // uploaded once instead of being added every frame. Begin of existing
+    // group replaces its content.
+    void BeginGroup( const Ogre::String& name );
+    void EndGroup();
+    void ClearGroup( const Ogre::String& name );
+    void SetGroupVisible( const Ogre::String& name, const bool visible );
+    bool IsGroup( const Ogre::String& name ) const;
+
     void renderQueueEnded( Ogre::uint8 queueGroupId, const Ogre::String& invocation, bool& repeatThisInvocation );
 
 private:
-    void CreateLineVertexBuffer();
-    void DestroyLineVertexBuffer();
-    void CreateLine3dVertexBuffer();
-    void DestroyLine3dVertexBuffer();
-    void CreateTriangle3dVertexBuffer();
-    void DestroyTriangle3dVertexBuffer();
-    void CreateCircleVertexBuffer();
-    void DestroyCircleVertexBuffer();
-    void CreateDiscVertexBuffer();
-    void DestroyDiscVertexBuffer();
-    void CreateQuadVertexBuffer();
-    void DestroyQuadVertexBuffer();
-    void CreateTextVertexBuffer();
-    void DestroyTextVertexBuffer();
+    void InitCmd();
+
+    enum BufferType
+    {
+        DDB_LINE,
+        DDB_CIRCLE,
+        DDB_DISC,
+        DDB_QUAD,
+        DDB_TEXT,
+        DDB_LINE3D,
+        DDB_TRIANGLE3D,
+        DDB_MAX
+    };
+
+    // vertices are collected on cpu side and copied to hardware buffer with
+    // one lock when buffer is drawn, hardware buffer grows when needed
+    struct Buffer
+    {
+        std::vector< float >                vertices;
+        unsigned int                        vertex_size; // in floats
+        Ogre::RenderOperation               render_op;
+        Ogre::HardwareVertexBufferSharedPtr hardware;
+        unsigned int                        capacity; // in vertices
+        bool                                uploaded; // hardware buffer has same data as vertices
+    };
+
+    struct Batch
+    {
+        Buffer buffers[ DDB_MAX ];
+    };
+
+    struct Group
+    {
+        Batch batch;
+        bool  visible;
+    };
+
+    void CreateBatch( Batch& batch );
+    void DestroyBatch( Batch& batch );
+    void ClearBatch( Batch& batch, const int first, const int last );
+    void RenderBatch( Batch& batch, const int first, const int last, const bool dynamic );
+    void UploadBuffer( Buffer& buffer, const bool dynamic );
+
+    bool IsSkipped() const;
+    Ogre::Vector2 ToScreen( const float x, const float y, const float width, const float height ) const;
+    void AddVertex( Buffer& buffer, const Ogre::Vector2& position );
+    void AddVertex( Buffer& buffer, const Ogre::Vector3& position );
+    void AddVertex( Buffer& buffer, const Ogre::Vector2& position, const float u, const float v );
 
 private:
     Ogre::SceneManager* m_SceneManager;
     Ogre::RenderSystem* m_RenderSystem;
+    Ogre::RenderTarget* m_Window;
+
+    Batch                               m_Frame; // cleared after every draw
+    std::map< Ogre::String, Group* >    m_Groups;
+    Batch*                              m_Current; // where primitives are added now
+    bool                                m_SkipFrame;
 
-    // line
-    Ogre::RenderOperation               m_LineRenderOp;
-    Ogre::HardwareVertexBufferSharedPtr m_LineVertexBuffer;
-    unsigned int                        m_LineMaxVertexCount;
-
-    // line3d
-    Ogre::RenderOperation               m_Line3dRenderOp;
-    Ogre::HardwareVertexBufferSharedPtr m_Line3dVertexBuffer;
-    unsigned int                        m_Line3dMaxVertexCount;
-
-    // triangle3d
-    Ogre::RenderOperation               m_Triangle3dRenderOp;
-    Ogre::HardwareVertexBufferSharedPtr m_Triangle3dVertexBuffer;
-    unsigned int                        m_Triangle3dMaxVertexCount;
-
-    // circle
-    Ogre::RenderOperation               m_CircleRenderOp;
-    Ogre::HardwareVertexBufferSharedPtr m_CircleVertexBuffer;
-    unsigned int                        m_CircleMaxVertexCount;
-
-    // circle
-    Ogre::RenderOperation               m_DiscRenderOp;
-    Ogre::HardwareVertexBufferSharedPtr m_DiscVertexBuffer;
-    unsigned int                        m_DiscMaxVertexCount;
-
-    // quad
-    Ogre::RenderOperation               m_QuadRenderOp;
-    Ogre::HardwareVertexBufferSharedPtr m_QuadVertexBuffer;
-    unsigned int                        m_QuadMaxVertexCount;
-
-    // text
-    Ogre::RenderOperation               m_TextRenderOp;
-    Ogre::HardwareVertexBufferSharedPtr m_TextVertexBuffer;
-    unsigned int                        m_TextMaxVertexCount;
     Ogre::FontPtr                       m_Font;
     int                                 m_FontHeight;
     TextAlignment                       m_TextAlignment;
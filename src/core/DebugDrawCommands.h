@@ -0,0 +1,24 @@
+#include "ConfigCmdManager.h"
+#include "Console.h"
+
+
+
+void
+CmdDebugDrawFont( const Ogre::StringVector& params )
+{
+    if( params.size() < 2 )
+    {
+        Console::getSingleton().AddTextToOutput( "Usage: /debug_draw_font <font name> [sdf]" );
+        return;
+    }
+
+    DebugDraw::getSingleton().SetFont( params[ 1 ], params.size() > 2 && params[ 2 ] == "sdf" );
+}
+
+
+
+void
+DebugDraw::InitCmd()
+{
+    ConfigCmdManager::getSingleton().AddCommand( "debug_draw_font", "Set ogre font used for debug text, sdf for distance field fonts", "", CmdDebugDrawFont, NULL );
+}
@@ -32,7 +32,8 @@ struct Event
         param2( 0 ),
         param3( 0 ),
         param4( 0 ),
-        event( "" )
+        event( "" ),
+        time( 0 )
     {
     };
 
@@ -43,6 +44,24 @@ struct Event
     float param3;
     float param4;
     Ogre::String event;
+    unsigned long long time; // microseconds when event happened, same clock as profiler
+};
+
+
+
+// mask of event types listener receives
+#define EVENT_MASK( type ) ( 1 << ( type ) )
+#define EVENT_MASK_ALL 0xffffffff
+
+
+
+// subscribed to InputManager, gets events of its mask in order they happened
+class InputListener
+{
+public:
+    virtual ~InputListener() {}
+
+    virtual void Input( const Event& event ) = 0;
 };
 
 
@@ -0,0 +1,105 @@
+#include "FrameBudget.h"
+
+#include <algorithm>
+#include <boost/thread.hpp>
+
+#include "Benchmark.h"
+#include "ConfigVar.h"
+#include "Counters.h"
+#include "Profiler.h"
+#include "Recorder.h"
+
+
+
+template<>FrameBudget* Ogre::Singleton< FrameBudget >::msSingleton = NULL;
+
+ConfigVarInt cv_frame_fps_max( "frame_fps_max", "Max frames per second, 0 - no limit", 0 );
+ConfigVarFloat cv_frame_time_target( "frame_time_target", "Milliseconds of frame above which budgets are lowered, 0 - budgets are not scaled", 16.6f );
+ConfigVarFloat cv_frame_budget_path( "frame_budget_path", "Milliseconds per frame for path requests, 0 - no limit", 2.0f );
+ConfigVarFloat cv_frame_budget_script( "frame_budget_script", "Milliseconds per frame for script resumes of each domain, 0 - no limit", 4.0f );
+ConfigVarFloat cv_frame_budget_ui( "frame_budget_ui", "Milliseconds per frame for ui geometry rebuild, 0 - no limit", 2.0f );
+
+// budgets are not scaled below this part
+const float FRAME_BUDGET_SCALE_MIN = 0.25f;
+const unsigned long long FRAME_BUDGET_NO_LIMIT = ( unsigned long long )-1;
+
+
+
+FrameBudget::FrameBudget():
+    m_FrameStart( Profiler::GetTime() ),
+    m_Scale( 1.0f )
+{
+}
+
+
+
+FrameBudget::~FrameBudget()
+{
+}
+
+
+
+void
+FrameBudget::BeginFrame()
+{
+    // previous frame without time spent waiting for fps cap
+    unsigned long long time = Profiler::GetTime();
+    unsigned long long frame_time = time - m_FrameStart;
+
+    float target = cv_frame_time_target.Get();
+    if( target > 0 )
+    {
+        if( frame_time > target * 1000.0f )
+        {
+            m_Scale = std::max( FRAME_BUDGET_SCALE_MIN, m_Scale * 0.9f );
+        }
+        else
+        {
+            m_Scale = std::min( 1.0f, m_Scale * 1.05f );
+        }
+    }
+    else
+    {
+        m_Scale = 1.0f;
+    }
+    COUNTER_SET( "frame_budget_scale", m_Scale );
+
+    int fps_max = cv_frame_fps_max.Get();
+    if( fps_max > 0 )
+    {
+        unsigned long long frame_min = 1000000 / fps_max;
+        if( frame_time < frame_min )
+        {
+            boost::this_thread::sleep_for( boost::chrono::microseconds( frame_min - frame_time ) );
+            time = Profiler::GetTime();
+        }
+    }
+
+    m_FrameStart = time;
+}
+
+
+
+unsigned long long
+FrameBudget::GetDeadline( const Work work ) const
+{
+    // simulation must go same way in record and its replay, so only ui can be moved then
+    if( work != UI && ( Recorder::getSingleton().IsRecording() == true || Recorder::getSingleton().IsReplaying() == true ) )
+    {
+        return FRAME_BUDGET_NO_LIMIT;
+    }
+
+    // scenario measures whole work, not part of it which fits in budget
+    if( Benchmark::getSingleton().IsRunning() == true )
+    {
+        return FRAME_BUDGET_NO_LIMIT;
+    }
+
+    float budget = ( work == PATH ) ? cv_frame_budget_path.Get() : ( work == SCRIPT ) ? cv_frame_budget_script.Get() : cv_frame_budget_ui.Get();
+    if( budget <= 0 )
+    {
+        return FRAME_BUDGET_NO_LIMIT;
+    }
+
+    return Profiler::GetTime() + ( unsigned long long )( budget * m_Scale * 1000.0f );
+}
@@ -0,0 +1,39 @@
+#ifndef FRAME_BUDGET_H
+#define FRAME_BUDGET_H
+
+#include <OgreSingleton.h>
+
+
+
+// Time limits for work which can be moved to next frame. Each kind of work
+// gets its budget from cvar, work started after deadline is left for next
+// frame. Budgets are scaled down while frames take longer than target time
+// and go back when frames are fast again. Optional fps cap waits at start
+// of frame so fast frames don't take whole cpu.
+class FrameBudget : public Ogre::Singleton< FrameBudget >
+{
+public:
+    enum Work
+    {
+        PATH,   // path requests of units
+        SCRIPT, // script resumes
+        UI      // ui geometry rebuilds
+    };
+
+    FrameBudget();
+    virtual ~FrameBudget();
+
+    // called at start of frame before any work
+    void BeginFrame();
+
+    // time (Profiler::GetTime) after which work started now must stop
+    unsigned long long GetDeadline( const Work work ) const;
+
+private:
+    unsigned long long m_FrameStart;
+    float m_Scale; // budgets multiplier
+};
+
+
+
+#endif // FRAME_BUDGET_H
@@ -5,10 +5,14 @@
 #include "CameraManager.h"
 #include "ConfigVar.h"
 #include "Console.h"
+#include "Counters.h"
 #include "DebugDraw.h"
+#include "FrameBudget.h"
 #include "../game/EntityManager.h"
 #include "InputManager.h"
 #include "Logger.h"
+#include "Profiler.h"
+#include "Recorder.h"
 #include "ScriptManager.h"
 #include "Timer.h"
 #include "UiManager.h"
@@ -46,6 +50,12 @@ GameFrameListener::GameFrameListener( Ogre::RenderWindow* win ):
     m_Mouse->setEventCallback( this );
     windowResized( m_Window );
 
+    // console gets everything, game gets only events it handles and only while console is hidden
+    InputManager::getSingleton().AddListener( Console::getSingletonPtr(), EVENT_MASK_ALL, true );
+    InputManager::getSingleton().AddListener( ScriptManager::getSingletonPtr(), EVENT_MASK( ET_PRESS ) | EVENT_MASK( ET_REPEAT_WAIT ), false );
+    InputManager::getSingleton().AddListener( CameraManager::getSingletonPtr(), EVENT_MASK( ET_REPEAT ) | EVENT_MASK( ET_MOUSE_SCROLL ), false );
+    InputManager::getSingleton().AddListener( EntityManager::getSingletonPtr(), EVENT_MASK( ET_REPEAT ) | EVENT_MASK( ET_MOUSE_PRESS ) | EVENT_MASK( ET_MOUSE_RELEASE ) | EVENT_MASK( ET_MOUSE_MOVE ) | EVENT_MASK( ET_MOUSE_SCROLL ), false );
+
     //Register as a Window listener
     Ogre::WindowEventUtilities::addWindowEventListener( m_Window, this );
 }
@@ -54,6 +64,11 @@ GameFrameListener::GameFrameListener( Ogre::RenderWindow* win ):
 
 GameFrameListener::~GameFrameListener()
 {
+    InputManager::getSingleton().RemoveListener( EntityManager::getSingletonPtr() );
+    InputManager::getSingleton().RemoveListener( CameraManager::getSingletonPtr() );
+    InputManager::getSingleton().RemoveListener( ScriptManager::getSingletonPtr() );
+    InputManager::getSingleton().RemoveListener( Console::getSingletonPtr() );
+
     m_InputManager->destroyInputObject( m_Keyboard );
     m_InputManager->destroyInputObject( m_Mouse );
 
@@ -69,13 +84,50 @@ GameFrameListener::~GameFrameListener()
 bool
 GameFrameListener::frameStarted( const Ogre::FrameEvent& evt )
 {
-    Timer::getSingleton().AddTime( evt.timeSinceLastFrame );
-
     if( g_ApplicationState == QG_EXIT )
     {
         return false;
     }
 
+    // headless replay runs all its ticks inside this frame without drawing
+    if( Recorder::getSingleton().IsHeadless() == true )
+    {
+        DEBUG_DRAW.SetSkipFrame( true );
+        while( Recorder::getSingleton().IsHeadless() == true && g_ApplicationState != QG_EXIT )
+        {
+            Profiler::getSingleton().BeginFrame();
+            Counters::getSingleton().Update();
+            Ogre::WindowEventUtilities::messagePump();
+            UpdateTick( evt.timeSinceLastFrame );
+        }
+        DEBUG_DRAW.SetSkipFrame( false );
+        return true;
+    }
+
+    // adapt budgets to previous frame and wait for fps cap
+    FrameBudget::getSingleton().BeginFrame();
+
+    // collect zones of previous frame including render
+    Profiler::getSingleton().BeginFrame();
+    Counters::getSingleton().Update();
+    const Ogre::RenderTarget::FrameStats& stats = m_Window->getStatistics();
+    COUNTER_SET( "render_batches", ( float )stats.batchCount );
+    COUNTER_SET( "render_triangles", ( float )stats.triangleCount );
+    UpdateTick( evt.timeSinceLastFrame );
+
+    return true;
+}
+
+
+
+void
+GameFrameListener::UpdateTick( const float delta )
+{
+    PROFILE_ZONE( "GameFrameListener::UpdateTick" );
+
+    // replay gives recorded time instead of real one
+    Timer::getSingleton().AddTime( Recorder::getSingleton().BeginTick( delta ) );
+
     if( m_Keyboard )
     {
         m_Keyboard->capture();
@@ -87,32 +139,20 @@ GameFrameListener::frameStarted( const Ogre::FrameEvent& evt )
     }
 
     InputManager::getSingleton().Update();
-    static InputEventArray input_event_array;
-    input_event_array.clear();
-    InputManager::getSingleton().GetInputEvents( input_event_array );
-
-    bool console_active = Console::getSingleton().IsVisible();
-
-    for( unsigned int i = 0; i < input_event_array.size(); ++i )
-    {
-        Console::getSingleton().Input( input_event_array[ i ] );
-
-        if( console_active != true )
-        {
-            ScriptManager::getSingleton().Input( input_event_array[ i ] );
-            CameraManager::getSingleton().Input( input_event_array[ i ] );
-            EntityManager::getSingleton().Input( input_event_array[ i ] );
-        }
-    }
+    InputManager::getSingleton().Dispatch();
 
     Console::getSingleton().Update();
 
+    // entity scripts may be updated in worker thread while ui and camera updated
+    ScriptManager::getSingleton().UpdateDebug();
     ScriptManager::getSingleton().Update( ScriptManager::SYSTEM );
+    ScriptManager::getSingleton().UpdateAsync( ScriptManager::ENTITY );
     UiManager::getSingleton().Update();
     CameraManager::getSingleton().Update();
+    ScriptManager::getSingleton().UpdateWait( ScriptManager::ENTITY );
     EntityManager::getSingleton().Update();
 
-    return true;
+    Recorder::getSingleton().EndTick( EntityManager::getSingleton().GetStateHash() );
 }
 
 
@@ -29,6 +29,10 @@ public:
     bool         mousePressed( const OIS::MouseEvent &e, OIS::MouseButtonID id );
     bool         mouseReleased( const OIS::MouseEvent &e, OIS::MouseButtonID id );
 
+protected:
+    // one step of game, headless replay runs many of them in one frame
+    void         UpdateTick( const float delta );
+
 protected:
     Ogre::RenderWindow* m_Window;
 
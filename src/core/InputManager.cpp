@@ -1,8 +1,13 @@
 #include "InputManager.h"
 #include "InputManagerCommands.h"
 
+#include <OgreStringConverter.h>
+#include <algorithm>
+
 #include "Console.h"
 #include "Logger.h"
+#include "Profiler.h"
+#include "Recorder.h"
 #include "Timer.h"
 
 
@@ -13,8 +18,18 @@ template<>InputManager *Ogre::Singleton< InputManager >::msSingleton = NULL;
 
 InputManager::InputManager():
     m_RepeatFirstWait( true ),
-    m_RepeatTimer( 0 )
+    m_RepeatTimer( 0 ),
+
+    m_RingMask( 1023 ),
+    m_RingWrite( 0 ),
+    m_RingRead( 0 ),
+    m_Dropped( 0 ),
+
+    m_MouseMoveValid( false )
 {
+    // size must be power of two
+    m_Ring.resize( m_RingMask + 1 );
+
     InitCmd();
 
     Reset();
@@ -34,7 +49,9 @@ InputManager::Reset()
     for( int button = 0; button < 256; ++button )
     {
         m_ButtonState[ button ] = false;
+        m_RepeatValid[ button ] = false;
     }
+    m_ButtonsPressed.clear();
 }
 
 
@@ -46,18 +63,27 @@ InputManager::ButtonPressed( const int button, const char text, const bool down
     {
         m_ButtonState[ button ] = down;
         m_ButtonText[ button ] = text;
+        if( down == true )
+        {
+            m_ButtonsPressed.push_back( button );
+        }
+        else
+        {
+            m_ButtonsPressed.erase( std::remove( m_ButtonsPressed.begin(), m_ButtonsPressed.end(), button ), m_ButtonsPressed.end() );
+        }
 
         Event event;
         event.type = ( down == true ) ? ET_PRESS : ET_RELEASE;
         event.button = button;
         event.param1 = text;
-        m_EventQueue.push_back( event );
+        PushEvent( event );
 
         m_RepeatFirstWait = true;
         m_RepeatTimer = 0;
     }
 
-    if( Console::getSingleton().IsVisible() != true )
+    // during replay binds come from record as commands
+    if( Console::getSingleton().IsVisible() != true && Recorder::getSingleton().IsReplaying() == false )
     {
         if( down == true )
         {
@@ -83,7 +109,7 @@ InputManager::MousePressed( const int x, const int x_abs, const int y, const int
     event.param2 = y;
     event.param3 = x_abs;
     event.param4 = y_abs;
-    m_EventQueue.push_back( event );
+    PushEvent( event );
 }
 
 
@@ -97,7 +123,7 @@ InputManager::MouseMoved( const int x, const int x_abs, const int y, const int y
     event.param2 = y;
     event.param3 = x_abs;
     event.param4 = y_abs;
-    m_EventQueue.push_back( event );
+    PushEvent( event );
 }
 
 
@@ -108,7 +134,7 @@ InputManager::MouseScrolled( const int value )
     Event event;
     event.type = ET_MOUSE_SCROLL;
     event.param1 = value;
-    m_EventQueue.push_back( event );
+    PushEvent( event );
 }
 
 
@@ -116,24 +142,34 @@ InputManager::MouseScrolled( const int value )
 void
 InputManager::Update()
 {
+    PROFILE_ZONE( "InputManager::Update" );
+
+    // all moves captured this frame are written as one event
+    FlushMouseMove();
+
+    if( m_Dropped > 0 )
+    {
+        LOG_WARNING( "Input event ring is full, " + Ogre::StringConverter::toString( m_Dropped ) + " events dropped." );
+        m_Dropped = 0;
+    }
+
     m_RepeatTimer += Timer::getSingleton().GetSystemTimeDelta();
 
     if( ( m_RepeatFirstWait == true && m_RepeatTimer >= 0.5 ) || ( m_RepeatFirstWait == false && m_RepeatTimer >= 0.05 ) )
     {
-        for( int button = 0; button < 256; ++button )
+        for( unsigned int i = 0; i < m_ButtonsPressed.size(); ++i )
         {
-            if( m_ButtonState[ button ] == true )
-            {
-                Event event;
-                event.type = ET_REPEAT_WAIT;
-                event.button = button;
-                event.param1 = m_ButtonText[ button ];
-                m_EventQueue.push_back( event );
+            int button = m_ButtonsPressed[ i ];
 
-                if( Console::getSingleton().IsVisible() != true )
-                {
-                    AddGameEvents( button, ET_REPEAT_WAIT );
-                }
+            Event event;
+            event.type = ET_REPEAT_WAIT;
+            event.button = button;
+            event.param1 = m_ButtonText[ button ];
+            PushEvent( event );
+
+            if( Console::getSingleton().IsVisible() != true )
+            {
+                AddGameEvents( button, ET_REPEAT_WAIT );
             }
         }
 
@@ -141,20 +177,30 @@ InputManager::Update()
         m_RepeatTimer = 0;
     }
 
-    for( int button = 0; button < 256; ++button )
+    // only held buttons give one repeat per frame. Repeat which consumer
+    // didn't read yet stands for this frame too, so ring has at most one
+    // repeat of each button, same as mouse moves are merged
+    unsigned int read = m_RingRead.load( boost::memory_order_acquire );
+    for( unsigned int i = 0; i < m_ButtonsPressed.size(); ++i )
     {
-        if( m_ButtonState[ button ] == true )
+        int button = m_ButtonsPressed[ i ];
+
+        if( m_RepeatValid[ button ] == true && ( int )( m_RepeatPosition[ button ] - read ) >= 0 )
         {
-            Event event;
-            event.type = ET_REPEAT;
-            event.button = button;
-            event.param1 = m_ButtonText[ button ];
-            m_EventQueue.push_back( event );
+            continue;
+        }
 
-            if( Console::getSingleton().IsVisible() != true )
-            {
-                AddGameEvents( button, ET_REPEAT );
-            }
+        Event event;
+        event.type = ET_REPEAT;
+        event.button = button;
+        event.param1 = m_ButtonText[ button ];
+        PushEvent( event );
+        m_RepeatPosition[ button ] = m_RingWrite.load( boost::memory_order_relaxed ) - 1;
+        m_RepeatValid[ button ] = true;
+
+        if( Console::getSingleton().IsVisible() != true )
+        {
+            AddGameEvents( button, ET_REPEAT );
         }
     }
 }
@@ -169,20 +215,186 @@ InputManager::IsButtonPressed( const int button ) const
 
 
 
+bool
+InputManager::PopEvent( Event& event )
+{
+    unsigned int read = m_RingRead.load( boost::memory_order_relaxed );
+    if( read == m_RingWrite.load( boost::memory_order_acquire ) )
+    {
+        return false;
+    }
+
+    event = m_Ring[ read & m_RingMask ];
+    m_RingRead.store( read + 1, boost::memory_order_release );
+    return true;
+}
+
+
+
 void
 InputManager::GetInputEvents( InputEventArray& input_events )
 {
-    input_events = m_EventQueue;
-    m_EventQueue.clear();
+    Event event;
+    while( PopEvent( event ) == true )
+    {
+        input_events.push_back( event );
+    }
+}
+
+
+
+void
+InputManager::Dispatch()
+{
+    PROFILE_ZONE( "InputManager::Dispatch" );
+
+    Event event;
+
+    // devices are ignored during replay, game gets recorded input
+    if( Recorder::getSingleton().IsReplaying() == true )
+    {
+        while( PopEvent( event ) == true )
+        {
+        }
+        Recorder::getSingleton().ReplayInput();
+        return;
+    }
+
+    // console opened by this events still passes rest of them to game
+    bool console_visible = Console::getSingleton().IsVisible();
+
+    while( PopEvent( event ) == true )
+    {
+        // only events that go to game are needed to repeat it
+        if( console_visible == false )
+        {
+            Recorder::getSingleton().RecordEvent( event );
+        }
+
+        DispatchEvent( event, console_visible );
+    }
+}
+
+
+
+void
+InputManager::DispatchReplayEvent( const Event& event )
+{
+    for( unsigned int i = 0; i < m_Listeners.size(); ++i )
+    {
+        const ListenerInfo& info = m_Listeners[ i ];
+        if( ( info.mask & EVENT_MASK( event.type ) ) != 0 && info.console == false )
+        {
+            info.listener->Input( event );
+        }
+    }
+}
+
+
+
+void
+InputManager::DispatchEvent( const Event& event, const bool console_visible )
+{
+    for( unsigned int i = 0; i < m_Listeners.size(); ++i )
+    {
+        const ListenerInfo& info = m_Listeners[ i ];
+        if( ( info.mask & EVENT_MASK( event.type ) ) != 0 && ( console_visible == false || info.console == true ) )
+        {
+            info.listener->Input( event );
+        }
+    }
+}
+
+
+
+void
+InputManager::AddListener( InputListener* listener, const unsigned int mask, const bool console )
+{
+    ListenerInfo info;
+    info.listener = listener;
+    info.mask = mask;
+    info.console = console;
+    m_Listeners.push_back( info );
+}
+
+
+
+void
+InputManager::RemoveListener( InputListener* listener )
+{
+    for( unsigned int i = 0; i < m_Listeners.size(); ++i )
+    {
+        if( m_Listeners[ i ].listener == listener )
+        {
+            m_Listeners.erase( m_Listeners.begin() + i );
+            return;
+        }
+    }
+}
+
+
+
+void
+InputManager::PushEvent( Event& event )
+{
+    event.time = Profiler::GetTime();
+
+    if( event.type == ET_MOUSE_MOVE )
+    {
+        // relative moves are summed, absolute position is last one
+        if( m_MouseMoveValid == true )
+        {
+            event.param1 += m_MouseMove.param1;
+            event.param2 += m_MouseMove.param2;
+        }
+        m_MouseMove = event;
+        m_MouseMoveValid = true;
+        return;
+    }
+
+    // keep order of move and other events
+    FlushMouseMove();
+    WriteEvent( event );
+}
+
+
+
+void
+InputManager::FlushMouseMove()
+{
+    if( m_MouseMoveValid == false )
+    {
+        return;
+    }
+
+    m_MouseMoveValid = false;
+    WriteEvent( m_MouseMove );
+}
+
+
+
+void
+InputManager::WriteEvent( const Event& event )
+{
+    unsigned int write = m_RingWrite.load( boost::memory_order_relaxed );
+    if( write - m_RingRead.load( boost::memory_order_acquire ) > m_RingMask )
+    {
+        ++m_Dropped;
+        return;
+    }
+
+    m_Ring[ write & m_RingMask ] = event;
+    m_RingWrite.store( write + 1, boost::memory_order_release );
 }
 
 
 
 void
-InputManager::BindCommand( ConfigCmd* cmd, const Ogre::StringVector& params, const ButtonList& buttons )
+InputManager::BindCommand( ConfigCmd* cmd, const Ogre::String& line, const Ogre::StringVector& params, const ButtonList& buttons )
 {
     BindInfo info;
     info.cmd = cmd;
+    info.line = line;
     info.params = params;
     info.buttons = buttons;
     m_Binds.push_back( info );
@@ -245,7 +457,9 @@ InputManager::ActivateBinds( const int button )
 
     for( unsigned int i = 0; i < binds_to_activate.size(); ++i )
     {
-         m_Binds[ binds_to_activate[ i ] ].cmd->GetHandler()( m_Binds[ binds_to_activate[ i ] ].params );
+        // replay runs it as console line
+        Recorder::getSingleton().RecordCommand( "/" + m_Binds[ binds_to_activate[ i ] ].line );
+        m_Binds[ binds_to_activate[ i ] ].cmd->GetHandler()( m_Binds[ binds_to_activate[ i ] ].params );
     }
 }
 
@@ -301,6 +515,6 @@ InputManager::AddGameEvents( const int button, const EventType type )
         Event event;
         event.type = type;
         event.event = m_BindGameEvents[ binds_to_activate[ i ] ].event;
-        m_EventQueue.push_back( event );
+        PushEvent( event );
     }
 }
@@ -4,6 +4,7 @@
 #include <OgreSingleton.h>
 #include <OgreString.h>
 #include <OIS.h>
+#include <boost/atomic.hpp>
 #include <vector>
 
 #include "Event.h"
@@ -31,23 +32,60 @@ public:
 
     bool                IsButtonPressed( const int button ) const;
 
+    // Events are written to single producer single consumer ring by thread
+    // which captures devices and read by one consumer, which may be other
+    // thread. Dispatch reads all events and passes them to listeners.
+    bool                PopEvent( Event& event );
     void                GetInputEvents( InputEventArray& input_events );
+    void                Dispatch();
+    // recorded event goes only to game listeners
+    void                DispatchReplayEvent( const Event& event );
+
+    // listeners get events in order they were added, listener without
+    // console flag doesn't get events while console is visible
+    void                AddListener( InputListener* listener, const unsigned int mask, const bool console );
+    void                RemoveListener( InputListener* listener );
 
     // binds
     void                InitCmd();
-    void                BindCommand( ConfigCmd* cmd, const Ogre::StringVector& params, const ButtonList& buttons );
+    void                BindCommand( ConfigCmd* cmd, const Ogre::String& line, const Ogre::StringVector& params, const ButtonList& buttons );
     void                BindGameEvent( const Ogre::String& event, const ButtonList& buttons );
     void                ActivateBinds( const int button );
     void                AddGameEvents( const int button, const EventType type );
 
+private:
+    void                PushEvent( Event& event );
+    void                FlushMouseMove();
+    void                WriteEvent( const Event& event );
+    void                DispatchEvent( const Event& event, const bool console_visible );
+
 private:
     bool                    m_ButtonState[ 256 ];
     char                    m_ButtonText[ 256 ];
+    ButtonList              m_ButtonsPressed; // so repeat doesn't check all buttons
 
     bool                    m_RepeatFirstWait;
     float                   m_RepeatTimer;
+    unsigned int            m_RepeatPosition[ 256 ]; // ring position of last repeat of button
+    bool                    m_RepeatValid[ 256 ];
+
+    InputEventArray         m_Ring;
+    unsigned int            m_RingMask;
+    boost::atomic< unsigned int > m_RingWrite; // changed only by producer
+    boost::atomic< unsigned int > m_RingRead; // changed only by consumer
+    unsigned int            m_Dropped;
 
-    InputEventArray         m_EventQueue;
+    // moves between other events are summed into one
+    Event                   m_MouseMove;
+    bool                    m_MouseMoveValid;
+
+    struct ListenerInfo
+    {
+        InputListener* listener;
+        unsigned int mask;
+        bool console;
+    };
+    std::vector< ListenerInfo > m_Listeners;
 
     // binds
     struct BindInfo
@@ -57,6 +95,7 @@ private:
         {};
 
         ConfigCmd* cmd;
+        Ogre::String line; // command line as typed, recorded by Recorder
         Ogre::StringVector params;
         ButtonList buttons;
     };
@@ -52,7 +52,7 @@ CmdBind( const Ogre::StringVector& params )
         ConfigCmd* cmd = ConfigCmdManager::getSingleton().Find( params_cmd[ 0 ] );
         if( cmd != NULL )
         {
-            InputManager::getSingleton().BindCommand( cmd, params_cmd, key_codes );
+            InputManager::getSingleton().BindCommand( cmd, params[ 2 ], params_cmd, key_codes );
             LOG_TRIVIAL( "Bind \"" + params[ 1 ] + "\" to command \"" + params[ 2 ] + "\"." );
         }
         else
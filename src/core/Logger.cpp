@@ -0,0 +1,314 @@
+#include "Logger.h"
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <ctime>
+
+#include "ConfigVar.h"
+#include "Timer.h"
+
+
+
+template<>Logger* Ogre::Singleton< Logger >::msSingleton = NULL;
+
+ConfigVar cv_log_console_rate( "log_console_rate", "Max number of trivial log lines per second shown in console, errors and warnings always shown", "30" );
+
+// must be power of two
+const unsigned int LOG_RING_SIZE = 4096;
+// trivial lines waiting for console, more are skipped
+const unsigned int LOG_CONSOLE_MAX = 1024;
+
+
+
+Logger::Logger( const Ogre::String& file_name ):
+    m_Level( LOG_LEVEL_TRIVIAL ),
+    m_RingMask( LOG_RING_SIZE - 1 ),
+    m_WritePosition( 0 ),
+    m_ReadPosition( 0 ),
+    m_Dropped( 0 ),
+    m_Exit( false ),
+    m_ConsoleSkipped( 0 ),
+    m_ConsoleTime( 0 ),
+    m_ConsoleCount( 0 )
+{
+    m_File.open( file_name.c_str() );
+
+    m_Ring = new Slot[ LOG_RING_SIZE ];
+    for( unsigned int i = 0; i < LOG_RING_SIZE; ++i )
+    {
+        m_Ring[ i ].sequence.store( i, boost::memory_order_relaxed );
+    }
+
+    m_Writer = new boost::thread( boost::bind( &Logger::UpdateWriter, this ) );
+
+    Ogre::LogManager::getSingleton().getDefaultLog()->addListener( this );
+}
+
+
+
+Logger::~Logger()
+{
+    Ogre::LogManager::getSingleton().getDefaultLog()->removeListener( this );
+
+    // writer writes everything left in ring before exit
+    m_Exit.store( true, boost::memory_order_release );
+    m_Writer->join();
+    delete m_Writer;
+
+    delete[] m_Ring;
+}
+
+
+
+bool
+Logger::IsLogged( const int level )
+{
+    Logger* logger = getSingletonPtr();
+    return logger == NULL || level <= logger->m_Level;
+}
+
+
+
+void
+Logger::Log( const int level, const char* file, const int line, const Ogre::String& message )
+{
+    Logger* logger = getSingletonPtr();
+    if( logger == NULL )
+    {
+        // before logger is created or after it is destroyed
+        if( Ogre::LogManager::getSingletonPtr() != NULL )
+        {
+            Ogre::LogMessageLevel lml = ( level == LOG_LEVEL_ERROR ) ? Ogre::LML_CRITICAL : ( level == LOG_LEVEL_WARNING ) ? Ogre::LML_NORMAL : Ogre::LML_TRIVIAL;
+            Ogre::LogManager::getSingleton().logMessage( message, lml );
+        }
+        return;
+    }
+
+    Record record;
+    record.level = level;
+    record.file = file;
+    record.line = line;
+    record.message = message;
+
+    if( logger->Push( record ) == false )
+    {
+        if( level == LOG_LEVEL_TRIVIAL )
+        {
+            logger->m_Dropped.fetch_add( 1, boost::memory_order_relaxed );
+            return;
+        }
+
+        // errors and warnings are never lost, wait for writer to free space
+        while( logger->Push( record ) == false )
+        {
+            boost::this_thread::yield();
+        }
+    }
+}
+
+
+
+void
+Logger::SetLevel( const int level )
+{
+    m_Level = level;
+}
+
+
+
+void
+Logger::GetConsoleLines( std::vector< LogLine >& lines )
+{
+    unsigned int skipped = 0;
+    {
+        boost::mutex::scoped_lock lock( m_ConsoleMutex );
+        lines.swap( m_ConsoleLines );
+        skipped = m_ConsoleSkipped;
+        m_ConsoleSkipped = 0;
+    }
+
+    float time = Timer::getSingleton().GetSystemTimeTotal();
+    if( time - m_ConsoleTime >= 1.0f )
+    {
+        m_ConsoleTime = time;
+        m_ConsoleCount = 0;
+    }
+
+    // trivial lines over rate are only in log file
+    int rate = cv_log_console_rate.GetI();
+    unsigned int count = 0;
+    for( unsigned int i = 0; i < lines.size(); ++i )
+    {
+        if( lines[ i ].level == LOG_LEVEL_TRIVIAL && m_ConsoleCount >= rate )
+        {
+            ++skipped;
+            continue;
+        }
+        if( lines[ i ].level == LOG_LEVEL_TRIVIAL )
+        {
+            ++m_ConsoleCount;
+        }
+        lines[ count++ ] = lines[ i ];
+    }
+    lines.resize( count );
+
+    if( skipped > 0 )
+    {
+        LogLine line;
+        line.level = LOG_LEVEL_WARNING;
+        line.text = Ogre::StringConverter::toString( skipped ) + " log lines not shown in console, see log file.";
+        lines.push_back( line );
+    }
+}
+
+
+
+void
+Logger::messageLogged( const Ogre::String& message, Ogre::LogMessageLevel lml, bool maskDebug, const Ogre::String& logName, bool& skipThisMessage )
+{
+    // ogre own messages, ogre already filtered them by its log detail. Normal
+    // is default level of ogre output, so only critical ones aren't trivial
+    int level = ( lml == Ogre::LML_CRITICAL ) ? LOG_LEVEL_ERROR : LOG_LEVEL_TRIVIAL;
+    Log( level, NULL, 0, message );
+}
+
+
+
+bool
+Logger::Push( Record& record )
+{
+    // bounded multi producer ring, every slot has sequence number that says
+    // if slot is free for producer with this position or filled for reader
+    unsigned int position = m_WritePosition.load( boost::memory_order_relaxed );
+    Slot* slot = NULL;
+    for( ;; )
+    {
+        slot = &m_Ring[ position & m_RingMask ];
+        unsigned int sequence = slot->sequence.load( boost::memory_order_acquire );
+        int diff = ( int )( sequence - position );
+        if( diff == 0 )
+        {
+            if( m_WritePosition.compare_exchange_weak( position, position + 1, boost::memory_order_relaxed ) == true )
+            {
+                break;
+            }
+        }
+        else if( diff < 0 )
+        {
+            // ring is full
+            return false;
+        }
+        else
+        {
+            position = m_WritePosition.load( boost::memory_order_relaxed );
+        }
+    }
+
+    slot->record.level = record.level;
+    slot->record.file = record.file;
+    slot->record.line = record.line;
+    slot->record.message.swap( record.message );
+    slot->sequence.store( position + 1, boost::memory_order_release );
+    return true;
+}
+
+
+
+bool
+Logger::Pop( Record& record )
+{
+    Slot& slot = m_Ring[ m_ReadPosition & m_RingMask ];
+    unsigned int sequence = slot.sequence.load( boost::memory_order_acquire );
+    if( ( int )( sequence - ( m_ReadPosition + 1 ) ) < 0 )
+    {
+        // ring is empty
+        return false;
+    }
+
+    record.level = slot.record.level;
+    record.file = slot.record.file;
+    record.line = slot.record.line;
+    record.message.swap( slot.record.message );
+    slot.sequence.store( m_ReadPosition + LOG_RING_SIZE, boost::memory_order_release );
+    ++m_ReadPosition;
+    return true;
+}
+
+
+
+void
+Logger::UpdateWriter()
+{
+    Record record;
+    for( ;; )
+    {
+        // exit is checked before ring is read so messages pushed before exit are written
+        bool exit = m_Exit.load( boost::memory_order_acquire );
+
+        bool written = false;
+        while( Pop( record ) == true )
+        {
+            Write( record );
+            written = true;
+        }
+
+        unsigned int dropped = m_Dropped.exchange( 0, boost::memory_order_relaxed );
+        if( dropped > 0 )
+        {
+            Record lost;
+            lost.level = LOG_LEVEL_WARNING;
+            lost.file = NULL;
+            lost.line = 0;
+            lost.message = "[LOG] " + Ogre::StringConverter::toString( dropped ) + " trivial messages dropped, log ring was full.";
+            Write( lost );
+            written = true;
+        }
+
+        if( written == true )
+        {
+            m_File.flush();
+        }
+        else if( exit == true )
+        {
+            return;
+        }
+        else
+        {
+            boost::this_thread::sleep_for( boost::chrono::milliseconds( 2 ) );
+        }
+    }
+}
+
+
+
+void
+Logger::Write( const Record& record )
+{
+    Ogre::String text;
+    if( record.file != NULL )
+    {
+        text = ( ( record.level == LOG_LEVEL_ERROR ) ? "[ERROR] " : "[WARNING] " ) + Ogre::String( record.file ) + " " + Ogre::StringConverter::toString( record.line ) + ": " + record.message;
+    }
+    else
+    {
+        text = record.message;
+    }
+
+    // same time prefix as ogre log
+    time_t now;
+    time( &now );
+    char time_string[ 16 ];
+    strftime( time_string, sizeof( time_string ), "%H:%M:%S: ", localtime( &now ) );
+    m_File << time_string << text << "\n";
+
+    LogLine line;
+    line.level = record.level;
+    line.text = text;
+    boost::mutex::scoped_lock lock( m_ConsoleMutex );
+    if( line.level == LOG_LEVEL_TRIVIAL && m_ConsoleLines.size() >= LOG_CONSOLE_MAX )
+    {
+        ++m_ConsoleSkipped;
+        return;
+    }
+    m_ConsoleLines.push_back( line );
+}
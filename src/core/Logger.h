@@ -1,15 +1,115 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <OgreLog.h>
 #include <OgreLogManager.h>
+#include <OgreSingleton.h>
 #include <OgreString.h>
 #include <OgreStringConverter.h>
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+#include <fstream>
+#include <vector>
 
 
 
-#define LOG_ERROR( message ) Ogre::LogManager::getSingleton().logMessage( "[ERROR] " + Ogre::String( __FILE__ ) + " " + Ogre::StringConverter::toString( __LINE__ ) + ": " + message, Ogre::LML_CRITICAL )
-#define LOG_WARNING( message ) Ogre::LogManager::getSingleton().logMessage( "[WARNING] " + Ogre::String( __FILE__ ) + " " + Ogre::StringConverter::toString( __LINE__ ) + ": " + message, Ogre::LML_NORMAL )
-#define LOG_TRIVIAL( message ) Ogre::LogManager::getSingleton().logMessage( message, Ogre::LML_TRIVIAL )
+#define LOG_LEVEL_ERROR   1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_TRIVIAL 3
+
+// messages above this level are removed at compile time, their text is never built
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_TRIVIAL
+#endif
+
+
+
+// line for console, level is one of LOG_LEVEL_*
+struct LogLine
+{
+    int level;
+    Ogre::String text;
+};
+
+
+
+// Messages are put to lock free ring by any thread and written to log file
+// by writer thread, so logging never waits for disk. Ogre own messages come
+// to same ring through log listener. Writer passes lines to console, which
+// takes them in main thread with rate limit.
+class Logger : public Ogre::Singleton< Logger >, public Ogre::LogListener
+{
+public:
+    Logger( const Ogre::String& file_name );
+    virtual ~Logger();
+
+    static bool IsLogged( const int level );
+    static void Log( const int level, const char* file, const int line, const Ogre::String& message );
+
+    void SetLevel( const int level );
+    void GetConsoleLines( std::vector< LogLine >& lines );
+
+    virtual void messageLogged( const Ogre::String& message, Ogre::LogMessageLevel lml, bool maskDebug, const Ogre::String &logName, bool& skipThisMessage );
+
+private:
+    Logger();
+
+    struct Record
+    {
+        int level;
+        const char* file; // NULL when message is written without source position
+        int line;
+        Ogre::String message;
+    };
+
+    bool Push( Record& record );
+    bool Pop( Record& record );
+    void UpdateWriter();
+    void Write( const Record& record );
+
+private:
+    int m_Level;
+    std::ofstream m_File;
+
+    struct Slot
+    {
+        boost::atomic< unsigned int > sequence;
+        Record record;
+    };
+    Slot* m_Ring;
+    unsigned int m_RingMask;
+    boost::atomic< unsigned int > m_WritePosition; // claimed by producers
+    unsigned int m_ReadPosition; // used only by writer
+    boost::atomic< unsigned int > m_Dropped;
+    boost::atomic< bool > m_Exit;
+    boost::thread* m_Writer;
+
+    boost::mutex m_ConsoleMutex;
+    std::vector< LogLine > m_ConsoleLines;
+    unsigned int m_ConsoleSkipped;
+    float m_ConsoleTime; // start of current rate limit second
+    int m_ConsoleCount; // trivial lines shown during current second
+};
+
+
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR( message ) do { if( Logger::IsLogged( LOG_LEVEL_ERROR ) == true ) { Logger::Log( LOG_LEVEL_ERROR, __FILE__, __LINE__, message ); } } while( false )
+#else
+#define LOG_ERROR( message ) do {} while( false )
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARNING
+#define LOG_WARNING( message ) do { if( Logger::IsLogged( LOG_LEVEL_WARNING ) == true ) { Logger::Log( LOG_LEVEL_WARNING, __FILE__, __LINE__, message ); } } while( false )
+#else
+#define LOG_WARNING( message ) do {} while( false )
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_TRIVIAL
+#define LOG_TRIVIAL( message ) do { if( Logger::IsLogged( LOG_LEVEL_TRIVIAL ) == true ) { Logger::Log( LOG_LEVEL_TRIVIAL, NULL, 0, message ); } } while( false )
+#else
+#define LOG_TRIVIAL( message ) do {} while( false )
+#endif
 
 
 
@@ -0,0 +1,128 @@
+#include "MemoryTracker.h"
+#include "MemoryTrackerCommands.h"
+
+#include <OgreStringConverter.h>
+#include <cmath>
+
+#include "Counters.h"
+
+
+
+template<>MemoryTracker* Ogre::Singleton< MemoryTracker >::msSingleton = NULL;
+
+Ogre::String memory_tag_name[ MEMORY_TAGS ] = { "lua_system", "lua_entity", "lua_ui", "pathfinding", "entity_buffers", "ui_description", "console" };
+
+
+
+Ogre::String
+memory_bytes_to_string( const double bytes )
+{
+    return Ogre::StringConverter::toString( ( float )( bytes / 1024.0 ), 1, 0, ' ', std::ios::fixed ) + " KB";
+}
+
+
+
+MemoryTracker::MemoryTracker():
+    m_SnapshotValid( false )
+{
+    for( unsigned int i = 0; i < MEMORY_TAGS; ++i )
+    {
+        m_Live[ i ] = Counters::getSingleton().Register( "memory_" + memory_tag_name[ i ], Counters::COUNTER );
+        m_Allocated[ i ] = Counters::getSingleton().Register( "memory_" + memory_tag_name[ i ] + "_allocated", Counters::COUNTER );
+        m_Allocations[ i ] = Counters::getSingleton().Register( "memory_" + memory_tag_name[ i ] + "_allocations", Counters::COUNTER );
+    }
+
+    InitCmd();
+}
+
+
+
+MemoryTracker::~MemoryTracker()
+{
+}
+
+
+
+void
+MemoryTracker::Allocated( const MemoryTag tag, const size_t size )
+{
+    MemoryTracker* tracker = getSingletonPtr();
+    if( tracker != NULL )
+    {
+        Counters& counters = Counters::getSingleton();
+        counters.Add( tracker->m_Live[ tag ], size );
+        counters.Add( tracker->m_Allocated[ tag ], size );
+        counters.Add( tracker->m_Allocations[ tag ], 1 );
+    }
+}
+
+
+
+void
+MemoryTracker::Freed( const MemoryTag tag, const size_t size )
+{
+    MemoryTracker* tracker = getSingletonPtr();
+    if( tracker != NULL )
+    {
+        Counters::getSingleton().Add( tracker->m_Live[ tag ], -( long long )size );
+    }
+}
+
+
+
+void
+MemoryTracker::Print() const
+{
+    // rates are for last second
+    for( unsigned int i = 0; i < MEMORY_TAGS; ++i )
+    {
+        TagState state = GetState( ( MemoryTag )i );
+        float rate = Counters::getSingleton().Get( "memory_" + memory_tag_name[ i ] + "_allocated" );
+        float number = Counters::getSingleton().Get( "memory_" + memory_tag_name[ i ] + "_allocations" );
+        Console::getSingleton().AddTextToOutput( memory_tag_name[ i ] + ": " + memory_bytes_to_string( state.live ) + " live, " + memory_bytes_to_string( rate ) + "/s in " + Ogre::StringConverter::toString( number, 0, 0, ' ', std::ios::fixed ) + " allocations/s" );
+    }
+}
+
+
+
+void
+MemoryTracker::Snapshot()
+{
+    for( unsigned int i = 0; i < MEMORY_TAGS; ++i )
+    {
+        m_Snapshot[ i ] = GetState( ( MemoryTag )i );
+    }
+    m_SnapshotValid = true;
+}
+
+
+
+void
+MemoryTracker::PrintDiff() const
+{
+    if( m_SnapshotValid == false )
+    {
+        Console::getSingleton().AddTextToOutput( "There is no memory snapshot, make one with /memory_snapshot." );
+        return;
+    }
+
+    // live growth shows leaks, allocated bytes without growth show churn
+    for( unsigned int i = 0; i < MEMORY_TAGS; ++i )
+    {
+        TagState state = GetState( ( MemoryTag )i );
+        double live = state.live - m_Snapshot[ i ].live;
+        Console::getSingleton().AddTextToOutput( memory_tag_name[ i ] + ": " + ( ( live >= 0 ) ? "+" : "-" ) + memory_bytes_to_string( std::abs( live ) ) + " live, " + memory_bytes_to_string( state.allocated - m_Snapshot[ i ].allocated ) + " allocated in " + Ogre::StringConverter::toString( ( unsigned long )( state.allocations - m_Snapshot[ i ].allocations ) ) + " allocations" );
+    }
+}
+
+
+
+MemoryTracker::TagState
+MemoryTracker::GetState( const MemoryTag tag ) const
+{
+    TagState state;
+    state.live = Counters::getSingleton().GetTotal( "memory_" + memory_tag_name[ tag ] );
+    state.allocated = Counters::getSingleton().GetTotal( "memory_" + memory_tag_name[ tag ] + "_allocated" );
+    state.allocations = Counters::getSingleton().GetTotal( "memory_" + memory_tag_name[ tag ] + "_allocations" );
+    return state;
+}
@@ -0,0 +1,98 @@
+#ifndef MEMORY_TRACKER_H
+#define MEMORY_TRACKER_H
+
+#include <OgreSingleton.h>
+#include <OgreString.h>
+#include <memory>
+
+
+
+// Accounting of memory by subsystem. Allocations and frees are added to
+// counters of calling thread (see Counters), so live bytes of tag is total
+// of its "memory_<tag>" counter and allocation rate is rate of its
+// "memory_<tag>_allocated" counter. Snapshot keeps current numbers, diff
+// shows what was allocated and what stayed alive since snapshot.
+
+
+
+// lua tags go in order of ScriptManager::Type
+enum MemoryTag
+{
+    MEMORY_LUA_SYSTEM,
+    MEMORY_LUA_ENTITY,
+    MEMORY_LUA_UI,
+    MEMORY_PATHFINDING,
+    MEMORY_ENTITY_BUFFERS,
+    MEMORY_UI_DESCRIPTION,
+    MEMORY_CONSOLE,
+    MEMORY_TAGS
+};
+
+
+
+class MemoryTracker : public Ogre::Singleton< MemoryTracker >
+{
+public:
+    MemoryTracker();
+    virtual ~MemoryTracker();
+
+    // do nothing if tracker isn't created
+    static void Allocated( const MemoryTag tag, const size_t size );
+    static void Freed( const MemoryTag tag, const size_t size );
+
+    void Print() const;
+    void Snapshot();
+    void PrintDiff() const;
+
+private:
+    void InitCmd();
+
+    struct TagState
+    {
+        double live; // bytes
+        double allocated; // bytes ever allocated
+        double allocations; // number of allocations
+    };
+    TagState GetState( const MemoryTag tag ) const;
+
+private:
+    unsigned int m_Live[ MEMORY_TAGS ];
+    unsigned int m_Allocated[ MEMORY_TAGS ];
+    unsigned int m_Allocations[ MEMORY_TAGS ];
+
+    bool m_SnapshotValid;
+    TagState m_Snapshot[ MEMORY_TAGS ];
+};
+
+
+
+// allocator for standard containers which counts their storage in tag
+template< typename T, int tag >
+class TrackedAllocator : public std::allocator< T >
+{
+public:
+    template< typename U > struct rebind
+    {
+        typedef TrackedAllocator< U, tag > other;
+    };
+
+    TrackedAllocator() {}
+    TrackedAllocator( const TrackedAllocator& other ): std::allocator< T >( other ) {}
+    template< typename U > TrackedAllocator( const TrackedAllocator< U, tag >& other ) {}
+
+    T* allocate( size_t number, const void* hint = 0 )
+    {
+        MemoryTracker::Allocated( ( MemoryTag )tag, number * sizeof( T ) );
+        return std::allocator< T >::allocate( number, hint );
+    }
+
+    void deallocate( T* pointer, size_t number )
+    {
+        MemoryTracker::Freed( ( MemoryTag )tag, number * sizeof( T ) );
+        std::allocator< T >::deallocate( pointer, number );
+    }
+};
+
+
+
+#endif // MEMORY_TRACKER_H
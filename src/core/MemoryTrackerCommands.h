@@ -0,0 +1,37 @@
+#include "ConfigCmdManager.h"
+#include "Console.h"
+
+
+
+void
+CmdMemory( const Ogre::StringVector& params )
+{
+    MemoryTracker::getSingleton().Print();
+}
+
+
+
+void
+CmdMemorySnapshot( const Ogre::StringVector& params )
+{
+    MemoryTracker::getSingleton().Snapshot();
+    Console::getSingleton().AddTextToOutput( "Memory snapshot made." );
+}
+
+
+
+void
+CmdMemoryDiff( const Ogre::StringVector& params )
+{
+    MemoryTracker::getSingleton().PrintDiff();
+}
+
+
+
+void
+MemoryTracker::InitCmd()
+{
+    ConfigCmdManager::getSingleton().AddCommand( "memory", "List live memory and allocation rate of subsystems", "", CmdMemory, NULL );
+    ConfigCmdManager::getSingleton().AddCommand( "memory_snapshot", "Remember memory state of subsystems for /memory_diff", "", CmdMemorySnapshot, NULL );
+    ConfigCmdManager::getSingleton().AddCommand( "memory_diff", "Show memory allocated and left alive in subsystems since /memory_snapshot", "", CmdMemoryDiff, NULL );
+}
@@ -0,0 +1,390 @@
+#include "Profiler.h"
+#include "ProfilerCommands.h"
+
+#include <OgreStringConverter.h>
+#include <algorithm>
+#include <boost/chrono.hpp>
+#include <fstream>
+
+#include "ConfigVar.h"
+#include "DebugDraw.h"
+#include "Logger.h"
+
+
+
+template<>Profiler* Ogre::Singleton< Profiler >::msSingleton = NULL;
+
+ConfigVar cv_profiler( "profiler", "Collect frame profiler zones", "false" );
+ConfigVar cv_debug_profiler( "debug_profiler", "Draw frame profiler zones (collects them too)", "false" );
+
+// number of frames kept in profiler history
+const unsigned int PROFILER_FRAMES = 120;
+// zones one thread can write between two collections
+const unsigned int PROFILER_RING_SIZE = 16384;
+
+
+
+void
+profile_thread_cleanup( ProfileThread* thread )
+{
+    // threads are owned by profiler so their zones stay after thread exit
+}
+
+
+
+bool
+profile_event_compare( const ProfileEvent& a, const ProfileEvent& b )
+{
+    // parent starts before its children or at same time but with smaller depth
+    return ( a.start != b.start ) ? a.start < b.start : a.depth < b.depth;
+}
+
+
+
+Profiler::Profiler():
+    m_Enabled( false ),
+    m_Thread( profile_thread_cleanup ),
+    m_FrameStart( 0 ),
+    m_FrameNumber( 0 ),
+    m_FrameTime( PROFILER_FRAMES, 0 ),
+    m_FrameEvents( PROFILER_FRAMES )
+{
+    // thread that creates profiler is main thread with index 0
+    GetThread();
+
+    InitCmd();
+}
+
+
+
+Profiler::~Profiler()
+{
+    m_Thread.release();
+    for( unsigned int i = 0; i < m_Threads.size(); ++i )
+    {
+        delete m_Threads[ i ];
+    }
+}
+
+
+
+void
+Profiler::BeginFrame()
+{
+    unsigned long long time = GetTime();
+
+    if( m_Enabled == true )
+    {
+        unsigned int frame = m_FrameNumber % PROFILER_FRAMES;
+        m_FrameTime[ frame ] = ( time - m_FrameStart ) / 1000.0f;
+        m_FrameEvents[ frame ].clear();
+        for( unsigned int i = 0; i < m_Nodes.size(); ++i )
+        {
+            m_Nodes[ i ].time[ frame ] = 0;
+            m_Nodes[ i ].calls[ frame ] = 0;
+        }
+
+        {
+            boost::mutex::scoped_lock lock( m_ThreadsMutex );
+            for( unsigned int i = 0; i < m_Threads.size(); ++i )
+            {
+                Collect( *m_Threads[ i ], frame );
+            }
+        }
+        ++m_FrameNumber;
+
+        if( cv_debug_profiler.GetB() == true )
+        {
+            UpdateDebug();
+        }
+    }
+
+    bool enabled = cv_profiler.GetB() == true || cv_debug_profiler.GetB() == true;
+    if( enabled == true && m_Enabled == false )
+    {
+        Reset();
+    }
+    m_Enabled = enabled;
+    m_FrameStart = time;
+}
+
+
+
+bool
+Profiler::IsEnabled() const
+{
+    return m_Enabled;
+}
+
+
+
+ProfileThread*
+Profiler::GetThread()
+{
+    ProfileThread* thread = m_Thread.get();
+    if( thread == NULL )
+    {
+        thread = new ProfileThread();
+        thread->ring.resize( PROFILER_RING_SIZE );
+        m_Thread.reset( thread );
+
+        boost::mutex::scoped_lock lock( m_ThreadsMutex );
+        thread->index = m_Threads.size();
+        m_Threads.push_back( thread );
+    }
+    return thread;
+}
+
+
+
+unsigned long long
+Profiler::GetTime()
+{
+    return boost::chrono::duration_cast< boost::chrono::microseconds >( boost::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+
+
+void
+Profiler::Dump( const Ogre::String& file_name ) const
+{
+    std::ofstream file( file_name.c_str() );
+    if( !file.is_open() )
+    {
+        LOG_ERROR( "Failed to open profile file \"" + file_name + "\" for writing." );
+        return;
+    }
+
+    file << "{\"traceEvents\":[\n";
+
+    unsigned int threads = 0;
+    {
+        boost::mutex::scoped_lock lock( m_ThreadsMutex );
+        threads = m_Threads.size();
+    }
+    for( unsigned int i = 0; i < threads; ++i )
+    {
+        file << ( ( i > 0 ) ? ",\n" : "" );
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << i << ",\"args\":{\"name\":\"" << ( ( i == 0 ) ? Ogre::String( "main" ) : "thread " + Ogre::StringConverter::toString( i ) ) << "\"}}";
+    }
+
+    // oldest frame first
+    unsigned int frames = std::min( m_FrameNumber, PROFILER_FRAMES );
+    for( unsigned int i = 0; i < frames; ++i )
+    {
+        const std::vector< ProfileEvent >& events = m_FrameEvents[ ( m_FrameNumber - frames + i ) % PROFILER_FRAMES ];
+        for( unsigned int j = 0; j < events.size(); ++j )
+        {
+            file << ",\n{\"name\":\"" << events[ j ].name << "\",\"ph\":\"X\",\"ts\":" << events[ j ].start << ",\"dur\":" << events[ j ].end - events[ j ].start << ",\"pid\":0,\"tid\":" << events[ j ].thread << "}";
+        }
+    }
+
+    file << "\n]}\n";
+
+    LOG_TRIVIAL( "Profile of " + Ogre::StringConverter::toString( frames ) + " frames dumped to \"" + file_name + "\"." );
+}
+
+
+
+void
+Profiler::Reset()
+{
+    m_FrameNumber = 0;
+    for( unsigned int i = 0; i < PROFILER_FRAMES; ++i )
+    {
+        m_FrameTime[ i ] = 0;
+        m_FrameEvents[ i ].clear();
+    }
+    m_Nodes.clear();
+    m_NodeIndex.clear();
+    m_Roots.clear();
+
+    boost::mutex::scoped_lock lock( m_ThreadsMutex );
+    for( unsigned int i = 0; i < m_Threads.size(); ++i )
+    {
+        m_Threads[ i ]->read = m_Threads[ i ]->write;
+    }
+}
+
+
+
+void
+Profiler::Collect( ProfileThread& thread, const unsigned int frame )
+{
+    unsigned int size = thread.ring.size();
+    if( thread.write - thread.read > size )
+    {
+        LOG_WARNING( "Profiler ring of thread " + Ogre::StringConverter::toString( thread.index ) + " overflowed, " + Ogre::StringConverter::toString( thread.write - thread.read - size ) + " zones lost." );
+        thread.read = thread.write - size;
+    }
+
+    // zones are written when they end so children come before parent
+    std::vector< ProfileEvent > events;
+    events.reserve( thread.write - thread.read );
+    for( ; thread.read != thread.write; ++thread.read )
+    {
+        events.push_back( thread.ring[ thread.read % size ] );
+    }
+    std::sort( events.begin(), events.end(), profile_event_compare );
+
+    // parent of zone is last started zone one level higher
+    std::vector< unsigned int > stack;
+    for( unsigned int i = 0; i < events.size(); ++i )
+    {
+        if( stack.size() > events[ i ].depth )
+        {
+            stack.resize( events[ i ].depth );
+        }
+        int parent = ( stack.size() > 0 ) ? ( int )stack.back() : -1 - ( int )thread.index;
+
+        unsigned int node = GetNode( parent, thread.index, events[ i ].name );
+        m_Nodes[ node ].time[ frame ] += ( events[ i ].end - events[ i ].start ) / 1000.0f;
+        m_Nodes[ node ].calls[ frame ] += 1;
+        stack.push_back( node );
+
+        m_FrameEvents[ frame ].push_back( events[ i ] );
+    }
+}
+
+
+
+unsigned int
+Profiler::GetNode( const int parent, const unsigned int thread, const char* name )
+{
+    std::pair< int, Ogre::String > key( parent, name );
+    std::map< std::pair< int, Ogre::String >, unsigned int >::iterator it = m_NodeIndex.find( key );
+    if( it != m_NodeIndex.end() )
+    {
+        return it->second;
+    }
+
+    ProfileNode node;
+    node.name = name;
+    node.thread = thread;
+    node.depth = ( parent >= 0 ) ? m_Nodes[ parent ].depth + 1 : 0;
+    node.time.resize( PROFILER_FRAMES, 0 );
+    node.calls.resize( PROFILER_FRAMES, 0 );
+
+    unsigned int index = m_Nodes.size();
+    m_Nodes.push_back( node );
+    m_NodeIndex[ key ] = index;
+
+    if( parent >= 0 )
+    {
+        m_Nodes[ parent ].children.push_back( index );
+    }
+    else
+    {
+        if( m_Roots.size() <= thread )
+        {
+            m_Roots.resize( thread + 1 );
+        }
+        m_Roots[ thread ].push_back( index );
+    }
+
+    return index;
+}
+
+
+
+void
+Profiler::UpdateDebug()
+{
+    unsigned int frames = std::min( m_FrameNumber, PROFILER_FRAMES );
+    float total = 0;
+    float max = 0;
+    for( unsigned int i = 0; i < frames; ++i )
+    {
+        total += m_FrameTime[ i ];
+        max = std::max( max, m_FrameTime[ i ] );
+    }
+
+    DEBUG_DRAW.SetTextAlignment( DEBUG_DRAW.LEFT );
+    DEBUG_DRAW.SetScreenSpace( true );
+    DEBUG_DRAW.SetColour( Ogre::ColourValue( 1.0f, 1.0f, 1.0f, 1.0f ) );
+
+    float x = 400.0f;
+    float y = 10.0f;
+    DEBUG_DRAW.Text( x, y, "Frame (avg / max ms, calls per frame over " + Ogre::StringConverter::toString( frames ) + " frames): " + Ogre::StringConverter::toString( total / frames, 3 ) + " / " + Ogre::StringConverter::toString( max, 3 ) );
+    y += 16.0f;
+
+    for( unsigned int i = 0; i < m_Roots.size(); ++i )
+    {
+        DEBUG_DRAW.SetColour( Ogre::ColourValue( 0.0f, 0.8f, 0.0f, 1.0f ) );
+        DEBUG_DRAW.Text( x, y, ( i == 0 ) ? Ogre::String( "Main thread:" ) : "Thread " + Ogre::StringConverter::toString( i ) + ":" );
+        y += 16.0f;
+
+        for( unsigned int j = 0; j < m_Roots[ i ].size(); ++j )
+        {
+            DrawNode( m_Roots[ i ][ j ], y, x + 10.0f );
+        }
+    }
+}
+
+
+
+void
+Profiler::DrawNode( const unsigned int node, float& y, const float x )
+{
+    const ProfileNode& zone = m_Nodes[ node ];
+
+    unsigned int frames = std::min( m_FrameNumber, PROFILER_FRAMES );
+    float total = 0;
+    float max = 0;
+    unsigned int calls = 0;
+    for( unsigned int i = 0; i < frames; ++i )
+    {
+        total += zone.time[ i ];
+        max = std::max( max, zone.time[ i ] );
+        calls += zone.calls[ i ];
+    }
+
+    // zone wasn't entered during last frames
+    if( calls == 0 )
+    {
+        return;
+    }
+
+    DEBUG_DRAW.SetColour( ( max > 1.0f ) ? Ogre::ColourValue( 0.8f, 0.8f, 0.0f, 1.0f ) : Ogre::ColourValue( 0.7f, 0.7f, 0.7f, 1.0f ) );
+    DEBUG_DRAW.Text( x + zone.depth * 10.0f, y, zone.name + ": " + Ogre::StringConverter::toString( total / frames, 3 ) + " / " + Ogre::StringConverter::toString( max, 3 ) + ", " + Ogre::StringConverter::toString( ( float )calls / frames, 3 ) );
+    y += 16.0f;
+
+    for( unsigned int i = 0; i < zone.children.size(); ++i )
+    {
+        DrawNode( zone.children[ i ], y, x );
+    }
+}
+
+
+
+ProfileZone::ProfileZone( const char* name ):
+    m_Thread( NULL ),
+    m_Name( name ),
+    m_Start( 0 )
+{
+    Profiler* profiler = Profiler::getSingletonPtr();
+    if( profiler != NULL && profiler->IsEnabled() == true )
+    {
+        m_Thread = profiler->GetThread();
+        ++m_Thread->depth;
+        m_Start = Profiler::GetTime();
+    }
+}
+
+
+
+ProfileZone::~ProfileZone()
+{
+    if( m_Thread != NULL )
+    {
+        --m_Thread->depth;
+
+        ProfileEvent& event = m_Thread->ring[ m_Thread->write % m_Thread->ring.size() ];
+        event.name = m_Name;
+        event.start = m_Start;
+        event.end = Profiler::GetTime();
+        event.depth = m_Thread->depth;
+        event.thread = m_Thread->index;
+        ++m_Thread->write;
+    }
+}
@@ -0,0 +1,126 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <OgreSingleton.h>
+#include <OgreString.h>
+#include <boost/thread.hpp>
+#include <map>
+#include <vector>
+
+
+
+// Frame profiler. Zone is marked with PROFILE_ZONE( "name" ) at start of scope
+// and written to ring of its thread when scope ends. At start of every frame
+// rings are collected into tree of zones per thread which keeps time of last
+// frames. Zone names must be string literals, they are stored as pointers.
+
+
+
+struct ProfileEvent
+{
+    const char* name;
+    unsigned long long start; // microseconds
+    unsigned long long end;
+    unsigned int depth;
+    unsigned int thread;
+};
+
+
+
+// written only by its own thread, read by main thread at frame start when all workers are idle
+struct ProfileThread
+{
+    ProfileThread():
+        index( 0 ),
+        write( 0 ),
+        read( 0 ),
+        depth( 0 )
+    {
+    }
+
+    unsigned int index;
+    std::vector< ProfileEvent > ring;
+    unsigned int write; // number of events ever written, ring position is write % ring size
+    unsigned int read;
+    unsigned int depth; // number of open zones
+};
+
+
+
+struct ProfileNode
+{
+    Ogre::String name;
+    unsigned int thread;
+    unsigned int depth;
+    std::vector< unsigned int > children;
+    std::vector< float > time; // ms for each of last frames
+    std::vector< unsigned int > calls;
+};
+
+
+
+class Profiler : public Ogre::Singleton< Profiler >
+{
+public:
+    Profiler();
+    virtual ~Profiler();
+
+    // called by main thread at start of frame before any zone
+    void BeginFrame();
+
+    bool IsEnabled() const;
+    ProfileThread* GetThread();
+    static unsigned long long GetTime();
+
+    // chrome trace event format (chrome://tracing)
+    void Dump( const Ogre::String& file_name ) const;
+
+private:
+    void InitCmd();
+    void Reset();
+    void Collect( ProfileThread& thread, const unsigned int frame );
+    unsigned int GetNode( const int parent, const unsigned int thread, const char* name );
+    void UpdateDebug();
+    void DrawNode( const unsigned int node, float& y, const float x );
+
+private:
+    bool m_Enabled;
+
+    mutable boost::mutex m_ThreadsMutex;
+    std::vector< ProfileThread* > m_Threads;
+    boost::thread_specific_ptr< ProfileThread > m_Thread;
+
+    unsigned long long m_FrameStart;
+    unsigned int m_FrameNumber; // number of collected frames
+    std::vector< float > m_FrameTime;
+    std::vector< std::vector< ProfileEvent > > m_FrameEvents;
+
+    std::vector< ProfileNode > m_Nodes;
+    std::map< std::pair< int, Ogre::String >, unsigned int > m_NodeIndex; // parent (or -1 - thread for roots) and name to node
+    std::vector< std::vector< unsigned int > > m_Roots; // per thread
+};
+
+
+
+class ProfileZone
+{
+public:
+    ProfileZone( const char* name );
+    ~ProfileZone();
+
+private:
+    ProfileZone();
+
+    ProfileThread* m_Thread;
+    const char* m_Name;
+    unsigned long long m_Start;
+};
+
+
+
+// one zone per scope, use inner block for more
+#define PROFILE_ZONE( name ) ProfileZone profile_zone( name )
+
+
+
+#endif // PROFILER_H
@@ -0,0 +1,24 @@
+#include "ConfigCmdManager.h"
+#include "Console.h"
+
+
+
+void
+CmdProfilerDump( const Ogre::StringVector& params )
+{
+    if( params.size() > 2 )
+    {
+        Console::getSingleton().AddTextToOutput( "Usage: /profiler_dump [file name]" );
+        return;
+    }
+
+    Profiler::getSingleton().Dump( ( params.size() == 2 ) ? params[ 1 ] : "profile.json" );
+}
+
+
+
+void
+Profiler::InitCmd()
+{
+    ConfigCmdManager::getSingleton().AddCommand( "profiler_dump", "Dump zones of last frames to chrome trace json file", "", CmdProfilerDump, NULL );
+}
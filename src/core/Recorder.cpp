@@ -0,0 +1,395 @@
+#include "Recorder.h"
+#include "RecorderCommands.h"
+
+#include <OgreStringConverter.h>
+#include <algorithm>
+#include <cstring>
+
+#include "InputManager.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "ScriptManager.h"
+#include "Utilites.h"
+#include "../Main.h"
+
+
+
+template<>Recorder* Ogre::Singleton< Recorder >::msSingleton = NULL;
+
+const char RECORD_MAGIC[ 4 ] = { 'X', 'G', 'R', 'C' };
+const unsigned int RECORD_VERSION = 1;
+
+// type of every record in file
+const unsigned char RECORD_TICK = 0;    // float delta
+const unsigned char RECORD_EVENT = 1;   // event fields
+const unsigned char RECORD_COMMAND = 2; // string
+const unsigned char RECORD_HASH = 3;    // state hash, ends tick
+
+
+
+Recorder::Recorder():
+    m_State( RS_NONE ),
+    m_ReplayPosition( 0 ),
+    m_Headless( false ),
+    m_ExitAtEnd( false ),
+    m_ReplayHash( 0 ),
+    m_Tick( 0 ),
+    m_Mismatches( 0 ),
+    m_StartTime( 0 ),
+    m_InTick( false )
+{
+    InitCmd();
+}
+
+
+
+Recorder::~Recorder()
+{
+    StopRecord();
+}
+
+
+
+void
+Recorder::StartRecord( const Ogre::String& file_name )
+{
+    if( m_State != RS_NONE )
+    {
+        LOG_ERROR( "Can't start recording to \"" + file_name + "\", recorder is already in use." );
+        return;
+    }
+
+    m_RecordFile.open( file_name.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+    if( m_RecordFile.is_open() == false )
+    {
+        LOG_ERROR( "Can't open record file \"" + file_name + "\"." );
+        return;
+    }
+
+    Write( RECORD_MAGIC, 4 );
+    Write( &RECORD_VERSION, sizeof( RECORD_VERSION ) );
+
+    m_State = RS_RECORD;
+    m_InTick = false;
+    m_Tick = 0;
+    LOG_TRIVIAL( "Recording session to \"" + file_name + "\"." );
+}
+
+
+
+void
+Recorder::StopRecord()
+{
+    if( m_State != RS_RECORD )
+    {
+        return;
+    }
+
+    m_RecordFile.close();
+    m_State = RS_NONE;
+    LOG_TRIVIAL( "Recorded " + Ogre::StringConverter::toString( m_Tick ) + " ticks." );
+}
+
+
+
+bool
+Recorder::IsRecording() const
+{
+    return m_State == RS_RECORD;
+}
+
+
+
+void
+Recorder::StartReplay( const Ogre::String& file_name, const bool headless, const bool exit_at_end )
+{
+    if( m_State != RS_NONE )
+    {
+        LOG_ERROR( "Can't start replay of \"" + file_name + "\", recorder is already in use." );
+        return;
+    }
+
+    if( ReadFileData( file_name, m_ReplayData ) == false )
+    {
+        LOG_ERROR( "Can't read record file \"" + file_name + "\"." );
+        return;
+    }
+
+    m_ReplayPosition = 0;
+    char magic[ 4 ];
+    unsigned int version = 0;
+    if( Read( magic, 4 ) == false || std::memcmp( magic, RECORD_MAGIC, 4 ) != 0 || Read( &version, sizeof( version ) ) == false || version != RECORD_VERSION )
+    {
+        LOG_ERROR( "File \"" + file_name + "\" isn't record of this version." );
+        m_ReplayData.clear();
+        return;
+    }
+
+    m_State = RS_REPLAY;
+    m_Headless = headless;
+    m_ExitAtEnd = exit_at_end;
+    m_InTick = false;
+    m_Tick = 0;
+    m_Mismatches = 0;
+    m_StartTime = Profiler::GetTime();
+    LOG_TRIVIAL( "Replaying session from \"" + file_name + "\"." );
+}
+
+
+
+void
+Recorder::StopReplay()
+{
+    if( m_State != RS_REPLAY )
+    {
+        return;
+    }
+
+    float time = ( Profiler::GetTime() - m_StartTime ) / 1000000.0f;
+    LOG_TRIVIAL( "Replayed " + Ogre::StringConverter::toString( m_Tick ) + " ticks in " + Ogre::StringConverter::toString( time ) + " seconds, " + Ogre::StringConverter::toString( m_Mismatches ) + " ticks with other state." );
+
+    m_ReplayData.clear();
+    m_ReplayItems.clear();
+    m_State = RS_NONE;
+    m_Headless = false;
+
+    if( m_ExitAtEnd == true )
+    {
+        g_ApplicationState = QG_EXIT;
+    }
+}
+
+
+
+bool
+Recorder::IsReplaying() const
+{
+    return m_State == RS_REPLAY;
+}
+
+
+
+bool
+Recorder::IsHeadless() const
+{
+    return m_State == RS_REPLAY && m_Headless == true;
+}
+
+
+
+float
+Recorder::BeginTick( const float delta )
+{
+    if( m_State == RS_RECORD )
+    {
+        Write( &RECORD_TICK, 1 );
+        Write( &delta, sizeof( delta ) );
+        m_InTick = true;
+        return delta;
+    }
+    else if( m_State != RS_REPLAY )
+    {
+        return delta;
+    }
+
+    m_ReplayItems.clear();
+
+    unsigned char type = 0;
+    float replay_delta = 0;
+    if( Read( &type, 1 ) == false || type != RECORD_TICK || Read( &replay_delta, sizeof( replay_delta ) ) == false )
+    {
+        // end of record
+        StopReplay();
+        return delta;
+    }
+
+    // read everything until end of tick
+    while( Read( &type, 1 ) == true && type != RECORD_HASH )
+    {
+        ReplayItem item;
+        item.command = ( type == RECORD_COMMAND );
+
+        bool read = false;
+        if( type == RECORD_EVENT )
+        {
+            unsigned char event_type = 0;
+            int button = 0;
+            read = Read( &event_type, 1 ) && Read( &button, sizeof( button ) ) &&
+                   Read( &item.event.param1, sizeof( float ) ) && Read( &item.event.param2, sizeof( float ) ) &&
+                   Read( &item.event.param3, sizeof( float ) ) && Read( &item.event.param4, sizeof( float ) ) &&
+                   ReadString( item.event.event );
+            item.event.type = ( EventType )event_type;
+            item.event.button = button;
+        }
+        else if( type == RECORD_COMMAND )
+        {
+            read = ReadString( item.line );
+        }
+
+        if( read == false )
+        {
+            LOG_ERROR( "Record is broken at tick " + Ogre::StringConverter::toString( m_Tick ) + "." );
+            StopReplay();
+            return delta;
+        }
+
+        m_ReplayItems.push_back( item );
+    }
+
+    if( Read( &m_ReplayHash, sizeof( m_ReplayHash ) ) == false )
+    {
+        StopReplay();
+        return delta;
+    }
+
+    m_InTick = true;
+    return replay_delta;
+}
+
+
+
+void
+Recorder::EndTick( const unsigned int hash )
+{
+    // recorder was started in middle of tick
+    if( m_InTick == false )
+    {
+        return;
+    }
+    m_InTick = false;
+
+    if( m_State == RS_RECORD )
+    {
+        Write( &RECORD_HASH, 1 );
+        Write( &hash, sizeof( hash ) );
+    }
+    else if( m_State == RS_REPLAY )
+    {
+        if( hash != m_ReplayHash )
+        {
+            if( m_Mismatches == 0 )
+            {
+                LOG_WARNING( "Replay state differs from record at tick " + Ogre::StringConverter::toString( m_Tick ) + "." );
+            }
+            ++m_Mismatches;
+        }
+    }
+    else
+    {
+        return;
+    }
+
+    ++m_Tick;
+}
+
+
+
+void
+Recorder::RecordEvent( const Event& event )
+{
+    if( m_State != RS_RECORD || m_InTick == false )
+    {
+        return;
+    }
+
+    unsigned char type = ( unsigned char )event.type;
+    Write( &RECORD_EVENT, 1 );
+    Write( &type, 1 );
+    Write( &event.button, sizeof( event.button ) );
+    Write( &event.param1, sizeof( float ) );
+    Write( &event.param2, sizeof( float ) );
+    Write( &event.param3, sizeof( float ) );
+    Write( &event.param4, sizeof( float ) );
+    WriteString( event.event );
+}
+
+
+
+void
+Recorder::RecordCommand( const Ogre::String& command )
+{
+    if( m_State != RS_RECORD || m_InTick == false )
+    {
+        return;
+    }
+
+    Write( &RECORD_COMMAND, 1 );
+    WriteString( command );
+}
+
+
+
+void
+Recorder::ReplayInput()
+{
+    for( unsigned int i = 0; i < m_ReplayItems.size(); ++i )
+    {
+        const ReplayItem& item = m_ReplayItems[ i ];
+        if( item.command == false )
+        {
+            InputManager::getSingleton().DispatchReplayEvent( item.event );
+        }
+        // same as console does with typed line
+        else if( item.line.size() > 0 && ( item.line[ 0 ] == '\\' || item.line[ 0 ] == '/' ) )
+        {
+            if( item.line.size() > 1 )
+            {
+                Console::getSingleton().ExecuteCommand( item.line.substr( 1 ) );
+            }
+        }
+        else
+        {
+            ScriptManager::getSingleton().RunString( item.line );
+        }
+    }
+    m_ReplayItems.clear();
+}
+
+
+
+void
+Recorder::Write( const void* data, const unsigned int size )
+{
+    m_RecordFile.write( ( const char* )data, size );
+}
+
+
+
+bool
+Recorder::Read( void* data, const unsigned int size )
+{
+    if( m_ReplayPosition + size > m_ReplayData.size() )
+    {
+        return false;
+    }
+
+    std::memcpy( data, m_ReplayData.data() + m_ReplayPosition, size );
+    m_ReplayPosition += size;
+    return true;
+}
+
+
+
+void
+Recorder::WriteString( const Ogre::String& string )
+{
+    unsigned short size = ( unsigned short )std::min< size_t >( string.size(), 0xffff );
+    Write( &size, sizeof( size ) );
+    Write( string.data(), size );
+}
+
+
+
+bool
+Recorder::ReadString( Ogre::String& string )
+{
+    unsigned short size = 0;
+    if( Read( &size, sizeof( size ) ) == false || m_ReplayPosition + size > m_ReplayData.size() )
+    {
+        return false;
+    }
+
+    string.assign( m_ReplayData.data() + m_ReplayPosition, size );
+    m_ReplayPosition += size;
+    return true;
+}
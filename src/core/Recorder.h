@@ -0,0 +1,87 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <OgreSingleton.h>
+#include <OgreString.h>
+#include <fstream>
+#include <vector>
+
+#include "Event.h"
+
+
+
+// Records session to binary file and plays it back. For every tick file has
+// time delta, input events which went to game, console lines typed by user
+// and hash of simulation state after tick. Replay uses recorded deltas instead
+// of real time and recorded input instead of devices, so same record gives
+// same simulation. Hash shows tick where replay went other way. Record and
+// replay should start from same state (for example both from start of game).
+// Headless replay runs all ticks without drawing as fast as possible.
+class Recorder : public Ogre::Singleton< Recorder >
+{
+public:
+    Recorder();
+    virtual ~Recorder();
+
+    void StartRecord( const Ogre::String& file_name );
+    void StopRecord();
+    bool IsRecording() const;
+
+    void StartReplay( const Ogre::String& file_name, const bool headless, const bool exit_at_end );
+    void StopReplay();
+    bool IsReplaying() const;
+    bool IsHeadless() const;
+
+    // called at start of tick with real time, returns time tick must use
+    float BeginTick( const float delta );
+    // called at end of tick with hash of simulation state
+    void EndTick( const unsigned int hash );
+
+    void RecordEvent( const Event& event );
+    void RecordCommand( const Ogre::String& command );
+
+    // passes recorded events and commands of current tick to game
+    void ReplayInput();
+
+private:
+    void InitCmd();
+
+    void Write( const void* data, const unsigned int size );
+    bool Read( void* data, const unsigned int size );
+    void WriteString( const Ogre::String& string );
+    bool ReadString( Ogre::String& string );
+
+private:
+    enum State
+    {
+        RS_NONE,
+        RS_RECORD,
+        RS_REPLAY
+    };
+    State m_State;
+
+    std::ofstream m_RecordFile;
+
+    Ogre::String m_ReplayData;
+    unsigned int m_ReplayPosition;
+    bool m_Headless;
+    bool m_ExitAtEnd;
+
+    struct ReplayItem
+    {
+        bool command;
+        Event event;
+        Ogre::String line;
+    };
+    std::vector< ReplayItem > m_ReplayItems; // input of current tick
+    unsigned int m_ReplayHash;
+
+    unsigned int m_Tick;
+    unsigned int m_Mismatches;
+    unsigned long long m_StartTime;
+    bool m_InTick; // tick was started after record or replay start
+};
+
+
+
+#endif // RECORDER_H
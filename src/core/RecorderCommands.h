@@ -0,0 +1,57 @@
+#include "ConfigCmdManager.h"
+#include "Console.h"
+
+
+
+void
+CmdRecord( const Ogre::StringVector& params )
+{
+    if( params.size() != 2 )
+    {
+        Console::getSingleton().AddTextToOutput( "Usage: /record <file name>" );
+        return;
+    }
+
+    Recorder::getSingleton().StartRecord( params[ 1 ] );
+}
+
+
+
+void
+CmdRecordStop( const Ogre::StringVector& params )
+{
+    Recorder::getSingleton().StopRecord();
+}
+
+
+
+void
+CmdReplay( const Ogre::StringVector& params )
+{
+    if( params.size() < 2 || params.size() > 3 || ( params.size() == 3 && params[ 2 ] != "headless" ) )
+    {
+        Console::getSingleton().AddTextToOutput( "Usage: /replay <file name> [headless]" );
+        return;
+    }
+
+    Recorder::getSingleton().StartReplay( params[ 1 ], params.size() == 3, false );
+}
+
+
+
+void
+CmdReplayStop( const Ogre::StringVector& params )
+{
+    Recorder::getSingleton().StopReplay();
+}
+
+
+
+void
+Recorder::InitCmd()
+{
+    ConfigCmdManager::getSingleton().AddCommand( "record", "Record input and time of session to file", "", CmdRecord, NULL );
+    ConfigCmdManager::getSingleton().AddCommand( "record_stop", "Stop recording of session", "", CmdRecordStop, NULL );
+    ConfigCmdManager::getSingleton().AddCommand( "replay", "Replay recorded session, headless replay isn't drawn", "", CmdReplay, NULL );
+    ConfigCmdManager::getSingleton().AddCommand( "replay_stop", "Stop replay of session", "", CmdReplayStop, NULL );
+}
@@ -1,10 +1,23 @@
 #include "ScriptManager.h"
 #include "ScriptManagerBinds.h"
 #include "ScriptManagerCommands.h"
+#include "ScriptManagerBenchmarks.h"
+
+#include <OgreRoot.h>
+#include <boost/bind.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sys/stat.h>
+#include <sys/types.h>
 
 #include "ConfigVar.h"
+#include "Counters.h"
 #include "DebugDraw.h"
+#include "FrameBudget.h"
 #include "Logger.h"
+#include "MemoryTracker.h"
+#include "Profiler.h"
 #include "Timer.h"
 #include "Utilites.h"
 #include "XmlScriptsFile.h"
@@ -13,6 +26,7 @@ extern "C"
     #include "library/lua/lua.h"
     #include "library/lua/lualib.h"
     #include "library/lua/lauxlib.h"
+    #include "library/lua/lstate.h"
 }
 #include "library/luabind/luabind.hpp"
 #include "library/luabind/yield_policy.hpp"
@@ -20,8 +34,22 @@ extern "C"
 
 
 ConfigVar cv_debug_script( "debug_script", "Debug script flags. 0x01 - System, 0x02 - Entity, 0x04 - Ui.", "0" );
+ConfigVar cv_script_budget( "script_budget", "Max number of lua instructions per script resume. Script preempted and continued next cycle if exceeded. 0 - no limit.", "1000000" );
+ConfigVar cv_script_profile( "script_profile", "Sample script execution per lua source line", "false" );
+ConfigVar cv_script_cache( "script_cache", "Load script files from precompiled bytecode cache if source not changed", "true" );
+ConfigVar cv_script_hot_reload( "script_hot_reload", "Watch script files and reload them on change", "false" );
+ConfigVar cv_script_threads( "script_threads", "Update entity scripts in worker thread while ui and camera are updated", "false" );
 
 Ogre::String script_entity_type[] = { "SYSTEM", "ENTITY", "UI" };
+Ogre::String script_table_name[] = { "System", "Entity", "UiContainer" };
+Ogre::String script_memory_counter[] = { "lua_memory_kb_system", "lua_memory_kb_entity", "lua_memory_kb_ui" };
+
+// number of lua instructions between profiler samples
+const int SCRIPT_PROFILE_STEP = 1000;
+
+// bytecode cache file is stored near source as "<file>c": magic, source hash, lua_dump output
+const char SCRIPT_CACHE_MAGIC[] = "XGLC";
+const size_t SCRIPT_CACHE_HEADER_SIZE = 8;
 
 bool
 priority_queue_compare( QueueScript a, QueueScript b )
@@ -29,6 +57,59 @@ priority_queue_compare( QueueScript a, QueueScript b )
     return a.priority < b.priority;
 }
 
+bool
+profile_compare( const ScriptProfile& a, const ScriptProfile& b )
+{
+    return a.time > b.time;
+}
+
+void
+script_hook( lua_State* state, lua_Debug* debug )
+{
+    ScriptManager::getSingleton().ScriptHook( state, debug );
+}
+
+// same as default lua allocator. Domain is passed as user data so we can find domain by state.
+// Memory of each domain is counted in its own tag.
+void*
+script_alloc( void* ud, void* ptr, size_t osize, size_t nsize )
+{
+    MemoryTag tag = ( MemoryTag )( MEMORY_LUA_SYSTEM + ( ( ScriptDomain* )ud )->type );
+    if( osize > 0 )
+    {
+        MemoryTracker::Freed( tag, osize );
+    }
+    if( nsize > 0 )
+    {
+        MemoryTracker::Allocated( tag, nsize );
+    }
+
+    if( nsize == 0 )
+    {
+        free( ptr );
+        return NULL;
+    }
+    return realloc( ptr, nsize );
+}
+
+time_t
+script_file_modified( const Ogre::String& file_name )
+{
+    struct stat info;
+    if( stat( file_name.c_str(), &info ) != 0 )
+    {
+        return 0;
+    }
+    return info.st_mtime;
+}
+
+int
+script_dump_writer( lua_State* state, const void* p, size_t size, void* data )
+{
+    ( ( Ogre::String* )data )->append( ( const char* )p, size );
+    return 0;
+}
+
 
 
 template<>ScriptManager *Ogre::Singleton< ScriptManager >::msSingleton = NULL;
@@ -36,21 +117,30 @@ template<>ScriptManager *Ogre::Singleton< ScriptManager >::msSingleton = NULL;
 
 
 ScriptManager::ScriptManager():
-    m_SystemTableName( "System" ),
-    m_EntityTableName( "Entity" ),
-    m_UiTableName( "UiContainer" )
+    m_HotReloadTimer( 0 )
 {
     LOG_TRIVIAL( "ScriptManager started." );
 
-    m_LuaState = lua_open();
-    luabind::open( m_LuaState );
-    luaopen_base( m_LuaState );
-    luaopen_string( m_LuaState );
-    luaopen_table( m_LuaState );
-    luaopen_math( m_LuaState );
+    for( int i = 0; i < 3; ++i )
+    {
+        ScriptDomain* domain = new ScriptDomain();
+        domain->type = ( Type )i;
+        domain->table_name = script_table_name[ i ];
+        domain->memory_counter = Counters::getSingleton().Register( script_memory_counter[ i ], Counters::GAUGE );
+        domain->state = lua_newstate( script_alloc, domain );
+        m_Domain[ i ] = domain;
+
+        luabind::open( domain->state );
+        luaopen_base( domain->state );
+        luaopen_string( domain->state );
+        luaopen_table( domain->state );
+        luaopen_math( domain->state );
+
+        InitBinds( ( Type )i );
+    }
 
-    InitBinds();
     InitCmd();
+    InitBenchmarks();
 
     //XmlScriptsFile scripts( "./data/scripts.xml" );
     //scripts.LoadScripts();
@@ -60,7 +150,29 @@ ScriptManager::ScriptManager():
 
 ScriptManager::~ScriptManager()
 {
-    lua_close( m_LuaState );
+    for( int i = 0; i < 3; ++i )
+    {
+        ScriptDomain* domain = m_Domain[ i ];
+
+        if( domain->worker != NULL )
+        {
+            {
+                boost::mutex::scoped_lock lock( domain->worker_mutex );
+                domain->worker_state = ScriptDomain::WORKER_EXIT;
+            }
+            domain->worker_condition.notify_all();
+            domain->worker->join();
+            delete domain->worker;
+        }
+
+        // widgets can live longer than scripts, their handles must go before state
+        if( UiManager::getSingletonPtr() != NULL )
+        {
+            UiManager::getSingleton().ClearScriptHandles( domain->state );
+        }
+        lua_close( domain->state );
+        delete domain;
+    }
 
     LOG_TRIVIAL( "ScriptManager closed." );
 }
@@ -82,18 +194,23 @@ ScriptManager::Input( const Event& event )
                                         event.param1 == OIS::KC_UP
                                       ) )
     {
-        for( unsigned int i = 0; i < m_ScriptEntity.size(); ++i )
+        Ogre::String argument2 = "";
+        if( event.type == ET_PRESS )
         {
-            Ogre::String argument2 = "";
-            if( event.type == ET_PRESS )
-            {
-                argument2 = "Press";
-            }
-            else if( event.type == ET_REPEAT_WAIT )
+            argument2 = "Press";
+        }
+        else if( event.type == ET_REPEAT_WAIT )
+        {
+            argument2 = "Repeat";
+        }
+
+        // input handled before workers started so we can add requests directly to all domains
+        for( int i = 0; i < 3; ++i )
+        {
+            for( unsigned int j = 0; j < m_Domain[ i ]->entity.size(); ++j )
             {
-                argument2 = "Repeat";
+                ScriptRequest( &m_Domain[ i ]->entity[ j ], "on_button", 100, KeyToString( ( OIS::KeyCode )( int )event.param1 ), argument2, ScriptId(), ScriptId() );
             }
-            ScriptRequest( &m_ScriptEntity[ i ], "on_button", 100, KeyToString( ( OIS::KeyCode )( int )event.param1 ), argument2, false, false );
         }
     }
 }
@@ -103,25 +220,179 @@ ScriptManager::Input( const Event& event )
 void
 ScriptManager::Update( const ScriptManager::Type type )
 {
+    PROFILE_ZONE( ( type == ScriptManager::SYSTEM ) ? "ScriptManager::Update system" : ( type == ScriptManager::ENTITY ) ? "ScriptManager::Update entity" : "ScriptManager::Update ui" );
+
+    if( type == ScriptManager::SYSTEM )
+    {
+        UpdateHotReload();
+    }
+
+    ScriptDomain& domain = *m_Domain[ type ];
+
+    // handle requests and continues sended from other threads
+    UpdateMessages( domain );
+
+    Counters::getSingleton().Set( domain.memory_counter, ( float )lua_gc( domain.state, LUA_GCCOUNT, 0 ) );
+
+
+
     // resort all queue. This will give us correct info for debug draw.
-    for( unsigned int i = 0; i < m_ScriptEntity.size(); ++i )
+    for( unsigned int i = 0; i < domain.entity.size(); ++i )
+    {
+        if( domain.entity[ i ].queue.size() > 0 )
+        {
+            if( domain.entity[ i ].resort == true )
+            {
+                std::stable_sort( domain.entity[ i ].queue.begin(), domain.entity[ i ].queue.end(), priority_queue_compare );
+                domain.entity[ i ].resort = false;
+            }
+        }
+    }
+
+
+
+    // start from first entity deferred in last update so all entities get resumed
+    unsigned long long deadline = FrameBudget::getSingleton().GetDeadline( FrameBudget::SCRIPT );
+    unsigned int number = domain.entity.size();
+    unsigned int start = ( number > 0 ) ? domain.update_start % number : 0;
+    bool deferred = false;
+    for( unsigned int n = 0; n < number; ++n )
     {
-        if( m_ScriptEntity[ i ].type == type )
+        unsigned int i = ( start + n ) % number;
+        // scripts can remove entities
+        if( i >= domain.entity.size() )
+        {
+            continue;
+        }
+
+        domain.entity[ i ].update_time = 0;
+
+        if( domain.entity[ i ].queue.size() > 0 )
         {
-            if( m_ScriptEntity[ i ].queue.size() > 0 )
+            ScriptId& current = domain.current_script_id;
+            current.type = type;
+            current.entity = domain.entity[ i ].name;
+            current.function = domain.entity[ i ].queue[ 0 ].function;
+
+            if( domain.entity[ i ].queue[ 0 ].wait == false && n > 0 && Profiler::GetTime() > deadline )
+            {
+                if( deferred == false )
+                {
+                    domain.update_start = i;
+                    deferred = true;
+                }
+                COUNTER_ADD( "scripts_deferred", 1 );
+            }
+            else if( domain.entity[ i ].queue[ 0 ].wait == false )
+            {
+                if( domain.entity[ i ].queue[ 0 ].yield == false)
+                {
+                    LOG_TRIVIAL( "[SCRIPT] Start script \"" + current.function + "\" for entity \"" + current.entity + "\"." );
+
+                    if( domain.entity[ i ].queue[ 0 ].paused_script_start.entity != "" )
+                    {
+                        ContinueScriptExecution( type, domain.entity[ i ].queue[ 0 ].paused_script_start );
+                        domain.entity[ i ].queue[ 0 ].paused_script_start.entity = "";
+                    }
+
+                    lua_State* state = domain.entity[ i ].queue[ 0 ].state;
+                    luabind::object table = GetTableByEntityName( type, current.entity, state );
+
+                    if( table.is_valid() &&
+                        luabind::type( table ) == LUA_TTABLE &&
+                        luabind::type( table[ current.function ] ) == LUA_TFUNCTION )
+                    {
+                        // function( self, argument1, argument2 )
+                        luabind::object function = table[ current.function ];
+                        function.push( state );
+                        table.push( state );
+                        lua_pushstring( state, domain.entity[ i ].queue[ 0 ].argument1.c_str() );
+                        lua_pushstring( state, domain.entity[ i ].queue[ 0 ].argument2.c_str() );
+
+                        int ret = ResumeScript( domain, i, 3 );
+
+                        if( ret == 0 )
+                        {
+                            LOG_TRIVIAL( "[SCRIPT] Script \"" + current.function + "\" for entity \"" + current.entity + "\" finished." );
+                            if( domain.entity[ i ].queue[ 0 ].function != "on_update" )
+                            {
+                                RemoveEntityTopScript( domain.entity[ i ] );
+                            }
+                        }
+                        else if( ret == 1 )
+                        {
+                            LOG_TRIVIAL( "[SCRIPT] Script \"" + current.function + "\" for entity \"" + current.entity + "\" not paused and will be continued next cycle." );
+                            domain.entity[ i ].queue[ 0 ].yield = true;
+                        }
+                        else
+                        {
+                            LOG_TRIVIAL( "[SCRIPT] Script \"" + current.function + "\" for entity \"" + current.entity + "\" not finished yet." );
+                            domain.entity[ i ].queue[ 0 ].yield = true;
+                            domain.entity[ i ].queue[ 0 ].wait = true;
+                        }
+                    }
+                    else
+                    {
+                        LOG_WARNING( "Script \"" + current.function + "\" for entity \"" + current.entity + "\" doesn't exist." );
+                        RemoveEntityTopScript( domain.entity[ i ] );
+                    }
+                }
+                else
+                {
+                    LOG_TRIVIAL( "[SCRIPT] Continue function \"" + current.function + "\" for entity \"" + current.entity + "\"." );
+
+                    int ret = ResumeScript( domain, i, 0 );
+
+                    if( ret == 0 ) // finished
+                    {
+                        LOG_TRIVIAL( "[SCRIPT] Script \"" + current.function + "\" for entity \"" + current.entity + "\" finished." );
+
+                        // stop yield for on_update
+                        domain.entity[ i ].queue[ 0 ].yield = false;
+
+                        if( domain.entity[ i ].queue[ 0 ].function != "on_update" )
+                        {
+                            RemoveEntityTopScript( domain.entity[ i ] );
+                        }
+                    }
+                    else if( ret == 1 )
+                    {
+                        LOG_TRIVIAL( "[SCRIPT] Script \"" + current.function + "\" for entity \"" + current.entity + "\" not paused and will be continued next cycle." );
+                    }
+                    else
+                    {
+                        LOG_TRIVIAL( "[SCRIPT] Script \"" + current.function + "\" for entity \"" + current.entity + "\" not finished yet." );
+                        domain.entity[ i ].queue[ 0 ].wait = true;
+                    }
+                }
+            }
+            else if( domain.entity[ i ].queue[ 0 ].seconds_to_wait > 0 )
             {
-                if( m_ScriptEntity[ i ].resort == true )
+                domain.entity[ i ].queue[ 0 ].seconds_to_wait -= Timer::getSingleton().GetGameTimeDelta();
+                domain.entity[ i ].queue[ 0 ].seconds_to_wait = ( domain.entity[ i ].queue[ 0 ].seconds_to_wait < 0 ) ? 0 : domain.entity[ i ].queue[ 0 ].seconds_to_wait;
+
+                if( domain.entity[ i ].queue[ 0 ].seconds_to_wait == 0 )
                 {
-                    std::stable_sort( m_ScriptEntity[ i ].queue.begin(), m_ScriptEntity[ i ].queue.end(), priority_queue_compare );
-                    m_ScriptEntity[ i ].resort = false;
+                    domain.entity[ i ].queue[ 0 ].wait = false;
                 }
             }
         }
     }
 
+    // without deferred scripts order goes back to usual
+    if( deferred == false )
+    {
+        domain.update_start = 0;
+    }
+}
 
 
-    // draw debug before update. This way it will be posible to see scripts that run once
+
+void
+ScriptManager::UpdateDebug()
+{
+    // draw debug before update. This way it will be posible to see scripts that run once.
+    // Called from main thread before any domain is updated so workers are idle here.
     int debug = cv_debug_script.GetI();
     if( debug != 0 )
     {
@@ -133,191 +404,347 @@ ScriptManager::Update( const ScriptManager::Type type )
         {
             if( ( debug & ( 1 << i ) ) != 0 )
             {
+                const ScriptDomain& domain = *m_Domain[ i ];
+
                 DEBUG_DRAW.SetColour( Ogre::ColourValue( 0.0f, 0.8f, 0.0f, 1.0f ) );
-                DEBUG_DRAW.Text( 10.0f, y, "Script \"" + script_entity_type[ i ] + "\" entity:" );
+                DEBUG_DRAW.Text( 10.0f, y, "Script \"" + script_entity_type[ i ] + "\" entity" + ( ( domain.worker != NULL ) ? " (worker)" : "" ) + ":" );
                 y += 16.0f;
 
-                for( unsigned int j = 0; j < m_ScriptEntity.size(); ++j )
+                for( unsigned int j = 0; j < domain.entity.size(); ++j )
                 {
-                    if( m_ScriptEntity[ j ].type == i )
-                    {
-                        Ogre::String text = m_ScriptEntity[ j ].name;
+                    Ogre::String text = domain.entity[ j ].name;
 
-                        unsigned int queue_size = m_ScriptEntity[ j ].queue.size();
-                        if( queue_size > 0 )
-                        {
-                            text += ": ";
-                            DEBUG_DRAW.SetColour( Ogre::ColourValue( 0.8f, 0.8f, 0.0f, 1.0f ) );
-                        }
-                        else
+                    unsigned int queue_size = domain.entity[ j ].queue.size();
+                    if( queue_size > 0 )
+                    {
+                        text += ": ";
+                        DEBUG_DRAW.SetColour( Ogre::ColourValue( 0.8f, 0.8f, 0.0f, 1.0f ) );
+                    }
+                    else
+                    {
+                        DEBUG_DRAW.SetColour( Ogre::ColourValue( 0.5f, 0.5f, 0.5f, 1.0f ) );
+                    }
+                    for( unsigned int k = 0; k < queue_size; ++k )
+                    {
+                        if( k > 0 )
                         {
-                            DEBUG_DRAW.SetColour( Ogre::ColourValue( 0.5f, 0.5f, 0.5f, 1.0f ) );
+                            text += ", ";
                         }
-                        for( unsigned int k = 0; k < queue_size; ++k )
-                        {
-                            if( k > 0 )
-                            {
-                                text += ", ";
-                            }
-                            text += "(" + Ogre::StringConverter::toString( m_ScriptEntity[ j ].queue[ k ].priority ) + ")" + m_ScriptEntity[ j ].queue[ k ].function;
+                        text += "(" + Ogre::StringConverter::toString( domain.entity[ j ].queue[ k ].priority ) + ")" + domain.entity[ j ].queue[ k ].function;
 
-                            if( m_ScriptEntity[ j ].queue[ k ].wait == true )
+                        if( domain.entity[ j ].queue[ k ].wait == true )
+                        {
+                            if( domain.entity[ j ].queue[ k ].seconds_to_wait != 0 )
                             {
-                                if( m_ScriptEntity[ j ].queue[ k ].seconds_to_wait != 0 )
-                                {
-                                    text += ":wait( " + Ogre::StringConverter::toString( m_ScriptEntity[ j ].queue[ k ].seconds_to_wait ) + " )";
-                                }
+                                text += ":wait( " + Ogre::StringConverter::toString( domain.entity[ j ].queue[ k ].seconds_to_wait ) + " )";
                             }
                         }
+                    }
 
-                        DEBUG_DRAW.Text( 20.0f, y, text );
-                        y += 16.0f;
+                    if( domain.entity[ j ].update_time > 0 )
+                    {
+                        text += " [" + Ogre::StringConverter::toString( domain.entity[ j ].update_time, 3 ) + " ms]";
                     }
+
+                    DEBUG_DRAW.Text( 20.0f, y, text );
+                    y += 16.0f;
                 }
             }
         }
     }
+}
 
 
 
-    for( unsigned int i = 0; i < m_ScriptEntity.size(); ++i )
+void
+ScriptManager::UpdateAsync( const ScriptManager::Type type )
+{
+    // ui scripts works with widgets and ogre scene so they always stay in main thread
+    if( cv_script_threads.GetB() == false || type == ScriptManager::UI )
     {
-        if( m_ScriptEntity[ i ].type == type )
-        {
-            if( m_ScriptEntity[ i ].queue.size() > 0 )
-            {
-                m_CurrentScriptId.entity = m_ScriptEntity[ i ].name;
-                m_CurrentScriptId.function = m_ScriptEntity[ i ].queue[ 0 ].function;
+        Update( type );
+        return;
+    }
 
-                if( m_ScriptEntity[ i ].queue[ 0 ].wait == false )
-                {
-                    if( m_ScriptEntity[ i ].queue[ 0 ].yield == false)
-                    {
-                        LOG_TRIVIAL( "[SCRIPT] Start script \"" + m_CurrentScriptId.function + "\" for entity \"" + m_CurrentScriptId.entity + "\"." );
+    ScriptDomain& domain = *m_Domain[ type ];
 
-                        if( m_ScriptEntity[ i ].queue[ 0 ].paused_script_start.entity != "" )
-                        {
-                            ContinueScriptExecution( m_ScriptEntity[ i ].queue[ 0 ].paused_script_start );
-                            m_ScriptEntity[ i ].queue[ 0 ].paused_script_start.entity = "";
-                        }
+    if( domain.worker == NULL )
+    {
+        LOG_TRIVIAL( "[SCRIPT] Start worker thread for \"" + script_entity_type[ type ] + "\" scripts." );
+        domain.worker = new boost::thread( boost::bind( &ScriptManager::UpdateWorker, this, &domain ) );
+    }
 
-                        luabind::object table = GetTableByEntityName( type, m_CurrentScriptId.entity, m_ScriptEntity[ i ].queue[ 0 ].state );
+    {
+        boost::mutex::scoped_lock lock( domain.worker_mutex );
+        domain.worker_state = ScriptDomain::WORKER_RUN;
+    }
+    domain.worker_condition.notify_all();
+}
 
-                        if( table.is_valid() &&
-                            luabind::type( table ) == LUA_TTABLE &&
-                            luabind::type( table[ m_CurrentScriptId.function ] ) == LUA_TFUNCTION )
-                        {
-                            int ret = 0;
 
-                            try
-                            {
-                                ret = luabind::resume_function< int >( table[ m_CurrentScriptId.function ], table, m_ScriptEntity[ i ].queue[ 0 ].argument1.c_str(), m_ScriptEntity[ i ].queue[ 0 ].argument2.c_str() );
-                            }
-                            catch( luabind::error& e )
-                            {
-                                LOG_ERROR( Ogre::String( lua_tostring( m_ScriptEntity[ i ].queue[ 0 ].state , -1 ) ) );
-                            }
 
-                            if( ret == 0 )
-                            {
-                                LOG_TRIVIAL( "[SCRIPT] Script \"" + m_CurrentScriptId.function + "\" for entity \"" + m_CurrentScriptId.entity + "\" finished." );
-                                if( m_ScriptEntity[ i ].queue[ 0 ].function != "on_update" )
-                                {
-                                    RemoveEntityTopScript( m_ScriptEntity[ i ] );
-                                }
-                            }
-                            else if( ret == 1 )
-                            {
-                                LOG_TRIVIAL( "[SCRIPT] Script \"" + m_CurrentScriptId.function + "\" for entity \"" + m_CurrentScriptId.entity + "\" not paused and will be continued next cycle." );
-                                m_ScriptEntity[ i ].queue[ 0 ].yield = true;
-                            }
-                            else
-                            {
-                                LOG_TRIVIAL( "[SCRIPT] Script \"" + m_CurrentScriptId.function + "\" for entity \"" + m_CurrentScriptId.entity + "\" not finished yet." );
-                                m_ScriptEntity[ i ].queue[ 0 ].yield = true;
-                                m_ScriptEntity[ i ].queue[ 0 ].wait = true;
-                            }
-                        }
-                        else
-                        {
-                            LOG_WARNING( "Script \"" + m_CurrentScriptId.function + "\" for entity \"" + m_CurrentScriptId.entity + "\" doesn't exist." );
-                            RemoveEntityTopScript( m_ScriptEntity[ i ] );
-                        }
-                    }
-                    else
-                    {
-                        LOG_TRIVIAL( "[SCRIPT] Continue function \"" + m_CurrentScriptId.function + "\" for entity \"" + m_CurrentScriptId.entity + "\"." );
+void
+ScriptManager::UpdateWait( const ScriptManager::Type type )
+{
+    ScriptDomain& domain = *m_Domain[ type ];
 
-                        int ret = 0;
+    if( domain.worker == NULL )
+    {
+        return;
+    }
 
-                        try
-                        {
-                            ret = luabind::resume< int >( m_ScriptEntity[ i ].queue[ 0 ].state );
-                        }
-                        catch( luabind::error& e )
-                        {
-                            luabind::object error_msg( luabind::from_stack( e.state(), -1 ) );
-                            LOG_ERROR( Ogre::String( luabind::object_cast< std::string >( error_msg ) ) );
-                        }
+    boost::mutex::scoped_lock lock( domain.worker_mutex );
+    while( domain.worker_state == ScriptDomain::WORKER_RUN )
+    {
+        domain.worker_condition.wait( lock );
+    }
+}
 
-                        if( ret == 0 ) // finished
-                        {
-                            LOG_TRIVIAL( "[SCRIPT] Script \"" + m_CurrentScriptId.function + "\" for entity \"" + m_CurrentScriptId.entity + "\" finished." );
 
-                            // stop yield for on_update
-                            m_ScriptEntity[ i ].queue[ 0 ].yield = false;
 
-                            if( m_ScriptEntity[ i ].queue[ 0 ].function != "on_update" )
-                            {
-                                RemoveEntityTopScript( m_ScriptEntity[ i ] );
-                            }
-                        }
-                        else if( ret == 1 )
-                        {
-                            LOG_TRIVIAL( "[SCRIPT] Script \"" + m_CurrentScriptId.function + "\" for entity \"" + m_CurrentScriptId.entity + "\" not paused and will be continued next cycle." );
-                        }
-                        else
-                        {
-                            LOG_TRIVIAL( "[SCRIPT] Script \"" + m_CurrentScriptId.function + "\" for entity \"" + m_CurrentScriptId.entity + "\" not finished yet." );
-                            m_ScriptEntity[ i ].queue[ 0 ].wait = true;
-                        }
-                    }
-                }
-                else if( m_ScriptEntity[ i ].queue[ 0 ].seconds_to_wait > 0 )
-                {
-                    m_ScriptEntity[ i ].queue[ 0 ].seconds_to_wait -= Timer::getSingleton().GetGameTimeDelta();
-                    m_ScriptEntity[ i ].queue[ 0 ].seconds_to_wait = ( m_ScriptEntity[ i ].queue[ 0 ].seconds_to_wait < 0 ) ? 0 : m_ScriptEntity[ i ].queue[ 0 ].seconds_to_wait;
+void
+ScriptManager::UpdateWorker( ScriptDomain* domain )
+{
+    for( ;; )
+    {
+        {
+            boost::mutex::scoped_lock lock( domain->worker_mutex );
+            while( domain->worker_state == ScriptDomain::WORKER_IDLE )
+            {
+                domain->worker_condition.wait( lock );
+            }
+            if( domain->worker_state == ScriptDomain::WORKER_EXIT )
+            {
+                return;
+            }
+        }
 
-                    if( m_ScriptEntity[ i ].queue[ 0 ].seconds_to_wait == 0 )
-                    {
-                        m_ScriptEntity[ i ].queue[ 0 ].wait = false;
-                    }
-                }
+        Update( domain->type );
+
+        {
+            boost::mutex::scoped_lock lock( domain->worker_mutex );
+            // don't overwrite exit request
+            if( domain->worker_state == ScriptDomain::WORKER_RUN )
+            {
+                domain->worker_state = ScriptDomain::WORKER_IDLE;
             }
         }
+        domain->worker_condition.notify_all();
+    }
+}
+
+
+
+void
+ScriptManager::RunString( const Ogre::String& lua, const ScriptManager::Type type )
+{
+    lua_State* state = m_Domain[ type ]->state;
+
+    if( luaL_dostring( state, lua.c_str() ) == 1 )
+    {
+        LOG_ERROR( Ogre::String( lua_tostring( state, -1 ) ) );
+        lua_pop( state, 1 );
+    }
+}
+
+
+
+void
+ScriptManager::RunFile( const Ogre::String& file, const ScriptManager::Type type )
+{
+    unsigned int i = 0;
+    for( ; i < m_ScriptFiles.size(); ++i )
+    {
+        if( m_ScriptFiles[ i ].file == file && m_ScriptFiles[ i ].type == type )
+        {
+            break;
+        }
+    }
+    if( i == m_ScriptFiles.size() )
+    {
+        ScriptFile script_file;
+        script_file.file = file;
+        script_file.type = type;
+        script_file.modified = script_file_modified( "./data/" + file );
+        m_ScriptFiles.push_back( script_file );
+    }
+
+    lua_State* state = m_Domain[ type ]->state;
+
+    if( LoadFile( file, state ) == true )
+    {
+        if( lua_pcall( state, 0, 0, 0 ) != 0 )
+        {
+            LOG_ERROR( Ogre::String( lua_tostring( state, -1 ) ) );
+            lua_pop( state, 1 );
+        }
+    }
+}
+
+
+
+void
+ScriptManager::CompileFile( const Ogre::String& file )
+{
+    // loading updates cache if it's outdated. Bytecode doesn't depend on state so use system one.
+    lua_State* state = m_Domain[ SYSTEM ]->state;
+
+    if( LoadFile( file, state ) == true )
+    {
+        lua_pop( state, 1 );
+        LOG_TRIVIAL( "Script file \"" + file + "\" compiled." );
     }
 }
 
 
 
 void
-ScriptManager::RunString( const Ogre::String& lua )
+ScriptManager::CompileAllFiles()
 {
-    if( luaL_dostring( m_LuaState, lua.c_str() ) == 1 )
+    Ogre::StringVectorPtr files = Ogre::ResourceGroupManager::getSingleton().findResourceNames( "Game", "*.lua" );
+    for( size_t i = 0; i < files->size(); ++i )
     {
-        LOG_ERROR( Ogre::String( lua_tostring( m_LuaState, -1 ) ) );
+        CompileFile( ( *files )[ i ] );
     }
 }
 
 
 
 void
-ScriptManager::RunFile( const Ogre::String& file )
+ScriptManager::UpdateHotReload()
+{
+    if( cv_script_hot_reload.GetB() == false )
+    {
+        return;
+    }
+
+    // check files once per second
+    m_HotReloadTimer += Timer::getSingleton().GetSystemTimeDelta();
+    if( m_HotReloadTimer < 1.0f )
+    {
+        return;
+    }
+    m_HotReloadTimer = 0;
+
+    for( unsigned int i = 0; i < m_ScriptFiles.size(); ++i )
+    {
+        time_t modified = script_file_modified( "./data/" + m_ScriptFiles[ i ].file );
+        if( modified != 0 && modified != m_ScriptFiles[ i ].modified )
+        {
+            m_ScriptFiles[ i ].modified = modified;
+            ReloadFile( m_ScriptFiles[ i ].file );
+        }
+    }
+}
+
+
+
+void
+ScriptManager::ReloadFile( const Ogre::String& file )
+{
+    LOG_TRIVIAL( "Reload script file \"" + file + "\"." );
+
+    // Running coroutines keep closures they was started with and finish with old code.
+    // All new requests search function by name in table so they will use new code.
+    // File reloaded in every domain it was run in.
+    bool reloaded = false;
+    for( unsigned int i = 0; i < m_ScriptFiles.size(); ++i )
+    {
+        if( m_ScriptFiles[ i ].file == file )
+        {
+            RunFile( file, m_ScriptFiles[ i ].type );
+            reloaded = true;
+        }
+    }
+    if( reloaded == false )
+    {
+        RunFile( file, SYSTEM );
+    }
+
+    // file may recreate entity tables, so restore binded fields
+    for( int i = 0; i < 3; ++i )
+    {
+        ScriptDomain& domain = *m_Domain[ i ];
+
+        for( unsigned int j = 0; j < domain.entity.size(); ++j )
+        {
+            luabind::object table = GetTableByEntityName( domain.type, domain.entity[ j ].name, domain.state );
+            if( table.is_valid() == false || luabind::type( table ) != LUA_TTABLE )
+            {
+                LOG_WARNING( "Script \"" + script_entity_type[ domain.type ] + "\" entity \"" + domain.entity[ j ].name + "\" doesn't exist after reload of \"" + file + "\"." );
+                continue;
+            }
+
+            if( domain.entity[ j ].entity != NULL )
+            {
+                table[ "entity" ] = boost::ref( *domain.entity[ j ].entity );
+            }
+        }
+    }
+}
+
+
+
+bool
+ScriptManager::LoadFile( const Ogre::String& file, lua_State* state )
 {
-    if( luaL_dofile( m_LuaState, ( "./data/" + file ).c_str() ) == 1 )
+    Ogre::String file_name = "./data/" + file;
+    Ogre::String chunk_name = "@" + file_name;
+
+    Ogre::String source;
+    if( ReadFileData( file_name, source ) == false )
+    {
+        LOG_ERROR( "Can't open script file \"" + file_name + "\"." );
+        return false;
+    }
+
+    unsigned int hash = HashData( source );
+    bool use_cache = cv_script_cache.GetB();
+
+    if( use_cache == true )
+    {
+        Ogre::String cache;
+        if( ReadFileData( file_name + "c", cache ) == true &&
+            cache.size() > SCRIPT_CACHE_HEADER_SIZE &&
+            cache.compare( 0, 4, SCRIPT_CACHE_MAGIC ) == 0 &&
+            memcmp( cache.data() + 4, &hash, 4 ) == 0 )
+        {
+            if( luaL_loadbuffer( state, cache.data() + SCRIPT_CACHE_HEADER_SIZE, cache.size() - SCRIPT_CACHE_HEADER_SIZE, chunk_name.c_str() ) == 0 )
+            {
+                return true;
+            }
+
+            // cache from other lua version or broken. Compile from source.
+            LOG_WARNING( "Can't load script cache for \"" + file_name + "\": " + Ogre::String( lua_tostring( state, -1 ) ) );
+            lua_pop( state, 1 );
+        }
+    }
+
+    if( luaL_loadbuffer( state, source.data(), source.size(), chunk_name.c_str() ) != 0 )
+    {
+        LOG_ERROR( Ogre::String( lua_tostring( state, -1 ) ) );
+        lua_pop( state, 1 );
+        return false;
+    }
+
+    if( use_cache == true )
     {
-        LOG_ERROR( Ogre::String( lua_tostring( m_LuaState, -1 ) ) );
+        Ogre::String cache( SCRIPT_CACHE_MAGIC, 4 );
+        cache.append( ( const char* )&hash, 4 );
+        lua_dump( state, script_dump_writer, &cache );
+
+        std::ofstream cache_file( ( file_name + "c" ).c_str(), std::ios::out | std::ios::binary );
+        if( cache_file.is_open() )
+        {
+            cache_file.write( cache.data(), cache.size() );
+        }
+        else
+        {
+            LOG_WARNING( "Can't write script cache for \"" + file_name + "\"." );
+        }
     }
+
+    return true;
 }
 
 
@@ -325,22 +752,25 @@ ScriptManager::RunFile( const Ogre::String& file )
 void
 ScriptManager::AddEntity( const ScriptManager::Type type, const Ogre::String& entity_name, Entity* entity )
 {
-    for( unsigned int i = 0; i < m_ScriptEntity.size(); ++i )
+    ScriptDomain& domain = *m_Domain[ type ];
+
+    for( unsigned int i = 0; i < domain.entity.size(); ++i )
     {
-        if( ( m_ScriptEntity[ i ].type == type ) && ( m_ScriptEntity[ i ].name == entity_name ) )
+        if( domain.entity[ i ].name == entity_name )
         {
             LOG_ERROR( "Script \"" + script_entity_type[ type ] + "\" entity \"" + entity_name + "\" already exist in script manager." );
             return;
         }
     }
 
-    luabind::object table = GetTableByEntityName( type, entity_name, m_LuaState );
+    luabind::object table = GetTableByEntityName( type, entity_name, domain.state );
 
     if( table.is_valid() && luabind::type( table ) == LUA_TTABLE )
     {
         ScriptEntity script_entity;
         script_entity.name = entity_name;
         script_entity.type = type;
+        script_entity.entity = entity;
 
         // init entity field for model entity
         if( entity != NULL )
@@ -354,9 +784,9 @@ ScriptManager::AddEntity( const ScriptManager::Type type, const Ogre::String& en
             QueueScript script;
             script.function = "on_start";
             script.priority = 0;
-            script.state = lua_newthread( m_LuaState );
+            script.state = lua_newthread( domain.state );
             // we dont want thread to be garbage collected so we store it
-            script.state_id = luaL_ref( m_LuaState, LUA_REGISTRYINDEX );
+            script.state_id = luaL_ref( domain.state, LUA_REGISTRYINDEX );
             script.seconds_to_wait = 0;
             script.wait = false;
             script.yield = false;
@@ -369,16 +799,16 @@ ScriptManager::AddEntity( const ScriptManager::Type type, const Ogre::String& en
             QueueScript script;
             script.function = "on_update";
             script.priority = 999;
-            script.state = lua_newthread( m_LuaState );
+            script.state = lua_newthread( domain.state );
             // we dont want thread to be garbage collected so we store it
-            script.state_id = luaL_ref( m_LuaState, LUA_REGISTRYINDEX );
+            script.state_id = luaL_ref( domain.state, LUA_REGISTRYINDEX );
             script.seconds_to_wait = 0;
             script.wait = false;
             script.yield = false;
             script_entity.queue.push_back( script );
         }
 
-        m_ScriptEntity.push_back( script_entity );
+        domain.entity.push_back( script_entity );
     }
 }
 
@@ -387,16 +817,18 @@ ScriptManager::AddEntity( const ScriptManager::Type type, const Ogre::String& en
 void
 ScriptManager::RemoveEntity( const ScriptManager::Type type, const Ogre::String& entity_name )
 {
-    for( unsigned int i = 0; i < m_ScriptEntity.size(); ++i )
+    ScriptDomain& domain = *m_Domain[ type ];
+
+    for( unsigned int i = 0; i < domain.entity.size(); ++i )
     {
-        if( m_ScriptEntity[ i ].type == type && m_ScriptEntity[ i ].name == entity_name )
+        if( domain.entity[ i ].name == entity_name )
         {
-            while( m_ScriptEntity[ i ].queue.size() > 0 )
+            while( domain.entity[ i ].queue.size() > 0 )
             {
-                ScriptManager::RemoveEntityTopScript( m_ScriptEntity[ i ] );
+                ScriptManager::RemoveEntityTopScript( domain.entity[ i ] );
             }
 
-            m_ScriptEntity.erase( m_ScriptEntity.begin() + i );
+            domain.entity.erase( domain.entity.begin() + i );
 
             return;
         }
@@ -411,11 +843,11 @@ ScriptManager::RemoveEntityTopScript( ScriptEntity& entity )
     if( entity.queue.size() > 0 )
     {
         // delete thread
-        luaL_unref( m_LuaState, LUA_REGISTRYINDEX, entity.queue[ 0 ].state_id );
+        luaL_unref( m_Domain[ entity.type ]->state, LUA_REGISTRYINDEX, entity.queue[ 0 ].state_id );
 
         if( entity.queue[ 0 ].paused_script_end.entity != "" )
         {
-            ContinueScriptExecution( entity.queue[ 0 ].paused_script_end );
+            ContinueScriptExecution( entity.type, entity.queue[ 0 ].paused_script_end );
             entity.queue[ 0 ].paused_script_end.entity = "";
         }
 
@@ -431,13 +863,7 @@ ScriptManager::GetTableByEntityName( const ScriptManager::Type type, const Ogre:
     // get real table by name
     Ogre::StringVector table_path = StringTokenise( name, "." );
     luabind::object table = luabind::globals( state );
-
-    switch( type )
-    {
-        case ScriptManager::SYSTEM: table = table[ m_SystemTableName ]; break;
-        case ScriptManager::ENTITY: table = table[ m_EntityTableName ]; break;
-        case ScriptManager::UI: table = table[ m_UiTableName ]; break;
-    }
+    table = table[ m_Domain[ type ]->table_name ];
 
     if( luabind::type( table ) != LUA_TTABLE )
     {
@@ -461,15 +887,17 @@ ScriptManager::GetTableByEntityName( const ScriptManager::Type type, const Ogre:
 QueueScript*
 ScriptManager::GetScriptByScriptId( const ScriptId& script ) const
 {
-    for( unsigned int i = 0; i < m_ScriptEntity.size(); ++i )
+    const ScriptDomain& domain = *m_Domain[ script.type ];
+
+    for( unsigned int i = 0; i < domain.entity.size(); ++i )
     {
-        if( script.entity == m_ScriptEntity[ i ].name )
+        if( script.entity == domain.entity[ i ].name )
         {
-            for( unsigned int j = 0; j < m_ScriptEntity[ i ].queue.size(); ++j )
+            for( unsigned int j = 0; j < domain.entity[ i ].queue.size(); ++j )
             {
-                if( script.function == m_ScriptEntity[ i ].queue[ j ].function )
+                if( script.function == domain.entity[ i ].queue[ j ].function )
                 {
-                    return ( QueueScript* ) &( m_ScriptEntity[ i ].queue[ j ] );
+                    return ( QueueScript* ) &( domain.entity[ i ].queue[ j ] );
                 }
             }
 
@@ -485,11 +913,13 @@ ScriptManager::GetScriptByScriptId( const ScriptId& script ) const
 ScriptEntity*
 ScriptManager::GetScriptEntityByName( const Type type, const Ogre::String& entity_name ) const
 {
-    for( unsigned int i = 0; i < m_ScriptEntity.size(); ++i )
+    const ScriptDomain& domain = *m_Domain[ type ];
+
+    for( unsigned int i = 0; i < domain.entity.size(); ++i )
     {
-        if( m_ScriptEntity[ i ].type == type && m_ScriptEntity[ i ].name == entity_name )
+        if( domain.entity[ i ].name == entity_name )
         {
-            return ( ScriptEntity* ) &( m_ScriptEntity[ i ] );
+            return ( ScriptEntity* ) &( domain.entity[ i ] );
         }
     }
 
@@ -499,9 +929,9 @@ ScriptManager::GetScriptEntityByName( const Type type, const Ogre::String& entit
 
 
 const ScriptId
-ScriptManager::GetCurrentScriptId() const
+ScriptManager::GetCurrentScriptId( lua_State* state ) const
 {
-    return m_CurrentScriptId;
+    return GetDomain( state )->current_script_id;
 }
 
 
@@ -509,6 +939,24 @@ ScriptManager::GetCurrentScriptId() const
 void
 ScriptManager::ContinueScriptExecution( const ScriptId& script )
 {
+    // called by engine from main thread
+    ContinueScriptExecution( SYSTEM, script );
+}
+
+
+
+void
+ScriptManager::ContinueScriptExecution( const ScriptManager::Type from, const ScriptId& script )
+{
+    if( IsSameThread( from, ( Type )script.type ) == false )
+    {
+        ScriptMessage message;
+        message.continue_script = true;
+        message.script = script;
+        AddMessage( message );
+        return;
+    }
+
     QueueScript* script_pointer = GetScriptByScriptId( script );
 
     if( script_pointer == NULL )
@@ -523,11 +971,11 @@ ScriptManager::ContinueScriptExecution( const ScriptId& script )
 
 
 int
-ScriptManager::ScriptWait( const float seconds )
+ScriptManager::ScriptWait( lua_State* state, const float seconds )
 {
     LOG_TRIVIAL( "script:wait: We set script wait for " + Ogre::StringConverter::toString( seconds ) + " seconds." );
 
-    QueueScript* script = GetScriptByScriptId( m_CurrentScriptId );
+    QueueScript* script = GetScriptByScriptId( GetCurrentScriptId( state ) );
 
     if( script == NULL )
     {
@@ -548,10 +996,21 @@ ScriptManager::ScriptWait( const float seconds )
 
 
 void
-ScriptManager::ScriptRequest( const Type type, const char* entity, const char* function, const int priority )
+ScriptManager::ScriptRequest( lua_State* state, const Type type, const char* entity, const char* function, const int priority )
 {
     LOG_TRIVIAL( "[SCRIPT] script:request: Request function \"" + Ogre::String( function ) + "\" for entity \"" + Ogre::String( entity ) + "\" with priority " + Ogre::StringConverter::toString( priority ) + "." );
 
+    if( IsSameThread( GetDomain( state )->type, type ) == false )
+    {
+        ScriptMessage message;
+        message.script.type = type;
+        message.script.entity = entity;
+        message.script.function = function;
+        message.priority = priority;
+        AddMessage( message );
+        return;
+    }
+
     ScriptEntity* script_entity = GetScriptEntityByName( type, Ogre::String( entity ) );
 
     if( script_entity == NULL )
@@ -560,7 +1019,7 @@ ScriptManager::ScriptRequest( const Type type, const char* entity, const char* f
         return;
     }
 
-    bool added = ScriptRequest( script_entity, function, priority, "", "", false, false );
+    bool added = ScriptRequest( script_entity, function, priority, "", "", ScriptId(), ScriptId() );
 
     if( added == false )
     {
@@ -571,10 +1030,23 @@ ScriptManager::ScriptRequest( const Type type, const char* entity, const char* f
 
 
 int
-ScriptManager::ScriptRequestStartSync( const Type type, const char* entity, const char* function, const int priority )
+ScriptManager::ScriptRequestStartSync( lua_State* state, const Type type, const char* entity, const char* function, const int priority )
 {
     LOG_TRIVIAL( "[SCRIPT] script:request_start_sync: Request function \"" + Ogre::String( function ) + "\" for entity \"" + Ogre::String( entity ) + "\" with priority " + Ogre::StringConverter::toString( priority ) + "." );
 
+    // script in other thread will be continued by message (or by message about failed request)
+    if( IsSameThread( GetDomain( state )->type, type ) == false )
+    {
+        ScriptMessage message;
+        message.script.type = type;
+        message.script.entity = entity;
+        message.script.function = function;
+        message.priority = priority;
+        message.paused_script_start = GetCurrentScriptId( state );
+        AddMessage( message );
+        return -1;
+    }
+
     ScriptEntity* script_entity = GetScriptEntityByName( type, Ogre::String( entity ) );
 
     if( script_entity == NULL )
@@ -583,7 +1055,7 @@ ScriptManager::ScriptRequestStartSync( const Type type, const char* entity, cons
         return 1;
     }
 
-    bool added = ScriptRequest( script_entity, function, priority, "", "", true, false );
+    bool added = ScriptRequest( script_entity, function, priority, "", "", GetCurrentScriptId( state ), ScriptId() );
 
     if( added == false )
     {
@@ -597,10 +1069,22 @@ ScriptManager::ScriptRequestStartSync( const Type type, const char* entity, cons
 
 
 int
-ScriptManager::ScriptRequestEndSync( const Type type, const char* entity, const char* function, const int priority )
+ScriptManager::ScriptRequestEndSync( lua_State* state, const Type type, const char* entity, const char* function, const int priority )
 {
     LOG_TRIVIAL( "[SCRIPT] script:request_end_sync: Request function \"" + Ogre::String( function ) + "\" for entity \"" + Ogre::String( entity ) + "\" with priority " + Ogre::StringConverter::toString( priority ) + "." );
 
+    if( IsSameThread( GetDomain( state )->type, type ) == false )
+    {
+        ScriptMessage message;
+        message.script.type = type;
+        message.script.entity = entity;
+        message.script.function = function;
+        message.priority = priority;
+        message.paused_script_end = GetCurrentScriptId( state );
+        AddMessage( message );
+        return -1;
+    }
+
     ScriptEntity* script_entity = GetScriptEntityByName( type, Ogre::String( entity ) );
 
     if( script_entity == NULL )
@@ -609,7 +1093,7 @@ ScriptManager::ScriptRequestEndSync( const Type type, const char* entity, const
         return 1;
     }
 
-    bool added = ScriptRequest( script_entity, function, priority, "", "", false, true );
+    bool added = ScriptRequest( script_entity, function, priority, "", "", ScriptId(), GetCurrentScriptId( state ) );
 
     if( added == false )
     {
@@ -623,9 +1107,11 @@ ScriptManager::ScriptRequestEndSync( const Type type, const char* entity, const
 
 
 bool
-ScriptManager::ScriptRequest( ScriptEntity* script_entity, const Ogre::String& function, const int priority, const Ogre::String& argument1, const Ogre::String& argument2, bool start_sync, bool end_sync )
+ScriptManager::ScriptRequest( ScriptEntity* script_entity, const Ogre::String& function, const int priority, const Ogre::String& argument1, const Ogre::String& argument2, const ScriptId& paused_script_start, const ScriptId& paused_script_end )
 {
-    luabind::object table = GetTableByEntityName( script_entity->type, script_entity->name, m_LuaState );
+    lua_State* state = m_Domain[ script_entity->type ]->state;
+
+    luabind::object table = GetTableByEntityName( script_entity->type, script_entity->name, state );
     if( table.is_valid() && luabind::type( table ) == LUA_TTABLE && luabind::type( table[ function ] ) == LUA_TFUNCTION )
     {
         QueueScript script;
@@ -633,20 +1119,14 @@ ScriptManager::ScriptRequest( ScriptEntity* script_entity, const Ogre::String& f
         script.argument1 = argument1;
         script.argument2 = argument2;
         script.priority = priority;
-        script.state = lua_newthread( m_LuaState );
+        script.state = lua_newthread( state );
         // we dont want thread to be garbage collected so we store it
-        script.state_id = luaL_ref( m_LuaState, LUA_REGISTRYINDEX );
+        script.state_id = luaL_ref( state, LUA_REGISTRYINDEX );
         script.seconds_to_wait = 0;
         script.wait = false;
         script.yield = false;
-        if( start_sync == true )
-        {
-            script.paused_script_start = GetCurrentScriptId();
-        }
-        if( end_sync == true )
-        {
-            script.paused_script_end = GetCurrentScriptId();
-        }
+        script.paused_script_start = paused_script_start;
+        script.paused_script_end = paused_script_end;
         script_entity->queue.push_back( script );
         script_entity->resort = true;
 
@@ -659,11 +1139,298 @@ ScriptManager::ScriptRequest( ScriptEntity* script_entity, const Ogre::String& f
 
 
 void
-ScriptManager::AddValueToStack( const float value )
+ScriptManager::AddValueToStack( lua_State* state, const float value )
 {
-    QueueScript* script = GetScriptByScriptId( m_CurrentScriptId );
+    QueueScript* script = GetScriptByScriptId( GetCurrentScriptId( state ) );
     if( script != NULL )
     {
         lua_pushnumber( script->state, value );
     }
 }
+
+
+
+void
+ScriptManager::ScriptHook( lua_State* state, lua_Debug* debug )
+{
+    if( debug->event != LUA_HOOKCOUNT )
+    {
+        return;
+    }
+
+    ScriptDomain& domain = *GetDomain( state );
+
+    domain.resume_instructions += domain.resume_step;
+
+    if( cv_script_profile.GetB() == true )
+    {
+        unsigned long time = Ogre::Root::getSingleton().getTimer()->getMicroseconds();
+
+        // time since last sample goes to line that executes now
+        lua_getinfo( state, "Sl", debug );
+        Ogre::String line = Ogre::String( debug->short_src ) + ":" + Ogre::StringConverter::toString( debug->currentline );
+        double sample_time = ( time - domain.profile_sample_time ) / 1000.0;
+        {
+            boost::mutex::scoped_lock lock( m_ProfileMutex );
+            ScriptProfile& profile = m_ProfileLine[ line ];
+            profile.name = line;
+            profile.calls += 1;
+            profile.time += sample_time;
+            profile.max_time = ( sample_time > profile.max_time ) ? sample_time : profile.max_time;
+        }
+
+        domain.profile_sample_time = time;
+    }
+
+    int budget = cv_script_budget.GetI();
+    if( budget > 0 && domain.resume_instructions >= budget )
+    {
+        // lua can't yield across C call boundary (metamethods, pcall, binded functions that call lua).
+        // In this case we check again a bit later.
+        if( state->nCcalls <= state->baseCcalls )
+        {
+            domain.resume_preempted = true;
+            lua_yield( state, 0 );
+        }
+    }
+}
+
+
+
+void
+ScriptManager::ProfilePrint( const unsigned int number ) const
+{
+    std::vector< ScriptProfile > functions;
+    std::vector< ScriptProfile > lines;
+    {
+        boost::mutex::scoped_lock lock( m_ProfileMutex );
+        std::map< Ogre::String, ScriptProfile >::const_iterator it;
+        for( it = m_ProfileFunction.begin(); it != m_ProfileFunction.end(); ++it )
+        {
+            functions.push_back( it->second );
+        }
+        for( it = m_ProfileLine.begin(); it != m_ProfileLine.end(); ++it )
+        {
+            lines.push_back( it->second );
+        }
+    }
+    std::sort( functions.begin(), functions.end(), profile_compare );
+    std::sort( lines.begin(), lines.end(), profile_compare );
+
+    Console::getSingleton().AddTextToOutput( "Script functions (total ms, calls, max ms, preempts):" );
+    for( unsigned int i = 0; i < functions.size() && i < number; ++i )
+    {
+        Console::getSingleton().AddTextToOutput( " " + Ogre::StringConverter::toString( ( float )functions[ i ].time, 3 ) + " " + Ogre::StringConverter::toString( functions[ i ].calls ) + " " + Ogre::StringConverter::toString( ( float )functions[ i ].max_time, 3 ) + " " + Ogre::StringConverter::toString( functions[ i ].preempts ) + " " + functions[ i ].name );
+    }
+
+    Console::getSingleton().AddTextToOutput( "Script lines (total ms, samples):" );
+    if( cv_script_profile.GetB() == false && lines.size() == 0 )
+    {
+        Console::getSingleton().AddTextToOutput( " set \"script_profile\" to true to sample lines." );
+    }
+    for( unsigned int i = 0; i < lines.size() && i < number; ++i )
+    {
+        Console::getSingleton().AddTextToOutput( " " + Ogre::StringConverter::toString( ( float )lines[ i ].time, 3 ) + " " + Ogre::StringConverter::toString( lines[ i ].calls ) + " " + lines[ i ].name );
+    }
+}
+
+
+
+void
+ScriptManager::ProfileDump( const Ogre::String& file_name ) const
+{
+    std::ofstream file( file_name.c_str() );
+    if( !file.is_open() )
+    {
+        LOG_ERROR( "Failed to open script profile file \"" + file_name + "\" for writing." );
+        return;
+    }
+
+    file << "type;name;calls;time_ms;max_time_ms;preempts\n";
+
+    {
+        boost::mutex::scoped_lock lock( m_ProfileMutex );
+        std::map< Ogre::String, ScriptProfile >::const_iterator it;
+        for( it = m_ProfileFunction.begin(); it != m_ProfileFunction.end(); ++it )
+        {
+            file << "function;" << it->second.name << ";" << it->second.calls << ";" << it->second.time << ";" << it->second.max_time << ";" << it->second.preempts << "\n";
+        }
+        for( it = m_ProfileLine.begin(); it != m_ProfileLine.end(); ++it )
+        {
+            file << "line;" << it->second.name << ";" << it->second.calls << ";" << it->second.time << ";" << it->second.max_time << ";" << it->second.preempts << "\n";
+        }
+    }
+
+    LOG_TRIVIAL( "Script profile dumped to \"" + file_name + "\"." );
+}
+
+
+
+void
+ScriptManager::ProfileReset()
+{
+    boost::mutex::scoped_lock lock( m_ProfileMutex );
+    m_ProfileFunction.clear();
+    m_ProfileLine.clear();
+}
+
+
+
+ScriptDomain*
+ScriptManager::GetDomain( lua_State* state ) const
+{
+    // all threads of one lua state share allocator with domain as user data
+    void* ud = NULL;
+    lua_getallocf( state, &ud );
+    return ( ScriptDomain* )ud;
+}
+
+
+
+lua_State*
+ScriptManager::GetMainState( lua_State* state ) const
+{
+    return GetDomain( state )->state;
+}
+
+
+
+bool
+ScriptManager::IsSameThread( const ScriptManager::Type from, const ScriptManager::Type to ) const
+{
+    return from == to || ( m_Domain[ from ]->worker == NULL && m_Domain[ to ]->worker == NULL );
+}
+
+
+
+void
+ScriptManager::AddMessage( const ScriptMessage& message )
+{
+    ScriptDomain& domain = *m_Domain[ message.script.type ];
+    boost::mutex::scoped_lock lock( domain.message_mutex );
+    domain.message.push_back( message );
+}
+
+
+
+void
+ScriptManager::UpdateMessages( ScriptDomain& domain )
+{
+    std::vector< ScriptMessage > message;
+    {
+        boost::mutex::scoped_lock lock( domain.message_mutex );
+        message.swap( domain.message );
+    }
+
+    for( unsigned int i = 0; i < message.size(); ++i )
+    {
+        if( message[ i ].continue_script == true )
+        {
+            ContinueScriptExecution( domain.type, message[ i ].script );
+            continue;
+        }
+
+        ScriptEntity* script_entity = GetScriptEntityByName( domain.type, message[ i ].script.entity );
+        bool added = false;
+        if( script_entity != NULL )
+        {
+            added = ScriptRequest( script_entity, message[ i ].script.function, message[ i ].priority, message[ i ].argument1, message[ i ].argument2, message[ i ].paused_script_start, message[ i ].paused_script_end );
+        }
+
+        if( added == false )
+        {
+            LOG_WARNING( "Script '" + message[ i ].script.function + "' for entity '" + message[ i ].script.entity + "' doesn't exist." );
+
+            // don't leave requesting script waiting forever
+            if( message[ i ].paused_script_start.entity != "" )
+            {
+                ContinueScriptExecution( domain.type, message[ i ].paused_script_start );
+            }
+            if( message[ i ].paused_script_end.entity != "" )
+            {
+                ContinueScriptExecution( domain.type, message[ i ].paused_script_end );
+            }
+        }
+    }
+}
+
+
+
+int
+ScriptManager::ResumeScript( ScriptDomain& domain, const unsigned int entity_id, const int arguments )
+{
+    lua_State* state = domain.entity[ entity_id ].queue[ 0 ].state;
+    const Ogre::String entity_name = domain.entity[ entity_id ].name;
+
+    // count hook used for instruction budget and for profiler samples
+    int budget = cv_script_budget.GetI();
+    domain.resume_step = ( budget > 0 ) ? budget : 0;
+    if( cv_script_profile.GetB() == true && ( domain.resume_step == 0 || domain.resume_step > SCRIPT_PROFILE_STEP ) )
+    {
+        domain.resume_step = SCRIPT_PROFILE_STEP;
+    }
+    domain.resume_instructions = 0;
+    domain.resume_preempted = false;
+    lua_sethook( state, ( domain.resume_step > 0 ) ? script_hook : NULL, LUA_MASKCOUNT, domain.resume_step );
+
+    Ogre::Timer* timer = Ogre::Root::getSingleton().getTimer();
+    unsigned long start = timer->getMicroseconds();
+    domain.profile_sample_time = start;
+
+    COUNTER_ADD( "scripts_resumed", 1 );
+    int status = lua_resume( state, arguments );
+
+    double time = ( timer->getMicroseconds() - start ) / 1000.0;
+
+    const ScriptId& current = domain.current_script_id;
+
+    int ret = 0;
+    if( status == LUA_YIELD )
+    {
+        if( domain.resume_preempted == true )
+        {
+            LOG_TRIVIAL( "[SCRIPT] Script \"" + current.function + "\" for entity \"" + current.entity + "\" preempted after " + Ogre::StringConverter::toString( domain.resume_instructions ) + " instructions." );
+            ret = 1;
+        }
+        else
+        {
+            // yielded binded functions return 1 to continue next cycle and -1 to wait
+            ret = ( lua_gettop( state ) > 0 && lua_isnumber( state, -1 ) ) ? ( int )lua_tonumber( state, -1 ) : 1;
+        }
+    }
+    else if( status != 0 )
+    {
+        LOG_ERROR( ( lua_isstring( state, -1 ) ) ? Ogre::String( lua_tostring( state, -1 ) ) : Ogre::String( "Unknown script error." ) );
+    }
+    lua_settop( state, 0 );
+
+    // script can add or remove entities so we can't store reference to entity during resume,
+    // index is checked to still point to same entity
+    if( entity_id < domain.entity.size() && domain.entity[ entity_id ].name == entity_name )
+    {
+        domain.entity[ entity_id ].update_time += ( float )time;
+    }
+    else
+    {
+        for( unsigned int i = 0; i < domain.entity.size(); ++i )
+        {
+            if( domain.entity[ i ].name == entity_name )
+            {
+                domain.entity[ i ].update_time += ( float )time;
+                break;
+            }
+        }
+    }
+
+    {
+        boost::mutex::scoped_lock lock( m_ProfileMutex );
+        ScriptProfile& profile = m_ProfileFunction[ current.entity + "." + current.function ];
+        profile.name = current.entity + "." + current.function;
+        profile.calls += 1;
+        profile.time += time;
+        profile.max_time = ( time > profile.max_time ) ? time : profile.max_time;
+        profile.preempts += ( domain.resume_preempted == true ) ? 1 : 0;
+    }
+
+    return ret;
+}
@@ -3,6 +3,9 @@
 
 #include <OgreSingleton.h>
 #include <OgreString.h>
+#include <boost/thread.hpp>
+#include <ctime>
+#include <map>
 
 #include "Event.h"
 extern "C"
@@ -17,8 +20,9 @@ class Entity;
 
 struct ScriptId
 {
-    ScriptId(): entity( "" ), function( "" ){}
+    ScriptId(): type( 0 ), entity( "" ), function( "" ){}
 
+    int type; // ScriptManager::Type, domain where entity is
     Ogre::String entity;
     Ogre::String function;
 };
@@ -26,6 +30,26 @@ struct ScriptId
 
 
 struct ScriptEntity;
+struct ScriptDomain;
+
+
+
+struct ScriptProfile
+{
+    ScriptProfile():
+        name( "" ),
+        calls( 0 ),
+        time( 0 ),
+        max_time( 0 ),
+        preempts( 0 )
+    {}
+
+    Ogre::String name;
+    unsigned int calls; // number of resumes for functions, number of samples for lines
+    double time; // milliseconds
+    double max_time; // milliseconds
+    unsigned int preempts;
+};
 
 
 
@@ -57,7 +81,28 @@ struct QueueScript
 
 
 
-class ScriptManager : public Ogre::Singleton< ScriptManager >
+// request or continue of script passed to domain that may run in other thread
+struct ScriptMessage
+{
+    ScriptMessage():
+        continue_script( false ),
+        priority( 0 ),
+        argument1( "" ),
+        argument2( "" )
+    {}
+
+    bool continue_script; // continue paused script, otherwise request new one
+    ScriptId script;
+    int priority;
+    Ogre::String argument1;
+    Ogre::String argument2;
+    ScriptId paused_script_start;
+    ScriptId paused_script_end;
+};
+
+
+
+class ScriptManager : public Ogre::Singleton< ScriptManager >, public InputListener
 {
 public:
     enum Type
@@ -72,12 +117,19 @@ public:
 
     void Input( const Event& event );
     void Update( const Type type );
+    void UpdateDebug();
+    void UpdateAsync( const Type type );
+    void UpdateWait( const Type type );
 
-    void RunString( const Ogre::String& lua );
-    void RunFile( const Ogre::String& file );
+    void RunString( const Ogre::String& lua, const Type type = SYSTEM );
+    void RunFile( const Ogre::String& file, const Type type = SYSTEM );
+    void CompileFile( const Ogre::String& file );
+    void CompileAllFiles();
+    void UpdateHotReload();
+    void ReloadFile( const Ogre::String& file );
 
     // binds
-    void InitBinds();
+    void InitBinds( const Type type );
     void InitCmd();
 
     void AddEntity( const Type type, const Ogre::String& entity_name, Entity* entity );
@@ -88,27 +140,59 @@ public:
     luabind::object GetTableByEntityName( const ScriptManager::Type type, const Ogre::String& name, lua_State* state ) const;
     QueueScript* GetScriptByScriptId( const ScriptId& script ) const;
     ScriptEntity* GetScriptEntityByName( const Type type, const Ogre::String& entity_name ) const;
-    const ScriptId GetCurrentScriptId() const;
+    const ScriptId GetCurrentScriptId( lua_State* state ) const;
+    // main state of domain to which state (or coroutine) belongs
+    lua_State* GetMainState( lua_State* state ) const;
     void ContinueScriptExecution( const ScriptId& script );
 
-    int ScriptWait( const float seconds );
-    void ScriptRequest( const Type type, const char* entity, const char* function, const int priority );
-    int ScriptRequestStartSync( const Type type, const char* entity, const char* function, const int priority );
-    int ScriptRequestEndSync( const Type type, const char* entity, const char* function, const int priority );
-    bool ScriptRequest( ScriptEntity* script_entity, const Ogre::String& function, const int priority, const Ogre::String& argument1, const Ogre::String& argument2, bool start_sync, bool end_sync );
+    int ScriptWait( lua_State* state, const float seconds );
+    void ScriptRequest( lua_State* state, const Type type, const char* entity, const char* function, const int priority );
+    int ScriptRequestStartSync( lua_State* state, const Type type, const char* entity, const char* function, const int priority );
+    int ScriptRequestEndSync( lua_State* state, const Type type, const char* entity, const char* function, const int priority );
+    bool ScriptRequest( ScriptEntity* script_entity, const Ogre::String& function, const int priority, const Ogre::String& argument1, const Ogre::String& argument2, const ScriptId& paused_script_start, const ScriptId& paused_script_end );
+
+    void AddValueToStack( lua_State* state, const float value );
 
-    void AddValueToStack( const float value );
+    // budget and profiler
+    void ScriptHook( lua_State* state, lua_Debug* debug );
+    void ProfilePrint( const unsigned int number ) const;
+    void ProfileDump( const Ogre::String& file_name ) const;
+    void ProfileReset();
 
 private:
-    lua_State* m_LuaState;
+    void InitBenchmarks();
+    static void BenchmarkSetupWait( const int size );
+    static void BenchmarkSetupResume( const int size );
+    static void BenchmarkTeardown( const int size );
+    static void BenchmarkUpdate( const int size );
+
+    ScriptDomain* GetDomain( lua_State* state ) const;
+    bool IsSameThread( const Type from, const Type to ) const;
+    void ContinueScriptExecution( const Type from, const ScriptId& script );
+    void AddMessage( const ScriptMessage& message );
+    void UpdateMessages( ScriptDomain& domain );
+    void UpdateWorker( ScriptDomain* domain );
+    bool LoadFile( const Ogre::String& file, lua_State* state );
+    int ResumeScript( ScriptDomain& domain, const unsigned int entity_id, const int arguments );
 
-    Ogre::String m_SystemTableName;
-    Ogre::String m_EntityTableName;
-    Ogre::String m_UiTableName;
+private:
+    // each domain has its own lua state. Domain can be updated by its own worker
+    // thread, domains communicate with each other through messages.
+    ScriptDomain* m_Domain[ 3 ];
 
-    std::vector< ScriptEntity > m_ScriptEntity;
+    // files executed by RunFile, watched for hot reload
+    struct ScriptFile
+    {
+        Ogre::String file;
+        Type type;
+        time_t modified;
+    };
+    std::vector< ScriptFile > m_ScriptFiles;
+    float m_HotReloadTimer;
 
-    ScriptId m_CurrentScriptId;
+    mutable boost::mutex m_ProfileMutex;
+    std::map< Ogre::String, ScriptProfile > m_ProfileFunction;
+    std::map< Ogre::String, ScriptProfile > m_ProfileLine;
 };
 
 
@@ -118,7 +202,9 @@ struct ScriptEntity
     ScriptEntity():
         name( "" ),
         type( ScriptManager::SYSTEM ),
-        resort( false )
+        resort( false ),
+        update_time( 0 ),
+        entity( NULL )
     {
     }
 
@@ -126,6 +212,57 @@ struct ScriptEntity
     ScriptManager::Type type;
     std::vector< QueueScript > queue;
     bool resort;
+    float update_time; // milliseconds spent in scripts during last update
+    Entity* entity; // game entity binded to script table as "entity" field
+};
+
+
+
+struct ScriptDomain
+{
+    enum WorkerState
+    {
+        WORKER_IDLE,
+        WORKER_RUN,
+        WORKER_EXIT
+    };
+
+    ScriptDomain():
+        type( ScriptManager::SYSTEM ),
+        state( NULL ),
+        table_name( "" ),
+        resume_step( 0 ),
+        resume_instructions( 0 ),
+        resume_preempted( false ),
+        profile_sample_time( 0 ),
+        memory_counter( 0 ),
+        update_start( 0 ),
+        worker( NULL ),
+        worker_state( WORKER_IDLE )
+    {
+    }
+
+    ScriptManager::Type type;
+    lua_State* state;
+    Ogre::String table_name;
+    std::vector< ScriptEntity > entity;
+    ScriptId current_script_id;
+
+    // budget and profiler state of current resume
+    int resume_step;
+    int resume_instructions;
+    bool resume_preempted;
+    unsigned long profile_sample_time;
+    unsigned int memory_counter; // gauge of lua memory in kilobytes
+    unsigned int update_start; // entity from which next update begins resumes
+
+    boost::mutex message_mutex;
+    std::vector< ScriptMessage > message;
+
+    boost::thread* worker;
+    boost::mutex worker_mutex;
+    boost::condition_variable worker_condition;
+    WorkerState worker_state;
 };
 
 
@@ -0,0 +1,64 @@
+#include "Benchmark.h"
+
+#include <OgreStringConverter.h>
+
+
+
+void
+benchmark_add_scripts( const int size, const Ogre::String& wait )
+{
+    // entities with coroutine which never ends, same as long running game scripts
+    ScriptManager::getSingleton().RunString( "System = System or {} for i = 1, " + Ogre::StringConverter::toString( size ) + " do System[ \"benchmark_\" .. i ] = { on_start = function( self ) while true do script:wait( " + wait + " ) end end } end" );
+    for( int i = 1; i <= size; ++i )
+    {
+        ScriptManager::getSingleton().AddEntity( ScriptManager::SYSTEM, "benchmark_" + Ogre::StringConverter::toString( i ), NULL );
+    }
+}
+
+
+
+void
+ScriptManager::InitBenchmarks()
+{
+    Benchmark::getSingleton().AddScenario( "script_wait_1000", BenchmarkSetupWait, BenchmarkUpdate, BenchmarkTeardown, 1000 );
+    Benchmark::getSingleton().AddScenario( "script_resume_100", BenchmarkSetupResume, BenchmarkUpdate, BenchmarkTeardown, 100 );
+    Benchmark::getSingleton().AddScenario( "script_resume_1000", BenchmarkSetupResume, BenchmarkUpdate, BenchmarkTeardown, 1000 );
+}
+
+
+
+void
+ScriptManager::BenchmarkSetupWait( const int size )
+{
+    // scripts sleep whole benchmark, update only checks their timers
+    benchmark_add_scripts( size, "1000000" );
+}
+
+
+
+void
+ScriptManager::BenchmarkSetupResume( const int size )
+{
+    // scripts are resumed every update
+    benchmark_add_scripts( size, "0" );
+}
+
+
+
+void
+ScriptManager::BenchmarkTeardown( const int size )
+{
+    for( int i = 1; i <= size; ++i )
+    {
+        ScriptManager::getSingleton().RemoveEntity( ScriptManager::SYSTEM, "benchmark_" + Ogre::StringConverter::toString( i ) );
+    }
+    ScriptManager::getSingleton().RunString( "for i = 1, " + Ogre::StringConverter::toString( size ) + " do System[ \"benchmark_\" .. i ] = nil end" );
+}
+
+
+
+void
+ScriptManager::BenchmarkUpdate( const int size )
+{
+    ScriptManager::getSingleton().Update( ScriptManager::SYSTEM );
+}
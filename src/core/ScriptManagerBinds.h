@@ -1,8 +1,10 @@
 #include "Console.h"
+#include "Counters.h"
 #include "Logger.h"
 #include "../game/Entity.h"
 #include "../game/EntityManager.h"
 #include "Timer.h"
+#include "UiList.h"
 #include "UiManager.h"
 #include "UiWidget.h"
 
@@ -25,61 +27,117 @@ ScriptConsole( const char* text )
 
 
 void
-ScriptManager::InitBinds()
+ScriptManager::InitBinds( const ScriptManager::Type type )
 {
+    // Each domain has its own lua state. Entity domain may be updated in worker thread
+    // so it gets only things that are safe to use while ui and camera are updated.
+    lua_State* state = m_Domain[ type ]->state;
+
     // globals
-    luabind::module( m_LuaState )
+    luabind::module( state )
     [
-        luabind::def( "print", ( void( * )( const char* ) ) &ScriptPrint ),
-        luabind::def( "console", ( void( * )( const char* ) ) &ScriptConsole )
+        luabind::def( "print", ( void( * )( const char* ) ) &ScriptPrint )
     ];
 
-    // ui widget access
-    luabind::module( m_LuaState )
-    [
-        luabind::class_< UiWidget >( "UiWidget" )
-            .def( "set_visible", ( void( UiWidget::* )( const bool ) ) &UiWidget::SetVisible )
-            .def( "is_visible", ( bool( UiWidget::* )() ) &UiWidget::IsVisible )
-            .def( "play_animation", ( void( UiWidget::* )( const char* ) ) &UiWidget::ScriptPlayAnimation )
-            .def( "play_animation_stop", ( void( UiWidget::* )( const char* ) ) &UiWidget::ScriptPlayAnimationStop )
-            .def( "play_animation", ( void( UiWidget::* )( const char*, const float, const float ) ) &UiWidget::ScriptPlayAnimation )
-            .def( "play_animation_stop", ( void( UiWidget::* )( const char*, const float, const float ) ) &UiWidget::ScriptPlayAnimationStop )
-            .def( "set_default_animation", ( void( UiWidget::* )( const char* ) ) &UiWidget::ScriptSetDefaultAnimation )
-            .def( "animation_sync", ( int( UiWidget::* )() ) &UiWidget::ScriptAnimationSync, luabind::yield )
-            .def( "set_colour", ( void( UiWidget::* )( const float, const float, const float ) ) &UiWidget::SetColour )
-            .def( "set_alpha", ( void( UiWidget::* )( const float ) ) &UiWidget::SetAlpha )
-            .def( "set_x", ( void( UiWidget::* )( const float, const float ) ) &UiWidget::SetX )
-            .def( "set_y", ( void( UiWidget::* )( const float, const float ) ) &UiWidget::SetY )
-            .def( "set_z", ( void( UiWidget::* )( const float ) ) &UiWidget::SetZ )
-            .def( "set_width", ( void( UiWidget::* )( const float, const float ) ) &UiWidget::SetWidth )
-            .def( "set_height", ( void( UiWidget::* )( const float, const float ) ) &UiWidget::SetHeight )
+    if( type == ScriptManager::SYSTEM || type == ScriptManager::UI )
+    {
+        luabind::module( state )
+        [
+            luabind::def( "console", ( void( * )( const char* ) ) &ScriptConsole )
+        ];
 
-    ];
+        // ui widget access
+        luabind::module( state )
+        [
+            luabind::class_< UiWidget >( "UiWidget" )
+                .def( "set_visible", ( void( UiWidget::* )( const bool ) ) &UiWidget::SetVisible )
+                .def( "is_visible", ( bool( UiWidget::* )() ) &UiWidget::IsVisible )
+                .def( "play_animation", ( void( UiWidget::* )( const char* ) ) &UiWidget::ScriptPlayAnimation )
+                .def( "play_animation_stop", ( void( UiWidget::* )( const char* ) ) &UiWidget::ScriptPlayAnimationStop )
+                .def( "play_animation", ( void( UiWidget::* )( const char*, const float, const float ) ) &UiWidget::ScriptPlayAnimation )
+                .def( "play_animation_stop", ( void( UiWidget::* )( const char*, const float, const float ) ) &UiWidget::ScriptPlayAnimationStop )
+                .def( "set_default_animation", ( void( UiWidget::* )( const char* ) ) &UiWidget::ScriptSetDefaultAnimation )
+                .def( "animation_sync", ( int( UiWidget::* )( lua_State* ) ) &UiWidget::ScriptAnimationSync, luabind::yield )
+                .def( "set_colour", ( void( UiWidget::* )( const float, const float, const float ) ) &UiWidget::SetColour )
+                .def( "set_alpha", ( void( UiWidget::* )( const float ) ) &UiWidget::SetAlpha )
+                .def( "set_x", ( void( UiWidget::* )( const float, const float ) ) &UiWidget::SetX )
+                .def( "set_y", ( void( UiWidget::* )( const float, const float ) ) &UiWidget::SetY )
+                .def( "set_z", ( void( UiWidget::* )( const float ) ) &UiWidget::SetZ )
+                .def( "set_width", ( void( UiWidget::* )( const float, const float ) ) &UiWidget::SetWidth )
+                .def( "set_height", ( void( UiWidget::* )( const float, const float ) ) &UiWidget::SetHeight ),
+
+            luabind::class_< UiList, UiWidget >( "UiList" )
+                .def( "set_items_number", ( void( UiList::* )( const unsigned int ) ) &UiList::SetNumberOfItems )
+                .def( "get_items_number", ( unsigned int( UiList::* )() const ) &UiList::GetNumberOfItems )
+                .def( "set_scroll", ( void( UiList::* )( const float ) ) &UiList::SetScroll )
+                .def( "get_scroll", ( float( UiList::* )() const ) &UiList::GetScroll )
+        ];
+
+        // ui access
+        luabind::module( state )
+        [
+            luabind::class_< UiManager >( "UiManager" )
+                .def( "get_widget", ( luabind::object( UiManager::* )( const char*, lua_State* ) ) &UiManager::ScriptGetWidget )
+        ];
+
+        luabind::globals( state )[ "ui_manager" ] = boost::ref( *( UiManager::getSingletonPtr() ) );
+    }
+
+    // entity access. Units are accessed in batches by handles to keep number of calls low.
+    if( type == ScriptManager::SYSTEM || type == ScriptManager::ENTITY )
+    {
+        luabind::module( state )
+        [
+            luabind::class_< EntityManager >( "EntityManager" )
+                .def( "get_units_number", ( int( EntityManager::* )() const ) &EntityManager::ScriptGetUnitsNumber )
+                .def( "get_units_in_rect", ( luabind::object( EntityManager::* )( lua_State*, const float, const float, const float, const float, const int ) const ) &EntityManager::ScriptGetUnitsInRect )
+                .def( "get_units_position", ( luabind::object( EntityManager::* )( lua_State*, const luabind::object& ) const ) &EntityManager::ScriptGetUnitsPosition )
+                .def( "get_units_action", ( luabind::object( EntityManager::* )( lua_State*, const luabind::object& ) const ) &EntityManager::ScriptGetUnitsAction )
+                .def( "set_units_move", ( void( EntityManager::* )( const luabind::object&, const float, const float ) ) &EntityManager::ScriptSetUnitsMove )
+                .def( "set_units_action", ( void( EntityManager::* )( const luabind::object&, const int ) ) &EntityManager::ScriptSetUnitsAction )
+                .enum_( "constants" )
+                [
+                    luabind::value( "ANY", -1 ),
+                    luabind::value( "NONE", Entity::NONE ),
+                    luabind::value( "WALK", Entity::WALK ),
+                    luabind::value( "GATHER", Entity::GATHER ),
+                    luabind::value( "ATTACK", Entity::ATTACK )
+                ]
+        ];
+
+        luabind::globals( state )[ "entity_manager" ] = boost::ref( *( EntityManager::getSingletonPtr() ) );
+    }
 
-    // ui access
-    luabind::module( m_LuaState )
+    // timer access, entity domain runs in worker thread so it can't change timer of main thread
+    luabind::class_< Timer > timer_class( "Timer" );
+    timer_class
+        .def( "get_game_time_total", ( float( Timer::* )() ) &Timer::GetGameTimeTotal )
+        .def( "get_timer", ( int( Timer::* )() ) &Timer::GetGameTimer );
+    if( type != ScriptManager::ENTITY )
+    {
+        timer_class.def( "set_timer", ( float( Timer::* )( const float ) ) &Timer::SetGameTimer );
+    }
+    luabind::module( state )
     [
-        luabind::class_< UiManager >( "UiManager" )
-            .def( "get_widget", ( UiWidget*( UiManager::* )( const char* ) ) &UiManager::ScriptGetWidget )
+        timer_class
     ];
 
-    // timer access
-    luabind::module( m_LuaState )
+    // counters access, values are updated once per second
+    luabind::module( state )
     [
-        luabind::class_< Timer >( "Timer" )
-            .def( "get_game_time_total", ( float( Timer::* )() ) &Timer::GetGameTimeTotal )
-            .def( "set_timer", ( float( Timer::* )( const float ) ) &Timer::SetGameTimer )
-            .def( "get_timer", ( int( Timer::* )() ) &Timer::GetGameTimer )
+        luabind::class_< Counters >( "Counters" )
+            .def( "get", ( float( Counters::* )( const Ogre::String& ) const ) &Counters::Get )
+            .def( "get_total", ( double( Counters::* )( const Ogre::String& ) const ) &Counters::GetTotal )
     ];
 
     // script access
-    luabind::module( m_LuaState )
+    luabind::module( state )
     [
         luabind::class_< ScriptManager >( "Script" )
-            .def( "wait", ( int( ScriptManager::* )( const float ) ) &ScriptManager::ScriptWait, luabind::yield )
-            .def( "request", ( void( ScriptManager::* )( const ScriptManager::Type, const char*, const char*, const int ) ) &ScriptManager::ScriptRequest )
-            .def( "request_start_sync", ( int( ScriptManager::* )( const ScriptManager::Type, const char*, const char*, const int ) ) &ScriptManager::ScriptRequestStartSync, luabind::yield )
-            .def( "request_end_sync", ( int( ScriptManager::* )( const ScriptManager::Type, const char*, const char*, const int ) ) &ScriptManager::ScriptRequestEndSync, luabind::yield )
+            .def( "wait", ( int( ScriptManager::* )( lua_State*, const float ) ) &ScriptManager::ScriptWait, luabind::yield )
+            .def( "request", ( void( ScriptManager::* )( lua_State*, const ScriptManager::Type, const char*, const char*, const int ) ) &ScriptManager::ScriptRequest )
+            .def( "request_start_sync", ( int( ScriptManager::* )( lua_State*, const ScriptManager::Type, const char*, const char*, const int ) ) &ScriptManager::ScriptRequestStartSync, luabind::yield )
+            .def( "request_end_sync", ( int( ScriptManager::* )( lua_State*, const ScriptManager::Type, const char*, const char*, const int ) ) &ScriptManager::ScriptRequestEndSync, luabind::yield )
             .enum_( "constants" )
             [
                 luabind::value( "SYSTEM", ScriptManager::SYSTEM ),
@@ -88,7 +146,7 @@ ScriptManager::InitBinds()
             ]
     ];
 
-    luabind::globals( m_LuaState )[ "ui_manager" ] = boost::ref( *( UiManager::getSingletonPtr() ) );
-    luabind::globals( m_LuaState )[ "timer" ] = boost::ref( *( Timer::getSingletonPtr() ) );
-    luabind::globals( m_LuaState )[ "script" ] = boost::ref( *this );
+    luabind::globals( state )[ "timer" ] = boost::ref( *( Timer::getSingletonPtr() ) );
+    luabind::globals( state )[ "counters" ] = boost::ref( *( Counters::getSingletonPtr() ) );
+    luabind::globals( state )[ "script" ] = boost::ref( *this );
 }
@@ -3,16 +3,35 @@
 
 
 
+ScriptManager::Type
+script_type_from_params( const Ogre::StringVector& params, const unsigned int index )
+{
+    if( params.size() > index )
+    {
+        if( params[ index ] == "entity" )
+        {
+            return ScriptManager::ENTITY;
+        }
+        else if( params[ index ] == "ui" )
+        {
+            return ScriptManager::UI;
+        }
+    }
+    return ScriptManager::SYSTEM;
+}
+
+
+
 void
 CmdScriptRunString( const Ogre::StringVector& params )
 {
     if( params.size() < 2 )
     {
-        Console::getSingleton().AddTextToOutput( "Usage: /script_run_string <string>" );
+        Console::getSingleton().AddTextToOutput( "Usage: /script_run_string <string> [system|entity|ui]" );
         return;
     }
 
-    ScriptManager::getSingleton().RunString( params[ 1 ] );
+    ScriptManager::getSingleton().RunString( params[ 1 ], script_type_from_params( params, 2 ) );
 }
 
 
@@ -22,11 +41,88 @@ CmdScriptRunFile( const Ogre::StringVector& params )
 {
     if( params.size() < 2 )
     {
-        Console::getSingleton().AddTextToOutput( "Usage: /script_run_file <file name>" );
+        Console::getSingleton().AddTextToOutput( "Usage: /script_run_file <file name> [system|entity|ui]" );
+        return;
+    }
+
+    ScriptManager::getSingleton().RunFile( params[ 1 ], script_type_from_params( params, 2 ) );
+}
+
+
+
+void
+CmdScriptReload( const Ogre::StringVector& params )
+{
+    if( params.size() != 2 )
+    {
+        Console::getSingleton().AddTextToOutput( "Usage: /script_reload <file name>" );
+        return;
+    }
+
+    ScriptManager::getSingleton().ReloadFile( params[ 1 ] );
+}
+
+
+
+void
+CmdScriptCompile( const Ogre::StringVector& params )
+{
+    if( params.size() > 2 )
+    {
+        Console::getSingleton().AddTextToOutput( "Usage: /script_compile [file name]" );
+        return;
+    }
+
+    if( params.size() == 2 )
+    {
+        ScriptManager::getSingleton().CompileFile( params[ 1 ] );
+    }
+    else
+    {
+        ScriptManager::getSingleton().CompileAllFiles();
+    }
+}
+
+
+
+void
+CmdScriptProfilePrint( const Ogre::StringVector& params )
+{
+    if( params.size() > 2 )
+    {
+        Console::getSingleton().AddTextToOutput( "Usage: /script_profile_print [number of entries]" );
+        return;
+    }
+
+    unsigned int number = 10;
+    if( params.size() == 2 )
+    {
+        number = Ogre::StringConverter::parseUnsignedInt( params[ 1 ] );
+    }
+
+    ScriptManager::getSingleton().ProfilePrint( number );
+}
+
+
+
+void
+CmdScriptProfileDump( const Ogre::StringVector& params )
+{
+    if( params.size() > 2 )
+    {
+        Console::getSingleton().AddTextToOutput( "Usage: /script_profile_dump [file name]" );
         return;
     }
 
-    ScriptManager::getSingleton().RunFile( params[ 1 ] );
+    ScriptManager::getSingleton().ProfileDump( ( params.size() == 2 ) ? params[ 1 ] : "script_profile.csv" );
+}
+
+
+
+void
+CmdScriptProfileReset( const Ogre::StringVector& params )
+{
+    ScriptManager::getSingleton().ProfileReset();
 }
 
 
@@ -36,4 +132,9 @@ ScriptManager::InitCmd()
 {
     ConfigCmdManager::getSingleton().AddCommand( "script_run_string", "Run script string", "", CmdScriptRunString, NULL );
     ConfigCmdManager::getSingleton().AddCommand( "script_run_file", "Run script file", "", CmdScriptRunFile, NULL );
+    ConfigCmdManager::getSingleton().AddCommand( "script_reload", "Reload script file without restarting running scripts", "", CmdScriptReload, NULL );
+    ConfigCmdManager::getSingleton().AddCommand( "script_compile", "Compile script file (or all script files in data) to bytecode cache", "", CmdScriptCompile, NULL );
+    ConfigCmdManager::getSingleton().AddCommand( "script_profile_print", "Print scripts functions and lines that took most time", "", CmdScriptProfilePrint, NULL );
+    ConfigCmdManager::getSingleton().AddCommand( "script_profile_dump", "Dump script profile to csv file", "", CmdScriptProfileDump, NULL );
+    ConfigCmdManager::getSingleton().AddCommand( "script_profile_reset", "Reset script profile", "", CmdScriptProfileReset, NULL );
 }
@@ -0,0 +1,254 @@
+#include "SdfFont.h"
+
+#include <Overlay/OgreFontManager.h>
+#include <OgreGpuProgramManager.h>
+#include <OgreHighLevelGpuProgramManager.h>
+#include <OgreImage.h>
+#include <OgreTechnique.h>
+#include <OgreTextureManager.h>
+#include <OgreUTFString.h>
+#include <algorithm>
+#include <fstream>
+
+#include "Logger.h"
+
+
+
+// text vertices are already in screen space (ui and debug draw use identity matrices)
+const char* SDF_VERTEX_PROGRAM =
+    "void main( float4 position : POSITION, float4 colour : COLOR0, float2 uv : TEXCOORD0,\n"
+    "    out float4 out_position : POSITION, out float4 out_colour : COLOR0, out float2 out_uv : TEXCOORD0 )\n"
+    "{\n"
+    "    out_position = float4( position.xyz, 1.0 );\n"
+    "    out_colour = colour;\n"
+    "    out_uv = uv;\n"
+    "}\n";
+
+// edge width is taken from screen space derivative so edge is one pixel wide at any scale
+const char* SDF_FRAGMENT_PROGRAM =
+    "float4 main( float4 colour : COLOR0, float2 uv : TEXCOORD0, uniform sampler2D atlas : register( s0 ) ) : COLOR\n"
+    "{\n"
+    "    float distance = tex2D( atlas, uv ).a;\n"
+    "    float width = fwidth( distance );\n"
+    "    float alpha = smoothstep( 0.5 - width, 0.5 + width, distance );\n"
+    "    return float4( colour.rgb, colour.a * alpha );\n"
+    "}\n";
+
+
+
+Ogre::String
+sdf_xml_escape( const Ogre::String& string )
+{
+    Ogre::String ret = "";
+    for( unsigned int i = 0; i < string.size(); ++i )
+    {
+        switch( string[ i ] )
+        {
+            case '&': ret += "&amp;"; break;
+            case '<': ret += "&lt;"; break;
+            case '>': ret += "&gt;"; break;
+            case '"': ret += "&quot;"; break;
+            default: ret += string[ i ];
+        }
+    }
+    return ret;
+}
+
+
+
+bool
+BuildSdfFont( const Ogre::String& ttf, const int size, const int spread, const std::vector< Ogre::Font::CodePointRange >& ranges, const Ogre::String& output )
+{
+    if( size <= 0 || spread <= 0 || ranges.size() == 0 )
+    {
+        LOG_ERROR( "Wrong parameters for sdf font \"" + output + "\"." );
+        return false;
+    }
+
+    // let ogre rasterize truetype font, glyphs are placed in cells with spacing
+    // between them so distance field of one glyph not overlap other
+    Ogre::String font_name = "SdfBuild." + output;
+    if( Ogre::FontManager::getSingleton().resourceExists( font_name ) == true )
+    {
+        Ogre::FontManager::getSingleton().remove( font_name );
+    }
+    Ogre::FontPtr font = Ogre::FontManager::getSingleton().create( font_name, "Game" );
+    font->setType( Ogre::FT_TRUETYPE );
+    font->setSource( ttf );
+    font->setTrueTypeSize( ( Ogre::Real )size );
+    font->setTrueTypeResolution( 72 );
+    for( unsigned int i = 0; i < ranges.size(); ++i )
+    {
+        font->addCodePointRange( ranges[ i ] );
+    }
+
+    try
+    {
+        font->load();
+    }
+    catch( const Ogre::Exception& e )
+    {
+        LOG_ERROR( "Can't load truetype font \"" + ttf + "\": " + e.getDescription() );
+        Ogre::FontManager::getSingleton().remove( font_name );
+        return false;
+    }
+
+    Ogre::String texture_name = font->getMaterial()->getTechnique( 0 )->getPass( 0 )->getTextureUnitState( 0 )->getTextureName();
+    Ogre::TexturePtr texture = Ogre::TextureManager::getSingleton().getByName( texture_name );
+    Ogre::Image source;
+    texture->convertToImage( source );
+
+    int width = ( int )source.getWidth();
+    int height = ( int )source.getHeight();
+
+    std::vector< bool > inside( width * height );
+    for( int y = 0; y < height; ++y )
+    {
+        for( int x = 0; x < width; ++x )
+        {
+            inside[ y * width + x ] = source.getColourAt( x, y, 0 ).a >= 0.5f;
+        }
+    }
+
+    // for every pixel search nearest pixel on other side of edge within spread
+    Ogre::uchar* data = OGRE_ALLOC_T( Ogre::uchar, width * height * 2, Ogre::MEMCATEGORY_GENERAL );
+    for( int y = 0; y < height; ++y )
+    {
+        for( int x = 0; x < width; ++x )
+        {
+            bool in = inside[ y * width + x ];
+            float best = ( float )spread;
+
+            for( int dy = -spread; dy <= spread; ++dy )
+            {
+                for( int dx = -spread; dx <= spread; ++dx )
+                {
+                    int sx = x + dx;
+                    int sy = y + dy;
+                    bool other = ( sx >= 0 && sy >= 0 && sx < width && sy < height ) ? inside[ sy * width + sx ] : false;
+                    if( other != in )
+                    {
+                        // edge lies between centers of pixels
+                        float distance = Ogre::Math::Sqrt( ( float )( dx * dx + dy * dy ) ) - 0.5f;
+                        best = std::min( best, distance );
+                    }
+                }
+            }
+
+            float value = 0.5f + 0.5f * ( ( in == true ) ? best : -best ) / spread;
+            value = std::max( 0.0f, std::min( 1.0f, value ) );
+
+            data[ ( y * width + x ) * 2 + 0 ] = 255;
+            data[ ( y * width + x ) * 2 + 1 ] = ( Ogre::uchar )( value * 255.0f + 0.5f );
+        }
+    }
+
+    Ogre::Image sdf;
+    sdf.loadDynamicImage( data, width, height, 1, Ogre::PF_BYTE_LA, true );
+    Ogre::String image_name = output + ".png";
+    try
+    {
+        sdf.save( "./data/" + image_name );
+    }
+    catch( const Ogre::Exception& e )
+    {
+        LOG_ERROR( "Can't save sdf atlas \"" + image_name + "\": " + e.getDescription() );
+        Ogre::FontManager::getSingleton().remove( font_name );
+        return false;
+    }
+
+    // ogre places glyph with bearing inside cell of advance width and max height,
+    // so cell rect is exactly what should be drawn
+    Ogre::String base_name = output;
+    Ogre::String::size_type slash = base_name.find_last_of( "/\\" );
+    if( slash != Ogre::String::npos )
+    {
+        base_name = base_name.substr( slash + 1 );
+    }
+
+    std::ofstream xml( ( "./data/" + output + ".xml" ).c_str() );
+    std::ofstream fontdef( ( "./data/" + output + ".fontdef" ).c_str() );
+    if( !xml.is_open() || !fontdef.is_open() )
+    {
+        LOG_ERROR( "Failed to open font description files for \"" + output + "\" for writing." );
+        Ogre::FontManager::getSingleton().remove( font_name );
+        return false;
+    }
+
+    int line_height = 0;
+    for( unsigned int i = 0; i < ranges.size(); ++i )
+    {
+        for( Ogre::Font::CodePoint code = ranges[ i ].first; code <= ranges[ i ].second; ++code )
+        {
+            const Ogre::Font::UVRect& uv = font->getGlyphTexCoords( code );
+            line_height = std::max( line_height, ( int )( ( uv.bottom - uv.top ) * height + 0.5f ) );
+        }
+    }
+
+    xml << "<font name=\"" << base_name << "\" image=\"" << image_name << "\" image_size=\"" << width << " " << height << "\" height=\"" << line_height << "\" sdf=\"true\" scale=\"1\">\n";
+    fontdef << base_name << "\n{\n    type image\n    source " << image_name << "\n\n";
+
+    for( unsigned int i = 0; i < ranges.size(); ++i )
+    {
+        for( Ogre::Font::CodePoint code = ranges[ i ].first; code <= ranges[ i ].second; ++code )
+        {
+            const Ogre::Font::UVRect& uv = font->getGlyphTexCoords( code );
+
+            Ogre::UTFString name;
+            name.push_back( ( Ogre::UTFString::unicode_char )code );
+
+            xml << "    <char name=\"" << sdf_xml_escape( name.asUTF8() ) << "\"";
+            xml << " x=\"" << ( int )( uv.left * width + 0.5f ) << "\" y=\"" << ( int )( uv.top * height + 0.5f ) << "\"";
+            xml << " width=\"" << ( int )( ( uv.right - uv.left ) * width + 0.5f ) << "\" height=\"" << ( int )( ( uv.bottom - uv.top ) * height + 0.5f ) << "\"";
+            xml << " pre=\"0\" post=\"0\" />\n";
+
+            fontdef << "    glyph u" << code << " " << uv.left << " " << uv.top << " " << uv.right << " " << uv.bottom << "\n";
+        }
+    }
+
+    xml << "</font>\n";
+    fontdef << "}\n";
+
+    Ogre::FontManager::getSingleton().remove( font_name );
+
+    LOG_TRIVIAL( "Sdf font \"" + output + "\" built from \"" + ttf + "\"." );
+    return true;
+}
+
+
+
+void
+SetSdfPass( Ogre::Pass* pass )
+{
+    pass->getTextureUnitState( 0 )->setTextureFiltering( Ogre::TFO_BILINEAR );
+
+    if( Ogre::GpuProgramManager::getSingleton().isSyntaxSupported( "vs_3_0" ) == false ||
+        Ogre::GpuProgramManager::getSingleton().isSyntaxSupported( "ps_3_0" ) == false )
+    {
+        // without shaders cut glyph on edge, at least stays sharp when scaled
+        pass->setAlphaRejectFunction( Ogre::CMPF_GREATER_EQUAL );
+        pass->setAlphaRejectValue( 128 );
+        return;
+    }
+
+    Ogre::HighLevelGpuProgramManager& manager = Ogre::HighLevelGpuProgramManager::getSingleton();
+    if( manager.resourceExists( "SdfFont.Vertex" ) == false )
+    {
+        Ogre::HighLevelGpuProgramPtr vertex = manager.createProgram( "SdfFont.Vertex", "General", "hlsl", Ogre::GPT_VERTEX_PROGRAM );
+        vertex->setSource( SDF_VERTEX_PROGRAM );
+        vertex->setParameter( "entry_point", "main" );
+        vertex->setParameter( "target", "vs_3_0" );
+        vertex->load();
+
+        Ogre::HighLevelGpuProgramPtr fragment = manager.createProgram( "SdfFont.Fragment", "General", "hlsl", Ogre::GPT_FRAGMENT_PROGRAM );
+        fragment->setSource( SDF_FRAGMENT_PROGRAM );
+        fragment->setParameter( "entry_point", "main" );
+        fragment->setParameter( "target", "ps_3_0" );
+        fragment->load();
+    }
+
+    pass->setAlphaRejectFunction( Ogre::CMPF_GREATER );
+    pass->setAlphaRejectValue( 0 );
+    pass->setVertexProgram( "SdfFont.Vertex" );
+    pass->setFragmentProgram( "SdfFont.Fragment" );
+}
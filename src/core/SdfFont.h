@@ -0,0 +1,27 @@
+#ifndef SDF_FONT_H
+#define SDF_FONT_H
+
+#include <Overlay/OgreFont.h>
+#include <OgrePass.h>
+#include <OgreString.h>
+#include <vector>
+
+
+
+// Signed distance field fonts store distance to glyph edge in alpha channel of
+// atlas (0.5 on edge). Drawn with sdf pass one atlas stays sharp at any scale.
+
+
+
+// Rasterize truetype font with Ogre and convert its atlas to distance field.
+// output is path relative to ./data, writes output.png, output.xml (ui font)
+// and output.fontdef (ogre font for debug draw).
+bool BuildSdfFont( const Ogre::String& ttf, const int size, const int spread, const std::vector< Ogre::Font::CodePointRange >& ranges, const Ogre::String& output );
+
+// Set distance field shaders to pass. If shaders not supported
+// falls back to alpha test on edge.
+void SetSdfPass( Ogre::Pass* pass );
+
+
+
+#endif // SDF_FONT_H
@@ -46,37 +46,45 @@ TextManager::GetLanguage()
 
 
 void
-TextManager::AddText( const Ogre::String& name, TiXmlNode* node )
+TextManager::AddTexts( UiDescription* texts )
 {
-    Text text;
-    text.name = name;
-    text.node = node;
-    m_Texts.push_back( text );
-}
-
-
+    m_TextFiles.push_back( texts );
 
-void
-TextManager::AddDialog( const Ogre::String& name, TiXmlNode* node, const float width, const float height )
-{
-    Dialog dialog;
-    dialog.name = name;
-    dialog.node = node;
-    dialog.width = width;
-    dialog.height = height;
-    m_Dialogs.push_back( dialog );
+    for( unsigned int i = 0; i < texts->GetNumberOfRoots(); ++i )
+    {
+        const UiDescRoot& root = texts->GetRoot( i );
+        if( root.type == UDR_TEXT )
+        {
+            Text text;
+            text.name = texts->GetString( root.name );
+            text.description = texts;
+            text.node = root.index;
+            m_Texts.push_back( text );
+        }
+        else if( root.type == UDR_DIALOG )
+        {
+            Dialog dialog;
+            dialog.name = texts->GetString( root.name );
+            dialog.description = texts;
+            dialog.node = root.index;
+            dialog.width = root.width;
+            dialog.height = root.height;
+            m_Dialogs.push_back( dialog );
+        }
+    }
 }
 
 
 
-TiXmlNode*
-TextManager::GetText( const Ogre::String& name ) const
+const UiDescription*
+TextManager::GetText( const Ogre::String& name, unsigned int& node ) const
 {
     for( unsigned int i = 0; i < m_Texts.size(); ++i )
     {
         if( m_Texts[ i ].name == name )
         {
-            return m_Texts[ i ].node;
+            node = m_Texts[ i ].node;
+            return m_Texts[ i ].description;
         }
     }
 
@@ -87,16 +95,17 @@ TextManager::GetText( const Ogre::String& name ) const
 
 
 
-TiXmlNode*
-TextManager::GetDialog( const Ogre::String& name, float &width, float& height ) const
+const UiDescription*
+TextManager::GetDialog( const Ogre::String& name, unsigned int& node, float &width, float& height ) const
 {
     for( unsigned int i = 0; i < m_Dialogs.size(); ++i )
     {
         if( m_Dialogs[ i ].name == name )
         {
+            node = m_Dialogs[ i ].node;
             width = m_Dialogs[ i ].width;
             height = m_Dialogs[ i ].height;
-            return m_Dialogs[ i ].node;
+            return m_Dialogs[ i ].description;
         }
     }
 
@@ -108,15 +117,12 @@ TextManager::GetDialog( const Ogre::String& name, float &width, float& height )
 void
 TextManager::UnloadTexts()
 {
-    for( unsigned int i = 0; i < m_Texts.size(); ++i )
-    {
-        delete m_Texts[ i ].node;
-    }
     m_Texts.clear();
+    m_Dialogs.clear();
 
-    for( unsigned int i = 0; i < m_Dialogs.size(); ++i )
+    for( unsigned int i = 0; i < m_TextFiles.size(); ++i )
     {
-        delete m_Dialogs[ i ].node;
+        delete m_TextFiles[ i ];
     }
-    m_Dialogs.clear();
+    m_TextFiles.clear();
 }
@@ -4,7 +4,7 @@
 #include <OgreString.h>
 #include <OgreSingleton.h>
 
-#include "library/tinyxml/tinyxml.h"
+#include "UiDescription.h"
 
 
 
@@ -18,10 +18,10 @@ public:
 
     void SetLanguage( const Ogre::String& language );
     const Ogre::String& GetLanguage();
-    void AddText( const Ogre::String& name, TiXmlNode* node );
-    void AddDialog( const Ogre::String& name, TiXmlNode* node, const float width, const float height );
-    TiXmlNode* GetText( const Ogre::String& name ) const;
-    TiXmlNode* GetDialog( const Ogre::String& name, float &width, float& height ) const;
+    // takes ownership of compiled text file
+    void AddTexts( UiDescription* texts );
+    const UiDescription* GetText( const Ogre::String& name, unsigned int& node ) const;
+    const UiDescription* GetDialog( const Ogre::String& name, unsigned int& node, float &width, float& height ) const;
     void UnloadTexts();
 
 private:
@@ -30,18 +30,22 @@ private:
     struct Text
     {
         Ogre::String name;
-        TiXmlNode* node;
+        const UiDescription* description;
+        unsigned int node;
     };
     std::vector< Text > m_Texts;
 
     struct Dialog
     {
         Ogre::String name;
-        TiXmlNode* node;
+        const UiDescription* description;
+        unsigned int node;
         float width;
         float height;
     };
-     std::vector< Dialog > m_Dialogs;
+    std::vector< Dialog > m_Dialogs;
+
+    std::vector< UiDescription* > m_TextFiles;
 };
 
 
@@ -4,7 +4,7 @@
 
 
 
-ConfigVar cv_timer_scale_game( "timer_scale_game", "Timer speed for game related things", "1" );
+ConfigVarFloat cv_timer_scale_game( "timer_scale_game", "Timer speed for game related things", 1.0f );
 
 
 
@@ -12,14 +12,35 @@ template<>Timer *Ogre::Singleton< Timer >::msSingleton = NULL;
 
 
 
+void
+timer_scale_game_changed( ConfigVar& cvar )
+{
+    if( Timer::getSingletonPtr() != NULL )
+    {
+        Timer::getSingleton().SetGameScale( cvar.GetF() );
+    }
+}
+
+
+
 Timer::Timer():
     m_SystemTimeTotal( 0 ),
     m_SystemTimeDelta( 0 ),
     m_GameTimeTotal( 0 ),
     m_GameTimeDelta( 0 ),
 
+    m_GameScale( cv_timer_scale_game.Get() ),
+
     m_GameTimer( 0 )
 {
+    cv_timer_scale_game.AddCallback( timer_scale_game_changed );
+}
+
+
+
+Timer::~Timer()
+{
+    cv_timer_scale_game.RemoveCallback( timer_scale_game_changed );
 }
 
 
@@ -62,7 +83,7 @@ Timer::AddTime( const float time )
     m_SystemTimeDelta = time;
     m_SystemTimeTotal += m_SystemTimeDelta;
 
-    m_GameTimeDelta = time * cv_timer_scale_game.GetF();
+    m_GameTimeDelta = time * m_GameScale;
     m_GameTimeTotal += m_GameTimeDelta;
 
     if( m_GameTimer > 0 )
@@ -77,6 +98,14 @@ Timer::AddTime( const float time )
 
 
 
+void
+Timer::SetGameScale( const float scale )
+{
+    m_GameScale = scale;
+}
+
+
+
 void
 Timer::SetGameTimer( const float timer )
 {
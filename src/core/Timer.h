@@ -9,6 +9,7 @@ class Timer : public Ogre::Singleton< Timer >
 {
 public:
     Timer();
+    ~Timer();
 
     float GetSystemTimeTotal();
     float GetSystemTimeDelta();
@@ -17,6 +18,9 @@ public:
 
     void AddTime( const float time );
 
+    // set from timer_scale_game cvar when it changes
+    void SetGameScale( const float scale );
+
     void SetGameTimer( const float timer );
     int GetGameTimer() const;
 
@@ -25,6 +29,7 @@ private:
     float m_SystemTimeDelta;
     float m_GameTimeTotal;
     float m_GameTimeDelta;
+    float m_GameScale;
 
     float m_GameTimer;
 };
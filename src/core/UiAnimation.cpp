@@ -7,6 +7,49 @@
 
 
 
+UiEasing
+UiEasingFromString( const Ogre::String& easing )
+{
+    if( easing == "in" )
+    {
+        return UE_IN;
+    }
+    else if( easing == "out" )
+    {
+        return UE_OUT;
+    }
+    else if( easing == "in_out" )
+    {
+        return UE_IN_OUT;
+    }
+    else if( easing == "step" )
+    {
+        return UE_STEP;
+    }
+    else if( easing != "" && easing != "linear" )
+    {
+        LOG_WARNING( "Unknown easing \"" + easing + "\", linear used." );
+    }
+    return UE_LINEAR;
+}
+
+
+
+float
+UiEasingApply( const UiEasing easing, const float t )
+{
+    switch( easing )
+    {
+        case UE_IN: return t * t;
+        case UE_OUT: return t * ( 2 - t );
+        case UE_IN_OUT: return ( t < 0.5f ) ? 2 * t * t : -1 + ( 4 - 2 * t ) * t;
+        case UE_STEP: return ( t < 1 ) ? 0.0f : 1.0f;
+        default: return t;
+    }
+}
+
+
+
 UiAnimation::UiAnimation( const Ogre::String& name, UiWidget* widget ):
     m_Name( name ),
     m_Widget( widget ),
@@ -34,51 +77,51 @@ UiAnimation::AddTime( const float time )
 
 
 
-    if( m_Scale.size() > 0 )
+    if( m_Scale.IsEmpty() == false )
     {
-        m_Widget->SetScale( KeyFrameGetValue( m_Scale ) );
+        m_Widget->SetScale( m_Scale.GetValue( m_Time ) );
     }
 
-    if( m_X.size() > 0 )
+    if( m_X.IsEmpty() == false )
     {
-        Ogre::Vector2 value = KeyFrameGetValue( m_X );
+        Ogre::Vector2 value = m_X.GetValue( m_Time );
         m_Widget->SetX( value.x, value.y );
     }
 
-    if( m_Y.size() > 0 )
+    if( m_Y.IsEmpty() == false )
     {
-        Ogre::Vector2 value = KeyFrameGetValue( m_Y );
+        Ogre::Vector2 value = m_Y.GetValue( m_Time );
         m_Widget->SetY( value.x, value.y );
     }
 
-    if( m_Width.size() > 0 )
+    if( m_Width.IsEmpty() == false )
     {
-        Ogre::Vector2 value = KeyFrameGetValue( m_Width );
+        Ogre::Vector2 value = m_Width.GetValue( m_Time );
         m_Widget->SetWidth( value.x, value.y );
     }
 
-    if( m_Height.size() > 0 )
+    if( m_Height.IsEmpty() == false )
     {
-        Ogre::Vector2 value = KeyFrameGetValue( m_Height );
+        Ogre::Vector2 value = m_Height.GetValue( m_Time );
         m_Widget->SetHeight( value.x, value.y );
     }
 
-    if( m_Rotation.size() > 0 )
+    if( m_Rotation.IsEmpty() == false )
     {
-        m_Widget->SetRotation( KeyFrameGetValue( m_Rotation ) );
+        m_Widget->SetRotation( m_Rotation.GetValue( m_Time ) );
     }
 
-    if( m_Alpha.size() > 0 )
+    if( m_Alpha.IsEmpty() == false )
     {
-        m_Widget->SetAlpha( KeyFrameGetValue( m_Alpha ) );
+        m_Widget->SetAlpha( m_Alpha.GetValue( m_Time ) );
     }
 
-    if( m_ScissorXTop.size() > 0 )
+    if( m_ScissorXTop.IsEmpty() == false )
     {
-        Ogre::Vector2 value1 =  KeyFrameGetValue( m_ScissorXTop );
-        Ogre::Vector2 value2 =  KeyFrameGetValue( m_ScissorYLeft );
-        Ogre::Vector2 value3 =  KeyFrameGetValue( m_ScissorXBottom );
-        Ogre::Vector2 value4 =  KeyFrameGetValue( m_ScissorYRight );
+        Ogre::Vector2 value1 =  m_ScissorXTop.GetValue( m_Time );
+        Ogre::Vector2 value2 =  m_ScissorYLeft.GetValue( m_Time );
+        Ogre::Vector2 value3 =  m_ScissorXBottom.GetValue( m_Time );
+        Ogre::Vector2 value4 =  m_ScissorYRight.GetValue( m_Time );
 
         m_Widget->SetScissorArea( value1.x, value1.y, value2.x, value2.y, value3.x, value3.y, value4.x, value4.y );
     }
@@ -114,6 +157,17 @@ void
 UiAnimation::SetLength( const float time )
 {
     m_Length = time;
+    m_Scale.SetLength( time );
+    m_X.SetLength( time );
+    m_Y.SetLength( time );
+    m_Width.SetLength( time );
+    m_Height.SetLength( time );
+    m_Rotation.SetLength( time );
+    m_Alpha.SetLength( time );
+    m_ScissorXTop.SetLength( time );
+    m_ScissorYLeft.SetLength( time );
+    m_ScissorXBottom.SetLength( time );
+    m_ScissorYRight.SetLength( time );
 }
 
 
@@ -129,7 +183,7 @@ UiAnimation::GetLength() const
 void
 UiAnimation::AddScaleKeyFrame( const UiKeyFrameVector2& key_frame )
 {
-    m_Scale.push_back( key_frame );
+    m_Scale.AddKeyFrame( key_frame );
 }
 
 
@@ -137,7 +191,7 @@ UiAnimation::AddScaleKeyFrame( const UiKeyFrameVector2& key_frame )
 void
 UiAnimation::AddXKeyFrame( const UiKeyFrameVector2& key_frame )
 {
-    m_X.push_back( key_frame );
+    m_X.AddKeyFrame( key_frame );
 }
 
 
@@ -145,7 +199,7 @@ UiAnimation::AddXKeyFrame( const UiKeyFrameVector2& key_frame )
 void
 UiAnimation::AddYKeyFrame( const UiKeyFrameVector2& key_frame )
 {
-    m_Y.push_back( key_frame );
+    m_Y.AddKeyFrame( key_frame );
 }
 
 
@@ -153,7 +207,7 @@ UiAnimation::AddYKeyFrame( const UiKeyFrameVector2& key_frame )
 void
 UiAnimation::AddWidthKeyFrame( const UiKeyFrameVector2& key_frame )
 {
-    m_Width.push_back( key_frame );
+    m_Width.AddKeyFrame( key_frame );
 }
 
 
@@ -161,7 +215,7 @@ UiAnimation::AddWidthKeyFrame( const UiKeyFrameVector2& key_frame )
 void
 UiAnimation::AddHeightKeyFrame( const UiKeyFrameVector2& key_frame )
 {
-    m_Height.push_back( key_frame );
+    m_Height.AddKeyFrame( key_frame );
 }
 
 
@@ -169,7 +223,7 @@ UiAnimation::AddHeightKeyFrame( const UiKeyFrameVector2& key_frame )
 void
 UiAnimation::AddRotationKeyFrame( const UiKeyFrameFloat& key_frame )
 {
-    m_Rotation.push_back( key_frame );
+    m_Rotation.AddKeyFrame( key_frame );
 }
 
 
@@ -177,7 +231,7 @@ UiAnimation::AddRotationKeyFrame( const UiKeyFrameFloat& key_frame )
 void
 UiAnimation::AddAlphaKeyFrame( const UiKeyFrameFloat& key_frame )
 {
-    m_Alpha.push_back( key_frame );
+    m_Alpha.AddKeyFrame( key_frame );
 }
 
 
@@ -185,86 +239,26 @@ UiAnimation::AddAlphaKeyFrame( const UiKeyFrameFloat& key_frame )
 void
 UiAnimation::AddScissorKeyFrame( const UiKeyFrameVector2& x1, const UiKeyFrameVector2& y1, const UiKeyFrameVector2& x2, const UiKeyFrameVector2& y2 )
 {
-    m_ScissorXTop.push_back( x1 );
-    m_ScissorYLeft.push_back( y1 );
-    m_ScissorXBottom.push_back( x2 );
-    m_ScissorYRight.push_back( y2 );
-}
-
-
-
-float
-UiAnimation::KeyFrameGetValue( std::vector< UiKeyFrameFloat >& data )
-{
-    float min_value = data[ 0 ].value;
-    float max_value = min_value;
-    float min = 0;
-    float max = m_Length;
-
-    for( unsigned int i = 0; i < data.size(); ++i )
-    {
-        if( data[ i ].time < m_Time && data[ i ].time > min )
-        {
-            min_value = data[ i ].value;
-            min = data[ i ].time;
-        }
-
-        if( data[ i ].time >= m_Time && data[ i ].time <= max )
-        {
-            max_value = data[ i ].value;
-            max = data[ i ].time;
-        }
-    }
-
-    float value;
-
-    if( m_Time == 0 )
-    {
-        value = min_value;
-    }
-    else
-    {
-        value = min_value + ( max_value - min_value ) * ( ( m_Time - min ) / ( max - min ) );
-    }
-
-    return value;
+    m_ScissorXTop.AddKeyFrame( x1 );
+    m_ScissorYLeft.AddKeyFrame( y1 );
+    m_ScissorXBottom.AddKeyFrame( x2 );
+    m_ScissorYRight.AddKeyFrame( y2 );
 }
 
 
 
-Ogre::Vector2
-UiAnimation::KeyFrameGetValue( std::vector< UiKeyFrameVector2 >& data )
+void
+UiAnimation::Bake( const float rate )
 {
-    Ogre::Vector2 min_value = data[ 0 ].value;
-    Ogre::Vector2 max_value = min_value;
-    float min = 0;
-    float max = m_Length;
-
-    for( unsigned int i = 0; i < data.size(); ++i )
-    {
-        if( data[ i ].time < m_Time && data[ i ].time > min )
-        {
-            min_value = data[ i ].value;
-            min = data[ i ].time;
-        }
-
-        if( data[ i ].time >= m_Time && data[ i ].time <= max )
-        {
-            max_value = data[ i ].value;
-            max = data[ i ].time;
-        }
-    }
-
-    Ogre::Vector2 value;
-
-    if( m_Time == 0 )
-    {
-        value = min_value;
-    }
-    else
-    {
-        value = min_value + ( max_value - min_value ) * ( ( m_Time - min ) / ( max - min ) );
-    }
-
-    return value;
+    m_Scale.Bake( rate );
+    m_X.Bake( rate );
+    m_Y.Bake( rate );
+    m_Width.Bake( rate );
+    m_Height.Bake( rate );
+    m_Rotation.Bake( rate );
+    m_Alpha.Bake( rate );
+    m_ScissorXTop.Bake( rate );
+    m_ScissorYLeft.Bake( rate );
+    m_ScissorXBottom.Bake( rate );
+    m_ScissorYRight.Bake( rate );
 }
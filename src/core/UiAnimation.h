@@ -1,8 +1,10 @@
 #ifndef UI_ANIMATION_H
 #define UI_ANIMATION_H
 
+#include <OgreMath.h>
 #include <OgreString.h>
 #include <OgreVector2.h>
+#include <algorithm>
 #include <vector>
 
 
@@ -11,22 +13,220 @@ class UiWidget;
 
 
 
+enum UiEasing
+{
+    UE_LINEAR,
+    UE_IN,
+    UE_OUT,
+    UE_IN_OUT,
+    UE_STEP
+};
+
+UiEasing UiEasingFromString( const Ogre::String& easing );
+float UiEasingApply( const UiEasing easing, const float t );
+
+
+
 struct UiKeyFrameFloat
 {
+    UiKeyFrameFloat(): time( 0 ), value( 0 ), easing( UE_LINEAR ){}
+
     float time;
     float value;
+    UiEasing easing; // easing of segment that ends on this key frame
 };
 
 
 
 struct UiKeyFrameVector2
 {
+    UiKeyFrameVector2(): time( 0 ), value( Ogre::Vector2::ZERO ), easing( UE_LINEAR ){}
+
     float time;
     Ogre::Vector2 value;
+    UiEasing easing; // easing of segment that ends on this key frame
 };
 
 
 
+// Track of one animated value. Key frames are converted to segments with cached
+// bounds, cursor remembers current segment so playing forward doesn't search.
+// Before first key value of first key is used, after last key value returns to
+// first key at the end of animation (cycled animations).
+template< class T, class K >
+class UiCurve
+{
+public:
+    UiCurve():
+        m_Length( 0 ),
+        m_Cursor( 0 ),
+        m_Update( false ),
+        m_SampleRate( 0 )
+    {
+    }
+
+    void
+    AddKeyFrame( const K& key_frame )
+    {
+        // keep key frames sorted by time
+        typename std::vector< K >::iterator it = m_KeyFrames.begin();
+        while( it != m_KeyFrames.end() && it->time <= key_frame.time )
+        {
+            ++it;
+        }
+        m_KeyFrames.insert( it, key_frame );
+        m_Update = true;
+    }
+
+    void
+    SetLength( const float length )
+    {
+        m_Length = length;
+        m_Update = true;
+    }
+
+    bool
+    IsEmpty() const
+    {
+        return m_KeyFrames.size() == 0;
+    }
+
+    // replace evaluation with samples taken with given rate (per second)
+    void
+    Bake( const float rate )
+    {
+        m_Samples.clear();
+        m_SampleRate = 0;
+        if( IsEmpty() == true || rate <= 0 )
+        {
+            return;
+        }
+
+        unsigned int number = ( unsigned int )Ogre::Math::Ceil( m_Length * rate ) + 1;
+        for( unsigned int i = 0; i < number; ++i )
+        {
+            m_Samples.push_back( Evaluate( std::min( i / rate, m_Length ) ) );
+        }
+        m_SampleRate = rate;
+    }
+
+    T
+    GetValue( const float time )
+    {
+        if( m_SampleRate > 0 )
+        {
+            float position = time * m_SampleRate;
+            unsigned int index = ( unsigned int )position;
+            if( index + 1 >= m_Samples.size() )
+            {
+                return m_Samples[ m_Samples.size() - 1 ];
+            }
+            return m_Samples[ index ] + ( m_Samples[ index + 1 ] - m_Samples[ index ] ) * ( position - index );
+        }
+
+        return Evaluate( time );
+    }
+
+private:
+    struct Segment
+    {
+        float start;
+        float end;
+        float inv_length;
+        T start_value;
+        T end_value;
+        UiEasing easing;
+    };
+
+    void
+    UpdateSegments()
+    {
+        m_Update = false;
+        m_Segments.clear();
+        m_Cursor = 0;
+
+        float time = 0;
+        T value = m_KeyFrames[ 0 ].value;
+        for( unsigned int i = 0; i <= m_KeyFrames.size(); ++i )
+        {
+            Segment segment;
+            segment.start = time;
+            segment.start_value = value;
+            if( i < m_KeyFrames.size() )
+            {
+                if( m_KeyFrames[ i ].time <= 0 || m_KeyFrames[ i ].time > m_Length )
+                {
+                    continue;
+                }
+                segment.end = m_KeyFrames[ i ].time;
+                segment.end_value = m_KeyFrames[ i ].value;
+                segment.easing = m_KeyFrames[ i ].easing;
+            }
+            else
+            {
+                segment.end = m_Length;
+                segment.end_value = m_KeyFrames[ 0 ].value;
+                segment.easing = UE_LINEAR;
+            }
+
+            // zero length segments never contain time
+            if( segment.end > segment.start )
+            {
+                segment.inv_length = 1.0f / ( segment.end - segment.start );
+                m_Segments.push_back( segment );
+            }
+
+            time = segment.end;
+            value = segment.end_value;
+        }
+    }
+
+    T
+    Evaluate( const float time )
+    {
+        if( m_Update == true )
+        {
+            UpdateSegments();
+        }
+
+        if( time <= 0 || m_Segments.size() == 0 )
+        {
+            return m_KeyFrames[ 0 ].value;
+        }
+
+        // time only moves forward during playing, search from start only after jump back
+        if( m_Cursor >= m_Segments.size() || time <= m_Segments[ m_Cursor ].start )
+        {
+            m_Cursor = 0;
+        }
+        while( m_Cursor + 1 < m_Segments.size() && time > m_Segments[ m_Cursor ].end )
+        {
+            ++m_Cursor;
+        }
+
+        const Segment& segment = m_Segments[ m_Cursor ];
+        float t = std::min( 1.0f, ( time - segment.start ) * segment.inv_length );
+        return segment.start_value + ( segment.end_value - segment.start_value ) * UiEasingApply( segment.easing, t );
+    }
+
+private:
+    std::vector< K >       m_KeyFrames;
+    std::vector< Segment > m_Segments;
+    float                  m_Length;
+    unsigned int           m_Cursor;
+    bool                   m_Update; // segments need rebuild
+
+    std::vector< T >       m_Samples;
+    float                  m_SampleRate;
+};
+
+
+
+typedef UiCurve< float, UiKeyFrameFloat > UiCurveFloat;
+typedef UiCurve< Ogre::Vector2, UiKeyFrameVector2 > UiCurveVector2;
+
+
+
 class UiAnimation
 {
 public:
@@ -55,31 +255,29 @@ public:
     void AddRotationKeyFrame( const UiKeyFrameFloat& key_frame );
     void AddAlphaKeyFrame( const UiKeyFrameFloat& key_frame );
     void AddScissorKeyFrame( const UiKeyFrameVector2& x1, const UiKeyFrameVector2& y1, const UiKeyFrameVector2& x2, const UiKeyFrameVector2& y2 );
+    void Bake( const float rate );
 
 private:
     UiAnimation();
 
-    float KeyFrameGetValue( std::vector< UiKeyFrameFloat >& data );
-    Ogre::Vector2 KeyFrameGetValue( std::vector< UiKeyFrameVector2 >& data );
-
     Ogre::String m_Name;
     UiWidget*    m_Widget;
 
     float        m_Time;
     float        m_Length;
 
-    std::vector< UiKeyFrameVector2 > m_Scale;
-    std::vector< UiKeyFrameVector2 > m_X;
-    std::vector< UiKeyFrameVector2 > m_Y;
-    std::vector< UiKeyFrameVector2 > m_Width;
-    std::vector< UiKeyFrameVector2 > m_Height;
-    std::vector< UiKeyFrameFloat >   m_Rotation;
-    std::vector< UiKeyFrameFloat >   m_Alpha;
-
-    std::vector< UiKeyFrameVector2 > m_ScissorXTop;
-    std::vector< UiKeyFrameVector2 > m_ScissorYLeft;
-    std::vector< UiKeyFrameVector2 > m_ScissorXBottom;
-    std::vector< UiKeyFrameVector2 > m_ScissorYRight;
+    UiCurveVector2 m_Scale;
+    UiCurveVector2 m_X;
+    UiCurveVector2 m_Y;
+    UiCurveVector2 m_Width;
+    UiCurveVector2 m_Height;
+    UiCurveFloat   m_Rotation;
+    UiCurveFloat   m_Alpha;
+
+    UiCurveVector2 m_ScissorXTop;
+    UiCurveVector2 m_ScissorYLeft;
+    UiCurveVector2 m_ScissorXBottom;
+    UiCurveVector2 m_ScissorYRight;
 };
 
 
@@ -0,0 +1,172 @@
+#include "UiAtlas.h"
+
+#include <OgreImage.h>
+#include <OgreResourceGroupManager.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "Logger.h"
+
+
+
+struct UiAtlasImage
+{
+    Ogre::String name;
+    Ogre::Image image;
+    int page;
+    int x;
+    int y;
+};
+
+
+
+// pack high images first so shelves are filled evenly
+bool
+ui_atlas_compare( const UiAtlasImage* a, const UiAtlasImage* b )
+{
+    return a->image.getHeight() > b->image.getHeight();
+}
+
+
+
+bool
+BuildUiAtlas( const Ogre::String& directory, const int page_size, const Ogre::String& output )
+{
+    // one pixel border around every image is filled with its edge pixels so
+    // filtering near edge doesn't take colours of neighbour image
+    const int padding = 1;
+
+    Ogre::StringVectorPtr names = Ogre::ResourceGroupManager::getSingleton().findResourceNames( "Game", directory + "/*.png" );
+
+    std::vector< UiAtlasImage > images( names->size() );
+    std::vector< UiAtlasImage* > sorted;
+    for( unsigned int i = 0; i < names->size(); ++i )
+    {
+        images[ i ].name = ( *names )[ i ];
+        images[ i ].page = -1;
+
+        // skip pages of previous build
+        if( images[ i ].name.find( output + "_" ) == 0 )
+        {
+            continue;
+        }
+
+        try
+        {
+            images[ i ].image.load( images[ i ].name, "Game" );
+        }
+        catch( const Ogre::Exception& e )
+        {
+            LOG_WARNING( "Can't load \"" + images[ i ].name + "\" for atlas: " + e.getDescription() );
+            continue;
+        }
+
+        if( ( int )images[ i ].image.getWidth() + padding * 2 > page_size || ( int )images[ i ].image.getHeight() + padding * 2 > page_size )
+        {
+            LOG_WARNING( "Image \"" + images[ i ].name + "\" is bigger than atlas page, it will be used as separate texture." );
+            continue;
+        }
+
+        sorted.push_back( &images[ i ] );
+    }
+
+    if( sorted.size() == 0 )
+    {
+        LOG_ERROR( "No images to pack in atlas from \"" + directory + "\"." );
+        return false;
+    }
+
+    std::stable_sort( sorted.begin(), sorted.end(), ui_atlas_compare );
+
+    // shelf packing: fill rows left to right, start new row when image not fit
+    // and new page when row not fit
+    int page = 0;
+    int shelf_x = 0;
+    int shelf_y = 0;
+    int shelf_height = 0;
+    for( unsigned int i = 0; i < sorted.size(); ++i )
+    {
+        int width = ( int )sorted[ i ]->image.getWidth() + padding * 2;
+        int height = ( int )sorted[ i ]->image.getHeight() + padding * 2;
+
+        if( shelf_x + width > page_size )
+        {
+            shelf_x = 0;
+            shelf_y += shelf_height;
+            shelf_height = 0;
+        }
+        if( shelf_y + height > page_size )
+        {
+            ++page;
+            shelf_x = 0;
+            shelf_y = 0;
+            shelf_height = 0;
+        }
+
+        sorted[ i ]->page = page;
+        sorted[ i ]->x = shelf_x + padding;
+        sorted[ i ]->y = shelf_y + padding;
+        shelf_x += width;
+        shelf_height = std::max( shelf_height, height );
+    }
+
+    std::ofstream xml( ( "./data/" + output + ".xml" ).c_str() );
+    if( !xml.is_open() )
+    {
+        LOG_ERROR( "Failed to open atlas file \"" + output + ".xml\" for writing." );
+        return false;
+    }
+    xml << "<atlas>\n";
+
+    for( int p = 0; p <= page; ++p )
+    {
+        Ogre::uchar* data = OGRE_ALLOC_T( Ogre::uchar, page_size * page_size * 4, Ogre::MEMCATEGORY_GENERAL );
+        memset( data, 0, page_size * page_size * 4 );
+        Ogre::Image page_image;
+        page_image.loadDynamicImage( data, page_size, page_size, 1, Ogre::PF_A8R8G8B8, true );
+
+        Ogre::String page_name = output + "_" + Ogre::StringConverter::toString( p ) + ".png";
+        xml << "    <page image=\"" << page_name << "\" size=\"" << page_size << " " << page_size << "\">\n";
+
+        for( unsigned int i = 0; i < sorted.size(); ++i )
+        {
+            UiAtlasImage* image = sorted[ i ];
+            if( image->page != p )
+            {
+                continue;
+            }
+
+            int width = ( int )image->image.getWidth();
+            int height = ( int )image->image.getHeight();
+            for( int y = -padding; y < height + padding; ++y )
+            {
+                for( int x = -padding; x < width + padding; ++x )
+                {
+                    int sx = std::max( 0, std::min( width - 1, x ) );
+                    int sy = std::max( 0, std::min( height - 1, y ) );
+                    page_image.setColourAt( image->image.getColourAt( sx, sy, 0 ), image->x + x, image->y + y, 0 );
+                }
+            }
+
+            xml << "        <texture name=\"" << image->name << "\" x=\"" << image->x << "\" y=\"" << image->y << "\" width=\"" << width << "\" height=\"" << height << "\" />\n";
+        }
+
+        xml << "    </page>\n";
+
+        try
+        {
+            page_image.save( "./data/" + page_name );
+        }
+        catch( const Ogre::Exception& e )
+        {
+            LOG_ERROR( "Can't save atlas page \"" + page_name + "\": " + e.getDescription() );
+            return false;
+        }
+    }
+
+    xml << "</atlas>\n";
+
+    LOG_TRIVIAL( "Packed " + Ogre::StringConverter::toString( sorted.size() ) + " images from \"" + directory + "\" into " + Ogre::StringConverter::toString( page + 1 ) + " atlas pages." );
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef UI_ATLAS_H
+#define UI_ATLAS_H
+
+#include <OgreString.h>
+
+
+
+// place of ui image inside atlas page
+struct UiAtlasTexture
+{
+    UiAtlasTexture():
+        page( "" ),
+        left( 0 ),
+        top( 0 ),
+        right( 1 ),
+        bottom( 1 )
+    {
+    }
+
+    Ogre::String page;
+    float left;
+    float top;
+    float right;
+    float bottom;
+};
+
+
+
+// Pack all images from directory in data into atlas pages. Writes pages as
+// output_N.png and lookup table output.xml (paths relative to ./data).
+bool BuildUiAtlas( const Ogre::String& directory, const int page_size, const Ogre::String& output );
+
+
+
+#endif // UI_ATLAS_H
@@ -0,0 +1,256 @@
+#include "UiBatch.h"
+
+#include <OgreHardwareBufferManager.h>
+#include <OgreMaterialManager.h>
+#include <algorithm>
+#include <cstring>
+
+#include "Counters.h"
+#include "Logger.h"
+#include "SdfFont.h"
+
+
+
+// Draw far quads first (bigger z is farther), so transparent quads blend over
+// what is behind them. For same z keep order in which widgets were rendered.
+bool
+ui_batch_compare( const UiBatchEntry& a, const UiBatchEntry& b )
+{
+    if( a.z != b.z )
+    {
+        return a.z > b.z;
+    }
+    return a.order < b.order;
+}
+
+
+
+UiBatch::UiBatch():
+    m_MaxVertexCount( 0 ),
+    m_DrawCalls( 0 )
+{
+    m_SceneManager = Ogre::Root::getSingleton().getSceneManager( "Scene" );
+    m_RenderSystem = Ogre::Root::getSingletonPtr()->getRenderSystem();
+
+    CreateVertexBuffer( 4096 );
+}
+
+
+
+UiBatch::~UiBatch()
+{
+    DestroyVertexBuffer();
+
+    std::map< Ogre::String, Ogre::MaterialPtr >::iterator it;
+    for( it = m_Materials.begin(); it != m_Materials.end(); ++it )
+    {
+        Ogre::MaterialManager::getSingleton().remove( it->second->getName() );
+    }
+}
+
+
+
+void
+UiBatch::Clear()
+{
+    m_Entries.clear();
+    m_Vertices.clear();
+}
+
+
+
+void
+UiBatch::AddVertices( const Ogre::MaterialPtr& material, const int scissor_left, const int scissor_top, const int scissor_right, const int scissor_bottom, const float z, const float* vertices, const unsigned int vertex_count )
+{
+    if( vertex_count == 0 || material.isNull() == true )
+    {
+        return;
+    }
+
+    UiBatchEntry entry;
+    entry.material = material.get();
+    entry.scissor_left = scissor_left;
+    entry.scissor_top = scissor_top;
+    entry.scissor_right = scissor_right;
+    entry.scissor_bottom = scissor_bottom;
+    entry.z = z;
+    entry.order = m_Entries.size();
+    entry.start = m_Vertices.size() / UI_VERTEX_SIZE;
+    entry.count = vertex_count;
+    m_Entries.push_back( entry );
+
+    m_Vertices.insert( m_Vertices.end(), vertices, vertices + vertex_count * UI_VERTEX_SIZE );
+}
+
+
+
+void
+UiBatch::Render()
+{
+    m_DrawCalls = 0;
+
+    if( m_Entries.size() == 0 )
+    {
+        return;
+    }
+
+    std::sort( m_Entries.begin(), m_Entries.end(), ui_batch_compare );
+
+    unsigned int vertex_count = m_Vertices.size() / UI_VERTEX_SIZE;
+    if( vertex_count > m_MaxVertexCount )
+    {
+        unsigned int new_count = m_MaxVertexCount * 2;
+        while( new_count < vertex_count )
+        {
+            new_count *= 2;
+        }
+        DestroyVertexBuffer();
+        CreateVertexBuffer( new_count );
+    }
+
+    // copy vertices in sorted order so every run of entries is continuous in buffer
+    COUNTER_ADD( "vertex_buffer_locks", 1 );
+    float* write_iterator = ( float* ) m_VertexBuffer->lock( Ogre::HardwareBuffer::HBL_DISCARD );
+    unsigned int buffer_start = 0;
+    for( unsigned int i = 0; i < m_Entries.size(); ++i )
+    {
+        memcpy( write_iterator, &m_Vertices[ m_Entries[ i ].start * UI_VERTEX_SIZE ], m_Entries[ i ].count * UI_VERTEX_SIZE * sizeof( float ) );
+        write_iterator += m_Entries[ i ].count * UI_VERTEX_SIZE;
+        m_Entries[ i ].start = buffer_start;
+        buffer_start += m_Entries[ i ].count;
+    }
+    m_VertexBuffer->unlock();
+
+    m_RenderSystem->_setWorldMatrix( Ogre::Matrix4::IDENTITY );
+    m_RenderSystem->_setProjectionMatrix( Ogre::Matrix4::IDENTITY );
+    m_RenderSystem->_setViewMatrix( Ogre::Matrix4::IDENTITY );
+
+    Ogre::Material* current_material = NULL;
+    unsigned int i = 0;
+    while( i < m_Entries.size() )
+    {
+        const UiBatchEntry& first = m_Entries[ i ];
+        unsigned int count = first.count;
+
+        unsigned int j = i + 1;
+        for( ; j < m_Entries.size(); ++j )
+        {
+            const UiBatchEntry& next = m_Entries[ j ];
+            if( next.material != first.material ||
+                next.scissor_left != first.scissor_left ||
+                next.scissor_top != first.scissor_top ||
+                next.scissor_right != first.scissor_right ||
+                next.scissor_bottom != first.scissor_bottom )
+            {
+                break;
+            }
+            count += next.count;
+        }
+
+        if( first.material != current_material )
+        {
+            m_SceneManager->_setPass( first.material->getTechnique( 0 )->getPass( 0 ), true, false );
+            current_material = first.material;
+        }
+
+        m_RenderSystem->setScissorTest( true, first.scissor_left, first.scissor_top, first.scissor_right, first.scissor_bottom );
+        m_RenderOp.vertexData->vertexStart = first.start;
+        m_RenderOp.vertexData->vertexCount = count;
+        m_RenderSystem->_render( m_RenderOp );
+        ++m_DrawCalls;
+
+        i = j;
+    }
+
+    m_RenderSystem->setScissorTest( false );
+}
+
+
+
+Ogre::MaterialPtr
+UiBatch::GetMaterial( const Ogre::String& texture, const bool depth, const bool sdf )
+{
+    Ogre::String name = ( ( depth == true ) ? "UiMaterials.Batch." : "UiMaterials.BatchNoDepth." ) + Ogre::String( ( sdf == true ) ? "Sdf." : "" ) + texture;
+
+    std::map< Ogre::String, Ogre::MaterialPtr >::iterator it = m_Materials.find( name );
+    if( it != m_Materials.end() )
+    {
+        return it->second;
+    }
+
+    Ogre::MaterialPtr material = Ogre::MaterialManager::getSingleton().create( name, "General" );
+    Ogre::Pass* pass = material->getTechnique( 0 )->getPass( 0 );
+    pass->setVertexColourTracking( Ogre::TVC_AMBIENT );
+    pass->setCullingMode( Ogre::CULL_NONE );
+    pass->setDepthCheckEnabled( depth );
+    pass->setDepthWriteEnabled( depth );
+    pass->setLightingEnabled( false );
+    pass->setSceneBlending( Ogre::SBT_TRANSPARENT_ALPHA );
+
+    pass->setAlphaRejectFunction( Ogre::CMPF_GREATER );
+    pass->setAlphaRejectValue( 0 );
+    Ogre::TextureUnitState* tex = pass->createTextureUnitState();
+    tex->setTextureName( texture );
+    tex->setNumMipmaps( -1 );
+    tex->setTextureFiltering( Ogre::TFO_NONE );
+
+    if( sdf == true )
+    {
+        SetSdfPass( pass );
+    }
+
+    m_Materials[ name ] = material;
+    return material;
+}
+
+
+
+unsigned int
+UiBatch::GetNumberOfDrawCalls() const
+{
+    return m_DrawCalls;
+}
+
+
+
+unsigned int
+UiBatch::GetNumberOfVertices() const
+{
+    return m_Vertices.size() / UI_VERTEX_SIZE;
+}
+
+
+
+void
+UiBatch::CreateVertexBuffer( const unsigned int vertex_count )
+{
+    m_MaxVertexCount = vertex_count;
+    m_RenderOp.vertexData = new Ogre::VertexData;
+    m_RenderOp.vertexData->vertexStart = 0;
+
+    Ogre::VertexDeclaration* vDecl = m_RenderOp.vertexData->vertexDeclaration;
+
+    size_t offset = 0;
+    vDecl->addElement( 0, 0, Ogre::VET_FLOAT3, Ogre::VES_POSITION );
+    offset += Ogre::VertexElement::getTypeSize( Ogre::VET_FLOAT3 );
+    vDecl->addElement( 0, offset, Ogre::VET_FLOAT4, Ogre::VES_DIFFUSE );
+    offset += Ogre::VertexElement::getTypeSize( Ogre::VET_FLOAT4 );
+    vDecl->addElement( 0, offset, Ogre::VET_FLOAT2, Ogre::VES_TEXTURE_COORDINATES );
+
+    m_VertexBuffer = Ogre::HardwareBufferManager::getSingletonPtr()->createVertexBuffer( vDecl->getVertexSize( 0 ), m_MaxVertexCount, Ogre::HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY_DISCARDABLE, false );
+
+    m_RenderOp.vertexData->vertexBufferBinding->setBinding( 0, m_VertexBuffer );
+    m_RenderOp.operationType = Ogre::RenderOperation::OT_TRIANGLE_LIST;
+    m_RenderOp.useIndexes = false;
+}
+
+
+
+void
+UiBatch::DestroyVertexBuffer()
+{
+    delete m_RenderOp.vertexData;
+    m_RenderOp.vertexData = 0;
+    m_VertexBuffer.setNull();
+    m_MaxVertexCount = 0;
+}
@@ -0,0 +1,72 @@
+#ifndef UI_BATCH_H
+#define UI_BATCH_H
+
+#include <OgreHardwareVertexBuffer.h>
+#include <OgreMaterial.h>
+#include <OgreRoot.h>
+#include <map>
+#include <vector>
+
+
+
+// number of floats per ui vertex: position xyz, colour rgba, uv
+const unsigned int UI_VERTEX_SIZE = 9;
+
+
+
+struct UiBatchEntry
+{
+    Ogre::Material* material;
+    int scissor_left;
+    int scissor_top;
+    int scissor_right;
+    int scissor_bottom;
+    float z;
+    unsigned int order; // order of adding, keeps tree order for same z
+    unsigned int start; // first vertex in vertices array
+    unsigned int count;
+};
+
+
+
+// Collects quads of all visible widgets during render, sorts them by z and
+// draws runs with same material and scissor with one call from one vertex buffer.
+class UiBatch
+{
+public:
+    UiBatch();
+    virtual ~UiBatch();
+
+    void Clear();
+    void AddVertices( const Ogre::MaterialPtr& material, const int scissor_left, const int scissor_top, const int scissor_right, const int scissor_bottom, const float z, const float* vertices, const unsigned int vertex_count );
+    void Render();
+
+    // materials are shared between widgets with same texture so they can be batched together
+    Ogre::MaterialPtr GetMaterial( const Ogre::String& texture, const bool depth, const bool sdf = false );
+
+    unsigned int GetNumberOfDrawCalls() const;
+    unsigned int GetNumberOfVertices() const;
+
+private:
+    void CreateVertexBuffer( const unsigned int vertex_count );
+    void DestroyVertexBuffer();
+
+private:
+    Ogre::SceneManager*                 m_SceneManager;
+    Ogre::RenderSystem*                 m_RenderSystem;
+
+    std::vector< UiBatchEntry >         m_Entries;
+    std::vector< float >                m_Vertices;
+
+    std::map< Ogre::String, Ogre::MaterialPtr > m_Materials;
+
+    Ogre::RenderOperation               m_RenderOp;
+    Ogre::HardwareVertexBufferSharedPtr m_VertexBuffer;
+    unsigned int                        m_MaxVertexCount;
+
+    unsigned int                        m_DrawCalls;
+};
+
+
+
+#endif // UI_BATCH_H
@@ -0,0 +1,935 @@
+#include "UiDescription.h"
+
+#include <OgreStringConverter.h>
+#include <cstring>
+#include <fstream>
+
+#include "ConfigVar.h"
+#include "Logger.h"
+#include "ScriptManager.h"
+#include "TextManager.h"
+#include "UiAnimation.h"
+#include "UiList.h"
+#include "UiManager.h"
+#include "UiSprite.h"
+#include "UiTextArea.h"
+#include "UiWidget.h"
+#include "Utilites.h"
+
+
+
+ConfigVar cv_ui_cache( "ui_cache", "Load ui screens, prototypes and texts from compiled cache if source not changed", "true" );
+
+// cache file: magic, version, source hash, sizes of structures, then arrays
+const char UI_CACHE_MAGIC[] = "XGUI";
+const unsigned int UI_CACHE_VERSION = 2;
+
+
+
+void
+ui_cache_write( Ogre::String& data, const void* p, const size_t size )
+{
+    data.append( ( const char* )p, size );
+}
+
+
+
+template< class T, class A > void
+ui_cache_write_array( Ogre::String& data, const std::vector< T, A >& array )
+{
+    unsigned int count = array.size();
+    ui_cache_write( data, &count, sizeof( count ) );
+    if( count > 0 )
+    {
+        ui_cache_write( data, &array[ 0 ], count * sizeof( T ) );
+    }
+}
+
+
+
+bool
+ui_cache_read( const Ogre::String& data, size_t& offset, void* p, const size_t size )
+{
+    if( offset + size > data.size() )
+    {
+        return false;
+    }
+    memcpy( p, data.data() + offset, size );
+    offset += size;
+    return true;
+}
+
+
+
+template< class T, class A > bool
+ui_cache_read_array( const Ogre::String& data, size_t& offset, std::vector< T, A >& array )
+{
+    unsigned int count = 0;
+    if( ui_cache_read( data, offset, &count, sizeof( count ) ) == false || count > ( data.size() - offset ) / sizeof( T ) )
+    {
+        return false;
+    }
+    array.resize( count );
+    return ( count == 0 ) || ui_cache_read( data, offset, &array[ 0 ], count * sizeof( T ) );
+}
+
+
+
+void
+ui_cache_header( Ogre::String& data, const unsigned int hash )
+{
+    data.assign( UI_CACHE_MAGIC, 4 );
+    unsigned int header[] =
+    {
+        UI_CACHE_VERSION,
+        hash,
+        sizeof( UiDescRoot ),
+        sizeof( UiDescWidget ),
+        sizeof( UiDescAnimation ),
+        sizeof( UiDescKeyFrame ),
+        sizeof( UiDescText )
+    };
+    ui_cache_write( data, header, sizeof( header ) );
+}
+
+
+
+UiDescription::UiDescription()
+{
+    Clear();
+}
+
+
+
+UiDescription::~UiDescription()
+{
+}
+
+
+
+void
+UiDescription::AddScreen( TiXmlNode* node )
+{
+    UiDescRoot root;
+    root.type = UDR_SCREEN;
+    root.name = AddString( GetString( node, "name" ) );
+    root.script = AddString( GetString( node, "script" ) );
+    root.index = m_Widgets.size();
+    root.width = 0;
+    root.height = 0;
+    m_Roots.push_back( root );
+
+    AddWidgetRecursive( node );
+}
+
+
+
+void
+UiDescription::AddPrototype( TiXmlNode* node )
+{
+    UiDescRoot root;
+    root.type = UDR_PROTOTYPE;
+    root.name = AddString( GetString( node, "name" ) );
+    root.script = 0;
+    root.index = m_Widgets.size();
+    root.width = 0;
+    root.height = 0;
+    m_Roots.push_back( root );
+
+    AddWidgetRecursive( node );
+}
+
+
+
+unsigned int
+UiDescription::AddText( TiXmlNode* node )
+{
+    UiDescRoot root;
+    root.type = UDR_TEXT;
+    root.name = AddString( GetString( node, "name" ) );
+    root.script = 0;
+    root.index = m_Texts.size();
+    root.width = 0;
+    root.height = 0;
+    m_Roots.push_back( root );
+
+    AddTextRecursive( node );
+    return root.index;
+}
+
+
+
+void
+UiDescription::AddDialog( TiXmlNode* node )
+{
+    UiDescRoot root;
+    root.type = UDR_DIALOG;
+    root.name = AddString( GetString( node, "name" ) );
+    root.script = 0;
+    root.index = m_Texts.size();
+    root.width = GetFloat( node, "width" );
+    root.height = GetFloat( node, "height" );
+    m_Roots.push_back( root );
+
+    AddTextRecursive( node );
+}
+
+
+
+void
+UiDescription::Clear()
+{
+    m_Strings.clear();
+    m_StringIndex.clear();
+    m_Roots.clear();
+    m_Widgets.clear();
+    m_Animations.clear();
+    m_KeyFrames.clear();
+    m_Texts.clear();
+
+    AddString( "" );
+}
+
+
+
+bool
+UiDescription::LoadCache( const Ogre::String& file )
+{
+    if( cv_ui_cache.GetB() == false )
+    {
+        return false;
+    }
+
+    Ogre::String source;
+    Ogre::String cache;
+    if( ReadFileData( "./data/" + file, source ) == false || ReadFileData( "./data/" + file + "b", cache ) == false )
+    {
+        return false;
+    }
+
+    Ogre::String header;
+    ui_cache_header( header, HashData( source ) );
+    if( cache.compare( 0, header.size(), header ) != 0 )
+    {
+        return false;
+    }
+
+    // string table in cache already starts with empty string
+    Clear();
+    m_Strings.clear();
+
+    size_t offset = header.size();
+    unsigned int count = 0;
+    bool valid = ui_cache_read( cache, offset, &count, sizeof( count ) );
+    for( unsigned int i = 0; valid == true && i < count; ++i )
+    {
+        unsigned int length = 0;
+        valid = ui_cache_read( cache, offset, &length, sizeof( length ) ) && offset + length <= cache.size();
+        if( valid == true )
+        {
+            m_Strings.push_back( cache.substr( offset, length ) );
+            offset += length;
+        }
+    }
+
+    valid = valid &&
+        ui_cache_read_array( cache, offset, m_Roots ) &&
+        ui_cache_read_array( cache, offset, m_Widgets ) &&
+        ui_cache_read_array( cache, offset, m_Animations ) &&
+        ui_cache_read_array( cache, offset, m_KeyFrames ) &&
+        ui_cache_read_array( cache, offset, m_Texts );
+
+    if( valid == false || m_Strings.size() == 0 )
+    {
+        LOG_WARNING( "Ui cache for \"" + file + "\" is broken. Compile from source." );
+        Clear();
+        return false;
+    }
+
+    return true;
+}
+
+
+
+void
+UiDescription::SaveCache( const Ogre::String& file ) const
+{
+    if( cv_ui_cache.GetB() == false )
+    {
+        return;
+    }
+
+    Ogre::String source;
+    if( ReadFileData( "./data/" + file, source ) == false )
+    {
+        return;
+    }
+
+    Ogre::String cache;
+    ui_cache_header( cache, HashData( source ) );
+
+    unsigned int count = m_Strings.size();
+    ui_cache_write( cache, &count, sizeof( count ) );
+    for( unsigned int i = 0; i < count; ++i )
+    {
+        unsigned int length = m_Strings[ i ].size();
+        ui_cache_write( cache, &length, sizeof( length ) );
+        cache.append( m_Strings[ i ] );
+    }
+
+    ui_cache_write_array( cache, m_Roots );
+    ui_cache_write_array( cache, m_Widgets );
+    ui_cache_write_array( cache, m_Animations );
+    ui_cache_write_array( cache, m_KeyFrames );
+    ui_cache_write_array( cache, m_Texts );
+
+    std::ofstream cache_file( ( "./data/" + file + "b" ).c_str(), std::ios::out | std::ios::binary );
+    if( cache_file.is_open() )
+    {
+        cache_file.write( cache.data(), cache.size() );
+    }
+    else
+    {
+        LOG_WARNING( "Can't write ui cache for \"" + file + "\"." );
+    }
+}
+
+
+
+void
+UiDescription::CreateScreens() const
+{
+    for( unsigned int i = 0; i < m_Roots.size(); ++i )
+    {
+        if( m_Roots[ i ].type != UDR_SCREEN )
+        {
+            continue;
+        }
+
+        const Ogre::String& script = m_Strings[ m_Roots[ i ].script ];
+        if( script != "" )
+        {
+            ScriptManager::getSingleton().RunFile( script, ScriptManager::UI );
+        }
+
+        const Ogre::String& base_name = m_Strings[ m_Roots[ i ].name ];
+        UiWidget* widget = new UiWidget( base_name );
+        widget->SetVisible( m_Widgets[ m_Roots[ i ].index ].visible != 0 );
+        CreateContent( m_Roots[ i ].index, base_name, widget );
+
+        UiManager::getSingleton().AddWidget( widget );
+    }
+}
+
+
+
+void
+UiDescription::CreateContent( const unsigned int node, const Ogre::String& base_name, UiWidget* widget ) const
+{
+    const UiDescWidget& desc = m_Widgets[ node ];
+
+    for( unsigned int i = desc.first_animation; i < desc.first_animation + desc.animation_count; ++i )
+    {
+        const UiDescAnimation& anim_desc = m_Animations[ i ];
+        UiAnimation* animation = new UiAnimation( m_Strings[ anim_desc.name ], widget );
+        animation->SetLength( anim_desc.length );
+
+        unsigned int key_end = anim_desc.first_key + anim_desc.key_count;
+        for( unsigned int j = anim_desc.first_key; j < key_end; ++j )
+        {
+            const UiDescKeyFrame& key_desc = m_KeyFrames[ j ];
+
+            UiKeyFrameVector2 key;
+            key.time = key_desc.time;
+            key.easing = ( UiEasing )key_desc.easing;
+            key.value = key_desc.value;
+
+            UiKeyFrameFloat key_float;
+            key_float.time = key_desc.time;
+            key_float.easing = ( UiEasing )key_desc.easing;
+            key_float.value = key_desc.value.x;
+
+            switch( key_desc.track )
+            {
+                case UDA_SCALE: animation->AddScaleKeyFrame( key ); break;
+                case UDA_X: animation->AddXKeyFrame( key ); break;
+                case UDA_Y: animation->AddYKeyFrame( key ); break;
+                case UDA_WIDTH: animation->AddWidthKeyFrame( key ); break;
+                case UDA_HEIGHT: animation->AddHeightKeyFrame( key ); break;
+                case UDA_ROTATION: animation->AddRotationKeyFrame( key_float ); break;
+                case UDA_ALPHA: animation->AddAlphaKeyFrame( key_float ); break;
+                case UDA_SCISSOR:
+                {
+                    if( j + 3 < key_end )
+                    {
+                        UiKeyFrameVector2 keys[ 4 ];
+                        for( unsigned int k = 0; k < 4; ++k )
+                        {
+                            keys[ k ].time = m_KeyFrames[ j + k ].time;
+                            keys[ k ].easing = ( UiEasing )m_KeyFrames[ j + k ].easing;
+                            keys[ k ].value = m_KeyFrames[ j + k ].value;
+                        }
+                        animation->AddScissorKeyFrame( keys[ 0 ], keys[ 1 ], keys[ 2 ], keys[ 3 ] );
+                    }
+                    j += 3;
+                }
+                break;
+            }
+        }
+
+        if( anim_desc.bake > 0 )
+        {
+            animation->Bake( anim_desc.bake );
+        }
+
+        widget->AddAnimation( animation );
+    }
+
+    for( unsigned int i = node + 1; i < desc.end; i = m_Widgets[ i ].end )
+    {
+        if( m_Widgets[ i ].type == UDW_PROTOTYPE )
+        {
+            unsigned int prototype_node = 0;
+            const UiDescription* prototype = UiManager::getSingleton().GetPrototype( m_Strings[ m_Widgets[ i ].name ], prototype_node );
+            if( prototype != NULL )
+            {
+                prototype->CreateContent( prototype_node, base_name, widget );
+            }
+        }
+        else
+        {
+            CreateWidget( i, base_name, widget );
+        }
+    }
+}
+
+
+
+unsigned int
+UiDescription::GetNumberOfRoots() const
+{
+    return m_Roots.size();
+}
+
+
+
+const UiDescRoot&
+UiDescription::GetRoot( const unsigned int index ) const
+{
+    return m_Roots[ index ];
+}
+
+
+
+const UiDescWidget&
+UiDescription::GetWidget( const unsigned int index ) const
+{
+    return m_Widgets[ index ];
+}
+
+
+
+const UiDescText&
+UiDescription::GetText( const unsigned int index ) const
+{
+    return m_Texts[ index ];
+}
+
+
+
+const Ogre::String&
+UiDescription::GetString( const unsigned int index ) const
+{
+    return m_Strings[ index ];
+}
+
+
+
+unsigned int
+UiDescription::AddString( const Ogre::String& string )
+{
+    boost::unordered_map< Ogre::String, unsigned int >::const_iterator it = m_StringIndex.find( string );
+    if( it != m_StringIndex.end() )
+    {
+        return it->second;
+    }
+
+    unsigned int index = m_Strings.size();
+    m_Strings.push_back( string );
+    m_StringIndex[ string ] = index;
+    return index;
+}
+
+
+
+void
+UiDescription::AddWidgetRecursive( TiXmlNode* node )
+{
+    UiDescWidget widget;
+    widget.type = UDW_WIDGET;
+    if( node->ValueStr() == "sprite" )
+    {
+        widget.type = UDW_SPRITE;
+    }
+    else if( node->ValueStr() == "text_area" )
+    {
+        widget.type = UDW_TEXT_AREA;
+    }
+    else if( node->ValueStr() == "list" )
+    {
+        widget.type = UDW_LIST;
+    }
+    else if( node->ValueStr() == "prototype" )
+    {
+        widget.type = UDW_PROTOTYPE;
+    }
+
+    widget.flags = 0;
+    widget.name = AddString( GetString( node, "name" ) );
+    widget.image = AddString( GetString( node, "image" ) );
+    widget.vertex_shader = AddString( GetString( node, "vertex_shader" ) );
+    widget.fragment_shader = AddString( GetString( node, "fragment_shader" ) );
+    widget.text_name = AddString( GetString( node, "text_name" ) );
+    widget.font = AddString( GetString( node, "font" ) );
+
+    Ogre::String text_align = GetString( node, "text_align" );
+    widget.text_align = ( text_align == "" ) ? -1 : ( ( text_align == "center" ) ? UiTextArea::CENTER : ( ( text_align == "right" ) ? UiTextArea::RIGHT : UiTextArea::LEFT ) );
+    Ogre::String align = GetString( node, "align" );
+    widget.align = ( align == "" ) ? -1 : ( ( align == "center" ) ? UiWidget::CENTER : ( ( align == "right" ) ? UiWidget::RIGHT : UiWidget::LEFT ) );
+    Ogre::String valign = GetString( node, "valign" );
+    widget.valign = ( valign == "" ) ? -1 : ( ( valign == "middle" ) ? UiWidget::MIDDLE : ( ( valign == "bottom" ) ? UiWidget::BOTTOM : UiWidget::TOP ) );
+
+    widget.row_prototype = AddString( GetString( node, "row_prototype" ) );
+    widget.row_height = GetFloat( node, "row_height", 0 );
+
+    widget.padding = GetVector4( node, "padding", Ogre::Vector4::ZERO );
+    if( widget.padding != Ogre::Vector4::ZERO )
+    {
+        widget.flags |= UDF_PADDING;
+    }
+
+    Ogre::String colours = GetString( node, "colours" );
+    if( colours != "" )
+    {
+        widget.flags |= UDF_COLOURS;
+        Ogre::StringVector colour_string = Ogre::StringUtil::split( colours, "," );
+        for( unsigned int i = 0; i < 4; ++i )
+        {
+            widget.colour[ i ] = Ogre::Vector3( 1, 1, 1 );
+            if( i < colour_string.size() )
+            {
+                Ogre::StringUtil::trim( colour_string[ i ] );
+                widget.colour[ i ] = Ogre::StringConverter::parseVector3( colour_string[ i ] );
+            }
+        }
+    }
+    else
+    {
+        widget.colour[ 0 ] = GetVector3( node, "colour", Ogre::Vector3( 1, 1, 1 ) );
+        widget.colour[ 1 ] = widget.colour[ 2 ] = widget.colour[ 3 ] = widget.colour[ 0 ];
+    }
+
+    widget.alpha = GetFloat( node, "alpha", 1 );
+
+    struct { const char* attribute; unsigned int flag; Ogre::Vector2* value; } percents[] =
+    {
+        { "origin_x", UDF_ORIGIN_X, &widget.origin_x },
+        { "origin_y", UDF_ORIGIN_Y, &widget.origin_y },
+        { "x", UDF_X, &widget.x },
+        { "y", UDF_Y, &widget.y },
+        { "width", UDF_WIDTH, &widget.width },
+        { "height", UDF_HEIGHT, &widget.height }
+    };
+    for( unsigned int i = 0; i < 6; ++i )
+    {
+        *percents[ i ].value = Ogre::Vector2::ZERO;
+        Ogre::String string = GetString( node, percents[ i ].attribute );
+        if( string != "" )
+        {
+            ParsePersent( percents[ i ].value->x, percents[ i ].value->y, string );
+            widget.flags |= percents[ i ].flag;
+        }
+    }
+
+    Ogre::String scissor_area = GetString( node, "scissor_area" );
+    Ogre::StringVector coords = Ogre::StringUtil::split( scissor_area, " " );
+    for( unsigned int i = 0; i < 4; ++i )
+    {
+        widget.scissor[ i ] = Ogre::Vector2::ZERO;
+        if( coords.size() == 4 )
+        {
+            ParsePersent( widget.scissor[ i ].x, widget.scissor[ i ].y, coords[ i ] );
+            widget.flags |= UDF_SCISSOR;
+        }
+    }
+
+    widget.scale = GetVector2( node, "scale", Ogre::Vector2( 1.0f, 1.0f ) );
+    widget.rotation = GetFloat( node, "rotation", 0.0f );
+    widget.global_scissor = GetBool( node, "global_scissor", true ) ? 1 : 0;
+    widget.visible = GetBool( node, "visible", false ) ? 1 : 0;
+
+    unsigned int index = m_Widgets.size();
+    widget.first_animation = m_Animations.size();
+    widget.animation_count = 0;
+    widget.end = index + 1;
+    m_Widgets.push_back( widget );
+
+    // animations of this widget go first so they are continuous in array
+    for( TiXmlNode* child = node->FirstChild(); child != NULL; child = child->NextSibling() )
+    {
+        if( child->Type() == TiXmlNode::TINYXML_ELEMENT && child->ValueStr() == "animation" )
+        {
+            AddAnimation( child );
+        }
+    }
+    m_Widgets[ index ].animation_count = m_Animations.size() - m_Widgets[ index ].first_animation;
+
+    for( TiXmlNode* child = node->FirstChild(); child != NULL; child = child->NextSibling() )
+    {
+        if( child->Type() != TiXmlNode::TINYXML_ELEMENT )
+        {
+            continue;
+        }
+
+        Ogre::String name = GetString( child, "name" );
+        if( child->ValueStr() == "prototype" )
+        {
+            // use of prototype, its content is taken from ui manager when instantiated
+            if( name != "" )
+            {
+                UiDescWidget prototype;
+                memset( &prototype, 0, sizeof( prototype ) );
+                prototype.type = UDW_PROTOTYPE;
+                prototype.name = AddString( name );
+                prototype.first_animation = m_Animations.size();
+                prototype.end = m_Widgets.size() + 1;
+                m_Widgets.push_back( prototype );
+            }
+        }
+        else if( child->ValueStr() == "widget" || child->ValueStr() == "sprite" || child->ValueStr() == "text_area" || child->ValueStr() == "list" )
+        {
+            if( name != "" )
+            {
+                AddWidgetRecursive( child );
+            }
+            else
+            {
+                LOG_ERROR( "There is no name in entity with base name " + m_Strings[ widget.name ] );
+            }
+        }
+    }
+
+    m_Widgets[ index ].end = m_Widgets.size();
+}
+
+
+
+void
+UiDescription::AddAnimation( TiXmlNode* node )
+{
+    Ogre::String name = GetString( node, "name" );
+    if( name == "" )
+    {
+        return;
+    }
+
+    UiDescAnimation animation;
+    animation.name = AddString( name );
+    animation.length = GetFloat( node, "length", 0 );
+    // baked animations sample curves with fixed rate instead of evaluating segments
+    animation.bake = GetFloat( node, "bake", 0 );
+    animation.first_key = m_KeyFrames.size();
+
+    AddKeyFrames( node, "scale", UDA_SCALE, animation.length );
+    AddKeyFrames( node, "x", UDA_X, animation.length );
+    AddKeyFrames( node, "y", UDA_Y, animation.length );
+    AddKeyFrames( node, "width", UDA_WIDTH, animation.length );
+    AddKeyFrames( node, "height", UDA_HEIGHT, animation.length );
+    AddKeyFrames( node, "rotation", UDA_ROTATION, animation.length );
+    AddKeyFrames( node, "alpha", UDA_ALPHA, animation.length );
+    AddKeyFrames( node, "scissor_area", UDA_SCISSOR, animation.length );
+
+    animation.key_count = m_KeyFrames.size() - animation.first_key;
+    m_Animations.push_back( animation );
+}
+
+
+
+void
+UiDescription::AddKeyFrames( TiXmlNode* node, const Ogre::String& attribute, const int track, const float length )
+{
+    Ogre::String string = GetString( node, attribute );
+    if( string == "" )
+    {
+        return;
+    }
+
+    Ogre::StringVector key_frame = Ogre::StringUtil::split( string, "," );
+    for( unsigned int i = 0; i < key_frame.size(); ++i )
+    {
+        Ogre::StringUtil::trim( key_frame[ i ] );
+
+        Ogre::StringVector data = Ogre::StringUtil::split( key_frame[ i ], ":" );
+        if( data.size() < 2 )
+        {
+            continue;
+        }
+
+        UiDescKeyFrame key;
+        key.track = track;
+        key.time = ParseKeyFrameTime( length, data[ 0 ] );
+        key.easing = UiEasingFromString( ( data.size() > 2 ) ? data[ 2 ] : Ogre::StringUtil::BLANK );
+        key.value = Ogre::Vector2::ZERO;
+
+        switch( track )
+        {
+            case UDA_SCALE:
+            {
+                key.value = Ogre::StringConverter::parseVector2( data[ 1 ] );
+                m_KeyFrames.push_back( key );
+            }
+            break;
+
+            case UDA_ROTATION:
+            case UDA_ALPHA:
+            {
+                key.value.x = Ogre::StringConverter::parseReal( data[ 1 ] );
+                m_KeyFrames.push_back( key );
+            }
+            break;
+
+            case UDA_SCISSOR:
+            {
+                Ogre::StringVector keys = Ogre::StringUtil::split( data[ 1 ], " " );
+                if( keys.size() != 4 )
+                {
+                    LOG_WARNING( "Scissor key frame \"" + key_frame[ i ] + "\" must have 4 coordinates." );
+                    continue;
+                }
+                for( unsigned int j = 0; j < 4; ++j )
+                {
+                    ParsePersent( key.value.x, key.value.y, keys[ j ] );
+                    m_KeyFrames.push_back( key );
+                }
+            }
+            break;
+
+            default:
+            {
+                ParsePersent( key.value.x, key.value.y, data[ 1 ] );
+                m_KeyFrames.push_back( key );
+            }
+        }
+    }
+}
+
+
+
+void
+UiDescription::AddTextRecursive( TiXmlNode* node )
+{
+    UiDescText text;
+    text.type = UDT_ELEMENT;
+    text.string = 0;
+    text.time = 0;
+    text.colour = Ogre::ColourValue::White;
+
+    if( node->Type() == TiXmlNode::TINYXML_TEXT )
+    {
+        text.type = UDT_TEXT;
+        text.string = AddString( node->ValueStr() );
+        text.end = m_Texts.size() + 1;
+        m_Texts.push_back( text );
+        return;
+    }
+    else if( node->Type() != TiXmlNode::TINYXML_ELEMENT )
+    {
+        return;
+    }
+
+    const Ogre::String& name = node->ValueStr();
+    const std::string* attribute = NULL;
+    if( name == "colour" )
+    {
+        text.type = UDT_COLOUR;
+        text.colour = Ogre::StringConverter::parseColourValue( GetString( node, "value" ) );
+    }
+    else if( name == "pause_ok" )
+    {
+        text.type = UDT_PAUSE_OK;
+    }
+    else if( name == "pause" )
+    {
+        attribute = node->ToElement()->Attribute( Ogre::String( "time" ) );
+        if( attribute != NULL )
+        {
+            text.type = UDT_PAUSE;
+            text.time = Ogre::StringConverter::parseReal( *attribute );
+        }
+    }
+    else if( name == "next_page" )
+    {
+        text.type = UDT_NEXT_PAGE;
+    }
+    else if( name == "timer" )
+    {
+        text.type = UDT_TIMER;
+    }
+    else if( name == "variable" || name == "include" )
+    {
+        attribute = node->ToElement()->Attribute( Ogre::String( "name" ) );
+        if( attribute != NULL )
+        {
+            text.type = ( name == "variable" ) ? UDT_VARIABLE : UDT_INCLUDE;
+            text.string = AddString( *attribute );
+        }
+    }
+    else if( name == "image" )
+    {
+        Ogre::String sprite = GetString( node, "sprite" );
+        if( sprite != "" )
+        {
+            text.type = UDT_IMAGE;
+            text.string = AddString( sprite );
+        }
+    }
+
+    unsigned int index = m_Texts.size();
+    m_Texts.push_back( text );
+
+    for( TiXmlNode* child = node->FirstChild(); child != NULL; child = child->NextSibling() )
+    {
+        AddTextRecursive( child );
+    }
+
+    m_Texts[ index ].end = m_Texts.size();
+}
+
+
+
+void
+UiDescription::CreateWidget( const unsigned int node, const Ogre::String& base_name, UiWidget* parent ) const
+{
+    const UiDescWidget& desc = m_Widgets[ node ];
+    const Ogre::String& name = m_Strings[ desc.name ];
+    Ogre::String path_name = base_name + "." + name;
+
+    UiWidget* widget;
+    if( desc.type == UDW_SPRITE )
+    {
+        UiSprite* sprite = new UiSprite( name, path_name, parent );
+        if( desc.image != 0 )
+        {
+            sprite->SetTexture( m_Strings[ desc.image ] );
+        }
+        if( desc.vertex_shader != 0 )
+        {
+            sprite->SetVertexShader( m_Strings[ desc.vertex_shader ] );
+        }
+        if( desc.fragment_shader != 0 )
+        {
+            sprite->SetFragmentShader( m_Strings[ desc.fragment_shader ] );
+        }
+        widget = sprite;
+    }
+    else if( desc.type == UDW_TEXT_AREA )
+    {
+        UiTextArea* text_area = new UiTextArea( name, path_name, parent );
+        if( desc.text_name != 0 )
+        {
+            unsigned int text_node = 0;
+            const UiDescription* text = TextManager::getSingleton().GetText( m_Strings[ desc.text_name ], text_node );
+            if( text != NULL )
+            {
+                text_area->SetText( text, text_node );
+            }
+        }
+        if( desc.font != 0 )
+        {
+            text_area->SetFont( m_Strings[ desc.font ] );
+        }
+        if( desc.text_align != -1 )
+        {
+            text_area->SetTextAlign( ( UiTextArea::TextAlign )desc.text_align );
+        }
+        if( ( desc.flags & UDF_PADDING ) != 0 )
+        {
+            text_area->SetPadding( desc.padding.x, desc.padding.y, desc.padding.z, desc.padding.w );
+        }
+        widget = text_area;
+    }
+    else if( desc.type == UDW_LIST )
+    {
+        UiList* list = new UiList( name, path_name, parent );
+        list->SetRowHeight( desc.row_height );
+        if( desc.row_prototype != 0 )
+        {
+            list->SetRowPrototype( m_Strings[ desc.row_prototype ] );
+        }
+        widget = list;
+    }
+    else
+    {
+        widget = new UiWidget( name, path_name, parent );
+    }
+
+    if( ( desc.flags & UDF_COLOURS ) != 0 )
+    {
+        widget->SetColours( desc.colour[ 0 ].x, desc.colour[ 0 ].y, desc.colour[ 0 ].z, desc.colour[ 1 ].x, desc.colour[ 1 ].y, desc.colour[ 1 ].z, desc.colour[ 2 ].x, desc.colour[ 2 ].y, desc.colour[ 2 ].z, desc.colour[ 3 ].x, desc.colour[ 3 ].y, desc.colour[ 3 ].z );
+    }
+    else
+    {
+        widget->SetColour( desc.colour[ 0 ].x, desc.colour[ 0 ].y, desc.colour[ 0 ].z );
+    }
+
+    widget->SetAlpha( desc.alpha );
+
+    if( desc.align != -1 )
+    {
+        widget->SetAlign( ( UiWidget::Align )desc.align );
+    }
+    if( desc.valign != -1 )
+    {
+        widget->SetVerticalAlign( ( UiWidget::VerticalAlign )desc.valign );
+    }
+
+    if( ( desc.flags & UDF_ORIGIN_X ) != 0 )
+    {
+        widget->SetOriginX( desc.origin_x.x, desc.origin_x.y );
+    }
+    if( ( desc.flags & UDF_ORIGIN_Y ) != 0 )
+    {
+        widget->SetOriginY( desc.origin_y.x, desc.origin_y.y );
+    }
+    if( ( desc.flags & UDF_X ) != 0 )
+    {
+        widget->SetX( desc.x.x, desc.x.y );
+    }
+    if( ( desc.flags & UDF_Y ) != 0 )
+    {
+        widget->SetY( desc.y.x, desc.y.y );
+    }
+    if( ( desc.flags & UDF_WIDTH ) != 0 )
+    {
+        widget->SetWidth( desc.width.x, desc.width.y );
+    }
+    if( ( desc.flags & UDF_HEIGHT ) != 0 )
+    {
+        widget->SetHeight( desc.height.x, desc.height.y );
+    }
+
+    widget->SetScale( desc.scale );
+    widget->SetRotation( desc.rotation );
+
+    if( ( desc.flags & UDF_SCISSOR ) != 0 )
+    {
+        widget->SetScissorArea( desc.scissor[ 0 ].x, desc.scissor[ 0 ].y, desc.scissor[ 1 ].x, desc.scissor[ 1 ].y, desc.scissor[ 2 ].x, desc.scissor[ 2 ].y, desc.scissor[ 3 ].x, desc.scissor[ 3 ].y );
+    }
+
+    widget->SetGlobalScissor( desc.global_scissor != 0 );
+    widget->SetVisible( desc.visible != 0 );
+
+    parent->AddChild( widget );
+
+    CreateContent( node, path_name, widget );
+}
@@ -0,0 +1,225 @@
+#ifndef UI_DESCRIPTION_H
+#define UI_DESCRIPTION_H
+
+#include <OgreColourValue.h>
+#include <OgreString.h>
+#include <OgreVector2.h>
+#include <OgreVector3.h>
+#include <OgreVector4.h>
+#include <boost/unordered_map.hpp>
+#include <vector>
+
+#include "MemoryTracker.h"
+#include "library/tinyxml/tinyxml.h"
+
+
+
+class UiWidget;
+
+
+
+// Compiled form of ui xml (screens, prototypes, texts). All attributes are
+// parsed once at compile time, trees are stored in flat arrays in document
+// order and every node knows index after its subtree, so children of node i
+// are i + 1, node[ i + 1 ].end, ... until node[ i ].end. Strings are kept in
+// one table, index 0 is empty string. Arrays are plain data and are written
+// to binary cache as is.
+
+
+
+enum UiDescWidgetType
+{
+    UDW_WIDGET,
+    UDW_SPRITE,
+    UDW_TEXT_AREA,
+    UDW_LIST,
+    UDW_PROTOTYPE // prototype definition or use of prototype, children are inserted in place
+};
+
+
+
+// set when attribute was in xml, otherwise widget default is kept
+enum UiDescWidgetFlag
+{
+    UDF_ORIGIN_X = 0x0001,
+    UDF_ORIGIN_Y = 0x0002,
+    UDF_X        = 0x0004,
+    UDF_Y        = 0x0008,
+    UDF_WIDTH    = 0x0010,
+    UDF_HEIGHT   = 0x0020,
+    UDF_SCISSOR  = 0x0040,
+    UDF_COLOURS  = 0x0080, // four corner colours instead of one
+    UDF_PADDING  = 0x0100
+};
+
+
+
+struct UiDescWidget
+{
+    int type;
+    unsigned int flags;
+    unsigned int name;
+    unsigned int image;
+    unsigned int vertex_shader;
+    unsigned int fragment_shader;
+    unsigned int text_name;
+    unsigned int font;
+    int text_align; // -1 if not set
+    int align;
+    int valign;
+    Ogre::Vector4 padding;
+    unsigned int row_prototype;
+    float row_height;
+    Ogre::Vector3 colour[ 4 ];
+    float alpha;
+    Ogre::Vector2 origin_x; // percent, value
+    Ogre::Vector2 origin_y;
+    Ogre::Vector2 x;
+    Ogre::Vector2 y;
+    Ogre::Vector2 width;
+    Ogre::Vector2 height;
+    Ogre::Vector2 scissor[ 4 ];
+    Ogre::Vector2 scale;
+    float rotation;
+    int global_scissor;
+    int visible;
+    unsigned int first_animation;
+    unsigned int animation_count;
+    unsigned int end;
+};
+
+
+
+enum UiDescAnimationTrack
+{
+    UDA_SCALE,
+    UDA_X,
+    UDA_Y,
+    UDA_WIDTH,
+    UDA_HEIGHT,
+    UDA_ROTATION,
+    UDA_ALPHA,
+    UDA_SCISSOR // four consecutive keys, one per scissor coordinate
+};
+
+
+
+struct UiDescKeyFrame
+{
+    int track;
+    int easing;
+    float time;
+    Ogre::Vector2 value; // float tracks use x
+};
+
+
+
+struct UiDescAnimation
+{
+    unsigned int name;
+    float length;
+    float bake;
+    unsigned int first_key;
+    unsigned int key_count;
+};
+
+
+
+enum UiDescTextType
+{
+    UDT_ELEMENT, // unknown element, only groups children
+    UDT_TEXT,
+    UDT_COLOUR,
+    UDT_PAUSE_OK,
+    UDT_PAUSE,
+    UDT_NEXT_PAGE,
+    UDT_TIMER,
+    UDT_VARIABLE,
+    UDT_INCLUDE,
+    UDT_IMAGE
+};
+
+
+
+struct UiDescText
+{
+    int type;
+    unsigned int string; // text, variable or included text name, sprite name
+    float time;
+    Ogre::ColourValue colour;
+    unsigned int end;
+};
+
+
+
+enum UiDescRootType
+{
+    UDR_SCREEN,
+    UDR_PROTOTYPE,
+    UDR_TEXT,
+    UDR_DIALOG
+};
+
+
+
+struct UiDescRoot
+{
+    int type;
+    unsigned int name;
+    unsigned int script;
+    unsigned int index; // widget for screens and prototypes, text node for texts and dialogs
+    float width;
+    float height;
+};
+
+
+
+class UiDescription
+{
+public:
+    UiDescription();
+    virtual ~UiDescription();
+
+    // compile from xml
+    void AddScreen( TiXmlNode* node );
+    void AddPrototype( TiXmlNode* node );
+    unsigned int AddText( TiXmlNode* node );
+    void AddDialog( TiXmlNode* node );
+    void Clear();
+
+    // binary cache near xml file as "<file>b", valid while source hash is same
+    bool LoadCache( const Ogre::String& file );
+    void SaveCache( const Ogre::String& file ) const;
+
+    // instantiate compiled screens and add them to ui manager
+    void CreateScreens() const;
+    // create animations and children of widget or prototype node in widget
+    void CreateContent( const unsigned int node, const Ogre::String& base_name, UiWidget* widget ) const;
+
+    unsigned int GetNumberOfRoots() const;
+    const UiDescRoot& GetRoot( const unsigned int index ) const;
+    const UiDescWidget& GetWidget( const unsigned int index ) const;
+    const UiDescText& GetText( const unsigned int index ) const;
+    const Ogre::String& GetString( const unsigned int index ) const;
+
+private:
+    unsigned int AddString( const Ogre::String& string );
+    void AddWidgetRecursive( TiXmlNode* node );
+    void AddAnimation( TiXmlNode* node );
+    void AddKeyFrames( TiXmlNode* node, const Ogre::String& attribute, const int track, const float length );
+    void AddTextRecursive( TiXmlNode* node );
+    void CreateWidget( const unsigned int node, const Ogre::String& base_name, UiWidget* parent ) const;
+
+private:
+    std::vector< Ogre::String > m_Strings;
+    boost::unordered_map< Ogre::String, unsigned int > m_StringIndex; // same strings share one entry while compiling
+    std::vector< UiDescRoot, TrackedAllocator< UiDescRoot, MEMORY_UI_DESCRIPTION > > m_Roots;
+    std::vector< UiDescWidget, TrackedAllocator< UiDescWidget, MEMORY_UI_DESCRIPTION > > m_Widgets;
+    std::vector< UiDescAnimation, TrackedAllocator< UiDescAnimation, MEMORY_UI_DESCRIPTION > > m_Animations;
+    std::vector< UiDescKeyFrame, TrackedAllocator< UiDescKeyFrame, MEMORY_UI_DESCRIPTION > > m_KeyFrames;
+    std::vector< UiDescText, TrackedAllocator< UiDescText, MEMORY_UI_DESCRIPTION > > m_Texts;
+};
+
+
+
+#endif // UI_DESCRIPTION_H
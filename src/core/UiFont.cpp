@@ -10,18 +10,24 @@ UiFont::UiFont( const Ogre::String& name, const Ogre::String& language ):
     m_ImageName( "" ),
     m_ImageWidth( 0 ),
     m_ImageHeight( 0 ),
-    m_Height( 0 )
+    m_Height( 0 ),
+    m_Sdf( false ),
+    m_Scale( 1 )
 {
+    m_CharTable.resize( UI_FONT_CHAR_TABLE_SIZE, -1 );
+
+    m_CharEmpty.char_code = -1;
+    m_CharEmpty.x = 0;
+    m_CharEmpty.y = 0;
+    m_CharEmpty.width = 0;
+    m_CharEmpty.height = 0;
+    m_CharEmpty.pre = 0;
+    m_CharEmpty.post = 0;
+
     // Insets special symbol of next row
-    UiCharData data;
+    UiCharData data = m_CharEmpty;
     data.char_code = 10;
-    data.x = 0;
-    data.y = 0;
-    data.width = 0;
-    data.height = 0;
-    data.pre = 0;
-    data.post = 0;
-    m_CharData.push_back( data );
+    AddCharData( data );
 }
 
 
@@ -93,7 +99,39 @@ UiFont::SetHeight( const int height )
 int
 UiFont::GetHeight() const
 {
-    return m_Height;
+    return ( int )( m_Height * m_Scale + 0.5f );
+}
+
+
+
+void
+UiFont::SetSdf( const bool sdf )
+{
+    m_Sdf = sdf;
+}
+
+
+
+bool
+UiFont::GetSdf() const
+{
+    return m_Sdf;
+}
+
+
+
+void
+UiFont::SetScale( const float scale )
+{
+    m_Scale = scale;
+}
+
+
+
+float
+UiFont::GetScale() const
+{
+    return m_Scale;
 }
 
 
@@ -101,22 +139,44 @@ UiFont::GetHeight() const
 void
 UiFont::AddCharData( const UiCharData& data )
 {
+    int index = m_CharData.size();
     m_CharData.push_back( data );
+
+    if( data.char_code >= 0 && data.char_code < UI_FONT_CHAR_TABLE_SIZE )
+    {
+        m_CharTable[ data.char_code ] = index;
+    }
+    else
+    {
+        m_CharHash[ data.char_code ] = index;
+    }
 }
 
 
 
-UiCharData
+const UiCharData&
 UiFont::GetCharData( const int char_code ) const
 {
-    for( unsigned int i = 0; i < m_CharData.size(); ++i )
+    int index = -1;
+
+    if( char_code >= 0 && char_code < UI_FONT_CHAR_TABLE_SIZE )
     {
-        if( m_CharData[ i ].char_code == char_code )
+        index = m_CharTable[ char_code ];
+    }
+    else
+    {
+        boost::unordered_map< int, int >::const_iterator it = m_CharHash.find( char_code );
+        if( it != m_CharHash.end() )
         {
-            return m_CharData[ i ];
+            index = it->second;
         }
     }
 
-    LOG_ERROR( "There is no char with char code " + Ogre::StringConverter::toString( char_code ) + " in font " + m_Name + "." );
-    return UiCharData();
+    if( index == -1 )
+    {
+        LOG_ERROR( "There is no char with char code " + Ogre::StringConverter::toString( char_code ) + " in font " + m_Name + "." );
+        return m_CharEmpty;
+    }
+
+    return m_CharData[ index ];
 }
@@ -2,6 +2,8 @@
 #define UI_FONT_H
 
 #include <OgreString.h>
+#include <boost/unordered_map.hpp>
+#include <vector>
 
 
 
@@ -18,6 +20,11 @@ struct UiCharData
 
 
 
+// chars with code below this are found by direct index, others through hash map
+const int UI_FONT_CHAR_TABLE_SIZE = 0x0500;
+
+
+
 class UiFont
 {
 public:
@@ -35,8 +42,15 @@ public:
     void SetHeight( const int height );
     int GetHeight() const;
 
+    // distance field atlas, one atlas drawn with different scale for all sizes
+    void SetSdf( const bool sdf );
+    bool GetSdf() const;
+    // multiplier from sizes in font file (atlas pixels) to ui units, applied to height too
+    void SetScale( const float scale );
+    float GetScale() const;
+
     void AddCharData( const UiCharData& data );
-    UiCharData GetCharData( const int char_code ) const;
+    const UiCharData& GetCharData( const int char_code ) const;
 
 private:
     Ogre::String              m_Name;
@@ -46,7 +60,12 @@ private:
     int                       m_ImageWidth;
     int                       m_ImageHeight;
     int                       m_Height;
+    bool                      m_Sdf;
+    float                     m_Scale;
     std::vector< UiCharData > m_CharData;
+    std::vector< int >        m_CharTable; // index in m_CharData or -1
+    boost::unordered_map< int, int > m_CharHash;
+    UiCharData                m_CharEmpty;
 };
 
 
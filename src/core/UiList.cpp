@@ -0,0 +1,230 @@
+#include "UiList.h"
+
+#include <OgreStringConverter.h>
+#include <algorithm>
+
+#include "Logger.h"
+#include "UiDescription.h"
+#include "UiManager.h"
+
+
+
+UiList::UiList( const Ogre::String& name ):
+    UiWidget( name )
+{
+    Initialise();
+}
+
+
+
+UiList::UiList( const Ogre::String& name, const Ogre::String& path_name, UiWidget* parent ):
+    UiWidget( name, path_name, parent )
+{
+    Initialise();
+}
+
+
+
+UiList::~UiList()
+{
+}
+
+
+
+void
+UiList::Initialise()
+{
+    m_RowPrototype = "";
+    m_RowHeight = 0;
+    m_NumberOfItems = 0;
+    m_Scroll = 0;
+    m_UpdateRows = true;
+
+    // partly visible rows are cut by list rect
+    SetScissorArea( 0, 0, 0, 0, 100, 0, 100, 0 );
+}
+
+
+
+void
+UiList::Update()
+{
+    if( m_Visible == true && m_UpdateRows == true && m_UpdateTransformation == false )
+    {
+        UpdateRows();
+    }
+
+    UiWidget::Update();
+}
+
+
+
+void
+UiList::UpdateTransformation()
+{
+    UiWidget::UpdateTransformation();
+
+    // size of list may be changed so number of visible rows too
+    m_UpdateRows = true;
+}
+
+
+
+void
+UiList::SetRowPrototype( const Ogre::String& prototype )
+{
+    m_RowPrototype = prototype;
+
+    // rows of old prototype are removed, other children of list stay
+    for( unsigned int i = 0; i < m_Rows.size(); ++i )
+    {
+        m_Children.erase( std::find( m_Children.begin(), m_Children.end(), m_Rows[ i ].widget ) );
+        delete m_Rows[ i ].widget;
+    }
+    m_Rows.clear();
+    m_UpdateRows = true;
+}
+
+
+
+void
+UiList::SetRowHeight( const float height )
+{
+    m_RowHeight = height;
+
+    for( unsigned int i = 0; i < m_Rows.size(); ++i )
+    {
+        m_Rows[ i ].widget->SetHeight( 0, m_RowHeight );
+    }
+    m_UpdateRows = true;
+}
+
+
+
+void
+UiList::SetNumberOfItems( const unsigned int items )
+{
+    m_NumberOfItems = items;
+
+    for( unsigned int i = 0; i < m_Rows.size(); ++i )
+    {
+        m_Rows[ i ].item = -1;
+    }
+    m_UpdateRows = true;
+}
+
+
+
+unsigned int
+UiList::GetNumberOfItems() const
+{
+    return m_NumberOfItems;
+}
+
+
+
+void
+UiList::SetScroll( const float scroll )
+{
+    m_Scroll = scroll;
+    m_UpdateRows = true;
+}
+
+
+
+float
+UiList::GetScroll() const
+{
+    return m_Scroll;
+}
+
+
+
+void
+UiList::UpdateRows()
+{
+    m_UpdateRows = false;
+
+    if( m_RowHeight <= 0 || m_RowPrototype == "" )
+    {
+        return;
+    }
+
+    // visible height in same units as row height
+    float unit = m_ScreenHeight * m_FinalScale.y / 720.0f;
+    float visible = ( unit > 0 ) ? m_FinalSize.y / unit : 0;
+    float max_scroll = std::max( 0.0f, m_NumberOfItems * m_RowHeight - visible );
+    m_Scroll = std::max( 0.0f, std::min( m_Scroll, max_scroll ) );
+
+    int first = ( int )( m_Scroll / m_RowHeight );
+    int last = std::min( ( int )m_NumberOfItems, ( int )Ogre::Math::Ceil( ( m_Scroll + visible ) / m_RowHeight ) );
+    unsigned int needed = ( last > first ) ? last - first : 0;
+
+    if( m_Rows.size() < needed )
+    {
+        while( m_Rows.size() < needed )
+        {
+            CreateRow();
+        }
+
+        // items are mapped to other rows now
+        for( unsigned int i = 0; i < m_Rows.size(); ++i )
+        {
+            m_Rows[ i ].item = -1;
+        }
+    }
+
+    for( unsigned int i = 0; i < m_Rows.size(); ++i )
+    {
+        if( m_Rows[ i ].item < first || m_Rows[ i ].item >= last )
+        {
+            m_Rows[ i ].item = -1;
+            m_Rows[ i ].widget->SetVisible( false );
+        }
+    }
+
+    ScriptEntity* script_entity = ScriptManager::getSingleton().GetScriptEntityByName( ScriptManager::UI, m_PathName );
+
+    for( int item = first; item < last; ++item )
+    {
+        Row& row = m_Rows[ item % m_Rows.size() ];
+        row.widget->SetY( 0, item * m_RowHeight - m_Scroll );
+        row.widget->SetVisible( true );
+
+        if( row.item != item )
+        {
+            row.item = item;
+            if( script_entity != NULL )
+            {
+                ScriptManager::getSingleton().ScriptRequest( script_entity, "on_row", 0, row.path_name, Ogre::StringConverter::toString( item ), ScriptId(), ScriptId() );
+            }
+        }
+    }
+}
+
+
+
+void
+UiList::CreateRow()
+{
+    Row row;
+    Ogre::String name = "Row" + Ogre::StringConverter::toString( m_Rows.size() );
+    row.path_name = m_PathName + "." + name;
+    row.item = -1;
+    row.widget = new UiWidget( name, row.path_name, this );
+    row.widget->SetHeight( 0, m_RowHeight );
+
+    unsigned int node = 0;
+    const UiDescription* prototype = UiManager::getSingleton().GetPrototype( m_RowPrototype, node );
+    if( prototype != NULL )
+    {
+        prototype->CreateContent( node, row.path_name, row.widget );
+    }
+    else
+    {
+        LOG_ERROR( "Can't find row prototype \"" + m_RowPrototype + "\" for list \"" + m_PathName + "\"." );
+    }
+
+    AddChild( row.widget );
+    m_Rows.push_back( row );
+}
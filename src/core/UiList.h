@@ -0,0 +1,57 @@
+#ifndef UI_LIST_H
+#define UI_LIST_H
+
+#include "UiWidget.h"
+
+
+
+// Vertical list of items where only visible items have widgets. Rows are
+// created from prototype and reused when list is scrolled, so list of any
+// length costs only visible rows. When row gets new item list script
+// function "on_row( self, row, item )" is requested with path of row widget
+// and item index, script fills row content.
+class UiList : public UiWidget
+{
+public:
+    UiList( const Ogre::String& name );
+    UiList( const Ogre::String& name, const Ogre::String& path_name, UiWidget* parent );
+    virtual ~UiList();
+
+    void Initialise();
+    virtual void Update();
+    virtual void UpdateTransformation();
+
+    void SetRowPrototype( const Ogre::String& prototype );
+    void SetRowHeight( const float height );
+    // resets all rows so they are filled again
+    void SetNumberOfItems( const unsigned int items );
+    unsigned int GetNumberOfItems() const;
+    // offset of list content from top in same units as row height
+    void SetScroll( const float scroll );
+    float GetScroll() const;
+
+private:
+    UiList();
+    void UpdateRows();
+    void CreateRow();
+
+private:
+    Ogre::String m_RowPrototype;
+    float        m_RowHeight;
+    unsigned int m_NumberOfItems;
+    float        m_Scroll;
+    bool         m_UpdateRows;
+
+    struct Row
+    {
+        UiWidget* widget;
+        Ogre::String path_name;
+        int item; // -1 if row is not used
+    };
+    // item is shown by row item % number of rows, so visible items never share row
+    std::vector< Row > m_Rows;
+};
+
+
+
+#endif // UI_LIST_H
@@ -1,12 +1,21 @@
 #include "UiManager.h"
+#include "UiManagerCommands.h"
+#include "UiManagerBenchmarks.h"
 
+#include <OgreResourceGroupManager.h>
 #include <OgreRoot.h>
 #include <OgreStringVector.h>
+#include <algorithm>
 
+#include "Counters.h"
+#include "FrameBudget.h"
 #include "Logger.h"
+#include "Profiler.h"
 #include "ScriptManager.h"
 #include "TextManager.h"
+#include "Timer.h"
 #include "Utilites.h"
+#include "XmlAtlasFile.h"
 #include "XmlFontsFile.h"
 #include "XmlPrototypesFile.h"
 #include "XmlScreensFile.h"
@@ -17,9 +26,22 @@ template<>UiManager* Ogre::Singleton< UiManager >::msSingleton = NULL;
 
 
 
+bool
+dirty_widget_compare( UiWidget* a, UiWidget* b )
+{
+    return a->GetDepth() < b->GetDepth();
+}
+
+
+
 UiManager::UiManager()
 {
+    m_Batch = new UiBatch();
+
     Ogre::Root::getSingleton().getSceneManager( "Scene" )->addRenderQueueListener( this );
+
+    InitCmd();
+    InitBenchmarks();
 }
 
 
@@ -37,6 +59,13 @@ UiManager::~UiManager()
     {
         delete m_Widgets[ i ];
     }
+
+    for( unsigned int i = 0; i < m_PrototypeFiles.size(); ++i )
+    {
+        delete m_PrototypeFiles[ i ];
+    }
+
+    delete m_Batch;
 }
 
 
@@ -44,6 +73,13 @@ UiManager::~UiManager()
 void
 UiManager::Initialise()
 {
+    // atlas is optional, built by ui_build_atlas
+    if( Ogre::ResourceGroupManager::getSingleton().resourceExists( "Game", "ui_atlas.xml" ) == true )
+    {
+        XmlAtlasFile atlas( "./data/ui_atlas.xml" );
+        atlas.LoadAtlas();
+    }
+
     //XmlFontsFile fonts( "./data/fonts.xml" );
     //fonts.LoadFonts();
 
@@ -56,15 +92,20 @@ UiManager::Initialise()
 void
 UiManager::Update()
 {
+    PROFILE_ZONE( "UiManager::Update" );
+
     // update all ui scripts
     ScriptManager::getSingleton().Update( ScriptManager::UI );
 
-
+    UpdateAnimations();
 
     for( unsigned int i = 0; i < m_Widgets.size(); ++i )
     {
         m_Widgets[ i ]->Update();
     }
+
+    // recalculate only what was changed by scripts, animations and text during update
+    UpdateDirtyWidgets();
 }
 
 
@@ -111,24 +152,52 @@ UiManager::GetFont( const Ogre::String& name )
 
 
 void
-UiManager::AddPrototype( const Ogre::String& name, TiXmlNode* prototype )
+UiManager::AddAtlasTexture( const Ogre::String& texture, const UiAtlasTexture& atlas )
+{
+    m_AtlasTextures[ texture ] = atlas;
+}
+
+
+
+const UiAtlasTexture*
+UiManager::GetAtlasTexture( const Ogre::String& texture ) const
 {
-    UiPrototype ui_prototype;
-    ui_prototype.name = name;
-    ui_prototype.node = prototype;
-    m_Prototypes.push_back( ui_prototype );
+    std::map< Ogre::String, UiAtlasTexture >::const_iterator it = m_AtlasTextures.find( texture );
+    return ( it != m_AtlasTextures.end() ) ? &it->second : NULL;
+}
+
+
+
+void
+UiManager::AddPrototypes( UiDescription* prototypes )
+{
+    m_PrototypeFiles.push_back( prototypes );
+
+    for( unsigned int i = 0; i < prototypes->GetNumberOfRoots(); ++i )
+    {
+        const UiDescRoot& root = prototypes->GetRoot( i );
+        if( root.type == UDR_PROTOTYPE )
+        {
+            UiPrototype ui_prototype;
+            ui_prototype.name = prototypes->GetString( root.name );
+            ui_prototype.description = prototypes;
+            ui_prototype.node = root.index;
+            m_Prototypes.push_back( ui_prototype );
+        }
+    }
 }
 
 
 
-TiXmlNode*
-UiManager::GetPrototype( const Ogre::String& name ) const
+const UiDescription*
+UiManager::GetPrototype( const Ogre::String& name, unsigned int& node ) const
 {
     for( unsigned int i = 0; i < m_Prototypes.size(); ++i )
     {
         if( m_Prototypes[ i ].name == name )
         {
-            return m_Prototypes[ i ].node;
+            node = m_Prototypes[ i ].node;
+            return m_Prototypes[ i ].description;
         }
     }
 
@@ -141,6 +210,7 @@ void
 UiManager::AddWidget( UiWidget* widget )
 {
     m_Widgets.push_back( widget );
+    widget->AddToIndex( widget->GetName() );
 }
 
 
@@ -148,35 +218,171 @@ UiManager::AddWidget( UiWidget* widget )
 UiWidget*
 UiManager::GetWidget( const Ogre::String& name )
 {
-    // get real table by name
-    Ogre::StringVector table_path = StringTokenise( name, "." );
-    UiWidget* widget = NULL;
+    boost::unordered_map< Ogre::String, std::vector< UiWidget* > >::const_iterator it = m_WidgetIndex.find( name );
+    return ( it != m_WidgetIndex.end() ) ? it->second.front() : NULL;
+}
+
 
-    if( table_path.size() > 0 )
+
+luabind::object
+UiManager::ScriptGetWidget( const char* name, lua_State* state )
+{
+    m_WidgetLookup.assign( name );
+    boost::unordered_map< Ogre::String, std::vector< UiWidget* > >::const_iterator it = m_WidgetIndex.find( m_WidgetLookup );
+    if( it == m_WidgetIndex.end() )
     {
-        for( unsigned int i = 0; i < m_Widgets.size(); ++i )
+        return luabind::object();
+    }
+
+    return it->second.front()->GetScriptHandle( state );
+}
+
+
+
+void
+UiManager::ClearScriptHandles( lua_State* state )
+{
+    for( unsigned int i = 0; i < m_Widgets.size(); ++i )
+    {
+        m_Widgets[ i ]->ClearScriptHandles( state );
+    }
+}
+
+
+
+void
+UiManager::AddWidgetIndex( const Ogre::String& path, UiWidget* widget )
+{
+    // for same names first widget is found, as with search through children,
+    // others are kept to be found after it is removed
+    m_WidgetIndex[ path ].push_back( widget );
+}
+
+
+
+void
+UiManager::RemoveWidgetIndex( const Ogre::String& path, UiWidget* widget )
+{
+    boost::unordered_map< Ogre::String, std::vector< UiWidget* > >::iterator it = m_WidgetIndex.find( path );
+    if( it != m_WidgetIndex.end() )
+    {
+        std::vector< UiWidget* >& widgets = it->second;
+        widgets.erase( std::remove( widgets.begin(), widgets.end(), widget ), widgets.end() );
+        if( widgets.size() == 0 )
         {
-            if( m_Widgets[ i ]->GetName() == table_path[ 0 ] )
-            {
-                widget = m_Widgets[ i ];
+            m_WidgetIndex.erase( it );
+        }
+    }
+}
+
+
+
+UiBatch&
+UiManager::GetBatch()
+{
+    return *m_Batch;
+}
+
+
+
+void
+UiManager::AddAnimatedWidget( UiWidget* widget )
+{
+    m_AnimatedWidgets.push_back( widget );
+}
+
 
-                for( unsigned int j = 1; ( j < table_path.size() ) && ( widget != NULL ); ++j )
-                {
-                    widget = widget->GetChild( table_path[ j ] );
-                }
+
+void
+UiManager::RemoveAnimatedWidget( UiWidget* widget )
+{
+    // list can be processed right now, so don't change its size
+    for( unsigned int i = 0; i < m_AnimatedWidgets.size(); ++i )
+    {
+        if( m_AnimatedWidgets[ i ] == widget )
+        {
+            m_AnimatedWidgets[ i ] = NULL;
+        }
+    }
+}
+
+
+
+void
+UiManager::UpdateAnimations()
+{
+    float delta_time = Timer::getSingleton().GetGameTimeDelta();
+
+    // animations of hidden widgets are paused. Widgets that start animation
+    // during this loop are added to end and updated in same pass
+    for( unsigned int i = 0; i < m_AnimatedWidgets.size(); ++i )
+    {
+        UiWidget* widget = m_AnimatedWidgets[ i ];
+        if( widget != NULL && widget->IsVisibleWithParents() == true )
+        {
+            if( widget->UpdateAnimation( delta_time ) == false )
+            {
+                m_AnimatedWidgets[ i ] = NULL;
             }
         }
     }
 
-    return widget;
+    m_AnimatedWidgets.erase( std::remove( m_AnimatedWidgets.begin(), m_AnimatedWidgets.end(), ( UiWidget* )NULL ), m_AnimatedWidgets.end() );
 }
 
 
 
-UiWidget*
-UiManager::ScriptGetWidget( const char* name )
+void
+UiManager::AddDirtyWidget( UiWidget* widget )
+{
+    m_DirtyWidgets.push_back( widget );
+}
+
+
+
+void
+UiManager::RemoveDirtyWidget( UiWidget* widget )
+{
+    // list can be processed right now, so don't change its size
+    for( unsigned int i = 0; i < m_DirtyWidgets.size(); ++i )
+    {
+        if( m_DirtyWidgets[ i ] == widget )
+        {
+            m_DirtyWidgets[ i ] = NULL;
+        }
+    }
+}
+
+
+
+void
+UiManager::UpdateDirtyWidgets()
 {
-    return GetWidget( Ogre::String( name ) );
+    // parents first, so children recalculated by parent are already clean when we reach them
+    m_DirtyWidgets.erase( std::remove( m_DirtyWidgets.begin(), m_DirtyWidgets.end(), ( UiWidget* )NULL ), m_DirtyWidgets.end() );
+    std::stable_sort( m_DirtyWidgets.begin(), m_DirtyWidgets.end(), dirty_widget_compare );
+
+    // widgets can be marked dirty during update (text area moves its sprites), they added to end
+    // widgets left after deadline stay dirty and in list, so they aren't added second time
+    unsigned long long deadline = FrameBudget::getSingleton().GetDeadline( FrameBudget::UI );
+    unsigned int done = 0;
+    for( ; done < m_DirtyWidgets.size(); ++done )
+    {
+        if( done > 0 && Profiler::GetTime() > deadline )
+        {
+            break;
+        }
+        if( m_DirtyWidgets[ done ] != NULL )
+        {
+            m_DirtyWidgets[ done ]->UpdateDirty();
+        }
+    }
+    m_DirtyWidgets.erase( m_DirtyWidgets.begin(), m_DirtyWidgets.begin() + done );
+
+    if( m_DirtyWidgets.size() > 0 )
+    {
+        COUNTER_ADD( "ui_deferred", m_DirtyWidgets.size() );
+    }
 }
 
 
@@ -186,11 +392,16 @@ UiManager::renderQueueStarted( Ogre::uint8 queueGroupId, const Ogre::String& inv
 {
     if( queueGroupId == Ogre::RENDER_QUEUE_OVERLAY )
     {
+        PROFILE_ZONE( "UiManager render" );
+
         Ogre::Root::getSingletonPtr()->getRenderSystem()->clearFrameBuffer( Ogre::FBT_DEPTH );
 
+        // widgets add their geometry to batch, then all ui drawn at once
+        m_Batch->Clear();
         for( unsigned int i = 0; i < m_Widgets.size(); ++i )
         {
             m_Widgets[ i ]->Render();
         }
+        m_Batch->Render();
     }
 }
@@ -4,10 +4,14 @@
 #include <OgreRenderQueueListener.h>
 #include <OgreSingleton.h>
 #include <OgreUTFString.h>
+#include <boost/unordered_map.hpp>
+#include <map>
 
+#include "UiAtlas.h"
+#include "UiBatch.h"
+#include "UiDescription.h"
 #include "UiFont.h"
 #include "UiWidget.h"
-#include "library/tinyxml/tinyxml.h"
 
 
 
@@ -18,30 +22,65 @@ public:
     virtual ~UiManager();
 
     void Initialise();
+    void InitCmd();
     void Update();
     void OnResize();
 
     void AddFont( UiFont* font );
     UiFont* GetFont( const Ogre::String& name );
 
-    void AddPrototype( const Ogre::String& name, TiXmlNode* prototype );
-    TiXmlNode* GetPrototype( const Ogre::String& name ) const;
+    void AddAtlasTexture( const Ogre::String& texture, const UiAtlasTexture& atlas );
+    const UiAtlasTexture* GetAtlasTexture( const Ogre::String& texture ) const;
+
+    // takes ownership of compiled prototypes file
+    void AddPrototypes( UiDescription* prototypes );
+    const UiDescription* GetPrototype( const Ogre::String& name, unsigned int& node ) const;
 
     void AddWidget( UiWidget* widget );
     UiWidget* GetWidget( const Ogre::String& name );
-    UiWidget* ScriptGetWidget( const char* name );
+    luabind::object ScriptGetWidget( const char* name, lua_State* state );
+    void ClearScriptHandles( lua_State* state );
+    void AddWidgetIndex( const Ogre::String& path, UiWidget* widget );
+    void RemoveWidgetIndex( const Ogre::String& path, UiWidget* widget );
+
+    UiBatch& GetBatch();
+
+    void AddAnimatedWidget( UiWidget* widget );
+    void RemoveAnimatedWidget( UiWidget* widget );
+    void UpdateAnimations();
+
+    void AddDirtyWidget( UiWidget* widget );
+    void RemoveDirtyWidget( UiWidget* widget );
+    void UpdateDirtyWidgets();
 
     void renderQueueStarted( Ogre::uint8 queueGroupId, const Ogre::String& invocation, bool& skipThisInvocation );
 
+private:
+    void InitBenchmarks();
+    static void BenchmarkSetupText( const int size );
+    static void BenchmarkTeardownText( const int size );
+    static void BenchmarkText( const int size );
+
 private:
     std::vector< UiFont* > m_Fonts;
+    std::map< Ogre::String, UiAtlasTexture > m_AtlasTextures; // images packed in atlas pages
     struct UiPrototype
     {
         Ogre::String name;
-        TiXmlNode* node;
+        const UiDescription* description;
+        unsigned int node;
     };
     std::vector< UiPrototype > m_Prototypes;
+    std::vector< UiDescription* > m_PrototypeFiles;
     std::vector< UiWidget* > m_Widgets;
+    // all widgets attached to root widgets by dotted path of names
+    // widgets with same path in order they were indexed, first one is found
+    boost::unordered_map< Ogre::String, std::vector< UiWidget* > > m_WidgetIndex;
+    Ogre::String m_WidgetLookup; // reused for lookups from scripts so they don't allocate
+    std::vector< UiWidget* > m_DirtyWidgets;
+    std::vector< UiWidget* > m_AnimatedWidgets; // widgets with playing or default animation
+
+    UiBatch* m_Batch;
 };
 
 
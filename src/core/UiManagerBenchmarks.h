@@ -0,0 +1,85 @@
+#include "Benchmark.h"
+#include "Logger.h"
+#include "UiTextArea.h"
+
+
+
+// text area which is not attached to any screen, it covers whole window
+UiTextArea* benchmark_text_area = NULL;
+
+
+
+Ogre::String
+benchmark_text( const int size )
+{
+    // text area can't hold more letters than its buffer size
+    const Ogre::String line = "The quick brown fox jumps over the lazy dog. ";
+    Ogre::String text;
+    while( text.size() + line.size() < ( size_t )size )
+    {
+        text += line;
+    }
+    return text;
+}
+
+
+
+void
+UiManager::InitBenchmarks()
+{
+    Benchmark::getSingleton().AddScenario( "ui_text_area_long", BenchmarkSetupText, BenchmarkText, BenchmarkTeardownText, 1000 );
+}
+
+
+
+void
+UiManager::BenchmarkSetupText( const int size )
+{
+    UiManager& manager = UiManager::getSingleton();
+    if( manager.m_Fonts.size() == 0 )
+    {
+        LOG_WARNING( "No fonts loaded, ui text benchmark measures nothing." );
+        return;
+    }
+
+    benchmark_text_area = new UiTextArea( "benchmark_text" );
+    benchmark_text_area->SetFont( manager.m_Fonts[ 0 ]->GetName() );
+    benchmark_text_area->SetWidth( 100, 0 );
+    benchmark_text_area->SetHeight( 100, 0 );
+    benchmark_text_area->UpdateTransformation();
+
+    // text is shown at once, so whole text is laid out on each run
+    Ogre::String text = benchmark_text( size );
+    benchmark_text_area->SetText( text );
+    benchmark_text_area->SetTextLimit( ( float )text.size() );
+    benchmark_text_area->UpdateGeometry();
+    if( benchmark_text_area->GetNumberOfGlyphs() == 0 )
+    {
+        LOG_WARNING( "Benchmark text area lays out no glyphs, ui text benchmark measures only text parsing." );
+    }
+}
+
+
+
+void
+UiManager::BenchmarkTeardownText( const int size )
+{
+    delete benchmark_text_area;
+    benchmark_text_area = NULL;
+}
+
+
+
+void
+UiManager::BenchmarkText( const int size )
+{
+    if( benchmark_text_area == NULL )
+    {
+        return;
+    }
+
+    Ogre::String text = benchmark_text( size );
+    benchmark_text_area->SetText( text );
+    benchmark_text_area->SetTextLimit( ( float )text.size() );
+    benchmark_text_area->UpdateGeometry();
+}
@@ -0,0 +1,64 @@
+#include "ConfigCmdManager.h"
+#include "Console.h"
+#include "SdfFont.h"
+#include "UiAtlas.h"
+
+
+
+void
+CmdUiBuildSdfFont( const Ogre::StringVector& params )
+{
+    if( params.size() < 4 )
+    {
+        Console::getSingleton().AddTextToOutput( "Usage: /ui_build_sdf_font <ttf file> <size> <output> [spread] [first-last ...]" );
+        return;
+    }
+
+    int size = Ogre::StringConverter::parseInt( params[ 2 ] );
+    int spread = ( params.size() > 4 ) ? Ogre::StringConverter::parseInt( params[ 4 ] ) : 4;
+
+    std::vector< Ogre::Font::CodePointRange > ranges;
+    for( unsigned int i = 5; i < params.size(); ++i )
+    {
+        Ogre::StringVector range = Ogre::StringUtil::split( params[ i ], "-" );
+        if( range.size() != 2 )
+        {
+            Console::getSingleton().AddTextToOutput( "Wrong code point range \"" + params[ i ] + "\"." );
+            return;
+        }
+        ranges.push_back( Ogre::Font::CodePointRange( Ogre::StringConverter::parseUnsignedInt( range[ 0 ] ), Ogre::StringConverter::parseUnsignedInt( range[ 1 ] ) ) );
+    }
+    if( ranges.size() == 0 )
+    {
+        ranges.push_back( Ogre::Font::CodePointRange( 32, 126 ) );
+    }
+
+    BuildSdfFont( params[ 1 ], size, spread, ranges, params[ 3 ] );
+}
+
+
+
+void
+CmdUiBuildAtlas( const Ogre::StringVector& params )
+{
+    if( params.size() < 2 )
+    {
+        Console::getSingleton().AddTextToOutput( "Usage: /ui_build_atlas <directory> [page size]" );
+        return;
+    }
+
+    int page_size = ( params.size() > 2 ) ? Ogre::StringConverter::parseInt( params[ 2 ] ) : 1024;
+    if( BuildUiAtlas( params[ 1 ], page_size, "ui_atlas" ) == true )
+    {
+        Console::getSingleton().AddTextToOutput( "Atlas built, restart game to use it." );
+    }
+}
+
+
+
+void
+UiManager::InitCmd()
+{
+    ConfigCmdManager::getSingleton().AddCommand( "ui_build_sdf_font", "Build distance field font atlas and font files from truetype font", "", CmdUiBuildSdfFont, NULL );
+    ConfigCmdManager::getSingleton().AddCommand( "ui_build_atlas", "Pack ui images from directory into atlas pages", "", CmdUiBuildAtlas, NULL );
+}
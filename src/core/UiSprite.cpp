@@ -1,22 +1,14 @@
 #include "UiSprite.h"
 
-#include <OgreHardwareBufferManager.h>
 #include <OgreMaterialManager.h>
 
 #include "Logger.h"
+#include "UiManager.h"
 
 
 
 UiSprite::UiSprite( const Ogre::String& name ):
-    UiWidget( name ),
-    m_U1( 0.0f ),
-    m_V1( 0.0f ),
-    m_U2( 1.0f ),
-    m_V2( 0.0f ),
-    m_U3( 1.0f ),
-    m_V3( 1.0f ),
-    m_U4( 0.0f ),
-    m_V4( 1.0f )
+    UiWidget( name )
 {
     Initialise();
 }
@@ -33,7 +25,10 @@ UiSprite::UiSprite( const Ogre::String& name, const Ogre::String& path_name, UiW
 
 UiSprite::~UiSprite()
 {
-    DestroyVertexBuffer();
+    if( m_MaterialUnique == true )
+    {
+        Ogre::MaterialManager::getSingleton().remove( m_Material->getName() );
+    }
 }
 
 
@@ -41,26 +36,19 @@ UiSprite::~UiSprite()
 void
 UiSprite::Initialise()
 {
-    m_SceneManager = Ogre::Root::getSingleton().getSceneManager( "Scene" );
-    m_RenderSystem = Ogre::Root::getSingletonPtr()->getRenderSystem();
-
-    m_Material = Ogre::MaterialManager::getSingleton().create( "UiMaterials." + m_PathName, "General" );
-    Ogre::Pass* pass = m_Material->getTechnique( 0 )->getPass( 0 );
-    pass->setVertexColourTracking( Ogre::TVC_AMBIENT );
-    pass->setCullingMode( Ogre::CULL_NONE );
-    pass->setDepthCheckEnabled( true );
-    pass->setDepthWriteEnabled( true );
-    pass->setLightingEnabled( false );
-    pass->setSceneBlending( Ogre::SBT_TRANSPARENT_ALPHA );
-
-    pass->setAlphaRejectFunction( Ogre::CMPF_GREATER );
-    pass->setAlphaRejectValue( 0 );
-    Ogre::TextureUnitState* tex = pass->createTextureUnitState();
-    tex->setTextureName( "system/blank.png" );
-    tex->setNumMipmaps( -1 );
-    tex->setTextureFiltering( Ogre::TFO_NONE );
-
-    CreateVertexBuffer();
+    m_U1 = 0.0f;
+    m_V1 = 0.0f;
+    m_U2 = 1.0f;
+    m_V2 = 0.0f;
+    m_U3 = 1.0f;
+    m_V3 = 1.0f;
+    m_U4 = 0.0f;
+    m_V4 = 1.0f;
+
+    m_VertexCount = 0;
+
+    m_MaterialUnique = false;
+    SetTexture( "system/blank.png" );
 }
 
 
@@ -76,20 +64,9 @@ UiSprite::Update()
 void
 UiSprite::Render()
 {
-    if( m_UpdateTransformation == false && m_Visible == true )
+    if( m_UpdateTransformation == false && m_Visible == true && m_Culled == false )
     {
-        if( m_RenderOp.vertexData->vertexCount != 0 )
-        {
-            m_RenderSystem->_setWorldMatrix( Ogre::Matrix4::IDENTITY );
-            m_RenderSystem->_setProjectionMatrix( Ogre::Matrix4::IDENTITY );
-            m_RenderSystem->_setViewMatrix( Ogre::Matrix4::IDENTITY );
-
-            m_SceneManager->_setPass( m_Material->getTechnique( 0 )->getPass( 0 ), true, false );
-
-            m_RenderSystem->setScissorTest( true, m_ScissorLeft, m_ScissorTop, m_ScissorRight, m_ScissorBottom );
-            m_RenderSystem->_render( m_RenderOp );
-            m_RenderSystem->setScissorTest( false );
-        }
+        UiManager::getSingleton().GetBatch().AddVertices( m_Material, m_ScissorLeft, m_ScissorTop, m_ScissorRight, m_ScissorBottom, m_FinalZ, m_Vertices, m_VertexCount );
     }
 
     UiWidget::Render();
@@ -98,20 +75,34 @@ UiSprite::Render()
 
 
 void
-UiSprite::UpdateTransformation()
+UiSprite::SetTexture( const Ogre::String& texture )
 {
-    UiWidget::UpdateTransformation();
-    UpdateGeometry();
-}
+    m_Texture = texture;
 
+    // packed textures are drawn from atlas page, so all sprites from one page share material
+    const UiAtlasTexture* atlas = UiManager::getSingleton().GetAtlasTexture( texture );
+    if( atlas != NULL )
+    {
+        m_Atlas = *atlas;
+    }
+    else
+    {
+        m_Atlas = UiAtlasTexture();
+        m_Atlas.page = texture;
+    }
 
+    if( m_MaterialUnique == true )
+    {
+        Ogre::Pass* pass = m_Material->getTechnique( 0 )->getPass( 0 );
+        Ogre::TextureUnitState* tex = pass->getTextureUnitState( 0 );
+        tex->setTextureName( m_Atlas.page );
+    }
+    else
+    {
+        m_Material = UiManager::getSingleton().GetBatch().GetMaterial( m_Atlas.page, true );
+    }
 
-void
-UiSprite::SetTexture( const Ogre::String& texture )
-{
-    Ogre::Pass* pass = m_Material->getTechnique( 0 )->getPass( 0 );
-    Ogre::TextureUnitState* tex = pass->getTextureUnitState( 0 );
-    tex->setTextureName( texture );
+    SetUpdateGeometry();
 }
 
 
@@ -127,6 +118,7 @@ UiSprite::SetUV( const float u1, const float v1, const float u2, const float v2,
     m_V3 = v3;
     m_U4 = u4;
     m_V4 = v4;
+    SetUpdateGeometry();
 }
 
 
@@ -134,6 +126,7 @@ UiSprite::SetUV( const float u1, const float v1, const float u2, const float v2,
 void
 UiSprite::SetVertexShader( const Ogre::String& shader )
 {
+    CreateUniqueMaterial();
     Ogre::Pass* pass = m_Material->getTechnique( 0 )->getPass( 0 );
     pass->setVertexProgram( shader, true );
     pass->getVertexProgram()->load();
@@ -144,6 +137,7 @@ UiSprite::SetVertexShader( const Ogre::String& shader )
 void
 UiSprite::SetFragmentShader( const Ogre::String& shader )
 {
+    CreateUniqueMaterial();
     Ogre::Pass* pass = m_Material->getTechnique( 0 )->getPass( 0 );
     pass->setFragmentProgram( shader, true );
     pass->getFragmentProgram()->load();
@@ -207,7 +201,19 @@ UiSprite::UpdateGeometry()
     float new_x4 = ( x4 / m_ScreenWidth ) * 2 - 1;
     float new_y4 = -( ( y4 / m_ScreenHeight ) * 2 - 1 );
 
-    float* writeIterator = ( float* ) m_VertexBuffer->lock( Ogre::HardwareBuffer::HBL_NORMAL );
+    // uv set for texture are relative to its rect in atlas
+    float atlas_width = m_Atlas.right - m_Atlas.left;
+    float atlas_height = m_Atlas.bottom - m_Atlas.top;
+    float u1 = m_Atlas.left + m_U1 * atlas_width;
+    float v1 = m_Atlas.top + m_V1 * atlas_height;
+    float u2 = m_Atlas.left + m_U2 * atlas_width;
+    float v2 = m_Atlas.top + m_V2 * atlas_height;
+    float u3 = m_Atlas.left + m_U3 * atlas_width;
+    float v3 = m_Atlas.top + m_V3 * atlas_height;
+    float u4 = m_Atlas.left + m_U4 * atlas_width;
+    float v4 = m_Atlas.top + m_V4 * atlas_height;
+
+    float* writeIterator = m_Vertices;
 
     *writeIterator++ = new_x1;
     *writeIterator++ = new_y1;
@@ -216,8 +222,8 @@ UiSprite::UpdateGeometry()
     *writeIterator++ = m_Colour1.g;
     *writeIterator++ = m_Colour1.b;
     *writeIterator++ = m_Colour1.a;
-    *writeIterator++ = m_U1;
-    *writeIterator++ = m_V1;
+    *writeIterator++ = u1;
+    *writeIterator++ = v1;
 
     *writeIterator++ = new_x2;
     *writeIterator++ = new_y2;
@@ -226,8 +232,8 @@ UiSprite::UpdateGeometry()
     *writeIterator++ = m_Colour2.g;
     *writeIterator++ = m_Colour2.b;
     *writeIterator++ = m_Colour2.a;
-    *writeIterator++ = m_U2;
-    *writeIterator++ = m_V2;
+    *writeIterator++ = u2;
+    *writeIterator++ = v2;
 
     *writeIterator++ = new_x3;
     *writeIterator++ = new_y3;
@@ -236,8 +242,8 @@ UiSprite::UpdateGeometry()
     *writeIterator++ = m_Colour3.g;
     *writeIterator++ = m_Colour3.b;
     *writeIterator++ = m_Colour3.a;
-    *writeIterator++ = m_U3;
-    *writeIterator++ = m_V3;
+    *writeIterator++ = u3;
+    *writeIterator++ = v3;
 
     *writeIterator++ = new_x1;
     *writeIterator++ = new_y1;
@@ -246,8 +252,8 @@ UiSprite::UpdateGeometry()
     *writeIterator++ = m_Colour1.g;
     *writeIterator++ = m_Colour1.b;
     *writeIterator++ = m_Colour1.a;
-    *writeIterator++ = m_U1;
-    *writeIterator++ = m_V1;
+    *writeIterator++ = u1;
+    *writeIterator++ = v1;
 
     *writeIterator++ = new_x3;
     *writeIterator++ = new_y3;
@@ -256,8 +262,8 @@ UiSprite::UpdateGeometry()
     *writeIterator++ = m_Colour3.g;
     *writeIterator++ = m_Colour3.b;
     *writeIterator++ = m_Colour3.a;
-    *writeIterator++ = m_U3;
-    *writeIterator++ = m_V3;
+    *writeIterator++ = u3;
+    *writeIterator++ = v3;
 
     *writeIterator++ = new_x4;
     *writeIterator++ = new_y4;
@@ -266,44 +272,25 @@ UiSprite::UpdateGeometry()
     *writeIterator++ = m_Colour4.g;
     *writeIterator++ = m_Colour4.b;
     *writeIterator++ = m_Colour4.a;
-    *writeIterator++ = m_U4;
-    *writeIterator++ = m_V4;
+    *writeIterator++ = u4;
+    *writeIterator++ = v4;
 
-    m_RenderOp.vertexData->vertexCount = 6;
-
-    m_VertexBuffer->unlock();
+    m_VertexCount = 6;
 }
 
 
 
 void
-UiSprite::CreateVertexBuffer()
+UiSprite::CreateUniqueMaterial()
 {
-    m_RenderOp.vertexData = new Ogre::VertexData;
-    m_RenderOp.vertexData->vertexStart = 0;
-
-    Ogre::VertexDeclaration* vDecl = m_RenderOp.vertexData->vertexDeclaration;
-
-    size_t offset = 0;
-    vDecl->addElement( 0, 0, Ogre::VET_FLOAT3, Ogre::VES_POSITION );
-    offset += Ogre::VertexElement::getTypeSize( Ogre::VET_FLOAT3 );
-    vDecl->addElement( 0, offset, Ogre::VET_FLOAT4, Ogre::VES_DIFFUSE );
-    offset += Ogre::VertexElement::getTypeSize( Ogre::VET_FLOAT4 );
-    vDecl->addElement( 0, offset, Ogre::VET_FLOAT2, Ogre::VES_TEXTURE_COORDINATES );
-
-    m_VertexBuffer = Ogre::HardwareBufferManager::getSingletonPtr()->createVertexBuffer( vDecl->getVertexSize( 0 ), 6, Ogre::HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY, false );
-
-    m_RenderOp.vertexData->vertexBufferBinding->setBinding( 0, m_VertexBuffer );
-    m_RenderOp.operationType = Ogre::RenderOperation::OT_TRIANGLE_LIST;
-    m_RenderOp.useIndexes = false;
-}
-
-
+    // sprite with own shaders can't share material with others
+    if( m_MaterialUnique == true )
+    {
+        return;
+    }
 
-void
-UiSprite::DestroyVertexBuffer()
-{
-    delete m_RenderOp.vertexData;
-    m_RenderOp.vertexData = 0;
-    m_VertexBuffer.setNull();
+    Ogre::String name = "UiMaterials." + m_PathName;
+    Ogre::MaterialManager::getSingleton().remove( name );
+    m_Material = m_Material->clone( name );
+    m_MaterialUnique = true;
 }
@@ -1,10 +1,10 @@
 #ifndef UI_SPRITE_H
 #define UI_SPRITE_H
 
-#include <OgreHardwareVertexBuffer.h>
-#include <OgreRenderQueueListener.h>
-#include <OgreRoot.h>
+#include <OgreMaterial.h>
 
+#include "UiAtlas.h"
+#include "UiBatch.h"
 #include "UiWidget.h"
 
 
@@ -19,23 +19,22 @@ public:
     void Initialise();
     virtual void Update();
     virtual void Render();
-    virtual void UpdateTransformation();
 
     void SetTexture( const Ogre::String& texture );
     void SetUV( const float u1, const float v1, const float u2, const float v2, const float u3, const float v3, const float u4, const float v4 );
     void SetVertexShader( const Ogre::String& shader );
     void SetFragmentShader( const Ogre::String& shader );
-    void UpdateGeometry();
+    virtual void UpdateGeometry();
 
 private:
     UiSprite();
-    void CreateVertexBuffer();
-    void DestroyVertexBuffer();
+    void CreateUniqueMaterial();
 
 private:
     Ogre::MaterialPtr                   m_Material;
-    Ogre::SceneManager*                 m_SceneManager;
-    Ogre::RenderSystem*                 m_RenderSystem;
+    bool                                m_MaterialUnique; // own material when shaders are set, otherwise shared for batching
+    Ogre::String                        m_Texture;
+    UiAtlasTexture                      m_Atlas; // uv rect of texture in atlas page, whole texture if not packed
 
     float m_U1;
     float m_V1;
@@ -46,8 +45,8 @@ private:
     float m_U4;
     float m_V4;
 
-    Ogre::RenderOperation               m_RenderOp;
-    Ogre::HardwareVertexBufferSharedPtr m_VertexBuffer;
+    float                               m_Vertices[ 6 * UI_VERTEX_SIZE ];
+    unsigned int                        m_VertexCount;
 };
 
 
@@ -1,8 +1,6 @@
 #include "UiTextArea.h"
 
 #include <Overlay/OgreFontManager.h>
-#include <OgreHardwareBufferManager.h>
-#include <OgreMaterialManager.h>
 
 #include "Logger.h"
 #include "TextManager.h"
@@ -29,7 +27,6 @@ UiTextArea::UiTextArea( const Ogre::String& name, const Ogre::String& path_name,
 
 UiTextArea::~UiTextArea()
 {
-    DestroyVertexBuffer();
 }
 
 
@@ -38,7 +35,9 @@ void
 UiTextArea::Initialise()
 {
     m_Font = NULL;
-    m_MaxLetters = 0;
+    m_MaxLetters = 1024;
+    m_Vertices.resize( m_MaxLetters * 6 * UI_VERTEX_SIZE );
+    m_VertexCount = 0;
     m_TextAlign = UiTextArea::LEFT;
     m_TextLimit = 0;
     m_TextPrintSpeed = -1; // -1 instant
@@ -54,6 +53,12 @@ UiTextArea::Initialise()
     m_PaddingBottom = 0;
     m_PaddingLeft = 0;
 
+    m_LayoutValid = false;
+    m_LayoutChar = 0;
+    m_LayoutX = 0;
+    m_LayoutY = 0;
+    m_TextWidth = -1;
+
     m_NextPressed = false;
     m_NextRepeated = false;
 
@@ -64,11 +69,6 @@ UiTextArea::Initialise()
     var.name = "UITextAreaTimer";
     var.value = "00:00";
     m_TextVariable.push_back( var );
-
-    m_SceneManager = Ogre::Root::getSingleton().getSceneManager( "Scene" );
-    m_RenderSystem = Ogre::Root::getSingletonPtr()->getRenderSystem();
-
-    CreateVertexBuffer();
 }
 
 
@@ -137,7 +137,7 @@ UiTextArea::Update()
                     m_TextLimit += time * char_to_add;
                 }
 
-                m_UpdateTransformation = true;
+                SetUpdateGeometry();
             }
             break;
 
@@ -151,7 +151,7 @@ UiTextArea::Update()
                     m_TextState = TS_SHOW_TEXT;
                 }
 
-                m_UpdateTransformation = true;
+                ResetLayout();
             }
             break;
 
@@ -199,6 +199,7 @@ UiTextArea::Update()
                     m_TextYOffset = 0;
                     m_TextYOffsetTarget = 0;
                     m_TextState = TS_SHOW_TEXT;
+                    ResetLayout();
                 }
             }
             break;
@@ -220,22 +221,10 @@ UiTextArea::Update()
 void
 UiTextArea::Render()
 {
-    if( m_UpdateTransformation == false && m_Visible == true )
+    // text can go outside of widget rect, so it's skipped only when fully clipped
+    if( m_UpdateTransformation == false && m_Visible == true && m_Clipped == false )
     {
-        if( m_RenderOp.vertexData->vertexCount != 0 )
-        {
-            m_RenderSystem->_setWorldMatrix( Ogre::Matrix4::IDENTITY );
-            m_RenderSystem->_setViewMatrix( Ogre::Matrix4::IDENTITY );
-            Ogre::Matrix4 mat;
-            m_RenderSystem->_convertProjectionMatrix( Ogre::Matrix4::IDENTITY, mat );
-            m_RenderSystem->_setProjectionMatrix( mat );
-
-            m_SceneManager->_setPass( m_Material->getTechnique( 0 )->getPass( 0 ), true, false );
-
-            m_RenderSystem->setScissorTest( true, m_ScissorLeft, m_ScissorTop, m_ScissorRight, m_ScissorBottom );
-            m_RenderSystem->_render( m_RenderOp );
-            m_RenderSystem->setScissorTest( false );
-        }
+        UiManager::getSingleton().GetBatch().AddVertices( m_Material, m_ScissorLeft, m_ScissorTop, m_ScissorRight, m_ScissorBottom, m_FinalZ, &m_Vertices[ 0 ], m_VertexCount );
     }
 
     UiWidget::Render();
@@ -243,15 +232,6 @@ UiTextArea::Render()
 
 
 
-void
-UiTextArea::UpdateTransformation()
-{
-    UiWidget::UpdateTransformation();
-    UpdateGeometry();
-}
-
-
-
 void
 UiTextArea::InputPressed()
 {
@@ -272,7 +252,7 @@ void
 UiTextArea::SetTextAlign( const TextAlign align )
 {
     m_TextAlign = align;
-    m_UpdateTransformation = true;
+    ResetLayout();
 }
 
 
@@ -284,6 +264,7 @@ UiTextArea::SetPadding( const float top, const float right, const float bottom,
     m_PaddingRight = right;
     m_PaddingBottom = bottom;
     m_PaddingLeft = left;
+    ResetLayout();
 }
 
 
@@ -299,13 +280,15 @@ UiTextArea::SetText( const Ogre::UTFString& text )
         LOG_ERROR( "Can't parse text \"" + text + "\". TinyXml Error: " + doc.ErrorDesc() );
         return;
     }
-    SetText( doc.RootElement() );
+    UiDescription description;
+    unsigned int node = description.AddText( doc.RootElement() );
+    SetText( &description, node );
 }
 
 
 
 void
-UiTextArea::SetText( TiXmlNode* text )
+UiTextArea::SetText( const UiDescription* text, const unsigned int node )
 {
     if( text == NULL )
     {
@@ -328,9 +311,9 @@ UiTextArea::SetText( TiXmlNode* text )
 
     TextClear();
 
-    PrepareTextFromNode( text, m_Colour1 );
+    PrepareTextFromDescription( text, node, m_Colour1 );
     m_TextState = TS_SHOW_TEXT;
-    m_UpdateTransformation = true;
+    ResetLayout();
 
     if( m_Text.size() > m_MaxLetters )
     {
@@ -350,6 +333,7 @@ UiTextArea::TextClear()
     m_TextPrintSpeedMod = 1;
     m_TextYOffset = 0;
     m_TextYOffsetTarget = 0;
+    ResetLayout();
 }
 
 
@@ -387,23 +371,10 @@ UiTextArea::SetFont( const Ogre::String& font )
         return;
     }
 
-    m_Material = Ogre::MaterialManager::getSingleton().create( "UiMaterials." + m_PathName, "General" );
-    Ogre::Pass* pass = m_Material->getTechnique( 0 )->getPass( 0 );
-    pass->setVertexColourTracking( Ogre::TVC_AMBIENT );
-    pass->setCullingMode( Ogre::CULL_NONE );
-    pass->setDepthCheckEnabled( false );
-    pass->setDepthWriteEnabled( false );
-    pass->setLightingEnabled( false );
-    pass->setSceneBlending( Ogre::SBT_TRANSPARENT_ALPHA );
-
-    pass->setAlphaRejectFunction( Ogre::CMPF_GREATER );
-    pass->setAlphaRejectValue( 0 );
-    Ogre::TextureUnitState* tex = pass->createTextureUnitState();
-    tex->setTextureName( m_Font->GetImageName() );
-    tex->setNumMipmaps( -1 );
-    tex->setTextureFiltering( Ogre::TFO_NONE );
-
-    m_UpdateTransformation = true;
+    // all text areas with same font share material and drawn in one batch
+    m_Material = UiManager::getSingleton().GetBatch().GetMaterial( m_Font->GetImageName(), false, m_Font->GetSdf() );
+
+    ResetLayout();
 }
 
 
@@ -485,7 +456,7 @@ UiTextArea::SetVariable( const Ogre::String& name, const Ogre::UTFString& value
         }
     }
 
-    m_UpdateTransformation = true;
+    ResetLayout();
 }
 
 
@@ -522,6 +493,15 @@ UiTextArea::GetTextLimit() const
 
 
 
+void
+UiTextArea::SetTextLimit( const float limit )
+{
+    m_TextLimit = limit;
+    SetUpdateGeometry();
+}
+
+
+
 unsigned int
 UiTextArea::GetTextSize() const
 {
@@ -530,6 +510,14 @@ UiTextArea::GetTextSize() const
 
 
 
+unsigned int
+UiTextArea::GetNumberOfGlyphs() const
+{
+    return m_VertexCount / 6;
+}
+
+
+
 float
 UiTextArea::GetPauseTime() const
 {
@@ -537,6 +525,16 @@ UiTextArea::GetPauseTime() const
 }
 
 
+
+void
+UiTextArea::UpdateTransformation()
+{
+    UiWidget::UpdateTransformation();
+    m_LayoutValid = false;
+}
+
+
+
 void
 UiTextArea::UpdateGeometry()
 {
@@ -559,18 +557,29 @@ UiTextArea::UpdateGeometry()
 
     //LOG_ERROR( "1) m_FinalOrigin.y = " + Ogre::StringConverter::toString( m_FinalOrigin.y ) + ", m_TextYOffset = " + Ogre::StringConverter::toString( m_TextYOffset ) );
 
-    float* writeIterator = ( float* ) m_VertexBuffer->lock( Ogre::HardwareBuffer::HBL_NORMAL );
-    m_RenderOp.vertexData->vertexCount = 0;
-
     float local_x_start = -m_FinalOrigin.x - ( width - m_PaddingLeft ) * m_FinalScale.x * m_ScreenHeight / 720.0f;
-    float local_x1 = local_x_start;
-    float local_y1 = -m_FinalOrigin.y + ( ( m_TextYOffset + m_PaddingTop ) * m_FinalScale.y * m_ScreenHeight / 720.0f );
+
+    // start from beginning only if layout changed, otherwise continue from last laid out char
+    if( m_LayoutValid == false )
+    {
+        m_LayoutValid = true;
+        m_LayoutChar = 0;
+        m_LayoutX = local_x_start;
+        m_LayoutY = -m_FinalOrigin.y + ( ( m_TextYOffset + m_PaddingTop ) * m_FinalScale.y * m_ScreenHeight / 720.0f );
+        m_VertexCount = 0;
+    }
+
+    float* writeIterator = &m_Vertices[ 0 ] + m_VertexCount * UI_VERTEX_SIZE;
+
+    float local_x1 = m_LayoutX;
+    float local_y1 = m_LayoutY;
     float local_x2;
     float local_y2;
     float x = m_FinalTranslate.x;
     float y = m_FinalTranslate.y;
+    float char_scale = m_Font->GetScale();
 
-    unsigned int i = 0;
+    unsigned int i = m_LayoutChar;
     for( ; ( i < m_TextLimit ) && ( i < m_Text.size() ); ++i )
     {
         if( m_Text[ i ].skip == true )
@@ -609,13 +618,12 @@ UiTextArea::UpdateGeometry()
             m_Text[ i ].sprite->GetHeight( height_percent, height );
             m_Text[ i ].sprite->SetY( 0, m_Text[ i ].sprite_y + ( local_y1 / ( m_FinalScale.y * m_ScreenHeight / 720.0f ) ) );
             m_Text[ i ].sprite->SetVisible( true );
-            m_Text[ i ].sprite->UpdateGeometry();
             continue;
         }
 
 
 
-        UiCharData char_data = m_Font->GetCharData( m_Text[ i ].char_code );
+        const UiCharData& char_data = m_Font->GetCharData( m_Text[ i ].char_code );
         Ogre::ColourValue colour = m_Text[ i ].colour;
 
         if( char_data.char_code == 10 )
@@ -625,16 +633,16 @@ UiTextArea::UpdateGeometry()
             continue;
         }
 
-        local_x1 += char_data.pre * m_FinalScale.x * m_ScreenHeight / 720.0f;
-        local_x2 = local_x1 + char_data.width * m_FinalScale.x * m_ScreenHeight / 720.0f;
-        local_y2 = local_y1 + char_data.height * m_FinalScale.y * m_ScreenHeight / 720.0f;
+        local_x1 += char_data.pre * char_scale * m_FinalScale.x * m_ScreenHeight / 720.0f;
+        local_x2 = local_x1 + char_data.width * char_scale * m_FinalScale.x * m_ScreenHeight / 720.0f;
+        local_y2 = local_y1 + char_data.height * char_scale * m_FinalScale.y * m_ScreenHeight / 720.0f;
 
-        if( local_x2 + char_data.post * m_FinalScale.x * m_ScreenHeight / 720.0f > m_FinalSize.x - m_PaddingRight * m_FinalScale.x * m_ScreenHeight / 720.0f )
+        if( local_x2 + char_data.post * char_scale * m_FinalScale.x * m_ScreenHeight / 720.0f > m_FinalSize.x - m_PaddingRight * m_FinalScale.x * m_ScreenHeight / 720.0f )
         {
             local_x1 = local_x_start;
-            local_x2 = local_x1 + char_data.width * m_FinalScale.x * m_ScreenHeight / 720.0f;
+            local_x2 = local_x1 + char_data.width * char_scale * m_FinalScale.x * m_ScreenHeight / 720.0f;
             local_y1 += m_Font->GetHeight() * m_FinalScale.y * m_ScreenHeight / 720.0f;
-            local_y2 = local_y1 + char_data.height * m_FinalScale.y * m_ScreenHeight / 720.0f;
+            local_y2 = local_y1 + char_data.height * char_scale * m_FinalScale.y * m_ScreenHeight / 720.0f;
         }
 
         // if we cross lower border of textarea - generate event and stop rendering
@@ -695,7 +703,7 @@ UiTextArea::UpdateGeometry()
         float new_x4 = ( x4 / m_ScreenWidth ) * 2 - 1;
         float new_y4 = -( ( y4 / m_ScreenHeight ) * 2 - 1 );
 
-        local_x1 += ( char_data.width + char_data.post ) * m_FinalScale.x * m_ScreenHeight / 720.0f;
+        local_x1 += ( char_data.width + char_data.post ) * char_scale * m_FinalScale.x * m_ScreenHeight / 720.0f;
 
         float width = m_Font->GetImageWidth();
         float height = m_Font->GetImageHeight();
@@ -775,10 +783,12 @@ UiTextArea::UpdateGeometry()
         *writeIterator++ = left;
         *writeIterator++ = bottom;
 
-        m_RenderOp.vertexData->vertexCount += 6;
+        m_VertexCount += 6;
     }
 
-    m_VertexBuffer->unlock();
+    m_LayoutChar = i;
+    m_LayoutX = local_x1;
+    m_LayoutY = local_y1;
 
     if( i == m_Text.size() )
     {
@@ -788,15 +798,30 @@ UiTextArea::UpdateGeometry()
 
 
 
+void
+UiTextArea::ResetLayout()
+{
+    m_LayoutValid = false;
+    m_TextWidth = -1;
+    SetUpdateGeometry();
+}
+
+
+
 float
-UiTextArea::GetTextWidth() const
+UiTextArea::GetTextWidth()
 {
+    if( m_TextWidth >= 0 )
+    {
+        return m_TextWidth;
+    }
+
     float width = 0;
     float width_max = 0;
 
     for( unsigned int i = 0; i < m_Text.size(); ++i )
     {
-        UiCharData char_data = m_Font->GetCharData( m_Text[ i ].char_code );
+        const UiCharData& char_data = m_Font->GetCharData( m_Text[ i ].char_code );
 
         // if we go to next row store max previous row width
         if( char_data.char_code == 10 )
@@ -806,190 +831,150 @@ UiTextArea::GetTextWidth() const
         }
         else
         {
-            width += char_data.pre + char_data.width + char_data.post;
+            width += ( char_data.pre + char_data.width + char_data.post ) * m_Font->GetScale();
         }
     }
 
-    return ( width > width_max ) ? width : width_max;
-;
+    m_TextWidth = ( width > width_max ) ? width : width_max;
+    return m_TextWidth;
 }
 
 
 
 void
-UiTextArea::PrepareTextFromNode( TiXmlNode* node, const Ogre::ColourValue& colour )
+UiTextArea::PrepareTextFromDescription( const UiDescription* text, const unsigned int node, const Ogre::ColourValue& colour )
 {
-    while( node != NULL )
+    const UiDescText& desc = text->GetText( node );
+    Ogre::ColourValue colour_child = colour;
+
+    switch( desc.type )
     {
-        switch( node->Type() )
+        case UDT_TEXT:
+        {
+            PrepareTextFromText( text->GetString( desc.string ), colour );
+        }
+        break;
+
+        case UDT_COLOUR:
+        {
+            colour_child = desc.colour;
+        }
+        break;
+
+        case UDT_PAUSE_OK:
+        {
+            TextChar new_char;
+            new_char.pause_ok = true;
+            m_Text.push_back( new_char );
+        }
+        break;
+
+        case UDT_PAUSE:
+        {
+            TextChar new_char;
+            new_char.pause_time = desc.time;
+            m_Text.push_back( new_char );
+        }
+        break;
+
+        case UDT_NEXT_PAGE:
+        {
+            TextChar new_char;
+            new_char.next_page = true;
+            m_Text.push_back( new_char );
+        }
+        break;
+
+        case UDT_TIMER:
+        case UDT_VARIABLE:
         {
-            case TiXmlNode::TINYXML_TEXT:
+            Ogre::String name = "UITextAreaTimer";
+            if( desc.type == UDT_TIMER )
             {
-                TiXmlText* childText = node->ToText();
-                if( childText )
-                {
-                    PrepareTextFromText( childText->Value(), colour );
-                }
+                m_Timer = true;
             }
-            break;
-
-            case TiXmlNode::TINYXML_ELEMENT:
+            else
             {
-                Ogre::ColourValue colour_child = colour;
+                name = text->GetString( desc.string );
+            }
 
-                Ogre::String name = node->ValueStr();
-                if( name == "colour" )
-                {
-                    colour_child = Ogre::StringConverter::parseColourValue( node->ToElement()->Attribute( "value" ) );
-                }
-                else if( name == "pause_ok" )
-                {
-                    TextChar new_char;
-                    new_char.pause_ok = true;
-                    m_Text.push_back( new_char );
-                }
-                else if( name == "pause" )
-                {
-                    const std::string* string = node->ToElement()->Attribute( Ogre::String( "time" ) );
-                    if( string != NULL )
-                    {
-                        TextChar new_char;
-                        new_char.pause_time = Ogre::StringConverter::parseReal( *string );
-                        m_Text.push_back( new_char );
-                    }
-                }
-                else if( name == "next_page" )
-                {
-                    TextChar new_char;
-                    new_char.next_page = true;
-                    m_Text.push_back( new_char );
-                }
-                else if( name == "timer" )
-                {
-                    m_Timer = true;
+            TextChar new_char;
+            new_char.skip = true;
+            new_char.variable = name;
+            new_char.colour = colour;
+            Ogre::UTFString var = GetVariable( name );
+            new_char.variable_len = var.size();
+            m_Text.push_back( new_char );
 
-                    TextChar new_char;
-                    new_char.skip = true;
-                    new_char.variable = "UITextAreaTimer";
-                    new_char.colour = colour;
-                    Ogre::UTFString var = GetVariable( "UITextAreaTimer" );
-                    new_char.variable_len = var.size();
-                    m_Text.push_back( new_char );
+            for( unsigned int i = 0; i < var.size(); ++i )
+            {
+                TextChar text_char;
+                text_char.char_code = var[ i ];
+                text_char.colour = colour;
+                m_Text.push_back( text_char );
+            }
+        }
+        break;
 
-                    for( unsigned int i = 0; i < var.size(); ++i )
-                    {
-                        TextChar text_char;
-                        text_char.char_code = var[ i ];
-                        text_char.colour = colour;
-                        m_Text.push_back( text_char );
-                    }
-                }
-                else if( name == "variable" )
-                {
-                    const std::string* string = node->ToElement()->Attribute( Ogre::String( "name" ) );
+        case UDT_INCLUDE:
+        {
+            unsigned int include_node = 0;
+            const UiDescription* include = TextManager::getSingleton().GetText( text->GetString( desc.string ), include_node );
+            if( include != NULL )
+            {
+                PrepareTextFromDescription( include, include_node, colour_child );
+            }
+        }
+        break;
 
-                    if( string != NULL )
+        case UDT_IMAGE:
+        {
+            const Ogre::String& name = text->GetString( desc.string );
+            unsigned int sprites_node = 0;
+            const UiDescription* sprites = UiManager::getSingleton().GetPrototype( "TextAreaSprite", sprites_node );
+            if( sprites != NULL )
+            {
+                const UiDescWidget& prototype = sprites->GetWidget( sprites_node );
+                for( unsigned int i = sprites_node + 1; i < prototype.end; i = sprites->GetWidget( i ).end )
+                {
+                    const UiDescWidget& sprite_desc = sprites->GetWidget( i );
+                    if( sprite_desc.type == UDW_SPRITE && sprites->GetString( sprite_desc.name ) == name )
                     {
                         TextChar new_char;
-                        new_char.skip = true;
-                        new_char.variable = *string;
-                        new_char.colour = colour;
-                        Ogre::UTFString var = GetVariable( *string );
-                        new_char.variable_len = var.size();
-                        m_Text.push_back( new_char );
 
-                        for( unsigned int i = 0; i < var.size(); ++i )
+                        UiSprite* sprite = new UiSprite( name, m_Name + "." + name, this );
+                        if( sprite_desc.image != 0 )
                         {
-                            TextChar text_char;
-                            text_char.char_code = var[ i ];
-                            text_char.colour = colour;
-                            m_Text.push_back( text_char );
+                            sprite->SetTexture( sprites->GetString( sprite_desc.image ) );
                         }
-                    }
-                }
-                else if( name == "include" )
-                {
-                    const std::string* text_name = node->ToElement()->Attribute( Ogre::String( "name" ) );
-
-                    if( text_name != NULL )
-                    {
-                        TiXmlNode* text = TextManager::getSingleton().GetText( *text_name );
-                        if( text != NULL )
+                        if( ( sprite_desc.flags & UDF_Y ) != 0 )
                         {
-                            PrepareTextFromNode( text, colour_child );
+                            new_char.sprite_y = sprite_desc.y.y;
                         }
-                    }
-                }
-                else if( name == "image" )
-                {
-                    Ogre::String name1 = GetString( node, "sprite" );
-                    if( name1 != "" )
-                    {
-                        TiXmlNode* sprites = UiManager::getSingleton().GetPrototype( "TextAreaSprite" );
-                        if( sprites != NULL )
+                        if( ( sprite_desc.flags & UDF_WIDTH ) != 0 )
                         {
-                            sprites = sprites->FirstChild();
-                            while( sprites != NULL )
-                            {
-                                if( sprites->Type() == TiXmlNode::TINYXML_ELEMENT && sprites->ValueStr() == "sprite" )
-                                {
-                                    Ogre::String name2 = GetString( sprites, "name" );
-                                    if( name1 == name2 )
-                                    {
-                                        TextChar new_char;
-
-                                        UiSprite* sprite = new UiSprite( name1, m_Name + "." + name1, this );
-                                        Ogre::String image = GetString( sprites, "image" );
-                                        if( image != "" )
-                                        {
-                                            sprite->SetTexture( image );
-                                        }
-                                        Ogre::String y_str = GetString( sprites, "y" );
-                                        if( y_str != "" )
-                                        {
-                                            float y_percent = 0;
-                                            float y = 0;
-                                            ParsePersent( y_percent, y, y_str );
-                                            new_char.sprite_y = y;
-                                        }
-                                        Ogre::String width_str = GetString( sprites, "width" );
-                                        if( width_str != "" )
-                                        {
-                                            float width_percent = 0;
-                                            float width = 0;
-                                            ParsePersent( width_percent, width, width_str );
-                                            sprite->SetWidth( 0, width );
-                                        }
-                                        Ogre::String height_str = GetString( sprites, "height" );
-                                        if( height_str != "" )
-                                        {
-                                            float height_percent = 0;
-                                            float height = 0;
-                                            ParsePersent( height_percent, height, height_str );
-                                            sprite->SetHeight( height_percent, height );
-                                        }
-
-                                        sprite->SetVisible( false );
-                                        AddChild( sprite );
-                                        new_char.sprite = sprite;
-                                        m_Text.push_back( new_char );
-                                        break;
-                                    }
-                                }
-
-                                sprites = sprites->NextSibling();
-                            }
+                            sprite->SetWidth( 0, sprite_desc.width.y );
                         }
+                        if( ( sprite_desc.flags & UDF_HEIGHT ) != 0 )
+                        {
+                            sprite->SetHeight( sprite_desc.height.x, sprite_desc.height.y );
+                        }
+
+                        sprite->SetVisible( false );
+                        AddChild( sprite );
+                        new_char.sprite = sprite;
+                        m_Text.push_back( new_char );
+                        break;
                     }
                 }
-
-                TiXmlNode* node_child = node->FirstChild();
-                PrepareTextFromNode( node_child, colour_child );
             }
-            break;
         }
+        break;
+    }
 
-        node = node->NextSibling();
+    for( unsigned int i = node + 1; i < desc.end; i = text->GetText( i ).end )
+    {
+        PrepareTextFromDescription( text, i, colour_child );
     }
 }
 
@@ -1006,39 +991,3 @@ UiTextArea::PrepareTextFromText( const Ogre::UTFString& text, const Ogre::Colour
         m_Text.push_back( new_char );
     };
 }
-
-
-
-void
-UiTextArea::CreateVertexBuffer()
-{
-    m_MaxLetters = 1024;
-    m_RenderOp.vertexData = new Ogre::VertexData;
-    m_RenderOp.vertexData->vertexStart = 0;
-
-    Ogre::VertexDeclaration* vDecl = m_RenderOp.vertexData->vertexDeclaration;
-
-    size_t offset = 0;
-    vDecl->addElement( 0, 0, Ogre::VET_FLOAT3, Ogre::VES_POSITION );
-    offset += Ogre::VertexElement::getTypeSize( Ogre::VET_FLOAT3 );
-    vDecl->addElement( 0, offset, Ogre::VET_FLOAT4, Ogre::VES_DIFFUSE );
-    offset += Ogre::VertexElement::getTypeSize( Ogre::VET_FLOAT4 );
-    vDecl->addElement( 0, offset, Ogre::VET_FLOAT2, Ogre::VES_TEXTURE_COORDINATES );
-
-    m_VertexBuffer = Ogre::HardwareBufferManager::getSingletonPtr()->createVertexBuffer( vDecl->getVertexSize( 0 ), m_MaxLetters * 6, Ogre::HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY, false );
-
-    m_RenderOp.vertexData->vertexBufferBinding->setBinding( 0, m_VertexBuffer );
-    m_RenderOp.operationType = Ogre::RenderOperation::OT_TRIANGLE_LIST;
-    m_RenderOp.useIndexes = false;
-}
-
-
-
-void
-UiTextArea::DestroyVertexBuffer()
-{
-    delete m_RenderOp.vertexData;
-    m_RenderOp.vertexData = 0;
-    m_VertexBuffer.setNull();
-    m_MaxLetters = 0;
-}
@@ -1,12 +1,12 @@
 #ifndef UI_TEXT_AREA_H
 #define UI_TEXT_AREA_H
 
-#include <OgreHardwareVertexBuffer.h>
-#include <OgreRenderQueueListener.h>
-#include <OgreRoot.h>
+#include <OgreMaterial.h>
 #include <OgreUTFString.h>
 
 #include "Timer.h"
+#include "UiBatch.h"
+#include "UiDescription.h"
 #include "UiFont.h"
 #include "UiSprite.h"
 #include "UiWidget.h"
@@ -76,8 +76,7 @@ public:
     virtual void Update();
     virtual void Render();
     virtual void UpdateTransformation();
-
-    void UpdateGeometry();
+    virtual void UpdateGeometry();
 
     void InputPressed();
     void InputRepeated();
@@ -91,7 +90,7 @@ public:
     void SetTextAlign( const TextAlign align );
     void SetPadding( const float top, const float right, const float bottom, const float left );
     void SetText( const Ogre::UTFString& text );
-    void SetText( TiXmlNode* text );
+    void SetText( const UiDescription* text, const unsigned int node );
     void TextClear();
     void RemoveSpritesFromText( const unsigned int end );
     void SetFont( const Ogre::String& font );
@@ -102,26 +101,27 @@ public:
     Ogre::UTFString GetVariable( const Ogre::String& name ) const;
     TextState GetTextState() const;
     float GetTextLimit() const;
+    // shows text up to limit without waiting for print speed
+    void SetTextLimit( const float limit );
     unsigned int GetTextSize() const;
+    // glyphs laid out by last UpdateGeometry
+    unsigned int GetNumberOfGlyphs() const;
     float GetPauseTime() const;
 
 private:
-    float GetTextWidth() const;
-    void PrepareTextFromNode( TiXmlNode* node, const Ogre::ColourValue& colour );
+    void ResetLayout();
+    float GetTextWidth();
+    void PrepareTextFromDescription( const UiDescription* text, const unsigned int node, const Ogre::ColourValue& colour );
     void PrepareTextFromText( const Ogre::UTFString& text, const Ogre::ColourValue& colour );
 
     UiTextArea();
-    void CreateVertexBuffer();
-    void DestroyVertexBuffer();
 
 private:
     Ogre::MaterialPtr m_Material;
-    Ogre::SceneManager* m_SceneManager;
-    Ogre::RenderSystem* m_RenderSystem;
 
     unsigned int m_MaxLetters;
-    Ogre::RenderOperation m_RenderOp;
-    Ogre::HardwareVertexBufferSharedPtr m_VertexBuffer;
+    std::vector< float > m_Vertices;
+    unsigned int m_VertexCount;
 
     UiFont* m_Font;
     TextAlign m_TextAlign;
@@ -147,6 +147,14 @@ private:
     float m_PaddingBottom;
     float m_PaddingLeft;
 
+    // layout of already shown text is kept between updates, when text limit grows
+    // only new chars are laid out from stored position and appended to vertices
+    bool m_LayoutValid;
+    unsigned int m_LayoutChar;
+    float m_LayoutX;
+    float m_LayoutY;
+    float m_TextWidth; // -1 if need recalculation
+
     bool m_Timer;
     int m_TimerTime;
 };
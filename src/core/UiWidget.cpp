@@ -2,12 +2,13 @@
 
 #include <OgreMath.h>
 #include <OgreRoot.h>
+#include <cfloat>
 
 #include "ConfigVar.h"
 #include "DebugDraw.h"
 #include "Logger.h"
 #include "ScriptManager.h"
-#include "Timer.h"
+#include "UiManager.h"
 
 
 
@@ -44,6 +45,13 @@ UiWidget::~UiWidget()
 
     ScriptManager::getSingleton().RemoveEntity( ScriptManager::UI, m_PathName );
 
+    UiManager::getSingleton().RemoveDirtyWidget( this );
+    UiManager::getSingleton().RemoveAnimatedWidget( this );
+    if( m_IndexPath != "" )
+    {
+        UiManager::getSingleton().RemoveWidgetIndex( m_IndexPath, this );
+    }
+
     RemoveAllChildren();
 }
 
@@ -61,6 +69,9 @@ UiWidget::Initialise()
     m_VerticalAlign = TOP;
 
     m_UpdateTransformation = true;
+    m_UpdateGeometry = true;
+    m_Depth = ( m_Parent != NULL ) ? m_Parent->GetDepth() + 1 : 0;
+    UiManager::getSingleton().AddDirtyWidget( this );
 
     m_FinalZ = 0;
     m_FinalOrigin = Ogre::Vector2::ZERO;
@@ -100,10 +111,13 @@ UiWidget::Initialise()
     m_ScissorRight = m_ScreenWidth;
     m_ScissorYPercentRight = 100;
     m_ScissorYRight = 0;
+    m_Clipped = false;
+    m_Culled = false;
 
     m_AnimationCurrent = NULL;
     m_AnimationDefault = "";
     m_AnimationState = UiAnimation::DEFAULT;
+    m_Animated = false;
     m_Colour1 = Ogre::ColourValue( 1, 1, 1, 1 );
     m_Colour2 = Ogre::ColourValue( 1, 1, 1, 1 );
     m_Colour3 = Ogre::ColourValue( 1, 1, 1, 1 );
@@ -122,58 +136,13 @@ UiWidget::Update()
         return;
     }
 
-    if( m_AnimationCurrent != NULL )
+    for( unsigned int i = 0; i < m_Children.size(); ++i )
     {
-        float delta_time = Timer::getSingleton().GetGameTimeDelta();
-        float time = m_AnimationCurrent->GetTime();
-
-        // if animation ended
-        if( time + delta_time >= m_AnimationEndTime )
+        // children with global scissor inherit empty scissor, so whole subtree is clipped
+        if( m_Clipped == false || m_Children[ i ]->m_GlobalScissor == false )
         {
-            if( time != m_AnimationEndTime)
-            {
-                m_AnimationCurrent->AddTime( m_AnimationEndTime - time );
-            }
-
-            for( unsigned int i = 0; i < m_AnimationSync.size(); ++i)
-            {
-                ScriptManager::getSingleton().ContinueScriptExecution( m_AnimationSync[ i ] );
-            }
-            m_AnimationSync.clear();
-
-            if( m_AnimationState == UiAnimation::DEFAULT && m_AnimationDefault != "" )
-            {
-                // in case of cycled default we need to sync with end
-                time = time + delta_time - m_AnimationCurrent->GetLength();
-                PlayAnimation( m_AnimationDefault, UiAnimation::DEFAULT, time, -1 );
-            }
-            else
-            {
-                m_AnimationCurrent = NULL;
-            }
+            m_Children[ i ]->Update();
         }
-        else
-        {
-            m_AnimationCurrent->AddTime( delta_time );
-        }
-    }
-    else if( m_AnimationCurrent == NULL && m_AnimationState == UiAnimation::DEFAULT && m_AnimationDefault != "" )
-    {
-        PlayAnimation( m_AnimationDefault, UiAnimation::DEFAULT, 0, -1 );
-    }
-
-
-
-    if( m_UpdateTransformation == true )
-    {
-        UpdateTransformation();
-    }
-
-
-
-    for( unsigned int i = 0; i < m_Children.size(); ++i )
-    {
-        m_Children[ i ]->Update();
     }
 
 
@@ -261,7 +230,9 @@ UiWidget::OnResize()
         m_Children[ i ]->OnResize();
     }
 
-    m_UpdateTransformation = true;
+    // screen size used in vertices too, so rebuild them even if final values stay same
+    SetUpdateTransformation();
+    SetUpdateGeometry();
 }
 
 
@@ -273,7 +244,10 @@ UiWidget::Render()
     {
         for( unsigned int i = 0; i < m_Children.size(); ++i )
         {
-            m_Children[ i ]->Render();
+            if( m_Clipped == false || m_Children[ i ]->m_GlobalScissor == false )
+            {
+                m_Children[ i ]->Render();
+            }
         }
     }
 }
@@ -296,6 +270,21 @@ UiWidget::IsVisible() const
 
 
 
+bool
+UiWidget::IsVisibleWithParents() const
+{
+    for( const UiWidget* widget = this; widget != NULL; widget = widget->m_Parent )
+    {
+        if( widget->m_Visible == false )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+
 const Ogre::String&
 UiWidget::GetName() const
 {
@@ -308,6 +297,11 @@ void
 UiWidget::AddChild( UiWidget *widget )
 {
     m_Children.push_back( widget );
+
+    if( m_IndexPath != "" )
+    {
+        widget->AddToIndex( m_IndexPath + "." + widget->GetName() );
+    }
 }
 
 
@@ -361,6 +355,67 @@ UiWidget::RemoveAllChildren()
 
 
 
+void
+UiWidget::AddToIndex( const Ogre::String& path )
+{
+    m_IndexPath = path;
+    UiManager::getSingleton().AddWidgetIndex( m_IndexPath, this );
+
+    for( unsigned int i = 0; i < m_Children.size(); ++i )
+    {
+        m_Children[ i ]->AddToIndex( m_IndexPath + "." + m_Children[ i ]->GetName() );
+    }
+}
+
+
+
+luabind::object
+UiWidget::GetScriptHandle( lua_State* state )
+{
+    // scripts run in coroutines which are collected after script ends,
+    // so handle is made in main state of domain which shares registry with them
+    lua_State* main_state = ScriptManager::getSingleton().GetMainState( state );
+
+    for( unsigned int i = 0; i < m_ScriptHandles.size(); ++i )
+    {
+        if( m_ScriptHandles[ i ].state == main_state )
+        {
+            return m_ScriptHandles[ i ].object;
+        }
+    }
+
+    ScriptHandle handle;
+    handle.state = main_state;
+    handle.object = luabind::object( main_state, this );
+    m_ScriptHandles.push_back( handle );
+    return handle.object;
+}
+
+
+
+void
+UiWidget::ClearScriptHandles( lua_State* state )
+{
+    for( unsigned int i = 0; i < m_ScriptHandles.size(); )
+    {
+        if( m_ScriptHandles[ i ].state == state )
+        {
+            m_ScriptHandles.erase( m_ScriptHandles.begin() + i );
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    for( unsigned int i = 0; i < m_Children.size(); ++i )
+    {
+        m_Children[ i ]->ClearScriptHandles( state );
+    }
+}
+
+
+
 void
 UiWidget::AddAnimation( UiAnimation* animation )
 {
@@ -394,6 +449,11 @@ UiWidget::PlayAnimation( const Ogre::String& animation, UiAnimation::State state
             m_AnimationCurrent->AddTime( 0 );
             m_AnimationEndTime = ( end == -1 ) ? m_AnimationCurrent->GetLength() : end;
             m_AnimationState = state;
+            if( m_Animated == false )
+            {
+                m_Animated = true;
+                UiManager::getSingleton().AddAnimatedWidget( this );
+            }
             return;
         }
     }
@@ -443,26 +503,79 @@ UiWidget::ScriptSetDefaultAnimation( const char* animation )
 {
     m_AnimationDefault = Ogre::String( animation );
     m_AnimationState = UiAnimation::DEFAULT;
+    if( m_Animated == false )
+    {
+        m_Animated = true;
+        UiManager::getSingleton().AddAnimatedWidget( this );
+    }
 }
 
 
 
 int
-UiWidget::ScriptAnimationSync()
+UiWidget::ScriptAnimationSync( lua_State* state )
 {
-    ScriptId script = ScriptManager::getSingleton().GetCurrentScriptId();
+    ScriptId script = ScriptManager::getSingleton().GetCurrentScriptId( state );
     m_AnimationSync.push_back( script );
     return -1;
 }
 
 
 
+bool
+UiWidget::UpdateAnimation( const float delta_time )
+{
+    if( m_AnimationCurrent != NULL )
+    {
+        float time = m_AnimationCurrent->GetTime();
+
+        // if animation ended
+        if( time + delta_time >= m_AnimationEndTime )
+        {
+            if( time != m_AnimationEndTime)
+            {
+                m_AnimationCurrent->AddTime( m_AnimationEndTime - time );
+            }
+
+            for( unsigned int i = 0; i < m_AnimationSync.size(); ++i)
+            {
+                ScriptManager::getSingleton().ContinueScriptExecution( m_AnimationSync[ i ] );
+            }
+            m_AnimationSync.clear();
+
+            if( m_AnimationState == UiAnimation::DEFAULT && m_AnimationDefault != "" )
+            {
+                // in case of cycled default we need to sync with end
+                time = time + delta_time - m_AnimationCurrent->GetLength();
+                PlayAnimation( m_AnimationDefault, UiAnimation::DEFAULT, time, -1 );
+            }
+            else
+            {
+                m_AnimationCurrent = NULL;
+            }
+        }
+        else
+        {
+            m_AnimationCurrent->AddTime( delta_time );
+        }
+    }
+    else if( m_AnimationCurrent == NULL && m_AnimationState == UiAnimation::DEFAULT && m_AnimationDefault != "" )
+    {
+        PlayAnimation( m_AnimationDefault, UiAnimation::DEFAULT, 0, -1 );
+    }
+
+    m_Animated = m_AnimationCurrent != NULL || ( m_AnimationState == UiAnimation::DEFAULT && m_AnimationDefault != "" );
+    return m_Animated;
+}
+
+
+
 void
 UiWidget::SetUpdateTransformation()
 {
-    for( unsigned int i = 0; i < m_Children.size(); ++i )
+    if( m_UpdateTransformation == false && m_UpdateGeometry == false )
     {
-        m_Children[ i ]->SetUpdateTransformation();
+        UiManager::getSingleton().AddDirtyWidget( this );
     }
 
     m_UpdateTransformation = true;
@@ -470,6 +583,76 @@ UiWidget::SetUpdateTransformation()
 
 
 
+void
+UiWidget::SetUpdateGeometry()
+{
+    if( m_UpdateTransformation == false && m_UpdateGeometry == false )
+    {
+        UiManager::getSingleton().AddDirtyWidget( this );
+    }
+
+    m_UpdateGeometry = true;
+}
+
+
+
+void
+UiWidget::UpdateDirty()
+{
+    if( m_UpdateTransformation == true )
+    {
+        UpdateLayout();
+    }
+    else if( m_UpdateGeometry == true )
+    {
+        m_UpdateGeometry = false;
+        UpdateGeometry();
+    }
+}
+
+
+
+void
+UiWidget::UpdateLayout()
+{
+    Ogre::Vector2 origin = m_FinalOrigin;
+    Ogre::Vector2 translate = m_FinalTranslate;
+    float z = m_FinalZ;
+    Ogre::Vector2 size = m_FinalSize;
+    Ogre::Vector2 scale = m_FinalScale;
+    float rotation = m_FinalRotation;
+    bool scissor = m_Scissor;
+    int scissor_top = m_ScissorTop;
+    int scissor_bottom = m_ScissorBottom;
+    int scissor_left = m_ScissorLeft;
+    int scissor_right = m_ScissorRight;
+
+    UpdateTransformation();
+
+    bool changed = origin != m_FinalOrigin || translate != m_FinalTranslate || z != m_FinalZ || size != m_FinalSize || scale != m_FinalScale || rotation != m_FinalRotation ||
+                   scissor != m_Scissor || scissor_top != m_ScissorTop || scissor_bottom != m_ScissorBottom || scissor_left != m_ScissorLeft || scissor_right != m_ScissorRight;
+
+    if( changed == true || m_UpdateGeometry == true )
+    {
+        m_UpdateGeometry = false;
+        UpdateGeometry();
+    }
+
+    for( unsigned int i = 0; i < m_Children.size(); ++i )
+    {
+        if( changed == true )
+        {
+            m_Children[ i ]->m_UpdateTransformation = true;
+        }
+        if( m_Children[ i ]->m_UpdateTransformation == true )
+        {
+            m_Children[ i ]->UpdateLayout();
+        }
+    }
+}
+
+
+
 void
 UiWidget::UpdateTransformation()
 {
@@ -601,15 +784,42 @@ UiWidget::UpdateTransformation()
 
 
 
+    // culling against scissor
+    m_Clipped = m_Scissor == true && ( m_ScissorTop >= m_ScissorBottom || m_ScissorLeft >= m_ScissorRight );
+    m_Culled = m_Clipped;
+    if( m_Scissor == true && m_Clipped == false )
+    {
+        Ogre::Vector4 rect = GetFinalRect();
+        m_Culled = rect.z <= m_ScissorLeft || rect.x >= m_ScissorRight || rect.w <= m_ScissorTop || rect.y >= m_ScissorBottom;
+    }
+
+
+
     m_UpdateTransformation = false;
 }
 
 
 
+void
+UiWidget::UpdateGeometry()
+{
+}
+
+
+
+unsigned int
+UiWidget::GetDepth() const
+{
+    return m_Depth;
+}
+
+
+
 void
 UiWidget::SetAlign( const UiWidget::Align align )
 {
     m_Align = align;
+    SetUpdateTransformation();
 }
 
 
@@ -618,6 +828,7 @@ void
 UiWidget::SetVerticalAlign( const UiWidget::VerticalAlign valign )
 {
     m_VerticalAlign = valign;
+    SetUpdateTransformation();
 }
 
 
@@ -685,6 +896,39 @@ UiWidget::GetFinalRotation() const
 
 
 
+Ogre::Vector4
+UiWidget::GetFinalRect() const
+{
+    float local_x1 = -m_FinalOrigin.x;
+    float local_y1 = -m_FinalOrigin.y;
+    float local_x2 = m_FinalSize.x + local_x1;
+    float local_y2 = m_FinalSize.y + local_y1;
+
+    if( m_FinalRotation == 0 )
+    {
+        return Ogre::Vector4( local_x1 + m_FinalTranslate.x, local_y1 + m_FinalTranslate.y, local_x2 + m_FinalTranslate.x, local_y2 + m_FinalTranslate.y );
+    }
+
+    float cos = Ogre::Math::Cos( Ogre::Radian( Ogre::Degree( m_FinalRotation ) ) );
+    float sin = Ogre::Math::Sin( Ogre::Radian( Ogre::Degree( m_FinalRotation ) ) );
+    float x[ 4 ] = { local_x1, local_x2, local_x2, local_x1 };
+    float y[ 4 ] = { local_y1, local_y1, local_y2, local_y2 };
+
+    Ogre::Vector4 rect( FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX );
+    for( unsigned int i = 0; i < 4; ++i )
+    {
+        float rx = x[ i ] * cos - y[ i ] * sin + m_FinalTranslate.x;
+        float ry = x[ i ] * sin + y[ i ] * cos + m_FinalTranslate.y;
+        rect.x = std::min( rect.x, rx );
+        rect.y = std::min( rect.y, ry );
+        rect.z = std::max( rect.z, rx );
+        rect.w = std::max( rect.w, ry );
+    }
+    return rect;
+}
+
+
+
 void
 UiWidget::SetOriginX( const float percent, const float x )
 {
@@ -843,7 +1087,7 @@ UiWidget::SetColour( const float r, const float g, const float b )
     m_Colour2.r = r; m_Colour2.g = g; m_Colour2.b = b;
     m_Colour3.r = r; m_Colour3.g = g; m_Colour3.b = b;
     m_Colour4.r = r; m_Colour4.g = g; m_Colour4.b = b;
-    SetUpdateTransformation();
+    SetUpdateGeometry();
 }
 
 
@@ -855,7 +1099,7 @@ UiWidget::SetColours( const float r1, const float g1, const float b1, const floa
     m_Colour2.r = r2; m_Colour2.g = g2; m_Colour2.b = b2;
     m_Colour3.r = r3; m_Colour3.g = g3; m_Colour3.b = b3;
     m_Colour4.r = r4; m_Colour4.g = g4; m_Colour4.b = b4;
-    SetUpdateTransformation();
+    SetUpdateGeometry();
 }
 
 
@@ -867,5 +1111,5 @@ UiWidget::SetAlpha( const float a )
     m_Colour2.a = a;
     m_Colour3.a = a;
     m_Colour4.a = a;
-    SetUpdateTransformation();
+    SetUpdateGeometry();
 }
@@ -25,6 +25,7 @@ public:
 
     void SetVisible( const bool visible );
     bool IsVisible() const;
+    bool IsVisibleWithParents() const;
 
     const Ogre::String& GetName() const;
 
@@ -34,6 +35,14 @@ public:
     unsigned int GetNumberOfChildren();
     void RemoveAllChildren();
 
+    // register widget and its children in UiManager path index,
+    // done when widget is attached to tree that is already indexed
+    void AddToIndex( const Ogre::String& path );
+    // same userdata is returned to script on each lookup
+    luabind::object GetScriptHandle( lua_State* state );
+    // release handles made in main lua state before it is closed
+    void ClearScriptHandles( lua_State* state );
+
     // animation related
     void AddAnimation( UiAnimation* animation );
     const Ogre::String& GetCurrentAnimationName() const;
@@ -44,10 +53,21 @@ public:
     void ScriptPlayAnimation( const char* name, const float start, const float end );
     void ScriptPlayAnimationStop( const char* name, const float start, const float end );
     void ScriptSetDefaultAnimation( const char* animation );
-    int ScriptAnimationSync();
-
+    int ScriptAnimationSync( lua_State* state );
+    // called by UiManager for all widgets with active animations,
+    // returns false when widget has nothing more to animate
+    bool UpdateAnimation( const float delta_time );
+
+    // Layout changes mark widget with SetUpdateTransformation, changes that only affect
+    // vertices (colour, uv, text) mark it with SetUpdateGeometry. Dirty widgets are
+    // collected by UiManager and updated once per frame top-down. Children are recalculated
+    // only if final values of parent changed.
     void SetUpdateTransformation();
+    void SetUpdateGeometry();
+    void UpdateDirty();
     virtual void UpdateTransformation();
+    virtual void UpdateGeometry();
+    unsigned int GetDepth() const;
 
     enum Align
     {
@@ -71,6 +91,8 @@ public:
     Ogre::Vector2 GetFinalScale() const;
     Ogre::Vector4 GetFinalScissor( bool& scissor ) const;
     float GetFinalRotation() const;
+    // bounding box of widget rect on screen: left, top, right, bottom
+    Ogre::Vector4 GetFinalRect() const;
 
     void SetOriginX( const float percent, const float x );
     void SetOriginY( const float percent, const float y );
@@ -93,6 +115,13 @@ public:
 
 private:
     UiWidget();
+    void UpdateLayout();
+
+    struct ScriptHandle
+    {
+        lua_State* state;
+        luabind::object object;
+    };
 
 protected:
     Ogre::String             m_Name;
@@ -100,6 +129,8 @@ protected:
 
     UiWidget*                m_Parent;
     std::vector< UiWidget* > m_Children;
+    Ogre::String             m_IndexPath; // path in UiManager index, empty if not indexed
+    std::vector< ScriptHandle > m_ScriptHandles;
 
     float                    m_ScreenWidth;
     float                    m_ScreenHeight;
@@ -113,7 +144,9 @@ protected:
     Align                    m_Align;
     VerticalAlign            m_VerticalAlign;
 
-    bool                     m_UpdateTransformation;
+    bool                     m_UpdateTransformation; // final values need recalculation
+    bool                     m_UpdateGeometry; // vertices need rebuild
+    unsigned int             m_Depth; // number of parents, used for top-down update
 
     Ogre::Vector2            m_FinalOrigin;
     Ogre::Vector2            m_FinalTranslate;
@@ -154,11 +187,18 @@ protected:
     float                    m_ScissorYPercentRight;
     float                    m_ScissorYRight;
 
+    // Scissor is empty, widget and children with global scissor are neither
+    // updated nor rendered. Happens when widget with local scissor lies outside
+    // of parent scissor (scrolled out rows and panels).
+    bool                     m_Clipped;
+    bool                     m_Culled; // final rect is outside of scissor, widget own quads are not drawn
+
     UiAnimation*                m_AnimationCurrent;
     std::vector< ScriptId >     m_AnimationSync;
     UiAnimation::State          m_AnimationState;
     Ogre::String                m_AnimationDefault;
     float                       m_AnimationEndTime;
+    bool                        m_Animated; // added to animated widgets in UiManager
     std::vector< UiAnimation* > m_Animations;
 };
 
@@ -1,6 +1,8 @@
 #include "Utilites.h"
 
 #include <OgreStringConverter.h>
+#include <fstream>
+#include <iterator>
 
 
 
@@ -574,3 +576,32 @@ StringTokenise( const Ogre::String& str, const Ogre::String& delimiters, const O
 
     return ret;
 }
+
+
+
+bool
+ReadFileData( const Ogre::String& file_name, Ogre::String& data )
+{
+    std::ifstream file( file_name.c_str(), std::ios::in | std::ios::binary );
+    if( !file.is_open() )
+    {
+        return false;
+    }
+    data.assign( std::istreambuf_iterator< char >( file ), std::istreambuf_iterator< char >() );
+    return true;
+}
+
+
+
+// FNV-1a
+unsigned int
+HashData( const Ogre::String& data )
+{
+    unsigned int hash = 2166136261u;
+    for( size_t i = 0; i < data.size(); ++i )
+    {
+        hash ^= ( unsigned char )data[ i ];
+        hash *= 16777619u;
+    }
+    return hash;
+}
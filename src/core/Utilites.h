@@ -52,4 +52,16 @@ StringTokenise( const Ogre::String& str, const Ogre::String& delimiters = "\t\n
 
 
 
+// read whole file in binary mode
+bool
+ReadFileData( const Ogre::String& file_name, Ogre::String& data );
+
+
+
+// hash of file contents for cache validation
+unsigned int
+HashData( const Ogre::String& data );
+
+
+
 #endif // UTILITES_H
@@ -0,0 +1,69 @@
+#include "XmlAtlasFile.h"
+
+#include "Logger.h"
+#include "UiAtlas.h"
+#include "UiManager.h"
+#include "Utilites.h"
+
+
+
+XmlAtlasFile::XmlAtlasFile( const Ogre::String& file ):
+    XmlFile( file )
+{
+}
+
+
+
+XmlAtlasFile::~XmlAtlasFile()
+{
+}
+
+
+
+void
+XmlAtlasFile::LoadAtlas()
+{
+    TiXmlNode* node = m_File.RootElement();
+
+    if( node == NULL || node->ValueStr() != "atlas" )
+    {
+        LOG_ERROR( m_File.ValueStr() + " is not a valid atlas file! No <atlas> in root." );
+        return;
+    }
+
+    node = node->FirstChild();
+    while( node != NULL )
+    {
+        if( node->Type() == TiXmlNode::TINYXML_ELEMENT && node->ValueStr() == "page" )
+        {
+            Ogre::String image = GetString( node, "image" );
+            Ogre::Vector2 size = GetVector2( node, "size" );
+            if( image == "" || size.x == 0 || size.y == 0 )
+            {
+                LOG_ERROR( "Atlas page in " + m_File.ValueStr() + " must have image and size." );
+                node = node->NextSibling();
+                continue;
+            }
+
+            TiXmlNode* texture = node->FirstChild();
+            while( texture != NULL )
+            {
+                if( texture->Type() == TiXmlNode::TINYXML_ELEMENT && texture->ValueStr() == "texture" )
+                {
+                    int x = GetInt( texture, "x" );
+                    int y = GetInt( texture, "y" );
+
+                    UiAtlasTexture data;
+                    data.page = image;
+                    data.left = x / size.x;
+                    data.top = y / size.y;
+                    data.right = ( x + GetInt( texture, "width" ) ) / size.x;
+                    data.bottom = ( y + GetInt( texture, "height" ) ) / size.y;
+                    UiManager::getSingleton().AddAtlasTexture( GetString( texture, "name" ), data );
+                }
+                texture = texture->NextSibling();
+            }
+        }
+        node = node->NextSibling();
+    }
+}
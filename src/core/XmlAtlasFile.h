@@ -0,0 +1,19 @@
+#ifndef XML_ATLAS_FILE_H
+#define XML_ATLAS_FILE_H
+
+#include "XmlFile.h"
+
+
+
+class XmlAtlasFile : public XmlFile
+{
+public:
+    XmlAtlasFile( const Ogre::String& file );
+    virtual ~XmlAtlasFile();
+
+    void LoadAtlas();
+};
+
+
+
+#endif // XML_ATLAS_FILE_H
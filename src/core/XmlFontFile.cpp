@@ -36,12 +36,16 @@ XmlFontFile::LoadFont()
     Ogre::String image = GetString( node, "image", "" );
     Ogre::Vector2 size = GetVector2( node, "image_size", Ogre::Vector2::ZERO );
     int height = GetInt( node, "height", 0 );
+    bool sdf = GetBool( node, "sdf", false );
+    float scale = GetFloat( node, "scale", 1.0f );
 
     if( name != "" && image != "" && size.x != 0 && size.y != 0 )
     {
         UiFont* font = new UiFont( name, language );
         font->SetImage( image, ( int )size.x, ( int )size.y );
         font->SetHeight( height );
+        font->SetSdf( sdf );
+        font->SetScale( scale );
 
         node = node->FirstChild();
 
@@ -1,8 +1,6 @@
 #include "XmlPrototypesFile.h"
 
 #include "Logger.h"
-#include "UiManager.h"
-#include "Utilites.h"
 
 
 
@@ -19,15 +17,15 @@ XmlPrototypesFile::~XmlPrototypesFile()
 
 
 
-void
-XmlPrototypesFile::LoadPrototypes()
+bool
+XmlPrototypesFile::LoadPrototypes( UiDescription& prototypes )
 {
     TiXmlNode* node = m_File.RootElement();
 
     if( node == NULL || node->ValueStr() != "prototypes" )
     {
         LOG_ERROR( "UI Manager: " + m_File.ValueStr() + " is not a valid prototypes file! No <prototypes> in root." );
-        return;
+        return false;
     }
 
     node = node->FirstChild();
@@ -35,10 +33,11 @@ XmlPrototypesFile::LoadPrototypes()
     {
         if( node->Type() == TiXmlNode::TINYXML_ELEMENT && node->ValueStr() == "prototype" )
         {
-            Ogre::String name = GetString( node, "name" );
-            UiManager::getSingleton().AddPrototype( name, node->Clone() );
+            prototypes.AddPrototype( node );
         }
 
         node = node->NextSibling();
     }
+
+    return true;
 }
@@ -1,6 +1,7 @@
 #ifndef XML_PROTOTYPES_FILE_H
 #define XML_PROTOTYPES_FILE_H
 
+#include "UiDescription.h"
 #include "XmlFile.h"
 
 
@@ -11,7 +12,8 @@ public:
     XmlPrototypesFile( const Ogre::String& file );
     virtual ~XmlPrototypesFile();
 
-    void LoadPrototypes();
+    // false if file wasn't loaded or isn't prototypes file
+    bool LoadPrototypes( UiDescription& prototypes );
 };
 
 
@@ -1,7 +1,7 @@
 #ifndef XML_SCREEN_FILE_H
 #define XML_SCREEN_FILE_H
 
-#include "UiWidget.h"
+#include "UiDescription.h"
 #include "XmlFile.h"
 
 
@@ -12,8 +12,8 @@ public:
     explicit XmlScreenFile( const Ogre::String& file );
     virtual ~XmlScreenFile();
 
-    void LoadScreen();
-    void LoadScreenRecursive( TiXmlNode* node, const Ogre::String& base_name, UiWidget* widget );
+    // false if file wasn't loaded or isn't screen file
+    bool LoadScreen( UiDescription& screen );
 };
 
 
@@ -1,6 +1,7 @@
 #include "XmlScreensFile.h"
 
 #include "Logger.h"
+#include "UiManager.h"
 #include "Utilites.h"
 #include "XmlPrototypesFile.h"
 #include "XmlScreenFile.h"
@@ -36,8 +37,18 @@ XmlScreensFile::LoadScreens()
     {
         if( node->Type() == TiXmlNode::TINYXML_ELEMENT && node->ValueStr() == "prototype" )
         {
-            XmlPrototypesFile prototypes( "./data/" + GetString( node, "file_name" ) );
-            prototypes.LoadPrototypes();
+            Ogre::String file = GetString( node, "file_name" );
+            UiDescription* prototypes = new UiDescription();
+            if( prototypes->LoadCache( file ) == false )
+            {
+                // broken file isn't cached so its error is shown on each start
+                XmlPrototypesFile xml( "./data/" + file );
+                if( xml.LoadPrototypes( *prototypes ) == true )
+                {
+                    prototypes->SaveCache( file );
+                }
+            }
+            UiManager::getSingleton().AddPrototypes( prototypes );
         }
         node = node->NextSibling();
     }
@@ -48,8 +59,17 @@ XmlScreensFile::LoadScreens()
     {
         if( node->Type() == TiXmlNode::TINYXML_ELEMENT && node->ValueStr() == "screen" )
         {
-            XmlScreenFile screen( "./data/" + GetString( node, "file_name" ) );
-            screen.LoadScreen();
+            Ogre::String file = GetString( node, "file_name" );
+            UiDescription screen;
+            if( screen.LoadCache( file ) == false )
+            {
+                XmlScreenFile xml( "./data/" + file );
+                if( xml.LoadScreen( screen ) == true )
+                {
+                    screen.SaveCache( file );
+                }
+            }
+            screen.CreateScreens();
         }
         node = node->NextSibling();
     }
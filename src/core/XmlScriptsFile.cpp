@@ -35,7 +35,18 @@ XmlScriptsFile::LoadScripts()
     {
         if( node->Type() == TiXmlNode::TINYXML_ELEMENT && node->ValueStr() == "script" )
         {
-            ScriptManager::getSingleton().RunFile( GetString( node, "file" ) );
+            // file can be run in entity or ui lua state, by default it goes to system
+            Ogre::String type = GetString( node, "type", "system" );
+            ScriptManager::Type script_type = ScriptManager::SYSTEM;
+            if( type == "entity" )
+            {
+                script_type = ScriptManager::ENTITY;
+            }
+            else if( type == "ui" )
+            {
+                script_type = ScriptManager::UI;
+            }
+            ScriptManager::getSingleton().RunFile( GetString( node, "file" ), script_type );
         }
         else if( node->Type() == TiXmlNode::TINYXML_ELEMENT && node->ValueStr() == "system_script" )
         {
@@ -1,8 +1,6 @@
 #include "XmlTextFile.h"
 
 #include "Logger.h"
-#include "TextManager.h"
-#include "Utilites.h"
 
 
 
@@ -19,15 +17,15 @@ XmlTextFile::~XmlTextFile()
 
 
 
-void
-XmlTextFile::LoadTexts()
+bool
+XmlTextFile::LoadTexts( UiDescription& texts )
 {
     TiXmlNode* node = m_File.RootElement();
 
     if( node == NULL || node->ValueStr() != "texts" )
     {
         LOG_ERROR( "Text Manager: " + m_File.ValueStr() + " is not a valid text file! No <texts> in root." );
-        return;
+        return false;
     }
 
     node = node->FirstChild();
@@ -35,16 +33,14 @@ XmlTextFile::LoadTexts()
     {
         if( node->Type() == TiXmlNode::TINYXML_ELEMENT && node->ValueStr() == "text" )
         {
-            Ogre::String name = GetString( node, "name" );
-            TextManager::getSingleton().AddText( name, node->Clone() );
+            texts.AddText( node );
         }
         else if( node->Type() == TiXmlNode::TINYXML_ELEMENT && node->ValueStr() == "dialog" )
         {
-            Ogre::String name = GetString( node, "name" );
-            float width = GetFloat( node, "width" );
-            float height = GetFloat( node, "height" );
-            TextManager::getSingleton().AddDialog( name, node->Clone(), width, height );
+            texts.AddDialog( node );
         }
         node = node->NextSibling();
     }
+
+    return true;
 }
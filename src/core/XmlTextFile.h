@@ -1,6 +1,7 @@
 #ifndef XML_TEXT_FILE_H
 #define XML_TEXT_FILE_H
 
+#include "UiDescription.h"
 #include "XmlFile.h"
 
 
@@ -11,7 +12,8 @@ public:
     XmlTextFile( const Ogre::String& file );
     virtual ~XmlTextFile();
 
-    void LoadTexts();
+    // false if file wasn't loaded or isn't text file
+    bool LoadTexts( UiDescription& texts );
 };
 
 
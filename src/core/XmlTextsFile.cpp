@@ -72,8 +72,17 @@ XmlTextsFile::LoadTexts()
                         Ogre::String file = GetString( node2, "file" );
                         if( file != "" )
                         {
-                            XmlTextFile text( "./data/" + file );
-                            text.LoadTexts();
+                            UiDescription* texts = new UiDescription();
+                            if( texts->LoadCache( file ) == false )
+                            {
+                                // broken file isn't cached so its error is shown on each start
+                                XmlTextFile xml( "./data/" + file );
+                                if( xml.LoadTexts( *texts ) == true )
+                                {
+                                    texts->SaveCache( file );
+                                }
+                            }
+                            TextManager::getSingleton().AddTexts( texts );
                         }
                         else
                         {
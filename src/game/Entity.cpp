@@ -7,7 +7,8 @@
 
 Entity::Entity( Ogre::SceneNode* node ):
     EntityTile( node ),
-    m_CollisionMask( 0 )
+    m_CollisionMask( 0 ),
+    m_Action( NONE )
 {
     SetColour( Ogre::ColourValue( 1, 1, 1, 1 ) );
 
@@ -79,7 +80,7 @@ Entity::SetAction( const Action action )
 
 
 
-const Action
+const Entity::Action
 Entity::GetAction() const
 {
     return m_Action;
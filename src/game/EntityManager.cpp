@@ -1,11 +1,18 @@
 #include <OgreRoot.h>
+#include <algorithm>
 #include "../core/CameraManager.h"
+#include "../core/Counters.h"
 #include "../core/DebugDraw.h"
+#include "../core/FrameBudget.h"
 #include "../core/Logger.h"
+#include "../core/MemoryTracker.h"
+#include "../core/Profiler.h"
 #include "../core/Timer.h"
+#include "../core/Utilites.h"
 #include "Entity.h"
 #include "EntityManager.h"
 #include "EntityManagerCommands.h"
+#include "EntityManagerBenchmarks.h"
 #include "EntityXmlFile.h"
 #include "MapXmlFile.h"
 
@@ -13,18 +20,46 @@
 
 template<>EntityManager *Ogre::Singleton< EntityManager >::msSingleton = NULL;
 
-ConfigVar cv_debug_move( "debug_move", "Draw movement debug", "false" );
-ConfigVar cv_debug_collision( "debug_collision", "Draw collision", "false" );
+ConfigVarBool cv_debug_move( "debug_move", "Draw movement debug", false );
+ConfigVarBool cv_debug_collision( "debug_collision", "Draw collision", false );
+ConfigVarBool cv_debug_pass( "debug_pass", "Draw not passable cells of map", false );
 
 std::vector< Ogre::Vector3 > place_finder_ignore;
 
 
 
+void
+script_get_units( const luabind::object& table, std::vector< int >& units )
+{
+    if( luabind::type( table ) != LUA_TTABLE )
+    {
+        return;
+    }
+
+    lua_State* state = table.interpreter();
+    table.push( state );
+    size_t size = lua_objlen( state, -1 );
+    units.reserve( size );
+    for( size_t i = 1; i <= size; ++i )
+    {
+        lua_rawgeti( state, -1, i );
+        if( lua_isnumber( state, -1 ) )
+        {
+            units.push_back( ( int )lua_tointeger( state, -1 ) );
+        }
+        lua_pop( state, 1 );
+    }
+    lua_pop( state, 1 );
+}
+
+
+
 EntityManager::EntityManager()
 {
     LOG_TRIVIAL( "EntityManager created." );
 
     InitCmd();
+    InitBenchmarks();
 
     m_Hud = new HudManager();
 
@@ -73,7 +108,49 @@ EntityManager::Input( const Event& event )
 void
 EntityManager::Update()
 {
-    float delta = Timer::getSingleton().GetGameTimeDelta();
+    PROFILE_ZONE( "EntityManager::Update" );
+
+    // paths which don't fit in budget are computed in next frames
+    unsigned long long deadline = FrameBudget::getSingleton().GetDeadline( FrameBudget::PATH );
+    UpdatePaths( deadline );
+    UpdateMovement( Timer::getSingleton().GetGameTimeDelta(), deadline );
+
+    COUNTER_SET( "entities_movable", ( float )m_EntitiesMovable.size() );
+    COUNTER_SET( "entities_stand", ( float )( m_Entities.size() - m_EntitiesMovable.size() ) );
+
+    m_Hud->Update();
+
+    UpdateDebug();
+}
+
+
+
+void
+EntityManager::UpdatePaths( const unsigned long long deadline )
+{
+    // at least one request is done each frame so queue always moves
+    size_t done = 0;
+    for( ; done < m_PathRequests.size(); ++done )
+    {
+        if( done > 0 && Profiler::GetTime() > deadline )
+        {
+            break;
+        }
+        UpdateEntityPath( m_PathRequests[ done ] );
+    }
+    m_PathRequests.erase( m_PathRequests.begin(), m_PathRequests.begin() + done );
+
+    if( m_PathRequests.size() > 0 )
+    {
+        COUNTER_ADD( "paths_deferred", m_PathRequests.size() );
+    }
+}
+
+
+
+void
+EntityManager::UpdateMovement( const float delta, const unsigned long long deadline )
+{
     float speed = 2.0f;
 
     for( size_t i = 0; i < m_EntitiesMovable.size(); ++i )
@@ -107,7 +184,22 @@ EntityManager::Update()
                 if( move_path.size() != 0 )
                 {
                     place_finder_ignore.clear();
-                    m_EntitiesMovable[ i ]->SetMovePath( AStarFinder( cur, end, m_EntitiesMovable[ i ] ) );
+                    if( Profiler::GetTime() <= deadline )
+                    {
+                        m_EntitiesMovable[ i ]->SetMovePath( AStarFinder( cur, end, m_EntitiesMovable[ i ] ) );
+                    }
+                    // out of budget unit keeps its old path while next cell is free,
+                    // otherwise it stops here and waits for path request
+                    else if( IsPassable( move_path.back(), m_EntitiesMovable[ i ] ) == false )
+                    {
+                        m_EntitiesMovable[ i ]->SetMovePath( std::vector< Ogre::Vector3 >() );
+                        SetEntityMove( m_EntitiesMovable[ i ], end );
+
+                        std::vector< Ogre::Vector3 > occupation;
+                        occupation.push_back( cur );
+                        m_EntitiesMovable[ i ]->SetOccupation( occupation );
+                        continue;
+                    }
 
                     //LOG_ERROR( "    path for entity " + Ogre::StringConverter::toString( m_EntitiesMovable[ i ] ) + ":" );
                     //std::vector< Ogre::Vector3 > path = m_EntitiesMovable[ i ]->GetMovePath();
@@ -139,10 +231,6 @@ EntityManager::Update()
             }
         }
     }
-
-    m_Hud->Update();
-
-    UpdateDebug();
 }
 
 
@@ -150,7 +238,7 @@ EntityManager::Update()
 void
 EntityManager::UpdateDebug()
 {
-    if( cv_debug_collision.GetB() == true )
+    if( cv_debug_collision.Get() == true )
     {
         for( size_t i = 0; i < m_Entities.size(); ++i )
         {
@@ -165,7 +253,7 @@ EntityManager::UpdateDebug()
         }
     }
 
-    if( cv_debug_move.GetB() == true )
+    if( cv_debug_move.Get() == true )
     {
         for( size_t i = 0; i < m_EntitiesMovable.size(); ++i )
         {
@@ -201,18 +289,33 @@ EntityManager::UpdateDebug()
         DEBUG_DRAW.Quad( pos_s.x, pos_s.y, pos_e.x, pos_s.y, pos_e.x, pos_e.y, pos_s.x, pos_e.y );
     }
 
-    for( size_t i = 0; i < 100; ++i )
+    if( cv_debug_pass.Get() == true )
     {
-        for( size_t j = 0; j < 100; ++j )
+        // pass map is static so it is built once in world space and only shown
+        if( DEBUG_DRAW.IsGroup( "pass_map" ) == false )
         {
-            //Ogre::Vector3 pos_s = CameraManager::getSingleton().ProjectPointToScreen( Ogre::Vector3( i - 0.5f, j - 0.5f, 0 ) );
-            //Ogre::Vector3 pos_e = CameraManager::getSingleton().ProjectPointToScreen( Ogre::Vector3( i + 0.5f, j + 0.5f, 0 ) );
-            //int pass = m_MapSector.GetPass( i, j );
-            //DEBUG_DRAW.SetColour( Ogre::ColourValue( 1, 1, 1, 1 ) );
-            //DEBUG_DRAW.Text( Ogre::Vector3( i, j, 0 ), 0, 0, Ogre::StringConverter::toString( pass ) );
-            //DEBUG_DRAW.SetColour( Ogre::ColourValue( 1, 1, 0, 0.3f ) );
-            //DEBUG_DRAW.Quad( pos_s.x, pos_s.y, pos_e.x, pos_s.y, pos_e.x, pos_e.y, pos_s.x, pos_e.y );
+            DEBUG_DRAW.BeginGroup( "pass_map" );
+            DEBUG_DRAW.SetColour( Ogre::ColourValue( 1, 1, 0, 0.3f ) );
+            for( unsigned int i = 0; i < 100; ++i )
+            {
+                for( unsigned int j = 0; j < 100; ++j )
+                {
+                    if( m_MapSector.GetPass( i, j ) != 0 )
+                    {
+                        Ogre::Vector3 pos_s( i - 0.5f, j - 0.5f, 0.01f );
+                        Ogre::Vector3 pos_e( i + 0.5f, j + 0.5f, 0.01f );
+                        DEBUG_DRAW.Triangle3d( pos_s, Ogre::Vector3( pos_e.x, pos_s.y, 0.01f ), pos_e );
+                        DEBUG_DRAW.Triangle3d( pos_s, pos_e, Ogre::Vector3( pos_s.x, pos_e.y, 0.01f ) );
+                    }
+                }
+            }
+            DEBUG_DRAW.EndGroup();
         }
+        DEBUG_DRAW.SetGroupVisible( "pass_map", true );
+    }
+    else if( DEBUG_DRAW.IsGroup( "pass_map" ) == true )
+    {
+        DEBUG_DRAW.SetGroupVisible( "pass_map", false );
     }
 
     //Ogre::SceneNode::ChildNodeIterator node = m_SceneNode->getChildIterator();
@@ -337,56 +440,259 @@ EntityManager::SetEntitySelectionMove( const Ogre::Vector3& move )
     //LOG_ERROR( "Start move: target=" + Ogre::StringConverter::toString( move ) );
     for( size_t i = 0; i < m_EntitiesSelected.size(); ++i )
     {
-        m_EntitiesSelected[ i ]->SetMoveEnd( move );
+        SetEntityMove( m_EntitiesSelected[ i ], move );
+    }
+}
+
+
+
+void
+EntityManager::SetEntityMove( EntityMovable* entity, const Ogre::Vector3& move )
+{
+    entity->SetMoveEnd( move );
+
+    // path is searched in UpdatePaths to new move end even if unit already waits
+    if( std::find( m_PathRequests.begin(), m_PathRequests.end(), entity ) == m_PathRequests.end() )
+    {
+        m_PathRequests.push_back( entity );
+    }
+}
+
+
+
+void
+EntityManager::UpdateEntityPath( EntityMovable* entity )
+{
+    Ogre::Vector3 move = entity->GetMoveEnd();
+
+    std::vector< Ogre::Vector3 > move_path = entity->GetMovePath();
+    Ogre::Vector3 start;
+    if( move_path.size() != 0 )
+    {
+        start = move_path.back();
+    }
+    else
+    {
+        start = entity->GetPosition();
+    }
+
+    place_finder_ignore.clear();
+    std::vector< Ogre::Vector3 > move_path_new = AStarFinder( start, move, entity );
+
+    // if segment not finished add new segment to it
+    if( move_path.size() != 0 )
+    {
+        move_path = move_path_new;
+        move_path.push_back( start );
+    }
+    else
+    {
+        move_path = move_path_new;
+    }
+    entity->SetMovePath( move_path );
+
+    //LOG_ERROR( "    path for entity " + Ogre::StringConverter::toString( i ) + ":" );
+    //std::vector< Ogre::Vector3 > path = entity->GetMovePath();
+    //for( size_t j = 0; j < path.size(); ++j )
+    //{
+        //LOG_ERROR( "        " + Ogre::StringConverter::toString( path[ j ] ) );
+    //}
+
+    std::vector< Ogre::Vector3 > occupation_old = entity->GetOccupation();
+    std::vector< Ogre::Vector3 > occupation;
+    if( occupation_old.size() > 0 )
+    {
+        occupation.push_back( occupation_old[ 0 ] );
+        //LOG_ERROR( "    occupation " + Ogre::StringConverter::toString( occupation_old[ 0 ] ) );
+        Ogre::Vector3 pos = entity->GetMoveNext();
+        if( pos.z != -1 )
+        {
+            //LOG_ERROR( "    occupation " + Ogre::StringConverter::toString( pos ) );
+            occupation.push_back( pos );
+        }
+        entity->SetOccupation( occupation );
+    }
+}
+
 
-        std::vector< Ogre::Vector3 > move_path = m_EntitiesSelected[ i ]->GetMovePath();
-        Ogre::Vector3 start;
-        if( move_path.size() != 0 )
+
+void
+EntityManager::GetUnitsInRect( const float x1, const float y1, const float x2, const float y2, const int action, std::vector< int >& units ) const
+{
+    float left = ( x1 < x2 ) ? x1 : x2;
+    float right = ( x1 < x2 ) ? x2 : x1;
+    float top = ( y1 < y2 ) ? y1 : y2;
+    float bottom = ( y1 < y2 ) ? y2 : y1;
+
+    for( size_t i = 0; i < m_EntitiesMovable.size(); ++i )
+    {
+        const Ogre::Vector3& pos = m_EntitiesMovable[ i ]->GetPosition();
+        if( pos.x >= left && pos.x <= right && pos.y >= top && pos.y <= bottom )
         {
-            start = move_path.back();
+            // negative action means any action
+            if( action < 0 || m_EntitiesMovable[ i ]->GetAction() == action )
+            {
+                units.push_back( i );
+            }
         }
-        else
+    }
+}
+
+
+
+void
+EntityManager::SetUnitsMove( const std::vector< int >& units, const Ogre::Vector3& move )
+{
+    for( size_t i = 0; i < units.size(); ++i )
+    {
+        if( units[ i ] < 0 || units[ i ] >= ( int )m_EntitiesMovable.size() )
         {
-            start = m_EntitiesSelected[ i ]->GetPosition();
+            LOG_WARNING( "EntityManager::SetUnitsMove: unit handle " + Ogre::StringConverter::toString( units[ i ] ) + " not valid." );
+            continue;
         }
 
-        place_finder_ignore.clear();
-        std::vector< Ogre::Vector3 > move_path_new = AStarFinder( start, move, m_EntitiesSelected[ i ] );
+        SetEntityMove( m_EntitiesMovable[ units[ i ] ], move );
+    }
+}
+
+
 
-        // if segment not finished add new segment to it
-        if( move_path.size() != 0 )
+void
+EntityManager::SetUnitsAction( const std::vector< int >& units, const Entity::Action action )
+{
+    for( size_t i = 0; i < units.size(); ++i )
+    {
+        if( units[ i ] < 0 || units[ i ] >= ( int )m_EntitiesMovable.size() )
         {
-            move_path = move_path_new;
-            move_path.push_back( start );
+            LOG_WARNING( "EntityManager::SetUnitsAction: unit handle " + Ogre::StringConverter::toString( units[ i ] ) + " not valid." );
+            continue;
         }
-        else
+
+        m_EntitiesMovable[ units[ i ] ]->SetAction( action );
+    }
+}
+
+
+
+luabind::object
+EntityManager::ScriptGetUnitsInRect( lua_State* state, const float x1, const float y1, const float x2, const float y2, const int action ) const
+{
+    std::vector< int > units;
+    GetUnitsInRect( x1, y1, x2, y2, action, units );
+
+    luabind::object table = luabind::newtable( state );
+    table.push( state );
+    for( size_t i = 0; i < units.size(); ++i )
+    {
+        lua_pushinteger( state, units[ i ] );
+        lua_rawseti( state, -2, i + 1 );
+    }
+    lua_pop( state, 1 );
+
+    return table;
+}
+
+
+
+luabind::object
+EntityManager::ScriptGetUnitsPosition( lua_State* state, const luabind::object& units ) const
+{
+    std::vector< int > handles;
+    script_get_units( units, handles );
+
+    // packed as { x1, y1, x2, y2, ... }
+    luabind::object table = luabind::newtable( state );
+    table.push( state );
+    for( size_t i = 0; i < handles.size(); ++i )
+    {
+        Ogre::Vector3 pos( 0, 0, 0 );
+        if( handles[ i ] >= 0 && handles[ i ] < ( int )m_EntitiesMovable.size() )
         {
-            move_path = move_path_new;
+            pos = m_EntitiesMovable[ handles[ i ] ]->GetPosition();
         }
-        m_EntitiesSelected[ i ]->SetMovePath( move_path );
-
-        //LOG_ERROR( "    path for entity " + Ogre::StringConverter::toString( i ) + ":" );
-        //std::vector< Ogre::Vector3 > path = m_EntitiesSelected[ i ]->GetMovePath();
-        //for( size_t j = 0; j < path.size(); ++j )
-        //{
-            //LOG_ERROR( "        " + Ogre::StringConverter::toString( path[ j ] ) );
-        //}
-
-        std::vector< Ogre::Vector3 > occupation_old = m_EntitiesSelected[ i ]->GetOccupation();
-        std::vector< Ogre::Vector3 > occupation;
-        if( occupation_old.size() > 0 )
+        lua_pushnumber( state, pos.x );
+        lua_rawseti( state, -2, i * 2 + 1 );
+        lua_pushnumber( state, pos.y );
+        lua_rawseti( state, -2, i * 2 + 2 );
+    }
+    lua_pop( state, 1 );
+
+    return table;
+}
+
+
+
+luabind::object
+EntityManager::ScriptGetUnitsAction( lua_State* state, const luabind::object& units ) const
+{
+    std::vector< int > handles;
+    script_get_units( units, handles );
+
+    luabind::object table = luabind::newtable( state );
+    table.push( state );
+    for( size_t i = 0; i < handles.size(); ++i )
+    {
+        int action = -1;
+        if( handles[ i ] >= 0 && handles[ i ] < ( int )m_EntitiesMovable.size() )
         {
-            occupation.push_back( occupation_old[ 0 ] );
-            //LOG_ERROR( "    occupation " + Ogre::StringConverter::toString( occupation_old[ 0 ] ) );
-            Ogre::Vector3 pos = m_EntitiesSelected[ i ]->GetMoveNext();
-            if( pos.z != -1 )
-            {
-                //LOG_ERROR( "    occupation " + Ogre::StringConverter::toString( pos ) );
-                occupation.push_back( pos );
-            }
-            m_EntitiesSelected[ i ]->SetOccupation( occupation );
+            action = m_EntitiesMovable[ handles[ i ] ]->GetAction();
         }
+        lua_pushinteger( state, action );
+        lua_rawseti( state, -2, i + 1 );
+    }
+    lua_pop( state, 1 );
+
+    return table;
+}
+
+
+
+void
+EntityManager::ScriptSetUnitsMove( const luabind::object& units, const float x, const float y )
+{
+    std::vector< int > handles;
+    script_get_units( units, handles );
+    SetUnitsMove( handles, Ogre::Vector3( std::floor( x + 0.5f ), std::floor( y + 0.5f ), 0 ) );
+}
+
+
+
+void
+EntityManager::ScriptSetUnitsAction( const luabind::object& units, const int action )
+{
+    std::vector< int > handles;
+    script_get_units( units, handles );
+    SetUnitsAction( handles, ( Entity::Action )action );
+}
+
+
+
+int
+EntityManager::ScriptGetUnitsNumber() const
+{
+    return m_EntitiesMovable.size();
+}
+
+
+
+unsigned int
+EntityManager::GetStateHash() const
+{
+    // game time, positions and actions of entities are enough to see where replay goes other way
+    Ogre::String state;
+    state.reserve( sizeof( float ) + m_Entities.size() * ( sizeof( Ogre::Vector3 ) + sizeof( int ) ) );
+
+    float time = Timer::getSingleton().GetGameTimeTotal();
+    state.append( ( const char* )&time, sizeof( time ) );
+    for( size_t i = 0; i < m_Entities.size(); ++i )
+    {
+        Ogre::Vector3 position = m_Entities[ i ]->GetPosition();
+        int action = m_Entities[ i ]->GetAction();
+        state.append( ( const char* )position.ptr(), sizeof( float ) * 3 );
+        state.append( ( const char* )&action, sizeof( action ) );
     }
+
+    return HashData( state );
 }
 
 
@@ -394,6 +700,9 @@ EntityManager::SetEntitySelectionMove( const Ogre::Vector3& move )
 std::vector< Ogre::Vector3 >
 EntityManager::AStarFinder( const Ogre::Vector3& start, const Ogre::Vector3& end, EntityMovable* self ) const
 {
+    PROFILE_ZONE( "EntityManager::AStarFinder" );
+    COUNTER_ADD( "path_computed", 1 );
+
     std::vector< Ogre::Vector3 > move_path;
 
     if( self == NULL )
@@ -412,35 +721,37 @@ EntityManager::AStarFinder( const Ogre::Vector3& start, const Ogre::Vector3& end
         return move_path;
     }
 
-    std::vector< AStarNode* > grid;
+    // whole grid in one block instead of allocation for each node
+    std::vector< AStarNode, TrackedAllocator< AStarNode, MEMORY_PATHFINDING > > grid( 100 * 100 );
     for( size_t i = 0; i < 100; ++i )
     {
         for( size_t j = 0; j < 100; ++j )
         {
-            AStarNode* node = new AStarNode();
-            node->x = i;
-            node->y = j;
-            node->g = 0.0f;
-            node->h = 0.0f;
-            node->f = 0.0f;
-            node->opened = false;
-            node->closed = false;
-            node->parent = NULL;
-            grid.push_back( node );
+            AStarNode& node = grid[ i * 100 + j ];
+            node.x = i;
+            node.y = j;
+            node.g = 0.0f;
+            node.h = 0.0f;
+            node.f = 0.0f;
+            node.opened = false;
+            node.closed = false;
+            node.parent = NULL;
         }
     }
 
-    AStarNode* start_node = grid[ start.x * 100 + start.y ];
+    AStarNode* start_node = &grid[ start.x * 100 + start.y ];
     start_node->opened = true;
 
-    std::vector< AStarNode* > open_list;
+    std::vector< AStarNode*, TrackedAllocator< AStarNode*, MEMORY_PATHFINDING > > open_list;
     open_list.push_back( start_node );
 
+    unsigned int expanded = 0;
     while( open_list.size() != 0 )
     {
         AStarNode* node = open_list.back();
         open_list.pop_back();
         node->closed = true;
+        ++expanded;
 
         //LOG_ERROR( "cycle for node: " + Ogre::StringConverter::toString( node->x ) + " " + Ogre::StringConverter::toString( node->y ) );
 
@@ -462,35 +773,35 @@ EntityManager::AStarFinder( const Ogre::Vector3& start, const Ogre::Vector3& end
         std::vector< AStarNode* > neighbors;
         if( IsPassable( Ogre::Vector3( node->x - 1, node->y - 1, 0 ), self ) && IsPassable( Ogre::Vector3( node->x, node->y - 1, 0 ), self ) && IsPassable( Ogre::Vector3( node->x - 1, node->y, 0 ), self ) )
         {
-            neighbors.push_back( grid[ ( node->x - 1 ) * 100 + ( node->y -  1) ] );
+            neighbors.push_back( &grid[ ( node->x - 1 ) * 100 + ( node->y -  1) ] );
         }
         if( IsPassable( Ogre::Vector3( node->x, node->y - 1, 0 ), self ) )
         {
-            neighbors.push_back( grid[ node->x * 100 + ( node->y - 1 ) ] );
+            neighbors.push_back( &grid[ node->x * 100 + ( node->y - 1 ) ] );
         }
         if( IsPassable( Ogre::Vector3( node->x + 1, node->y - 1, 0 ), self ) && IsPassable( Ogre::Vector3( node->x, node->y - 1, 0 ), self ) && IsPassable( Ogre::Vector3( node->x + 1, node->y, 0 ), self ) )
         {
-            neighbors.push_back( grid[ ( node->x + 1 ) * 100 + ( node->y - 1 ) ] );
+            neighbors.push_back( &grid[ ( node->x + 1 ) * 100 + ( node->y - 1 ) ] );
         }
         if( IsPassable( Ogre::Vector3( node->x - 1, node->y, 0 ), self ) )
         {
-            neighbors.push_back( grid[ ( node->x - 1 ) * 100 + node->y ] );
+            neighbors.push_back( &grid[ ( node->x - 1 ) * 100 + node->y ] );
         }
         if( IsPassable( Ogre::Vector3( node->x + 1, node->y, 0 ), self ) )
         {
-            neighbors.push_back( grid[ ( node->x + 1 ) * 100 + node->y ] );
+            neighbors.push_back( &grid[ ( node->x + 1 ) * 100 + node->y ] );
         }
         if( IsPassable( Ogre::Vector3( node->x - 1, node->y + 1, 0 ), self ) && IsPassable( Ogre::Vector3( node->x, node->y + 1, 0 ), self ) && IsPassable( Ogre::Vector3( node->x - 1, node->y, 0 ), self ) )
         {
-            neighbors.push_back( grid[ ( node->x - 1 ) * 100 + ( node->y + 1 ) ] );
+            neighbors.push_back( &grid[ ( node->x - 1 ) * 100 + ( node->y + 1 ) ] );
         }
         if( IsPassable( Ogre::Vector3( node->x, node->y + 1, 0 ), self ) )
         {
-            neighbors.push_back( grid[ node->x * 100 + ( node->y + 1 ) ] );
+            neighbors.push_back( &grid[ node->x * 100 + ( node->y + 1 ) ] );
         }
         if( IsPassable( Ogre::Vector3( node->x + 1, node->y + 1, 0 ), self ) && IsPassable( Ogre::Vector3( node->x, node->y + 1, 0 ), self ) && IsPassable( Ogre::Vector3( node->x + 1, node->y, 0 ), self ) )
         {
-            neighbors.push_back( grid[ ( node->x + 1 ) * 100 + ( node->y + 1 ) ] );
+            neighbors.push_back( &grid[ ( node->x + 1 ) * 100 + ( node->y + 1 ) ] );
         }
         for( size_t i = 0; i < neighbors.size(); ++i )
         {
@@ -530,10 +841,7 @@ EntityManager::AStarFinder( const Ogre::Vector3& start, const Ogre::Vector3& end
         }
     }
 
-    for( size_t i = 0; i < grid.size(); ++i )
-    {
-        delete grid[ i ];
-    }
+    COUNTER_ADD( "path_nodes_expanded", expanded );
 
     if( move_path.size() == 0 )
     {
@@ -594,6 +902,8 @@ EntityManager::PlaceFinder( const Ogre::Vector3& pos, Entity* self ) const
 const bool
 EntityManager::IsPassable( const Ogre::Vector3& pos, Entity* self ) const
 {
+    COUNTER_ADD( "is_passable_calls", 1 );
+
     //LOG_ERROR( "IsPassable x=" + Ogre::StringConverter::toString( pos.x ) + ", y=" + Ogre::StringConverter::toString( pos.y ) );
 
     if( self == NULL )
@@ -3,6 +3,11 @@
 
 #include <OgreSingleton.h>
 #include "../core/Event.h"
+extern "C"
+{
+    #include "../core/library/lua/lua.h"
+}
+#include "../core/library/luabind/object.hpp"
 #include "EntityMovable.h"
 #include "EntityStand.h"
 #include "HudManager.h"
@@ -22,7 +27,7 @@ struct EntityDesc
 
 
 
-class EntityManager : public Ogre::Singleton< EntityManager >
+class EntityManager : public Ogre::Singleton< EntityManager >, public InputListener
 {
 public:
     EntityManager();
@@ -40,7 +45,38 @@ public:
     void SetEntitySelection( const Ogre::Vector3& start, const Ogre::Vector3& end );
     void SetEntitySelectionMove( const Ogre::Vector3& move );
 
+    // batch unit access. Units referenced by handles (index of movable entity).
+    void GetUnitsInRect( const float x1, const float y1, const float x2, const float y2, const int action, std::vector< int >& units ) const;
+    void SetUnitsMove( const std::vector< int >& units, const Ogre::Vector3& move );
+    void SetUnitsAction( const std::vector< int >& units, const Entity::Action action );
+    luabind::object ScriptGetUnitsInRect( lua_State* state, const float x1, const float y1, const float x2, const float y2, const int action ) const;
+    luabind::object ScriptGetUnitsPosition( lua_State* state, const luabind::object& units ) const;
+    luabind::object ScriptGetUnitsAction( lua_State* state, const luabind::object& units ) const;
+    void ScriptSetUnitsMove( const luabind::object& units, const float x, const float y );
+    void ScriptSetUnitsAction( const luabind::object& units, const int action );
+    int ScriptGetUnitsNumber() const;
+
+    // hash of simulation state, compared by replay every tick
+    unsigned int GetStateHash() const;
+
 private:
+    void InitBenchmarks();
+    EntityMovable* BenchmarkAddUnit( const float x, const float y );
+    static void BenchmarkSetup( const int size );
+    static void BenchmarkSetupMaze( const int size );
+    static void BenchmarkSetupBlock( const int size );
+    static void BenchmarkTeardown( const int size );
+    static void BenchmarkAStar( const int size );
+    static void BenchmarkIsPassable( const int size );
+    static void BenchmarkPlaceFinder( const int size );
+    static void BenchmarkUpdate( const int size );
+    static void BenchmarkMapParse( const int size );
+
+    void UpdatePaths( const unsigned long long deadline );
+    void UpdateMovement( const float delta, const unsigned long long deadline );
+    void SetEntityMove( EntityMovable* entity, const Ogre::Vector3& move );
+    void UpdateEntityPath( EntityMovable* entity );
+
     struct AStarNode
     {
         int x;
@@ -68,6 +104,7 @@ private:
     std::vector< Entity* > m_Entities;
     std::vector< EntityMovable* > m_EntitiesMovable;
     std::vector< EntityMovable* > m_EntitiesSelected;
+    std::vector< EntityMovable* > m_PathRequests;
 };
 
 
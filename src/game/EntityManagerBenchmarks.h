@@ -0,0 +1,249 @@
+#include "../core/Benchmark.h"
+#include "EntityManager.h"
+#include "MapXmlFile.h"
+
+#include <OgreStringConverter.h>
+#include <cmath>
+
+
+
+// game state is moved away while benchmark runs and returned in teardown
+std::vector< Entity* > benchmark_saved_entities;
+std::vector< EntityMovable* > benchmark_saved_entities_movable;
+std::vector< EntityMovable* > benchmark_saved_entities_selected;
+std::vector< EntityMovable* > benchmark_saved_path_requests;
+std::vector< int > benchmark_saved_pass; // x * height + y
+
+// unit for which paths and passability are checked, it isn't in entity list
+EntityMovable* benchmark_self = NULL;
+std::vector< Ogre::SceneNode* > benchmark_nodes;
+
+extern std::vector< Ogre::Vector3 > place_finder_ignore;
+
+
+
+void
+EntityManager::InitBenchmarks()
+{
+    Benchmark::getSingleton().AddScenario( "astar_open", BenchmarkSetup, BenchmarkAStar, BenchmarkTeardown, 0 );
+    Benchmark::getSingleton().AddScenario( "astar_maze", BenchmarkSetupMaze, BenchmarkAStar, BenchmarkTeardown, 0 );
+    Benchmark::getSingleton().AddScenario( "is_passable_10", BenchmarkSetup, BenchmarkIsPassable, BenchmarkTeardown, 10 );
+    Benchmark::getSingleton().AddScenario( "is_passable_100", BenchmarkSetup, BenchmarkIsPassable, BenchmarkTeardown, 100 );
+    Benchmark::getSingleton().AddScenario( "is_passable_1000", BenchmarkSetup, BenchmarkIsPassable, BenchmarkTeardown, 1000 );
+    Benchmark::getSingleton().AddScenario( "place_finder_blocked", BenchmarkSetupBlock, BenchmarkPlaceFinder, BenchmarkTeardown, 81 );
+    Benchmark::getSingleton().AddScenario( "entity_update_100", BenchmarkSetup, BenchmarkUpdate, BenchmarkTeardown, 100 );
+    Benchmark::getSingleton().AddScenario( "entity_update_1000", BenchmarkSetup, BenchmarkUpdate, BenchmarkTeardown, 1000 );
+    Benchmark::getSingleton().AddScenario( "map_xml_parse", NULL, BenchmarkMapParse, NULL, 10000 );
+}
+
+
+
+EntityMovable*
+EntityManager::BenchmarkAddUnit( const float x, const float y )
+{
+    static int UNIQUE_NODE_ID = 0;
+
+    // nodes are children of entity node and destroyed in teardown, scenario
+    // runs inside one frame so units are never rendered
+    Ogre::SceneNode* node = m_SceneNode->createChildSceneNode( "Benchmark" + Ogre::StringConverter::toString( UNIQUE_NODE_ID ) );
+    ++UNIQUE_NODE_ID;
+    benchmark_nodes.push_back( node );
+
+    EntityMovable* unit = new EntityMovable( node );
+    std::vector< Ogre::Vector3 > occupation;
+    occupation.push_back( Ogre::Vector3( x, y, 0 ) );
+    unit->SetOccupation( occupation );
+    unit->SetCollisionMask( 1 );
+    unit->SetPosition( Ogre::Vector3( x, y, 0 ) );
+    return unit;
+}
+
+
+
+void
+EntityManager::BenchmarkSetup( const int size )
+{
+    EntityManager& manager = EntityManager::getSingleton();
+
+    manager.m_Entities.swap( benchmark_saved_entities );
+    manager.m_EntitiesMovable.swap( benchmark_saved_entities_movable );
+    manager.m_EntitiesSelected.swap( benchmark_saved_entities_selected );
+    manager.m_PathRequests.swap( benchmark_saved_path_requests );
+
+    unsigned int width = manager.m_MapSector.GetWidth();
+    unsigned int height = manager.m_MapSector.GetHeight();
+    benchmark_saved_pass.resize( width * height );
+    for( unsigned int x = 0; x < width; ++x )
+    {
+        for( unsigned int y = 0; y < height; ++y )
+        {
+            benchmark_saved_pass[ x * height + y ] = manager.m_MapSector.GetPass( x, y );
+            manager.m_MapSector.SetPass( x, y, 0 );
+        }
+    }
+    place_finder_ignore.clear();
+
+    benchmark_self = manager.BenchmarkAddUnit( 1, 1 );
+
+    // 7919 is prime so every unit gets its own cell, same for every run
+    unsigned int cells = width * height;
+    for( int i = 0; i < size; ++i )
+    {
+        unsigned int cell = ( i * 7919 + cells / 2 ) % cells;
+        EntityMovable* unit = manager.BenchmarkAddUnit( ( float )( cell % width ), ( float )( cell / width ) );
+        manager.m_Entities.push_back( unit );
+        manager.m_EntitiesMovable.push_back( unit );
+    }
+}
+
+
+
+void
+EntityManager::BenchmarkSetupMaze( const int size )
+{
+    BenchmarkSetup( size );
+
+    // walls across whole map with one gap at alternating ends
+    EntityManager& manager = EntityManager::getSingleton();
+    unsigned int width = manager.m_MapSector.GetWidth();
+    unsigned int height = manager.m_MapSector.GetHeight();
+    for( unsigned int x = 5; x < width; x += 10 )
+    {
+        unsigned int gap = ( ( x / 10 ) % 2 == 0 ) ? height - 2 : 1;
+        for( unsigned int y = 0; y < height; ++y )
+        {
+            if( y != gap )
+            {
+                manager.m_MapSector.SetPass( x, y, 1 );
+            }
+        }
+    }
+}
+
+
+
+void
+EntityManager::BenchmarkSetupBlock( const int size )
+{
+    BenchmarkSetup( 0 );
+
+    // square of units around center of map, place finder must go around it
+    EntityManager& manager = EntityManager::getSingleton();
+    int side = ( int )ceil( sqrt( ( float )size ) );
+    for( int i = 0; i < size; ++i )
+    {
+        EntityMovable* unit = manager.BenchmarkAddUnit( ( float )( ( int )manager.m_MapSector.GetWidth() / 2 - side / 2 + i % side ), ( float )( ( int )manager.m_MapSector.GetHeight() / 2 - side / 2 + i / side ) );
+        manager.m_Entities.push_back( unit );
+        manager.m_EntitiesMovable.push_back( unit );
+    }
+}
+
+
+
+void
+EntityManager::BenchmarkTeardown( const int size )
+{
+    EntityManager& manager = EntityManager::getSingleton();
+
+    delete benchmark_self;
+    benchmark_self = NULL;
+    for( unsigned int i = 0; i < manager.m_Entities.size(); ++i )
+    {
+        delete manager.m_Entities[ i ];
+    }
+    for( unsigned int i = 0; i < benchmark_nodes.size(); ++i )
+    {
+        manager.m_SceneNode->removeAndDestroyChild( benchmark_nodes[ i ]->getName() );
+    }
+    benchmark_nodes.clear();
+
+    manager.m_Entities.clear();
+    manager.m_EntitiesMovable.clear();
+    manager.m_EntitiesSelected.clear();
+    manager.m_PathRequests.clear();
+    manager.m_Entities.swap( benchmark_saved_entities );
+    manager.m_EntitiesMovable.swap( benchmark_saved_entities_movable );
+    manager.m_EntitiesSelected.swap( benchmark_saved_entities_selected );
+    manager.m_PathRequests.swap( benchmark_saved_path_requests );
+
+    unsigned int width = manager.m_MapSector.GetWidth();
+    unsigned int height = manager.m_MapSector.GetHeight();
+    for( unsigned int x = 0; x < width; ++x )
+    {
+        for( unsigned int y = 0; y < height; ++y )
+        {
+            manager.m_MapSector.SetPass( x, y, benchmark_saved_pass[ x * height + y ] );
+        }
+    }
+    place_finder_ignore.clear();
+}
+
+
+
+void
+EntityManager::BenchmarkAStar( const int size )
+{
+    EntityManager& manager = EntityManager::getSingleton();
+    place_finder_ignore.clear();
+    manager.AStarFinder( Ogre::Vector3( 1, 1, 0 ), Ogre::Vector3( ( float )( manager.m_MapSector.GetWidth() - 2 ), ( float )( manager.m_MapSector.GetHeight() - 2 ), 0 ), benchmark_self );
+}
+
+
+
+void
+EntityManager::BenchmarkIsPassable( const int size )
+{
+    EntityManager& manager = EntityManager::getSingleton();
+    int width = ( int )manager.m_MapSector.GetWidth();
+    int height = ( int )manager.m_MapSector.GetHeight();
+    for( int x = 0; x < width; ++x )
+    {
+        for( int y = 0; y < height; ++y )
+        {
+            manager.IsPassable( Ogre::Vector3( ( float )x, ( float )y, 0 ), benchmark_self );
+        }
+    }
+}
+
+
+
+void
+EntityManager::BenchmarkPlaceFinder( const int size )
+{
+    EntityManager& manager = EntityManager::getSingleton();
+    place_finder_ignore.clear();
+    manager.PlaceFinder( Ogre::Vector3( ( float )( manager.m_MapSector.GetWidth() / 2 ), ( float )( manager.m_MapSector.GetHeight() / 2 ), 0 ), benchmark_self );
+}
+
+
+
+void
+EntityManager::BenchmarkUpdate( const int size )
+{
+    EntityManager& manager = EntityManager::getSingleton();
+
+    // units walk one cell forth and back, 30 ticks for each cell
+    for( size_t i = 0; i < manager.m_EntitiesMovable.size(); ++i )
+    {
+        EntityMovable* unit = manager.m_EntitiesMovable[ i ];
+        if( unit->GetMovePath().size() == 0 )
+        {
+            Ogre::Vector3 pos = unit->GetPosition();
+            Ogre::Vector3 end = Ogre::Vector3( ( float )( ( ( int )pos.x ) ^ 1 ), pos.y, 0 );
+            std::vector< Ogre::Vector3 > move_path;
+            move_path.push_back( end );
+            unit->SetMoveEnd( end );
+            unit->SetMovePath( move_path );
+        }
+    }
+
+    manager.UpdateMovement( 1.0f / 60.0f, ( unsigned long long )-1 );
+}
+
+
+
+void
+EntityManager::BenchmarkMapParse( const int size )
+{
+    MapXmlFile map_file( "data/map/test.xml" );
+}
@@ -1,6 +1,8 @@
 #include <OgreHardwareBufferManager.h>
 #include <OgreMaterialManager.h>
 #include <OgreRoot.h>
+#include "../core/Counters.h"
+#include "../core/MemoryTracker.h"
 #include "EntityTile.h"
 
 
@@ -126,6 +128,7 @@ EntityTile::UpdateGeometry()
     float top = 0.0f;
     float bottom = 1.0f;
 
+    COUNTER_ADD( "vertex_buffer_locks", 1 );
     float* writeIterator = ( float* ) m_VertexBuffer->lock( Ogre::HardwareBuffer::HBL_NORMAL );
 
     *writeIterator++ = x1;
@@ -211,6 +214,7 @@ EntityTile::CreateVertexBuffer()
     vDecl->addElement( 0, offset, Ogre::VET_FLOAT2, Ogre::VES_TEXTURE_COORDINATES );
 
     m_VertexBuffer = Ogre::HardwareBufferManager::getSingletonPtr()->createVertexBuffer( vDecl->getVertexSize( 0 ), 6, Ogre::HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY, false );
+    MemoryTracker::Allocated( MEMORY_ENTITY_BUFFERS, m_VertexBuffer->getSizeInBytes() );
 
     mRenderOp.vertexData->vertexBufferBinding->setBinding( 0, m_VertexBuffer );
     mRenderOp.operationType = Ogre::RenderOperation::OT_TRIANGLE_LIST;
@@ -222,6 +226,7 @@ EntityTile::CreateVertexBuffer()
 void
 EntityTile::DestroyVertexBuffer()
 {
+    MemoryTracker::Freed( MEMORY_ENTITY_BUFFERS, m_VertexBuffer->getSizeInBytes() );
     delete mRenderOp.vertexData;
     mRenderOp.vertexData = 0;
     m_VertexBuffer.setNull();
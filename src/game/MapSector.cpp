@@ -1,6 +1,7 @@
 #include <OgreHardwareBufferManager.h>
 #include <OgreMaterialManager.h>
 #include <OgreRoot.h>
+#include "../core/Counters.h"
 #include "../core/Logger.h"
 #include "MapSector.h"
 #include "MapTilesXmlFile.h"
@@ -113,6 +114,7 @@ MapSector::Quad( const unsigned int x, const unsigned int y, const float width,
 
     float m_Z = 0.0f;
 
+    COUNTER_ADD( "vertex_buffer_locks", 1 );
     float* writeIterator = ( float* ) m_VertexBuffer->lock( Ogre::HardwareBuffer::HBL_NORMAL );
     writeIterator += mRenderOp.vertexData->vertexCount * 9;
 
@@ -195,6 +197,33 @@ MapSector::GetPass( const unsigned int x, const unsigned int y ) const
 
 
 
+void
+MapSector::SetPass( const unsigned int x, const unsigned int y, const int pass )
+{
+    if( ( x < 100 ) && ( y < 100 ) )
+    {
+        m_PassMap[ x ][ y ] = pass;
+    }
+}
+
+
+
+unsigned int
+MapSector::GetWidth() const
+{
+    return sizeof( m_PassMap ) / sizeof( m_PassMap[ 0 ] );
+}
+
+
+
+unsigned int
+MapSector::GetHeight() const
+{
+    return sizeof( m_PassMap[ 0 ] ) / sizeof( m_PassMap[ 0 ][ 0 ] );
+}
+
+
+
 void
 MapSector::CreateVertexBuffers()
 {
@@ -31,6 +31,10 @@ public:
     void Quad( const unsigned int x, const unsigned int y, const float width, const float height, const Ogre::String& name );
 
     const int GetPass( const unsigned int x, const unsigned int y ) const;
+    void SetPass( const unsigned int x, const unsigned int y, const int pass );
+    // size of pass map in cells
+    unsigned int GetWidth() const;
+    unsigned int GetHeight() const;
 
 private:
     void CreateVertexBuffers();